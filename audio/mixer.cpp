@@ -22,6 +22,8 @@
 
 #include "gui/EventRecorder.h"
 
+#include "common/atomic.h"
+#include "common/config-manager.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 
@@ -43,24 +45,25 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, ResamplerQuality resamplerQuality);
 	~Channel();
 
 	/**
-	 * Mixes the channel's samples into the given buffer.
+	 * Mixes the channel's samples into the given mix bus.
 	 *
-	 * @param data buffer where to mix the data
-	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 * @param bus     32-bit buffer where to accumulate the data
+	 * @param scratch 16-bit buffer of the same length, used for the
+	 *                rate converted samples before volume is applied
+	 * @param len     number of sample *pairs*. So a value of
+	 *                10 means that the buffers contain twice 10 samples.
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *bus, int16 *scratch, uint len);
 
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && !_converter->hasTail(); }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -115,12 +118,6 @@ public:
 	 */
 	int8 getBalance();
 
-	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
-	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
-
 	/**
 	 * Queries how long the channel has been playing.
 	 */
@@ -148,9 +145,20 @@ public:
 	 */
 	SoundHandle getHandle() const { return _handle; }
 
+	/**
+	 * Sets the channel's position in the channel list of its sound type bus.
+	 */
+	void setBusIndex(uint busIndex) { _busIndex = busIndex; }
+
+	/**
+	 * Queries the channel's position in the channel list of its sound type bus.
+	 */
+	uint getBusIndex() const { return _busIndex; }
+
 private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
+	uint _busIndex;
 	bool _permanent;
 	int _pauseLevel;
 	int _id;
@@ -178,17 +186,35 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _resamplerQuality(kResamplerLinear),
+	  _mixBus(0), _submixBus(0), _mixScratch(0), _mixBufferSize(0),
+	  _commandWritePos(0), _commandReadPos(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		_channels[i] = 0;
+	for (int i = 0; i < COMMAND_QUEUE_SIZE; i++)
+		_commands[i].sequence = i;
+
+#ifdef HAVE_ATOMICS
+	_useCommandQueue = true;
+#else
+	_useCommandQueue = false;
+#endif
+
+	// Like the output rate, the resampler is only configurable by advanced
+	// users who edit their config file directly.
+	if (ConfMan.hasKey("resampler_quality", Common::ConfigManager::kApplicationDomain))
+		_resamplerQuality = (ResamplerQuality)CLIP<int>(ConfMan.getInt("resampler_quality", Common::ConfigManager::kApplicationDomain),
+		                                                 kResamplerLinear, kResamplerPolyphaseBest);
 }
 
 MixerImpl::~MixerImpl() {
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (uint i = 0; i < _channels.size(); i++)
 		delete _channels[i];
+
+	free(_mixBus);
+	free(_submixBus);
+	free(_mixScratch);
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -197,28 +223,109 @@ void MixerImpl::setReady(bool ready) {
 	_mixerReady = ready;
 }
 
+void MixerImpl::enableCommandQueue(bool enable) {
+	Common::StackLock lock(_mutex);
+
+	applyCommands();
+#ifdef HAVE_ATOMICS
+	_useCommandQueue = enable;
+#endif
+}
+
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
-void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
-	int index = -1;
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] == 0) {
-			index = i;
+Channel *MixerImpl::findChannel(SoundHandle handle) const {
+	const uint index = handle._val & (MAX_CHANNELS - 1);
+	if (index >= _channels.size() || !_channels[index] || _channels[index]->getHandle()._val != handle._val)
+		return 0;
+
+	return _channels[index];
+}
+
+bool MixerImpl::postCommand(CommandType type, SoundHandle handle, int32 value) {
+	if (!_useCommandQueue)
+		return false;
+
+	// A bounded multi-producer queue: an entry is free for position pos
+	// when its sequence number is pos, and filled in when it is pos + 1.
+	int32 pos = Common::atomicLoad(&_commandWritePos);
+	while (true) {
+		Command &command = _commands[pos & (COMMAND_QUEUE_SIZE - 1)];
+		const int32 diff = (int32)((uint32)Common::atomicLoad(&command.sequence) - (uint32)pos);
+
+		if (diff == 0) {
+			if (Common::atomicCompareExchange(&_commandWritePos, pos, (int32)((uint32)pos + 1))) {
+				command.type = type;
+				command.handle = handle._val;
+				command.value = value;
+				Common::atomicStore(&command.sequence, (int32)((uint32)pos + 1));
+				return true;
+			}
+		} else if (diff < 0) {
+			// The mixer did not catch up yet
+			return false;
+		}
+
+		// Another thread took the entry first
+		pos = Common::atomicLoad(&_commandWritePos);
+	}
+}
+
+void MixerImpl::applyCommands() {
+	while (true) {
+		Command &command = _commands[_commandReadPos & (COMMAND_QUEUE_SIZE - 1)];
+		if (Common::atomicLoad(&command.sequence) != (int32)((uint32)_commandReadPos + 1))
 			break;
+
+		// Changes to sounds which stopped meanwhile are ignored, like
+		// the unqueued ones
+		SoundHandle handle;
+		handle._val = command.handle;
+		Channel *chan = findChannel(handle);
+		if (chan) {
+			if (command.type == kCommandVolume)
+				chan->setVolume(command.value);
+			else
+				chan->setBalance(command.value);
 		}
+
+		Common::atomicStore(&command.sequence, (int32)((uint32)_commandReadPos + COMMAND_QUEUE_SIZE));
+		_commandReadPos = (int32)((uint32)_commandReadPos + 1);
 	}
-	if (index == -1) {
-		warning("MixerImpl::out of mixer slots");
-		delete chan;
-		return;
+}
+
+void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+	if (_freeSlots.empty()) {
+		if (_channels.size() >= MAX_CHANNELS) {
+			warning("MixerImpl::out of mixer slots");
+			delete chan;
+			return;
+		}
+
+		// Grow the pool by a whole slab, so that it does not have to be
+		// reallocated for every new channel
+		const uint oldSize = _channels.size();
+		_channels.resize(oldSize + CHANNEL_SLAB_SIZE);
+		for (uint i = oldSize + CHANNEL_SLAB_SIZE; i > oldSize; i--) {
+			_channels[i - 1] = 0;
+			_freeSlots.push_back(i - 1);
+		}
 	}
 
+	const uint index = _freeSlots.back();
+	_freeSlots.pop_back();
 	_channels[index] = chan;
 
+	SoundTypeBus &bus = _buses[chan->getType()];
+	chan->setBusIndex(bus.channels.size());
+	bus.channels.push_back(chan);
+	if (bus.pauseLevel)
+		chan->pause(true);
+
 	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	chanHandle._val = index | (_handleSeed << CHANNEL_INDEX_BITS);
 
 	chan->setHandle(chanHandle);
 	_handleSeed++;
@@ -226,6 +333,21 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		*handle = chanHandle;
 }
 
+void MixerImpl::removeChannel(Channel *chan) {
+	const uint index = chan->getHandle()._val & (MAX_CHANNELS - 1);
+	assert(_channels[index] == chan);
+	_channels[index] = 0;
+	_freeSlots.push_back(index);
+
+	// Move the last channel of the bus into the freed position
+	Common::Array<Channel *> &busChannels = _buses[chan->getType()].channels;
+	const uint busIndex = chan->getBusIndex();
+	assert(busChannels[busIndex] == chan);
+	busChannels[busIndex] = busChannels.back();
+	busChannels[busIndex]->setBusIndex(busIndex);
+	busChannels.pop_back();
+}
+
 void MixerImpl::playStream(
 			SoundType type,
 			SoundHandle *handle,
@@ -241,12 +363,12 @@ void MixerImpl::playStream(
 		return;
 	}
 
-
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
 	assert(_mixerReady);
 
 	// Prevent duplicate sounds
 	if (id != -1) {
-		for (int i = 0; i != NUM_CHANNELS; i++)
+		for (uint i = 0; i < _channels.size(); i++)
 			if (_channels[i] != 0 && _channels[i]->getId() == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
@@ -265,7 +387,7 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _resamplerQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
@@ -274,118 +396,202 @@ void MixerImpl::playStream(
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
-	Common::StackLock lock(_mutex);
-
 	int16 *buf = (int16 *)samples;
 	// we store stereo, 16-bit samples
 	assert(len % 4 == 0);
 	len >>= 2;
 
-	// Since the mixer callback has been called, the mixer must be ready...
-	_mixerReady = true;
+	// Finished channels are only unlinked while the lock is held and get
+	// destroyed afterwards, so that freeing their streams does not keep
+	// engine threads waiting on the mixer mutex.
+	Common::Array<Channel *> finished;
+	int res = 0, tmp;
+
+	{
+		Common::StackLock lock(_mutex);
 
-	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+		// Since the mixer callback has been called, the mixer must be ready...
+		_mixerReady = true;
 
-	// mix all channels
-	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
+		applyCommands();
+
+		if (len > _mixBufferSize) {
+			free(_mixBus);
+			free(_submixBus);
+			free(_mixScratch);
+			_mixBus = (int32 *)malloc(2 * len * sizeof(int32));
+			_submixBus = (int32 *)malloc(2 * len * sizeof(int32));
+			_mixScratch = (int16 *)malloc(2 * len * sizeof(int16));
+			if (!_mixBus || !_submixBus || !_mixScratch)
+				error("[MixerImpl::mixCallback] Cannot allocate memory for mix buffers");
+			_mixBufferSize = len;
+		}
+
+		// zero the bus
+		memset(_mixBus, 0, 2 * len * sizeof(int32));
+
+		for (int type = 0; type < NUM_SOUND_TYPES; type++) {
+			SoundTypeBus &bus = _buses[type];
+			if (bus.channels.empty())
+				continue;
+
+			memset(_submixBus, 0, 2 * len * sizeof(int32));
+
+			// mix all channels of the bus, in reverse order so that
+			// removing a finished channel does not skip another one
+			for (uint i = bus.channels.size(); i > 0; i--) {
+				Channel *chan = bus.channels[i - 1];
+				if (chan->isFinished()) {
+					removeChannel(chan);
+					finished.push_back(chan);
+				} else if (!chan->isPaused()) {
+					tmp = chan->mix(_submixBus, _mixScratch, len);
+
+					if (tmp > res)
+						res = tmp;
+				}
 			}
+
+			// Muted buses still consume their streams, they are just not
+			// added to the main mix
+			if (!bus.mute)
+				mixSubmixToBus(_mixBus, _submixBus, len, bus.volume);
 		}
 
+		// Channels are summed up without clipping, only the final mix is clamped
+		clampBusToOutput(buf, _mixBus, len);
+	}
+
+	for (uint i = 0; i < finished.size(); i++)
+		delete finished[i];
+
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	Common::Array<Channel *> stopped;
+
+	{
+		Common::StackLock lock(_mutex);
+		for (uint i = 0; i < _channels.size(); i++) {
+			if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
+				stopped.push_back(_channels[i]);
+				removeChannel(_channels[i]);
+			}
 		}
 	}
+
+	for (uint i = 0; i < stopped.size(); i++)
+		delete stopped[i];
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	Common::Array<Channel *> stopped;
+
+	{
+		Common::StackLock lock(_mutex);
+		for (uint i = 0; i < _channels.size(); i++) {
+			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+				stopped.push_back(_channels[i]);
+				removeChannel(_channels[i]);
+			}
 		}
 	}
+
+	for (uint i = 0; i < stopped.size(); i++)
+		delete stopped[i];
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	Channel *stopped;
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+	{
+		Common::StackLock lock(_mutex);
 
-	delete _channels[index];
-	_channels[index] = 0;
+		// Simply ignore stop requests for handles of sounds that already terminated
+		stopped = findChannel(handle);
+		if (!stopped)
+			return;
+
+		removeChannel(stopped);
+	}
+
+	delete stopped;
 }
 
-void MixerImpl::muteSoundType(SoundType type, bool mute) {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	_soundTypeSettings[type].mute = mute;
+void MixerImpl::stopSoundType(SoundType type) {
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
 
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+	Common::Array<Channel *> stopped;
+
+	{
+		Common::StackLock lock(_mutex);
+		Common::Array<Channel *> &busChannels = _buses[type].channels;
+		for (uint i = busChannels.size(); i > 0; i--) {
+			Channel *chan = busChannels[i - 1];
+			if (!chan->isPermanent()) {
+				stopped.push_back(chan);
+				removeChannel(chan);
+			}
+		}
 	}
+
+	for (uint i = 0; i < stopped.size(); i++)
+		delete stopped[i];
+}
+
+void MixerImpl::muteSoundType(SoundType type, bool mute) {
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
+
+	Common::StackLock lock(_mutex);
+	_buses[type].mute = mute;
 }
 
 bool MixerImpl::isSoundTypeMuted(SoundType type) const {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
-	return _soundTypeSettings[type].mute;
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
+	return _buses[type].mute;
 }
 
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	// Engines fade sounds by changing their volume every frame, which
+	// should not wait for the mixer callback.
+	if (postCommand(kCommandVolume, handle, volume))
 		return;
 
-	_channels[index]->setVolume(volume);
+	Common::StackLock lock(_mutex);
+	applyCommands();
+
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->setVolume(volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return 0;
+	Common::StackLock lock(_mutex);
+	applyCommands();
 
-	return _channels[index]->getVolume();
+	Channel *chan = findChannel(handle);
+	return chan ? chan->getVolume() : 0;
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
-	Common::StackLock lock(_mutex);
-
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	if (postCommand(kCommandBalance, handle, balance))
 		return;
 
-	_channels[index]->setBalance(balance);
+	Common::StackLock lock(_mutex);
+	applyCommands();
+
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->setBalance(balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return 0;
+	Common::StackLock lock(_mutex);
+	applyCommands();
 
-	return _channels[index]->getBalance();
+	Channel *chan = findChannel(handle);
+	return chan ? chan->getBalance() : 0;
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -395,26 +601,24 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return Timestamp(0, _sampleRate);
 
-	return _channels[index]->getElapsedTime();
+	return chan->getElapsedTime();
 }
 
 void MixerImpl::loopChannel(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
-
-	_channels[index]->loop();
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->loop();
 }
 
 void MixerImpl::pauseAll(bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
+	for (uint i = 0; i < _channels.size(); i++) {
 		if (_channels[i] != 0) {
 			_channels[i]->pause(paused);
 		}
@@ -423,7 +627,7 @@ void MixerImpl::pauseAll(bool paused) {
 
 void MixerImpl::pauseID(int id, bool paused) {
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
+	for (uint i = 0; i < _channels.size(); i++) {
 		if (_channels[i] != 0 && _channels[i]->getId() == id) {
 			_channels[i]->pause(paused);
 			return;
@@ -435,11 +639,28 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (chan)
+		chan->pause(paused);
+}
+
+void MixerImpl::pauseSoundType(SoundType type, bool paused) {
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
+
+	Common::StackLock lock(_mutex);
+	SoundTypeBus &bus = _buses[type];
+
+	if (paused)
+		bus.pauseLevel++;
+	else if (bus.pauseLevel > 0)
+		bus.pauseLevel--;
+	else
 		return;
 
-	_channels[index]->pause(paused);
+	// Each channel carries the bus pause as one extra pause level, which
+	// keeps its elapsed time bookkeeping intact
+	for (uint i = 0; i < bus.channels.size(); i++)
+		bus.channels[i]->pause(paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
@@ -449,7 +670,7 @@ bool MixerImpl::isSoundIDActive(int id) {
 	g_eventRec.updateSubsystems();
 #endif
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (uint i = 0; i < _channels.size(); i++)
 		if (_channels[i] && _channels[i]->getId() == id)
 			return true;
 	return false;
@@ -457,10 +678,8 @@ bool MixerImpl::isSoundIDActive(int id) {
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
-	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
-		return _channels[index]->getId();
-	return 0;
+	Channel *chan = findChannel(handle);
+	return chan ? chan->getId() : 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
@@ -470,20 +689,18 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	g_eventRec.updateSubsystems();
 #endif
 
-	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return findChannel(handle) != 0;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
+
 	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
-			return true;
-	return false;
+	return !_buses[type].channels.empty();
 }
 
 void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
 
 	// Check range
 	volume = CLIP<int>(volume, 0, kMaxMixerVolume);
@@ -492,18 +709,13 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// scaling? See also Player_V2::setMasterVolume
 
 	Common::StackLock lock(_mutex);
-	_soundTypeSettings[type].volume = volume;
-
-	for (int i = 0; i != NUM_CHANNELS; ++i) {
-		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
-	}
+	_buses[type].volume = volume;
 }
 
 int MixerImpl::getVolumeForSoundType(SoundType type) const {
-	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+	assert(0 <= (int)type && (int)type < NUM_SOUND_TYPES);
 
-	return _soundTypeSettings[type].volume;
+	return _buses[type].volume;
 }
 
 
@@ -512,8 +724,9 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
-	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
+				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+				 ResamplerQuality resamplerQuality)
+	: _type(type), _busIndex(0), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
 	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
 	  _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
 	  _stream(stream, autofreeStream) {
@@ -521,7 +734,7 @@ Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, resamplerQuality);
 }
 
 Channel::~Channel() {
@@ -547,29 +760,25 @@ int8 Channel::getBalance() {
 }
 
 void Channel::updateChannelVolumes() {
-	// From the channel balance/volume and the global volume, we compute
-	// the effective volume for the left and right channel. Note the
-	// slightly odd divisor: the 255 reflects the fact that the maximal
-	// value for _volume is 255, while the 127 is there because the
-	// balance value ranges from -127 to 127.  The mixer (music/sound)
-	// volume is in the range 0 - kMaxMixerVolume.
-	// Hence, the vol_l/vol_r values will be in that range, too
-
-	if (!_mixer->isSoundTypeMuted(_type)) {
-		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
-
-		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
-		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
-		}
+	// From the channel balance/volume, we compute the effective volume
+	// for the left and right channel. Note the slightly odd divisor: the
+	// 255 reflects the fact that the maximal value for _volume is 255,
+	// while the 127 is there because the balance value ranges from -127
+	// to 127. The vol_l/vol_r values will be in the range 0 -
+	// kMaxMixerVolume. The volume and mute state of the sound type are
+	// applied later on, when the submix bus of the type is mixed.
+
+	int vol = Mixer::kMaxMixerVolume * _volume;
+
+	if (_balance == 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = vol / Mixer::kMaxChannelVolume;
+	} else if (_balance < 0) {
+		_volL = vol / Mixer::kMaxChannelVolume;
+		_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 	} else {
-		_volL = _volR = 0;
+		_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+		_volR = vol / Mixer::kMaxChannelVolume;
 	}
 }
 
@@ -631,18 +840,32 @@ void Channel::loop() {
 	}
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int32 *bus, int16 *scratch, uint len) {
 	assert(_stream);
 
 	int res = 0;
-	if (_stream->endOfData()) {
+	if (_stream->endOfData() && !(_stream->endOfStream() && _converter->hasTail())) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+
+		// Rate convert at full volume, the channel volume is applied while
+		// accumulating into the mix bus.
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		for (uint i = 0; i < 2 * len; i++)
+			scratch[i] = (int16)0x8000;
+#else
+		memset(scratch, 0, 2 * len * sizeof(int16));
+#endif
+		res = _converter->flow(*_stream, scratch, len, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		for (int i = 0; i < 2 * res; i++)
+			scratch[i] ^= 0x8000;
+#endif
+		mixToBus(bus, scratch, res, _volL, _volR);
 		_samplesDecoded += res;
 	}
 
@@ -149,6 +149,14 @@ public:
 	 */
 	virtual void stopHandle(SoundHandle handle) = 0;
 
+	/**
+	 * Stop all currently playing sounds of the given sound type,
+	 * except for permanent channels.
+	 *
+	 * @param type  The sound type to stop.
+	 */
+	virtual void stopSoundType(SoundType type) = 0;
+
 
 
 	/**
@@ -175,6 +183,17 @@ public:
 	 */
 	virtual void pauseHandle(SoundHandle handle, bool paused) = 0;
 
+	/**
+	 * Pause or unpause all sounds of the given sound type.
+	 *
+	 * Pausing is recursive, like pauseAll, and also affects sounds of the
+	 * type that are started while it is paused.
+	 *
+	 * @param type    The sound type to pause or unpause.
+	 * @param paused  True to pause the sounds, false to unpause them.
+	 */
+	virtual void pauseSoundType(SoundType type, bool paused) = 0;
+
 
 
 	/**
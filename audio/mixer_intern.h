@@ -24,8 +24,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -59,7 +61,33 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		/** Number of handle bits used for the channel slot index. */
+		CHANNEL_INDEX_BITS = 10,
+		/** Upper limit for the number of simultaneously playing channels. */
+		MAX_CHANNELS = 1 << CHANNEL_INDEX_BITS,
+		/** Number of channel slots added whenever the pool runs full. */
+		CHANNEL_SLAB_SIZE = 32,
+		/** Number of sound types, see Mixer::SoundType. */
+		NUM_SOUND_TYPES = 4,
+		/** Number of entries in the command queue, a power of two. */
+		COMMAND_QUEUE_SIZE = 256
+	};
+
+	enum CommandType {
+		kCommandVolume,
+		kCommandBalance
+	};
+
+	/**
+	 * Channel parameter change posted without taking the mixer mutex.
+	 * The sequence number tells the mixer whether the entry is filled in
+	 * and tells posting threads whether it is free again.
+	 */
+	struct Command {
+		volatile int32 sequence;
+		CommandType type;
+		uint32 handle;
+		int32 value;
 	};
 
 	Common::Mutex _mutex;
@@ -67,17 +95,60 @@ private:
 	const uint _sampleRate;
 	bool _mixerReady;
 	uint32 _handleSeed;
+	ResamplerQuality _resamplerQuality;
 
-	struct SoundTypeSettings {
-		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
+	/**
+	 * Submix bus of a sound type. All channels of the type are summed up
+	 * in here before the bus volume is applied and the result is added
+	 * to the main mix.
+	 */
+	struct SoundTypeBus {
+		SoundTypeBus() : mute(false), volume(kMaxMixerVolume), pauseLevel(0) {}
 
 		bool mute;
 		int volume;
+		int pauseLevel;
+		Common::Array<Channel *> channels;
 	};
 
-	SoundTypeSettings _soundTypeSettings[4];
-	Channel *_channels[NUM_CHANNELS];
+	SoundTypeBus _buses[NUM_SOUND_TYPES];
+
+	/** Channel pool, indexed by the low bits of the sound handles. */
+	Common::Array<Channel *> _channels;
+	/** Unused slots in _channels. */
+	Common::Array<uint> _freeSlots;
+
+	/** 32-bit accumulation buffer all buses are mixed into. */
+	int32 *_mixBus;
+	/** 32-bit accumulation buffer of the bus currently being mixed. */
+	int32 *_submixBus;
+	/** Per channel rate conversion output, before volume is applied. */
+	int16 *_mixScratch;
+	/** Size of the mix buffers, in sample pairs. */
+	uint _mixBufferSize;
 
+	/**
+	 * Queue of channel volume and balance changes. Any thread may post to
+	 * it, while it is only emptied with the mutex held, so that the engine
+	 * does not wait for a mix in progress to change these.
+	 */
+	Command _commands[COMMAND_QUEUE_SIZE];
+	volatile int32 _commandWritePos;
+	/** Next entry to apply, only accessed with the mutex held. */
+	int32 _commandReadPos;
+	bool _useCommandQueue;
+
+	Channel *findChannel(SoundHandle handle) const;
+	void removeChannel(Channel *chan);
+
+	/**
+	 * Queue a channel parameter change. Returns false if the queue is full
+	 * or disabled, in which case the caller has to apply it itself.
+	 */
+	bool postCommand(CommandType type, SoundHandle handle, int32 value);
+
+	/** Apply all the queued changes. Requires the mutex to be held. */
+	void applyCommands();
 
 public:
 
@@ -100,10 +171,12 @@ public:
 	virtual void stopAll();
 	virtual void stopID(int id);
 	virtual void stopHandle(SoundHandle handle);
+	virtual void stopSoundType(SoundType type);
 
 	virtual void pauseAll(bool paused);
 	virtual void pauseID(int id, bool paused);
 	virtual void pauseHandle(SoundHandle handle, bool paused);
+	virtual void pauseSoundType(SoundType type, bool paused);
 
 	virtual bool isSoundIDActive(int id);
 	virtual int getSoundID(SoundHandle handle);
@@ -151,6 +224,13 @@ public:
 	 * their audio system has been completed.
 	 */
 	void setReady(bool ready);
+
+	/**
+	 * Enable or disable queueing channel volume and balance changes instead
+	 * of taking the mixer mutex for them. It is enabled by default where
+	 * atomic operations are available. Meant for benchmarks.
+	 */
+	void enableCommandQueue(bool enable);
 };
 
 /** @} */
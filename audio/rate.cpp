@@ -31,10 +31,20 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "common/algorithm.h"
 #include "common/frac.h"
+#include "common/hashmap.h"
+#include "common/mutex.h"
+#include "common/singleton.h"
 #include "common/textconsole.h"
 #include "common/util.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Audio {
 
 
@@ -338,12 +348,426 @@ public:
 };
 
 
+#pragma mark -
+
+
+/**
+ * Coefficients of a windowed-sinc low-pass filter, split into phases.
+ *
+ * Phase p holds the numTaps coefficients used for an output sample that
+ * lies p / numPhases input samples after the center of the filter window.
+ * Coefficients are in Q14 fixed point, and every phase sums up to exactly
+ * one, so that the filter has unity gain at DC.
+ */
+struct PolyphaseFilterBank {
+	enum {
+		COEFF_BITS = 14,
+		MAX_PHASES = 1024,
+		MAX_TAPS = 128
+	};
+
+	uint numTaps;
+	uint numPhases;
+	int16 *coeffs;
+
+	PolyphaseFilterBank(st_rate_t inrate, st_rate_t outrate, uint baseTaps);
+	~PolyphaseFilterBank() { delete[] coeffs; }
+
+	const int16 *getPhase(uint phase) const { return coeffs + phase * numTaps; }
+};
+
+/** Zeroth order modified Bessel function of the first kind, for the Kaiser window. */
+static double besselI0(double x) {
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 50 && term > sum * 1e-12; k++) {
+		const double t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+	}
+	return sum;
+}
+
+PolyphaseFilterBank::PolyphaseFilterBank(st_rate_t inrate, st_rate_t outrate, uint baseTaps) {
+	// When downsampling, the cutoff moves down and the filter has to grow
+	// accordingly to keep the same transition band.
+	const uint ratio = (inrate + outrate - 1) / outrate;
+	numTaps = MIN<uint>(baseTaps * ratio, MAX_TAPS);
+
+	// One phase per distinct output position, if that is a sane number.
+	// Otherwise the positions get rounded down to the nearest phase.
+	numPhases = MIN<uint>(outrate / Common::gcd<uint>(inrate, outrate), MAX_PHASES);
+
+	coeffs = new int16[numPhases * numTaps];
+
+	const double cutoff = 0.5 * MIN<double>(1.0, (double)outrate / inrate) * (baseTaps >= 32 ? 0.95 : 0.9);
+	const double beta = 8.0;
+	const double halfWidth = numTaps / 2.0;
+	const double windowNorm = besselI0(beta);
+
+	double *h = new double[numTaps];
+	for (uint p = 0; p < numPhases; p++) {
+		const double phase = (double)p / numPhases;
+		double sum = 0.0;
+
+		for (uint j = 0; j < numTaps; j++) {
+			// Distance between the output position and input sample j
+			const double d = phase + halfWidth - 1 - j;
+			const double w = d / halfWidth;
+			const double window = (w > -1.0 && w < 1.0) ? besselI0(beta * sqrt(1.0 - w * w)) / windowNorm : 0.0;
+			const double x = 2.0 * cutoff * d;
+			const double sinc = (fabs(x) < 1e-9) ? 1.0 : sin(M_PI * x) / (M_PI * x);
+			h[j] = 2.0 * cutoff * sinc * window;
+			sum += h[j];
+		}
+
+		int16 *c = coeffs + p * numTaps;
+		int total = 0;
+		uint peak = 0;
+		for (uint j = 0; j < numTaps; j++) {
+			c[j] = (int16)floor(h[j] / sum * (1 << COEFF_BITS) + 0.5);
+			total += c[j];
+			if (c[j] > c[peak])
+				peak = j;
+		}
+		// Put the rounding error on the largest tap, to keep DC gain exact
+		c[peak] += (1 << COEFF_BITS) - total;
+	}
+	delete[] h;
+}
+
+/**
+ * Cache of filter banks, so that all channels converting between the same
+ * two rates share their coefficient tables. Banks stay around until the
+ * cache is destroyed, there are only few distinct rate pairs in practice.
+ */
+class PolyphaseFilterCache : public Common::Singleton<PolyphaseFilterCache> {
+public:
+	~PolyphaseFilterCache() {
+		for (BankMap::iterator i = _banks.begin(); i != _banks.end(); ++i)
+			delete i->_value;
+	}
+
+	const PolyphaseFilterBank *getBank(st_rate_t inrate, st_rate_t outrate, uint baseTaps) {
+		Common::StackLock lock(_mutex);
+
+		const uint64 key = ((uint64)inrate << 40) | ((uint64)outrate << 8) | baseTaps;
+		BankMap::iterator i = _banks.find(key);
+		if (i != _banks.end())
+			return i->_value;
+
+		PolyphaseFilterBank *bank = new PolyphaseFilterBank(inrate, outrate, baseTaps);
+		_banks[key] = bank;
+		return bank;
+	}
+
+private:
+	struct UInt64Hash {
+		uint operator()(uint64 x) const { return (uint)(x ^ (x >> 32)); }
+	};
+	typedef Common::HashMap<uint64, PolyphaseFilterBank *, UInt64Hash> BankMap;
+
+	Common::Mutex _mutex;
+	BankMap _banks;
+};
+
+/**
+ * Computes the dot product of the samples and filter coefficients.
+ * @p numTaps must be a multiple of 8.
+ */
+static inline int32 polyphaseDotProduct(const st_sample_t *samples, const int16 *coeffs, uint numTaps) {
+#if defined(__SSE2__)
+	__m128i acc = _mm_setzero_si128();
+	for (uint j = 0; j < numTaps; j += 8)
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(samples + j)), _mm_loadu_si128((const __m128i *)(coeffs + j))));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+	acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(acc);
+#elif defined(__ARM_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for (uint j = 0; j < numTaps; j += 8) {
+		const int16x8_t x = vld1q_s16(samples + j);
+		const int16x8_t c = vld1q_s16(coeffs + j);
+		acc = vmlal_s16(acc, vget_low_s16(x), vget_low_s16(c));
+		acc = vmlal_s16(acc, vget_high_s16(x), vget_high_s16(c));
+	}
+	const int32x2_t sum = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+	return vget_lane_s32(vpadd_s32(sum, sum), 0);
+#else
+	int32 acc = 0;
+	for (uint j = 0; j < numTaps; j++)
+		acc += samples[j] * coeffs[j];
+	return acc;
+#endif
+}
+
+/**
+ * Audio rate converter based on a windowed-sinc polyphase FIR filter.
+ *
+ * Compared to the linear interpolation this is considerably slower, but it
+ * does not produce audible aliasing when upsampling low rate samples.
+ */
+template<bool stereo, bool reverseStereo>
+class PolyphaseRateConverter : public RateConverter {
+protected:
+	enum {
+		CHANNELS = stereo ? 2 : 1
+	};
+
+	const PolyphaseFilterBank *_bank;
+	const st_rate_t _inrate;
+	const st_rate_t _outrate;
+
+	st_sample_t _inBuf[INTERMEDIATE_BUFFER_SIZE];
+
+	/** deinterleaved input history, one buffer per channel */
+	st_sample_t *_history[CHANNELS];
+	uint _historySize;
+	/** start of the current filter window in _history */
+	uint _historyPos;
+	/** end of the valid data in _history */
+	uint _historyEnd;
+
+	/** position between two input samples, in units of 1 / _outrate */
+	st_rate_t _frac;
+
+	/** samples of silence still to be added after the end of the input */
+	uint _tailLeft;
+	bool _ended;
+
+	void compactHistory();
+	bool refill(AudioStream &input);
+	bool padTail();
+
+public:
+	PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, uint baseTaps);
+	~PolyphaseRateConverter();
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+	bool hasTail() const {
+		return !_ended || _tailLeft > 0 || _historyEnd - _historyPos >= _bank->numTaps;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+PolyphaseRateConverter<stereo, reverseStereo>::PolyphaseRateConverter(st_rate_t inrate, st_rate_t outrate, uint baseTaps)
+	: _inrate(inrate), _outrate(outrate), _frac(0), _tailLeft(0), _ended(false) {
+	_bank = PolyphaseFilterCache::instance().getBank(inrate, outrate, baseTaps);
+
+	_historySize = _bank->numTaps + INTERMEDIATE_BUFFER_SIZE / CHANNELS;
+	for (int ch = 0; ch < CHANNELS; ch++)
+		_history[ch] = new st_sample_t[_historySize]();
+
+	// Start with half a window of silence, so that the first output sample
+	// is centered on the first input sample
+	_historyPos = 0;
+	_historyEnd = _bank->numTaps / 2 - 1;
+}
+
+template<bool stereo, bool reverseStereo>
+PolyphaseRateConverter<stereo, reverseStereo>::~PolyphaseRateConverter() {
+	for (int ch = 0; ch < CHANNELS; ch++)
+		delete[] _history[ch];
+}
+
+template<bool stereo, bool reverseStereo>
+void PolyphaseRateConverter<stereo, reverseStereo>::compactHistory() {
+	// Move the unused history to the front of the buffers
+	const uint remaining = _historyEnd - _historyPos;
+	for (int ch = 0; ch < CHANNELS; ch++)
+		memmove(_history[ch], _history[ch] + _historyPos, remaining * sizeof(st_sample_t));
+	_historyPos = 0;
+	_historyEnd = remaining;
+}
+
+template<bool stereo, bool reverseStereo>
+bool PolyphaseRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	compactHistory();
+
+	const int len = input.readBuffer(_inBuf, MIN<int>((_historySize - _historyEnd) * CHANNELS, ARRAYSIZE(_inBuf)));
+	if (len <= 0)
+		return false;
+
+	const st_sample_t *in = _inBuf;
+	for (int i = 0; i < len / CHANNELS; i++) {
+		for (int ch = 0; ch < CHANNELS; ch++)
+			_history[ch][_historyEnd] = *in++;
+		_historyEnd++;
+	}
+
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+bool PolyphaseRateConverter<stereo, reverseStereo>::padTail() {
+	// The window is centered half a window before its end, so that much
+	// silence moves its center past the last input sample
+	if (!_ended) {
+		_ended = true;
+		_tailLeft = _bank->numTaps / 2;
+	}
+
+	if (_tailLeft == 0)
+		return false;
+
+	compactHistory();
+
+	const uint len = MIN<uint>(_tailLeft, _historySize - _historyEnd);
+	for (int ch = 0; ch < CHANNELS; ch++)
+		memset(_history[ch] + _historyEnd, 0, len * sizeof(st_sample_t));
+	_historyEnd += len;
+	_tailLeft -= len;
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+int PolyphaseRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t *ostart, *oend;
+
+	ostart = obuf;
+	oend = obuf + osamp * 2;
+
+	const uint numTaps = _bank->numTaps;
+
+	while (obuf < oend) {
+		// make sure a whole filter window of input is available
+		while (_historyEnd - _historyPos < numTaps) {
+			// Streams which only ran dry for now continue without a gap
+			if (!refill(input) && (!input.endOfStream() || !padTail()))
+				return (obuf - ostart) / 2;
+		}
+
+		const uint phase = (uint)(((uint64)_frac * _bank->numPhases) / _outrate);
+		const int16 *coeffs = _bank->getPhase(phase);
+
+		st_sample_t out0, out1;
+		int32 acc = polyphaseDotProduct(_history[0] + _historyPos, coeffs, numTaps);
+		out0 = (st_sample_t)CLIP<int32>((acc + (1 << (PolyphaseFilterBank::COEFF_BITS - 1))) >> PolyphaseFilterBank::COEFF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		if (stereo) {
+			acc = polyphaseDotProduct(_history[CHANNELS - 1] + _historyPos, coeffs, numTaps);
+			out1 = (st_sample_t)CLIP<int32>((acc + (1 << (PolyphaseFilterBank::COEFF_BITS - 1))) >> PolyphaseFilterBank::COEFF_BITS, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		} else {
+			out1 = out0;
+		}
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+
+		// Increment output position
+		_frac += _inrate;
+		_historyPos += _frac / _outrate;
+		_frac %= _outrate;
+	}
+	return (obuf - ostart) / 2;
+}
+
+
+#pragma mark -
+
+// Both kernels below rely on kMaxMixerVolume being 256, so that the volume
+// division of RateConverter::flow turns into a (truncating) shift by 8.
+
+void mixToBus(int32 *bus, const st_sample_t *src, st_size_t len, st_volume_t vol_l, st_volume_t vol_r) {
+	st_size_t samples = len * 2;
+
+#if defined(__SSE2__)
+	const __m128i vol = _mm_set_epi16(vol_r, vol_l, vol_r, vol_l, vol_r, vol_l, vol_r, vol_l);
+	const __m128i roundMask = _mm_set1_epi32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	for (; samples >= 8; samples -= 8, src += 8, bus += 8) {
+		const __m128i in = _mm_loadu_si128((const __m128i *)src);
+		const __m128i lo = _mm_mullo_epi16(in, vol);
+		const __m128i hi = _mm_mulhi_epi16(in, vol);
+		__m128i p0 = _mm_unpacklo_epi16(lo, hi);
+		__m128i p1 = _mm_unpackhi_epi16(lo, hi);
+
+		// Round towards zero, like the integer division in the scalar code
+		p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), roundMask)), 8);
+		p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), roundMask)), 8);
+
+		_mm_storeu_si128((__m128i *)bus, _mm_add_epi32(_mm_loadu_si128((const __m128i *)bus), p0));
+		_mm_storeu_si128((__m128i *)(bus + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i *)(bus + 4)), p1));
+	}
+#elif defined(__ARM_NEON)
+	const int16 volArray[4] = { (int16)vol_l, (int16)vol_r, (int16)vol_l, (int16)vol_r };
+	const int16x4_t vol = vld1_s16(volArray);
+	const int32x4_t roundMask = vdupq_n_s32(Audio::Mixer::kMaxMixerVolume - 1);
+
+	for (; samples >= 8; samples -= 8, src += 8, bus += 8) {
+		const int16x8_t in = vld1q_s16(src);
+		int32x4_t p0 = vmull_s16(vget_low_s16(in), vol);
+		int32x4_t p1 = vmull_s16(vget_high_s16(in), vol);
+
+		// Round towards zero, like the integer division in the scalar code
+		p0 = vshrq_n_s32(vaddq_s32(p0, vandq_s32(vshrq_n_s32(p0, 31), roundMask)), 8);
+		p1 = vshrq_n_s32(vaddq_s32(p1, vandq_s32(vshrq_n_s32(p1, 31), roundMask)), 8);
+
+		vst1q_s32(bus, vaddq_s32(vld1q_s32(bus), p0));
+		vst1q_s32(bus + 4, vaddq_s32(vld1q_s32(bus + 4), p1));
+	}
+#endif
+
+	for (; samples > 0; samples -= 2, src += 2, bus += 2) {
+		bus[0] += (src[0] * (int)vol_l) / Audio::Mixer::kMaxMixerVolume;
+		bus[1] += (src[1] * (int)vol_r) / Audio::Mixer::kMaxMixerVolume;
+	}
+}
+
+void mixSubmixToBus(int32 *bus, const int32 *submix, st_size_t len, st_volume_t vol) {
+	st_size_t samples = len * 2;
+
+	if (vol == Audio::Mixer::kMaxMixerVolume) {
+		for (; samples > 0; samples--)
+			*bus++ += *submix++;
+	} else if (vol != 0) {
+		// Submixes of many loud channels can exceed 2^23, so scale in 64 bits
+		for (; samples > 0; samples--)
+			*bus++ += (int32)(((int64)*submix++ * vol) / Audio::Mixer::kMaxMixerVolume);
+	}
+}
+
+void clampBusToOutput(st_sample_t *obuf, const int32 *bus, st_size_t len) {
+	st_size_t samples = len * 2;
+
+#ifndef OUTPUT_UNSIGNED_AUDIO
+#if defined(__SSE2__)
+	for (; samples >= 8; samples -= 8, obuf += 8, bus += 8) {
+		const __m128i b0 = _mm_loadu_si128((const __m128i *)bus);
+		const __m128i b1 = _mm_loadu_si128((const __m128i *)(bus + 4));
+		_mm_storeu_si128((__m128i *)obuf, _mm_packs_epi32(b0, b1));
+	}
+#elif defined(__ARM_NEON)
+	for (; samples >= 8; samples -= 8, obuf += 8, bus += 8)
+		vst1q_s16(obuf, vcombine_s16(vqmovn_s32(vld1q_s32(bus)), vqmovn_s32(vld1q_s32(bus + 4))));
+#endif
+#endif
+
+	for (; samples > 0; samples--) {
+		const int val = CLIP<int32>(*bus++, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		*obuf++ = ((int16)val) ^ 0x8000;
+#else
+		*obuf++ = val;
+#endif
+	}
+}
+
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, ResamplerQuality quality) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (quality == kResamplerPolyphase) {
+			return new PolyphaseRateConverter<stereo, reverseStereo>(inrate, outrate, 16);
+		} else if (quality == kResamplerPolyphaseBest) {
+			return new PolyphaseRateConverter<stereo, reverseStereo>(inrate, outrate, 32);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +780,18 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, ResamplerQuality quality) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality);
 }
 
 } // End of namespace Audio
+
+namespace Common {
+DECLARE_SINGLETON(Audio::PolyphaseFilterCache);
+}
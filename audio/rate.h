@@ -52,6 +52,16 @@ enum {
 	ST_SUCCESS = 0
 };
 
+/**
+ * Quality levels for sample rate conversion, as selected by the
+ * "resampler_quality" config key.
+ */
+enum ResamplerQuality {
+	kResamplerLinear = 0,       /*!< Linear interpolation. Fast, but aliases (default). */
+	kResamplerPolyphase = 1,    /*!< Windowed-sinc polyphase filter with 16 taps. */
+	kResamplerPolyphaseBest = 2 /*!< Windowed-sinc polyphase filter with 32 taps. */
+};
+
 static inline void clampedAdd(int16& a, int b) {
 	int val;
 #ifdef OUTPUT_UNSIGNED_AUDIO
@@ -72,6 +82,29 @@ static inline void clampedAdd(int16& a, int b) {
 #endif
 }
 
+/**
+ * Scale @p len interleaved stereo sample pairs from @p src by the given
+ * left/right volumes and add them to the 32-bit mix bus @p bus.
+ *
+ * The scaling matches the one done by RateConverter::flow, but the result
+ * is not clamped, so that several channels can be summed up without
+ * clipping in between. Uses SSE2 or NEON when available.
+ */
+void mixToBus(int32 *bus, const st_sample_t *src, st_size_t len, st_volume_t vol_l, st_volume_t vol_r);
+
+/**
+ * Scale @p len stereo sample pairs from the 32-bit submix bus @p submix by
+ * @p vol (in the range 0 - Mixer::kMaxMixerVolume) and add them to the
+ * 32-bit mix bus @p bus.
+ */
+void mixSubmixToBus(int32 *bus, const int32 *submix, st_size_t len, st_volume_t vol);
+
+/**
+ * Clamp @p len stereo sample pairs from the 32-bit mix bus @p bus into
+ * the 16-bit output buffer @p obuf. Uses SSE2 or NEON when available.
+ */
+void clampBusToOutput(st_sample_t *obuf, const int32 *bus, st_size_t len);
+
 class RateConverter {
 public:
 	RateConverter() {}
@@ -83,9 +116,15 @@ public:
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
+
+	/**
+	 * @return Whether flow() still produces output once the input stream
+	 *         has ended, like the tail of a filter.
+	 */
+	virtual bool hasTail() const { return false; }
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, ResamplerQuality quality = kResamplerLinear);
 /** @} */
 } // End of namespace Audio
 
@@ -173,6 +173,17 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Retrieves the size and the last modification time of the file referred
+	 * by this node, without opening it. Backends which cannot do this cheaply
+	 * may leave this unimplemented.
+	 *
+	 * @param size	the size of the file in bytes
+	 * @param mtime	the modification time, in an unspecified but monotonic unit
+	 * @return bool true if the values could be retrieved, false otherwise.
+	 */
+	virtual bool getFileStats(int64 &size, int64 &mtime) const { return false; }
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
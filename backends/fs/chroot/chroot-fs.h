@@ -42,6 +42,7 @@ public:
 	virtual bool isDirectory() const override;
 	virtual bool isReadable() const override;
 	virtual bool isWritable() const override;
+	virtual bool getFileStats(int64 &size, int64 &mtime) const override;
 
 	virtual AbstractFSNode *getChild(const Common::String &n) const override;
 	virtual bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
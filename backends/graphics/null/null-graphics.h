@@ -24,10 +24,21 @@
 #define BACKENDS_GRAPHICS_NULL_H
 
 #include "backends/graphics/graphics.h"
+#include "graphics/surface.h"
 
+/**
+ * Graphics manager which never shows anything. The screen contents are
+ * still kept, so that screenshots can be taken, e.g. by the event recorder
+ * to compare them with the ones stored in a recording.
+ */
 class NullGraphicsManager : public GraphicsManager {
 public:
-	virtual ~NullGraphicsManager() {}
+	NullGraphicsManager() : _width(0), _height(0), _overlayVisible(false) {
+		memset(_palette, 0, sizeof(_palette));
+	}
+	virtual ~NullGraphicsManager() {
+		_screen.free();
+	}
 
 	bool hasFeature(OSystem::Feature f) const override { return false; }
 	void setFeatureState(OSystem::Feature f, bool enable) override {}
@@ -52,6 +63,8 @@ public:
 		_width = width;
 		_height = height;
 		_format = format ? *format : Graphics::PixelFormat::createFormatCLUT8();
+		_screen.free();
+		_screen.create(width, height, _format);
 	}
 
 	virtual int getScreenChangeID() const override { return 0; }
@@ -61,12 +74,20 @@ public:
 
 	int16 getHeight() const override { return _height; }
 	int16 getWidth() const override { return _width; }
-	void setPalette(const byte *colors, uint start, uint num) override {}
-	void grabPalette(byte *colors, uint start, uint num) const override {}
-	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) override {}
-	Graphics::Surface *lockScreen() override { return NULL; }
+	void setPalette(const byte *colors, uint start, uint num) override {
+		memcpy(_palette + start * 3, colors, num * 3);
+	}
+	void grabPalette(byte *colors, uint start, uint num) const override {
+		memcpy(colors, _palette + start * 3, num * 3);
+	}
+	void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) override {
+		_screen.copyRectToSurface(buf, pitch, x, y, w, h);
+	}
+	Graphics::Surface *lockScreen() override { return &_screen; }
 	void unlockScreen() override {}
-	void fillScreen(uint32 col) override {}
+	void fillScreen(uint32 col) override {
+		_screen.fillRect(Common::Rect(_screen.w, _screen.h), col);
+	}
 	void updateScreen() override {}
 	void setShakePos(int shakeXOffset, int shakeYOffset) override {}
 	void setFocusRectangle(const Common::Rect& rect) override {}
@@ -90,6 +111,8 @@ public:
 private:
 	uint _width, _height;
 	Graphics::PixelFormat _format;
+	Graphics::Surface _screen;
+	byte _palette[256 * 3];
 	bool _overlayVisible;
 };
 
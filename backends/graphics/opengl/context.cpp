@@ -43,6 +43,8 @@ void Context::reset() {
 	framebufferObjectSupported = false;
 	packedPixelsSupported = false;
 	textureEdgeClampSupported = false;
+	unpackSubimageSupported = false;
+	pixelBufferObjectSupported = false;
 
 #define GL_FUNC_DEF(ret, name, param) name = nullptr;
 #include "backends/graphics/opengl/opengl-func.h"
@@ -139,6 +141,8 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	bool ARBShadingLanguage100 = false;
 	bool ARBVertexShader = false;
 	bool ARBFragmentShader = false;
+	bool ARBMapBufferRange = false;
+	bool ARBPixelBufferObject = false;
 
 	Common::StringTokenizer tokenizer(extString, " ");
 	while (!tokenizer.empty()) {
@@ -162,6 +166,12 @@ void OpenGLGraphicsManager::initializeGLContext() {
 			g_context.packedPixelsSupported = true;
 		} else if (token == "GL_SGIS_texture_edge_clamp") {
 			g_context.textureEdgeClampSupported = true;
+		} else if (token == "GL_EXT_unpack_subimage") {
+			g_context.unpackSubimageSupported = true;
+		} else if (token == "GL_ARB_map_buffer_range") {
+			ARBMapBufferRange = true;
+		} else if (token == "GL_ARB_pixel_buffer_object") {
+			ARBPixelBufferObject = true;
 		}
 	}
 
@@ -187,6 +197,19 @@ void OpenGLGraphicsManager::initializeGLContext() {
 		g_context.textureEdgeClampSupported = true;
 	}
 
+	// Desktop GL always has GL_UNPACK_ROW_LENGTH, GLES only since 3.0
+	if (g_context.type == kContextGL || g_context.majorVersion >= 3) {
+		g_context.unpackSubimageSupported = true;
+	}
+
+	// Pixel buffer objects need buffer mapping, which is part of GL 3.0 and
+	// GLES 3.0.
+	if (g_context.majorVersion >= 3 || (g_context.type == kContextGL && ARBMapBufferRange && ARBPixelBufferObject)) {
+		g_context.pixelBufferObjectSupported = g_context.glGenBuffers && g_context.glDeleteBuffers
+		                                       && g_context.glBindBuffer && g_context.glBufferData
+		                                       && g_context.glMapBufferRange && g_context.glUnmapBuffer;
+	}
+
 	// Log context type.
 	switch (g_context.type) {
 	case kContextGL:
@@ -213,6 +236,8 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	debug(5, "OpenGL: FBO support: %d", g_context.framebufferObjectSupported);
 	debug(5, "OpenGL: Packed pixels support: %d", g_context.packedPixelsSupported);
 	debug(5, "OpenGL: Texture edge clamping support: %d", g_context.textureEdgeClampSupported);
+	debug(5, "OpenGL: Unpack subimage support: %d", g_context.unpackSubimageSupported);
+	debug(5, "OpenGL: Pixel buffer object support: %d", g_context.pixelBufferObjectSupported);
 }
 
 } // End of namespace OpenGL
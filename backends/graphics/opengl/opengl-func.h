@@ -142,6 +142,15 @@ GL_FUNC_2_DEF(GLenum, glCheckFramebufferStatus, glCheckFramebufferStatusEXT, (GL
 GL_FUNC_2_DEF(void, glActiveTexture, glActiveTextureARB, (GLenum texture));
 #endif
 
+// Pixel buffer objects, used for uploading textures. These are only
+// available with GL 3.0+ and GLES 3.0+, so they are always looked up.
+GL_EXT_FUNC_DEF(void, glGenBuffers, (GLsizei n, GLuint *buffers));
+GL_EXT_FUNC_DEF(void, glDeleteBuffers, (GLsizei n, const GLuint *buffers));
+GL_EXT_FUNC_DEF(void, glBindBuffer, (GLenum target, GLuint buffer));
+GL_EXT_FUNC_DEF(void, glBufferData, (GLenum target, GLsizeiptr size, const void *data, GLenum usage));
+GL_EXT_FUNC_DEF(void *, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access));
+GL_EXT_FUNC_DEF(GLboolean, glUnmapBuffer, (GLenum target));
+
 #ifdef DEFINED_GL_EXT_FUNC_DEF
 #undef DEFINED_GL_EXT_FUNC_DEF
 #undef GL_EXT_FUNC_DEF
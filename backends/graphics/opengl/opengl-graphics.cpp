@@ -499,12 +499,21 @@ void OpenGLGraphicsManager::updateScreen() {
 	}
 
 	// Update changes to textures.
+	const uint32 uploadStart = g_system->getMillis(true);
 	_gameScreen->updateGLTexture();
 	if (_cursorVisible && _cursor) {
 		_cursor->updateGLTexture();
 	}
 	_overlay->updateGLTexture();
 
+	const GLTexture::UploadStats &uploadStats = GLTexture::getUploadStats();
+	if (uploadStats.uploads) {
+		debug(9, "OpenGL: Uploaded %u bytes (%u as whole rows) in %u calls, %u buffered, %u ms",
+		      uploadStats.bytes, uploadStats.rowBytes, uploadStats.uploads,
+		      uploadStats.bufferedUploads, g_system->getMillis(true) - uploadStart);
+		GLTexture::resetUploadStats();
+	}
+
 	// Clear the screen buffer.
 	GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
 
@@ -61,6 +61,19 @@
 #ifdef __ANDROID__
 	#include <GLES/gl.h>
 	#define USE_BUILTIN_OPENGL
+
+	// GLES 1 lacks these, they are only used when the context supports them
+	#ifndef GL_UNPACK_ROW_LENGTH
+		#define GL_UNPACK_ROW_LENGTH         0x0CF2
+		#define GL_UNPACK_SKIP_ROWS          0x0CF3
+		#define GL_UNPACK_SKIP_PIXELS        0x0CF4
+	#endif
+	#ifndef GL_PIXEL_UNPACK_BUFFER
+		#define GL_STREAM_DRAW               0x88E0
+		#define GL_PIXEL_UNPACK_BUFFER       0x88EC
+		#define GL_MAP_WRITE_BIT             0x0002
+		#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+	#endif
 #else
 	#include "backends/graphics/opengl/opengl-defs.h"
 #endif
@@ -132,6 +145,12 @@ struct Context {
 	/** Whether texture coordinate edge clamping is available or not. */
 	bool textureEdgeClampSupported;
 
+	/** Whether GL_UNPACK_ROW_LENGTH is available or not. */
+	bool unpackSubimageSupported;
+
+	/** Whether pixel buffer objects can be used for texture uploads or not. */
+	bool pixelBufferObjectSupported;
+
 #define GL_FUNC_DEF(ret, name, param) ret (GL_CALL_CONV *name)param
 #include "backends/graphics/opengl/opengl-func.h"
 #undef GL_FUNC_DEF
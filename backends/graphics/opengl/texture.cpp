@@ -35,16 +35,21 @@
 
 namespace OpenGL {
 
+GLTexture::UploadStats GLTexture::_uploadStats = { 0, 0, 0, 0 };
+
 GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
 	: _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType),
 	  _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
 	  _texCoords(), _glFilter(GL_NEAREST),
-	  _glTexture(0) {
+	  _glTexture(0), _glBuffers(), _curBuffer(0) {
 	create();
 }
 
 GLTexture::~GLTexture() {
 	GL_CALL_SAFE(glDeleteTextures, (1, &_glTexture));
+	if (_glBuffers[0]) {
+		GL_CALL_SAFE(glDeleteBuffers, (2, _glBuffers));
+	}
 }
 
 void GLTexture::enableLinearFiltering(bool enable) {
@@ -63,6 +68,16 @@ void GLTexture::enableLinearFiltering(bool enable) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+
+	destroyBuffers();
+}
+
+void GLTexture::destroyBuffers() {
+	if (_glBuffers[0]) {
+		GL_CALL(glDeleteBuffers(2, _glBuffers));
+		_glBuffers[0] = _glBuffers[1] = 0;
+	}
+	_curBuffer = 0;
 }
 
 void GLTexture::create() {
@@ -141,29 +156,95 @@ void GLTexture::setSize(uint width, uint height) {
 }
 
 void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &src) {
+	if (area.isEmpty()) {
+		return;
+	}
+
 	// Set the texture on the active texture unit.
 	bind();
 
+	const uint bpp = src.format.bytesPerPixel;
+	_uploadStats.rowBytes += area.height() * src.w * bpp;
+	++_uploadStats.uploads;
+
+	if (g_context.pixelBufferObjectSupported && updateAreaBuffered(area, src)) {
+		return;
+	}
+
 	// Update the actual texture.
-	// Although we have the area of the texture buffer we want to update we
-	// cannot take advantage of the left/right boundries here because it is
-	// not possible to specify a pitch to glTexSubImage2D. To be precise, with
-	// plain OpenGL we could set GL_UNPACK_ROW_LENGTH to achieve this. However,
-	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH. Thus, we are left
-	// with the following options:
-	//
-	// 1) (As we do right now) Simply always update the whole texture lines of
-	//    rect changed. This is simplest to implement. In case performance is
-	//    really an issue we can think of switching to another method.
-	//
-	// 2) Copy the dirty rect to a temporary buffer and upload that by using
-	//    glTexSubImage2D. This is what the Android backend does. It is more
-	//    complicated though.
-	//
-	// 3) Use glTexSubImage2D per line changed. This is what the old OpenGL
-	//    graphics manager did but it is much slower! Thus, we do not use it.
-	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
-	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
+	// When GL_UNPACK_ROW_LENGTH is available we can specify the pitch of the
+	// source and only upload the dirty rect itself. OpenGL ES 1.0 and 2.0
+	// lack it (unless GL_EXT_unpack_subimage is present), in which case we
+	// simply upload the whole texture lines of the rect. Uploading each line
+	// separately is much slower, thus we do not use it.
+	if (g_context.unpackSubimageSupported) {
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, src.pitch / bpp));
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                        _glFormat, _glType, src.getBasePtr(area.left, area.top)));
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+		_uploadStats.bytes += area.height() * area.width() * bpp;
+	} else {
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
+		                        _glFormat, _glType, src.getBasePtr(0, area.top)));
+
+		_uploadStats.bytes += area.height() * src.w * bpp;
+	}
+}
+
+bool GLTexture::updateAreaBuffered(const Common::Rect &area, const Graphics::Surface &src) {
+	if (!_glBuffers[0]) {
+		GL_CALL(glGenBuffers(2, _glBuffers));
+	}
+
+	const uint rowSize = area.width() * src.format.bytesPerPixel;
+	const uint size = rowSize * area.height();
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _glBuffers[_curBuffer]));
+	_curBuffer ^= 1;
+
+	// Orphan the previous storage so mapping never waits for an upload which
+	// is still in flight.
+	GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW));
+
+	void *mapped;
+	GL_ASSIGN(mapped, glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	if (!mapped) {
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		return false;
+	}
+
+	// Pack the rect tightly into the buffer.
+	byte *dst = (byte *)mapped;
+	const byte *srcPtr = (const byte *)src.getBasePtr(area.left, area.top);
+	for (int y = area.height(); y > 0; --y) {
+		memcpy(dst, srcPtr, rowSize);
+		dst += rowSize;
+		srcPtr += src.pitch;
+	}
+
+	// The buffer contents may get lost, e.g. on mode switches. In that case
+	// the caller falls back to a direct upload.
+	GLboolean unmapped;
+	GL_ASSIGN(unmapped, glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	if (unmapped) {
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                        _glFormat, _glType, NULL));
+
+		_uploadStats.bytes += size;
+		++_uploadStats.bufferedUploads;
+	}
+
+	// Unbind the buffer again, otherwise glTexImage2D calls would read from it.
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+	return unmapped;
+}
+
+void GLTexture::resetUploadStats() {
+	_uploadStats.uploads = 0;
+	_uploadStats.bytes = 0;
+	_uploadStats.rowBytes = 0;
+	_uploadStats.bufferedUploads = 0;
 }
 
 //
@@ -171,7 +252,7 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 //
 
 Surface::Surface()
-	: _allDirty(false), _dirtyArea() {
+	: _allDirty(false), _dirtyRects() {
 }
 
 void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcPtr, uint srcPitch) {
@@ -179,15 +260,7 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	assert(x + w <= (uint)dstSurf->w);
 	assert(y + h <= (uint)dstSurf->h);
 
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = Common::Rect(x, y, x + w, y + h);
-	} else {
-		_dirtyArea.extend(Common::Rect(x, y, x + w, y + h));
-	}
+	addDirtyArea(Common::Rect(x, y, x + w, y + h));
 
 	const byte *src = (const byte *)srcPtr;
 	byte *dst = (byte *)dstSurf->getBasePtr(x, y);
@@ -212,12 +285,82 @@ void Surface::fill(uint32 color) {
 	flagDirty();
 }
 
+int Surface::mergeCost(const Common::Rect &a, const Common::Rect &b) {
+	Common::Rect merged(a);
+	merged.extend(b);
+
+	// Overlapping rects result in a negative cost, merging them is always
+	// worthwhile.
+	return merged.width() * merged.height() - a.width() * a.height() - b.width() * b.height();
+}
+
+void Surface::addDirtyArea(const Common::Rect &area) {
+	// Common::Rect::extend behaves unexpected whenever one of the two
+	// parameters is an empty rect, so empty rects are never stored.
+	if (_allDirty || area.isEmpty()) {
+		return;
+	}
+
+	// Absorb all rects which are cheap to merge with the new one. Each merge
+	// grows the rect, so start over to catch rects which became cheap.
+	Common::Rect rect(area);
+	for (uint i = 0; i < _dirtyRects.size();) {
+		if (mergeCost(rect, _dirtyRects[i]) <= kUploadOverhead) {
+			rect.extend(_dirtyRects[i]);
+			_dirtyRects.remove_at(i);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+
+	_dirtyRects.push_back(rect);
+
+	// Keep the list bounded by merging the cheapest pair.
+	while (_dirtyRects.size() > kMaxDirtyRects) {
+		uint bestA = 0, bestB = 1;
+		int bestCost = mergeCost(_dirtyRects[0], _dirtyRects[1]);
+
+		for (uint i = 0; i < _dirtyRects.size(); ++i) {
+			for (uint j = i + 1; j < _dirtyRects.size(); ++j) {
+				const int cost = mergeCost(_dirtyRects[i], _dirtyRects[j]);
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestA = i;
+					bestB = j;
+				}
+			}
+		}
+
+		_dirtyRects[bestA].extend(_dirtyRects[bestB]);
+		_dirtyRects.remove_at(bestB);
+	}
+}
+
 Common::Rect Surface::getDirtyArea() const {
 	if (_allDirty) {
 		return Common::Rect(getWidth(), getHeight());
-	} else {
-		return _dirtyArea;
 	}
+
+	Common::Rect area;
+	for (DirtyRectList::const_iterator i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i) {
+		if (area.isEmpty()) {
+			area = *i;
+		} else {
+			area.extend(*i);
+		}
+	}
+	return area;
+}
+
+Surface::DirtyRectList Surface::getDirtyRects() const {
+	if (_allDirty) {
+		DirtyRectList rects;
+		rects.push_back(Common::Rect(getWidth(), getHeight()));
+		return rects;
+	}
+
+	return _dirtyRects;
 }
 
 //
@@ -277,8 +420,20 @@ void Texture::updateGLTexture() {
 		return;
 	}
 
-	Common::Rect dirtyArea = getDirtyArea();
+	if (GLTexture::isSubRectUploadSupported()) {
+		const DirtyRectList dirtyRects = getDirtyRects();
+		for (DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+			updateGLTextureArea(*i);
+		}
+	} else {
+		updateGLTextureArea(getDirtyArea());
+	}
+
+	// We should have handled everything, thus not dirty anymore.
+	clearDirty();
+}
 
+void Texture::updateGLTextureArea(Common::Rect dirtyArea) {
 	// In case we use linear filtering we might need to duplicate the last
 	// pixel row/column to avoid glitches with filtering.
 	if (_glTexture.isLinearFilteringEnabled()) {
@@ -309,9 +464,6 @@ void Texture::updateGLTexture() {
 	}
 
 	_glTexture.updateArea(dirtyArea, _textureData);
-
-	// We should have handled everything, thus not dirty anymore.
-	clearDirty();
 }
 
 TextureCLUT8::TextureCLUT8(GLenum glIntFormat, GLenum glFormat, GLenum glType, const Graphics::PixelFormat &format)
@@ -408,20 +560,24 @@ void TextureCLUT8::updateGLTexture() {
 	// Do the palette look up
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	Common::Rect dirtyArea = getDirtyArea();
-
-	if (outSurf->format.bytesPerPixel == 2) {
-		doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
-	} else if (outSurf->format.bytesPerPixel == 4) {
-		doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
-	} else {
-		warning("TextureCLUT8::updateGLTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+	const DirtyRectList dirtyRects = getDirtyRects();
+	for (DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		const Common::Rect &dirtyArea = *i;
+
+		if (outSurf->format.bytesPerPixel == 2) {
+			doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
+		} else if (outSurf->format.bytesPerPixel == 4) {
+			doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
+		} else {
+			warning("TextureCLUT8::updateGLTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+			break;
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -459,11 +615,12 @@ void FakeTexture::updateGLTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
-
-	byte *dst = (byte *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const byte *src = (const byte *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
-	Graphics::crossBlit(dst, src, outSurf->pitch, _rgbData.pitch, dirtyArea.width(), dirtyArea.height(), outSurf->format, _rgbData.format);
+	const DirtyRectList dirtyRects = getDirtyRects();
+	for (DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		byte *dst = (byte *)outSurf->getBasePtr(i->left, i->top);
+		const byte *src = (const byte *)_rgbData.getBasePtr(i->left, i->top);
+		Graphics::crossBlit(dst, src, outSurf->pitch, _rgbData.pitch, i->width(), i->height(), outSurf->format, _rgbData.format);
+	}
 
 	// Do generic handling of updating the texture.
 	Texture::updateGLTexture();
@@ -481,25 +638,28 @@ void TextureRGB555::updateGLTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const DirtyRectList dirtyRects = getDirtyRects();
+	for (DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		const Common::Rect &dirtyArea = *i;
 
-	uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
+		uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
 
-	const uint16 *src = (const uint16 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgbData.pitch - 2 * dirtyArea.width();
+		const uint16 *src = (const uint16 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgbData.pitch - 2 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint16 color = *src++;
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint16 color = *src++;
 
-			*dst++ =   ((color & 0x7C00) << 1)                             // R
-			         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
-			         | (color & 0x001F);                                   // B
-		}
+				*dst++ =   ((color & 0x7C00) << 1)                             // R
+				         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
+				         | (color & 0x001F);                                   // B
+			}
 
-		src = (const uint16 *)((const byte *)src + srcAdd);
-		dst = (uint16 *)((byte *)dst + dstAdd);
+			src = (const uint16 *)((const byte *)src + srcAdd);
+			dst = (uint16 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -523,23 +683,26 @@ void TextureRGBA8888Swap::updateGLTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const DirtyRectList dirtyRects = getDirtyRects();
+	for (DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		const Common::Rect &dirtyArea = *i;
 
-	uint32 *dst = (uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 4 * dirtyArea.width();
+		uint32 *dst = (uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 4 * dirtyArea.width();
 
-	const uint32 *src = (const uint32 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgbData.pitch - 4 * dirtyArea.width();
+		const uint32 *src = (const uint32 *)_rgbData.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgbData.pitch - 4 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint32 color = *src++;
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint32 color = *src++;
 
-			*dst++ = SWAP_BYTES_32(color);
-		}
+				*dst++ = SWAP_BYTES_32(color);
+			}
 
-		src = (const uint32 *)((const byte *)src + srcAdd);
-		dst = (uint32 *)((byte *)dst + dstAdd);
+			src = (const uint32 *)((const byte *)src + srcAdd);
+			dst = (uint32 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -672,7 +835,14 @@ void TextureCLUT8GPU::updateGLTexture() {
 
 	// Update CLUT8 texture if necessary.
 	if (Surface::isDirty()) {
-		_clut8Texture.updateArea(getDirtyArea(), _clut8Data);
+		if (GLTexture::isSubRectUploadSupported()) {
+			const DirtyRectList dirtyRects = getDirtyRects();
+			for (DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+				_clut8Texture.updateArea(*i, _clut8Data);
+			}
+		} else {
+			_clut8Texture.updateArea(getDirtyArea(), _clut8Data);
+		}
 		clearDirty();
 	}
 
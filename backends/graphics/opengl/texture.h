@@ -28,6 +28,7 @@
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
+#include "common/array.h"
 #include "common/rect.h"
 
 namespace OpenGL {
@@ -99,6 +100,39 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Test whether uploading a rect only transfers the rect itself. If not,
+	 * whole texture rows are uploaded and callers should rather upload the
+	 * bounding box of several rects at once.
+	 */
+	static bool isSubRectUploadSupported() {
+		return g_context.unpackSubimageSupported || g_context.pixelBufferObjectSupported;
+	}
+
+	/**
+	 * Statistics about texture uploads, accumulated over all textures.
+	 */
+	struct UploadStats {
+		/** Number of glTexSubImage2D calls issued. */
+		uint32 uploads;
+		/** Number of bytes passed to OpenGL. */
+		uint32 bytes;
+		/** Number of bytes uploading whole texture rows would have taken. */
+		uint32 rowBytes;
+		/** Number of uploads which went through a pixel buffer object. */
+		uint32 bufferedUploads;
+	};
+
+	/**
+	 * Query the upload statistics gathered since the last reset.
+	 */
+	static const UploadStats &getUploadStats() { return _uploadStats; }
+
+	/**
+	 * Reset the upload statistics.
+	 */
+	static void resetUploadStats();
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -143,6 +177,24 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+	/**
+	 * Upload the area through one of the pixel buffer objects.
+	 *
+	 * @return true on success, false when the buffer could not be mapped.
+	 */
+	bool updateAreaBuffered(const Common::Rect &area, const Graphics::Surface &src);
+
+	void destroyBuffers();
+
+	/**
+	 * Pixel unpack buffers used for uploads. Two are used alternately so
+	 * that filling one does not wait for the upload from the other.
+	 */
+	GLuint _glBuffers[2];
+	uint _curBuffer;
+
+	static UploadStats _uploadStats;
 };
 
 /**
@@ -201,7 +253,7 @@ public:
 	void fill(uint32 color);
 
 	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	virtual bool isDirty() const { return _allDirty || !_dirtyRects.empty(); }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -239,12 +291,48 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	typedef Common::Array<Common::Rect> DirtyRectList;
 
+	void clearDirty() { _allDirty = false; _dirtyRects.clear(); }
+
+	/**
+	 * Mark an area of the surface as dirty.
+	 *
+	 * Overlapping or nearby rects are merged whenever uploading their union
+	 * is estimated to be cheaper than uploading both separately. The list
+	 * never grows beyond kMaxDirtyRects entries.
+	 */
+	void addDirtyArea(const Common::Rect &area);
+
+	/**
+	 * @return The bounding box of all dirty rects.
+	 */
 	Common::Rect getDirtyArea() const;
+
+	/**
+	 * @return The list of dirty rects. When the whole surface is dirty this is
+	 *         a single rect covering it.
+	 */
+	DirtyRectList getDirtyRects() const;
 private:
+	enum {
+		/** Maximum number of dirty rects tracked per surface. */
+		kMaxDirtyRects = 8,
+		/**
+		 * Estimated fixed cost of an upload, in pixels. Two rects are merged
+		 * when their union does not cover more than this many pixels in
+		 * addition to the pixels of both rects.
+		 */
+		kUploadOverhead = 4096
+	};
+
+	/**
+	 * Calculate how many pixels merging two rects would add to the upload.
+	 */
+	static int mergeCost(const Common::Rect &a, const Common::Rect &b);
+
 	bool _allDirty;
-	Common::Rect _dirtyArea;
+	DirtyRectList _dirtyRects;
 };
 
 /**
@@ -289,6 +377,8 @@ protected:
 	const Graphics::PixelFormat _format;
 
 private:
+	void updateGLTextureArea(Common::Rect dirtyArea);
+
 	GLTexture _glTexture;
 
 	Graphics::Surface _textureData;
@@ -26,6 +26,7 @@
 #include "backends/graphics/graphics.h"
 #include "backends/mixer/mixer.h"
 #include "backends/mutex/mutex.h"
+#include "backends/threads/threads.h"
 #include "gui/EventRecorder.h"
 
 #include "common/timer.h"
@@ -319,7 +320,8 @@ Audio::Mixer *ModularMixerBackend::getMixer() {
 
 ModularMutexBackend::ModularMutexBackend()
 	:
-	_mutexManager(0) {
+	_mutexManager(0),
+	_threadManager(0) {
 
 }
 
@@ -327,6 +329,8 @@ ModularMutexBackend::~ModularMutexBackend() {
 	// _timerManager needs to be deleted before _mutexManager to avoid a crash.
 	delete _timerManager;
 	_timerManager = 0;
+	delete _threadManager;
+	_threadManager = 0;
 	delete _mutexManager;
 	_mutexManager = 0;
 }
@@ -350,3 +354,38 @@ void ModularMutexBackend::deleteMutex(MutexRef mutex) {
 	assert(_mutexManager);
 	_mutexManager->deleteMutex(mutex);
 }
+
+// Backends without a thread manager do not support threads, the
+// defaults of OSystem report that to the callers.
+
+uint ModularMutexBackend::getHardwareThreadCount() {
+	return _threadManager ? _threadManager->getHardwareThreadCount() : 1;
+}
+
+OSystem::ThreadRef ModularMutexBackend::createThread(ThreadProc proc, void *data) {
+	return _threadManager ? _threadManager->createThread(proc, data) : 0;
+}
+
+void ModularMutexBackend::joinThread(ThreadRef thread) {
+	assert(_threadManager);
+	_threadManager->joinThread(thread);
+}
+
+OSystem::ConditionRef ModularMutexBackend::createCondition() {
+	return _threadManager ? _threadManager->createCondition() : 0;
+}
+
+void ModularMutexBackend::waitCondition(ConditionRef cond, MutexRef mutex) {
+	assert(_threadManager);
+	_threadManager->waitCondition(cond, mutex);
+}
+
+void ModularMutexBackend::signalCondition(ConditionRef cond, bool all) {
+	if (_threadManager)
+		_threadManager->signalCondition(cond, all);
+}
+
+void ModularMutexBackend::deleteCondition(ConditionRef cond) {
+	if (_threadManager)
+		_threadManager->deleteCondition(cond);
+}
@@ -28,6 +28,7 @@
 class GraphicsManager;
 class MixerManager;
 class MutexManager;
+class ThreadManager;
 
 /**
  * Base classes for modular backends.
@@ -180,11 +181,25 @@ public:
 
 	//@}
 
+	/** @name Thread handling */
+	//@{
+
+	virtual uint getHardwareThreadCount() override final;
+	virtual ThreadRef createThread(ThreadProc proc, void *data) override final;
+	virtual void joinThread(ThreadRef thread) override final;
+	virtual ConditionRef createCondition() override final;
+	virtual void waitCondition(ConditionRef cond, MutexRef mutex) override final;
+	virtual void signalCondition(ConditionRef cond, bool all) override final;
+	virtual void deleteCondition(ConditionRef cond) override final;
+
+	//@}
+
 protected:
 	/** @name Managers variables */
 	//@{
 
 	MutexManager *_mutexManager;
+	ThreadManager *_threadManager;
 
 	//@}
 };
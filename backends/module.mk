@@ -147,6 +147,7 @@ MODULE_OBJS += \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	plugins/sdl/sdl-provider.o \
+	threads/sdl/sdl-threads.o \
 	timer/sdl/sdl-timer.o
 
 # SDL 2 removed audio CD support
@@ -226,12 +227,14 @@ endif
 
 ifeq ($(BACKEND),android)
 MODULE_OBJS += \
-	mutex/pthread/pthread-mutex.o
+	mutex/pthread/pthread-mutex.o \
+	threads/pthread/pthread-threads.o
 endif
 
 ifeq ($(BACKEND),android3d)
 MODULE_OBJS += \
-	mutex/pthread/pthread-mutex.o
+	mutex/pthread/pthread-mutex.o \
+	threads/pthread/pthread-threads.o
 endif
 
 ifeq ($(BACKEND),androidsdl)
@@ -308,7 +311,8 @@ endif
 
 ifdef IPHONE
 MODULE_OBJS += \
-	mutex/pthread/pthread-mutex.o
+	mutex/pthread/pthread-mutex.o \
+	threads/pthread/pthread-threads.o
 endif
 
 ifeq ($(BACKEND),maemo)
@@ -58,6 +58,7 @@
 #include "backends/audiocd/default/default-audiocd.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mutex/pthread/pthread-mutex.h"
+#include "backends/threads/pthread/pthread-threads.h"
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 
@@ -426,6 +427,7 @@ void OSystem_Android::initBackend() {
 	LOGD("Setting DefaultSaveFileManager path to: %s", ConfMan.get("savepath").c_str());
 
 	_mutexManager = new PthreadMutexManager();
+	_threadManager = new PthreadThreadManager();
 	_timerManager = new DefaultTimerManager();
 
 	_event_queue_lock = new Common::Mutex();
@@ -47,6 +47,7 @@
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "backends/mutex/pthread/pthread-mutex.h"
+#include "backends/threads/pthread/pthread-threads.h"
 #include "backends/fs/chroot/chroot-fs-factory.h"
 #include "backends/fs/posix/posix-fs.h"
 #include "audio/mixer.h"
@@ -132,6 +133,7 @@ int OSystem_iOS7::timerHandler(int t) {
 
 void OSystem_iOS7::initBackend() {
 	_mutexManager = new PthreadMutexManager();
+	_threadManager = new PthreadThreadManager();
 
 #ifdef IPHONE_SANDBOXED
 	_savefileManager = new SandboxedSaveFileManager(_chrootBasePath, "/Savegames");
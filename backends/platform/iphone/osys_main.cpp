@@ -38,6 +38,7 @@
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
 #include "backends/mutex/pthread/pthread-mutex.h"
+#include "backends/threads/pthread/pthread-threads.h"
 #include "audio/mixer.h"
 #include "audio/mixer_intern.h"
 
@@ -85,6 +86,7 @@ int OSystem_IPHONE::timerHandler(int t) {
 
 void OSystem_IPHONE::initBackend() {
 	_mutexManager = new PthreadMutexManager();
+	_threadManager = new PthreadThreadManager();
 
 #ifdef IPHONE_SANDBOXED
 	_savefileManager = new DefaultSaveFileManager(iPhone_getDocumentsDir());
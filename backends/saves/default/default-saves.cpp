@@ -42,6 +42,9 @@
 #include "common/fs.h"
 #include "common/archive.h"
 #include "common/config-manager.h"
+#include "common/endian.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
 #include "common/zlib.h"
 
 #include <errno.h>	// for removeSavefile()
@@ -57,6 +60,10 @@ DefaultSaveFileManager::DefaultSaveFileManager(const Common::String &defaultSave
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	flushSavefileMetadata();
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -148,6 +155,8 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 		}
 	}
 
+	dropSavefileMetadata(filename);
+
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
 	// Update file's timestamp
 	Common::HashMap<Common::String, uint32> timestamps = loadTimestamps();
@@ -195,6 +204,8 @@ bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
 	}
 #endif
 
+	dropSavefileMetadata(filename);
+
 	// Obtain node if exists.
 	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
 	if (file == _saveFileCache.end()) {
@@ -270,6 +281,10 @@ void DefaultSaveFileManager::assureCached(const Common::String &savePathName) {
 		return;
 	}
 
+	// The metadata indices belong to the previously cached directory
+	flushSavefileMetadata();
+	_savefileIndices.clear();
+
 	_saveFileCache.clear();
 	_cachedDirectory.clear();
 
@@ -301,6 +316,165 @@ void DefaultSaveFileManager::assureCached(const Common::String &savePathName) {
 	_cachedDirectory = savePathName;
 }
 
+// The metadata indices live in a subdirectory of the save path, so that
+// they are neither listed as save files nor synced to the cloud
+#define SAVEFILE_INDEX_DIRECTORY ".index"
+
+enum {
+	kSavefileIndexVersion = 2
+};
+
+Common::SeekableReadStream *DefaultSaveFileManager::openSavefileMetadata(const Common::String &filename) {
+	// Assure the savefile name cache is up-to-date.
+	assureCached(getSavePath());
+	if (getError().getCode() != Common::kNoError)
+		return nullptr;
+
+	// Metadata is only trusted as long as the file has the same size and
+	// modification time as when it was stored.
+	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
+	int64 size, mtime;
+	if (file == _saveFileCache.end() || !file->_value.getFileStats(size, mtime))
+		return nullptr;
+
+	SavefileIndex *index = getSavefileIndex(filename);
+	if (!index)
+		return nullptr;
+
+	SavefileMetadataMap::const_iterator entry = index->entries.find(filename);
+	if (entry == index->entries.end() || entry->_value.size != size || entry->_value.mtime != mtime || entry->_value.data.empty())
+		return nullptr;
+
+	const uint32 dataSize = entry->_value.data.size();
+	byte *data = (byte *)malloc(dataSize);
+	if (!data)
+		return nullptr;
+	memcpy(data, entry->_value.data.begin(), dataSize);
+	return new Common::MemoryReadStream(data, dataSize, DisposeAfterUse::YES);
+}
+
+void DefaultSaveFileManager::setSavefileMetadata(const Common::String &filename, const byte *data, uint32 size) {
+	// Assure the savefile name cache is up-to-date.
+	assureCached(getSavePath());
+	if (getError().getCode() != Common::kNoError)
+		return;
+
+	SaveFileCache::const_iterator file = _saveFileCache.find(filename);
+	int64 fileSize, mtime;
+	if (file == _saveFileCache.end() || !file->_value.getFileStats(fileSize, mtime))
+		return;
+
+	SavefileIndex *index = getSavefileIndex(filename);
+	if (!index)
+		return;
+
+	SavefileMetadata &entry = index->entries[filename];
+	entry.size = fileSize;
+	entry.mtime = mtime;
+	entry.data = Common::Array<byte>(data, size);
+	index->dirty = true;
+}
+
+void DefaultSaveFileManager::flushSavefileMetadata() {
+	for (SavefileIndexMap::iterator i = _savefileIndices.begin(); i != _savefileIndices.end(); ++i) {
+		if (i->_value.dirty)
+			writeSavefileIndex(i->_value);
+	}
+}
+
+DefaultSaveFileManager::SavefileIndex *DefaultSaveFileManager::getSavefileIndex(const Common::String &filename) {
+	if (_cachedDirectory.empty())
+		return nullptr;
+
+	// Save files are grouped by the part of their name before the first dot,
+	// which usually is the target
+	const char *dot = strchr(filename.c_str(), '.');
+	const Common::String indexName = dot ? Common::String(filename.c_str(), dot) : filename;
+
+	SavefileIndexMap::iterator i = _savefileIndices.find(indexName);
+	if (i != _savefileIndices.end())
+		return &i->_value;
+
+	SavefileIndex &index = _savefileIndices[indexName];
+	index.node = Common::FSNode(_cachedDirectory).getChild(SAVEFILE_INDEX_DIRECTORY).getChild(indexName);
+	if (!index.node.exists())
+		return &index;
+
+	Common::ScopedPtr<Common::SeekableReadStream> in(Common::wrapCompressedReadStream(index.node.createReadStream()));
+	if (!in || in->readUint32BE() != MKTAG('S', 'I', 'D', 'X') || in->readUint32LE() != kSavefileIndexVersion)
+		return &index;
+
+	const uint32 count = in->readUint32LE();
+	for (uint32 n = 0; n < count && !in->eos() && !in->err(); ++n) {
+		const Common::String name = in->readPascalString(false);
+		SavefileMetadata entry;
+		entry.size = in->readSint64LE();
+		entry.mtime = in->readSint64LE();
+		entry.data.resize(in->readUint32LE());
+		if (in->read(entry.data.begin(), entry.data.size()) != entry.data.size())
+			break;
+		index.entries[name] = entry;
+	}
+
+	return &index;
+}
+
+void DefaultSaveFileManager::dropSavefileMetadata(const Common::String &filename) {
+	SavefileIndex *index = getSavefileIndex(filename);
+	if (!index)
+		return;
+
+	// The entry would not match the new size and modification time of the
+	// file anyway, so it is enough to write the index out with the next flush
+	SavefileMetadataMap::iterator entry = index->entries.find(filename);
+	if (entry != index->entries.end()) {
+		index->entries.erase(entry);
+		index->dirty = true;
+	}
+}
+
+void DefaultSaveFileManager::writeSavefileIndex(SavefileIndex &index) {
+	// Do not try again before the index changes
+	index.dirty = false;
+
+	const Common::FSNode directory = index.node.getParent();
+	if (!directory.exists() && !directory.createDirectory()) {
+		warning("DefaultSaveFileManager::writeSavefileIndex: Can not create '%s'", directory.getPath().c_str());
+		return;
+	}
+
+	// The index is written directly rather than through openForSaving, so
+	// that it stays out of the save file cache.
+	Common::ScopedPtr<Common::WriteStream> out(Common::wrapCompressedWriteStream(index.node.createWriteStream()));
+	if (!out) {
+		warning("DefaultSaveFileManager::writeSavefileIndex: Can not write '%s'", index.node.getPath().c_str());
+		return;
+	}
+
+	uint32 count = 0;
+	for (SavefileMetadataMap::const_iterator i = index.entries.begin(); i != index.entries.end(); ++i) {
+		if (i->_key.size() <= 255)
+			count++;
+	}
+
+	out->writeUint32BE(MKTAG('S', 'I', 'D', 'X'));
+	out->writeUint32LE(kSavefileIndexVersion);
+	out->writeUint32LE(count);
+
+	for (SavefileMetadataMap::const_iterator i = index.entries.begin(); i != index.entries.end(); ++i) {
+		if (i->_key.size() > 255)
+			continue;
+		out->writeByte(i->_key.size());
+		out->writeString(i->_key);
+		out->writeSint64LE(i->_value.size);
+		out->writeSint64LE(i->_value.mtime);
+		out->writeUint32LE(i->_value.data.size());
+		out->write(i->_value.data.begin(), i->_value.data.size());
+	}
+
+	out->finalize();
+}
+
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
 
 Common::HashMap<Common::String, uint32> DefaultSaveFileManager::loadTimestamps() {
@@ -27,6 +27,7 @@
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/fs.h"
+#include "common/array.h"
 #include "common/hash-str.h"
 #include <limits.h>
 
@@ -37,6 +38,7 @@ class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::String &defaultSavepath);
+	~DefaultSaveFileManager() override;
 
 	void updateSavefilesList(Common::StringArray &lockedFiles) override;
 	Common::StringArray listSavefiles(const Common::String &pattern) override;
@@ -46,6 +48,10 @@ public:
 	bool removeSavefile(const Common::String &filename) override;
 	bool exists(const Common::String &filename) override;
 
+	Common::SeekableReadStream *openSavefileMetadata(const Common::String &filename) override;
+	void setSavefileMetadata(const Common::String &filename, const byte *data, uint32 size) override;
+	void flushSavefileMetadata() override;
+
 #ifdef USE_LIBCURL
 
 	static const uint32 INVALID_TIMESTAMP = UINT_MAX;
@@ -101,6 +107,52 @@ protected:
 	 */
 	Common::StringArray _lockedFiles;
 
+	/**
+	 * Metadata of a single save file, together with the size and the
+	 * modification time of the save file it was stored for.
+	 */
+	struct SavefileMetadata {
+		int64 size;
+		int64 mtime;
+		Common::Array<byte> data;
+	};
+
+	typedef Common::HashMap<Common::String, SavefileMetadata, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SavefileMetadataMap;
+
+	/**
+	 * Metadata of all save files whose names share the same prefix (usually
+	 * the target). It is kept in a single compressed file, named after the
+	 * prefix, in the ".index" subdirectory of the save path. Changes are
+	 * only written by flushSavefileMetadata().
+	 */
+	struct SavefileIndex {
+		Common::FSNode node;
+		SavefileMetadataMap entries;
+		bool dirty;
+
+		SavefileIndex() : dirty(false) {}
+	};
+
+	typedef Common::HashMap<Common::String, SavefileIndex, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SavefileIndexMap;
+
+	/**
+	 * Metadata indices loaded from the currently cached directory.
+	 */
+	SavefileIndexMap _savefileIndices;
+
+	/**
+	 * Get the metadata index for a save file, loading it if needed. Returns
+	 * nullptr if the file is not suitable for being indexed.
+	 */
+	SavefileIndex *getSavefileIndex(const Common::String &filename);
+
+	/**
+	 * Forget the metadata of a save file, e.g. because it is being replaced.
+	 */
+	void dropSavefileMetadata(const Common::String &filename);
+
+	void writeSavefileIndex(SavefileIndex &index);
+
 private:
 	/**
 	 * The currently cached directory.
@@ -0,0 +1,107 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_time_h
+#define FORBIDDEN_SYMBOL_EXCEPTION_unistd_h
+
+#include "common/scummsys.h"
+
+#if defined(__ANDROID__) || defined(IPHONE) || defined(POSIX)
+
+#include "backends/threads/pthread/pthread-threads.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+namespace {
+
+struct PthreadThread {
+	pthread_t thread;
+	OSystem::ThreadProc proc;
+	void *data;
+};
+
+void *pthreadThreadProc(void *data) {
+	PthreadThread *thread = (PthreadThread *)data;
+	thread->proc(thread->data);
+	return nullptr;
+}
+
+} // End of anonymous namespace
+
+uint PthreadThreadManager::getHardwareThreadCount() {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 1 ? (uint)count : 1;
+}
+
+OSystem::ThreadRef PthreadThreadManager::createThread(OSystem::ThreadProc proc, void *data) {
+	PthreadThread *thread = new PthreadThread();
+	thread->proc = proc;
+	thread->data = data;
+	if (pthread_create(&thread->thread, nullptr, pthreadThreadProc, thread) != 0) {
+		warning("pthread_create() failed");
+		delete thread;
+		return 0;
+	}
+	return (OSystem::ThreadRef)thread;
+}
+
+void PthreadThreadManager::joinThread(OSystem::ThreadRef thread) {
+	PthreadThread *t = (PthreadThread *)thread;
+	if (pthread_join(t->thread, nullptr) != 0)
+		warning("pthread_join() failed");
+	delete t;
+}
+
+OSystem::ConditionRef PthreadThreadManager::createCondition() {
+	pthread_cond_t *cond = new pthread_cond_t;
+
+	if (pthread_cond_init(cond, nullptr) != 0) {
+		warning("pthread_cond_init() failed");
+		delete cond;
+		return 0;
+	}
+
+	return (OSystem::ConditionRef)cond;
+}
+
+void PthreadThreadManager::waitCondition(OSystem::ConditionRef cond, OSystem::MutexRef mutex) {
+	if (pthread_cond_wait((pthread_cond_t *)cond, (pthread_mutex_t *)mutex) != 0)
+		warning("pthread_cond_wait() failed");
+}
+
+void PthreadThreadManager::signalCondition(OSystem::ConditionRef cond, bool all) {
+	int result = all ? pthread_cond_broadcast((pthread_cond_t *)cond) : pthread_cond_signal((pthread_cond_t *)cond);
+	if (result != 0)
+		warning("pthread_cond_signal() failed");
+}
+
+void PthreadThreadManager::deleteCondition(OSystem::ConditionRef cond) {
+	pthread_cond_t *c = (pthread_cond_t *)cond;
+
+	if (pthread_cond_destroy(c) != 0)
+		warning("pthread_cond_destroy() failed");
+	else
+		delete c;
+}
+
+#endif
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/threads/sdl/sdl-threads.h"
+#include "backends/platform/sdl/sdl-sys.h"
+
+namespace {
+
+struct SdlThread {
+	SDL_Thread *thread;
+	OSystem::ThreadProc proc;
+	void *data;
+};
+
+int SDLCALL sdlThreadProc(void *data) {
+	SdlThread *thread = (SdlThread *)data;
+	thread->proc(thread->data);
+	return 0;
+}
+
+} // End of anonymous namespace
+
+uint SdlThreadManager::getHardwareThreadCount() {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	int count = SDL_GetCPUCount();
+	return count > 1 ? count : 1;
+#else
+	return 1;
+#endif
+}
+
+OSystem::ThreadRef SdlThreadManager::createThread(OSystem::ThreadProc proc, void *data) {
+	SdlThread *thread = new SdlThread();
+	thread->proc = proc;
+	thread->data = data;
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	thread->thread = SDL_CreateThread(sdlThreadProc, "ScummVM worker", thread);
+#else
+	thread->thread = SDL_CreateThread(sdlThreadProc, thread);
+#endif
+	if (!thread->thread) {
+		warning("SDL_CreateThread() failed: %s", SDL_GetError());
+		delete thread;
+		return 0;
+	}
+	return (OSystem::ThreadRef)thread;
+}
+
+void SdlThreadManager::joinThread(OSystem::ThreadRef thread) {
+	SdlThread *t = (SdlThread *)thread;
+	SDL_WaitThread(t->thread, nullptr);
+	delete t;
+}
+
+OSystem::ConditionRef SdlThreadManager::createCondition() {
+	return (OSystem::ConditionRef)SDL_CreateCond();
+}
+
+void SdlThreadManager::waitCondition(OSystem::ConditionRef cond, OSystem::MutexRef mutex) {
+	SDL_CondWait((SDL_cond *)cond, (SDL_mutex *)mutex);
+}
+
+void SdlThreadManager::signalCondition(OSystem::ConditionRef cond, bool all) {
+	if (all)
+		SDL_CondBroadcast((SDL_cond *)cond);
+	else
+		SDL_CondSignal((SDL_cond *)cond);
+}
+
+void SdlThreadManager::deleteCondition(OSystem::ConditionRef cond) {
+	SDL_DestroyCond((SDL_cond *)cond);
+}
+
+#endif
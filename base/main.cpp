@@ -44,6 +44,7 @@
 #include "common/events.h"
 #include "gui/EventRecorder.h"
 #include "common/fs.h"
+#include "common/jobsystem.h"
 #ifdef ENABLE_EVENTRECORDER
 #include "common/recorderfile.h"
 #endif
@@ -475,6 +476,10 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		}
 	}
 
+	// Create the job system while this is the only thread. Worker threads,
+	// like the video decode ahead one, submit jobs as well.
+	Common::JobSystem::instance();
+
 	// Process the remaining command line settings. Must be done after the
 	// config file and the plugins have been loaded.
 	Common::Error res;
@@ -484,6 +489,9 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 		if (res.getCode() != Common::kNoError)
 			warning("%s", res.getDesc().c_str());
 
+		// Stop the workers, commands may have used them.
+		Common::JobSystem::destroy();
+
 		PluginManager::instance().unloadDetectionPlugin();
 		PluginManager::instance().unloadAllPlugins();
 		PluginManager::destroy();
@@ -611,6 +619,8 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderUpdate);
 			} else if (recordMode == "playback") {
 				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderPlayback);
+			} else if (recordMode == "benchmark") {
+				g_eventRec.init(recordFileName, GUI::EventRecorder::kRecorderPlayback, true);
 			} else if ((recordMode == "info") && (!recordFileName.empty())) {
 				Common::PlaybackFile record;
 				record.openRead(recordFileName);
@@ -706,6 +716,8 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 			launcherDialog();
 		}
 	}
+	// Jobs may still run code from the engine plugins
+	Common::JobSystem::destroy();
 #ifdef USE_CLOUD
 #ifdef USE_SDL_NET
 	Networking::LocalWebserver::destroy();
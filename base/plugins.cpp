@@ -745,6 +745,9 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist) const
 		}
 	}
 
+	// Remember the MD5s of the files we have seen for the next run
+	MD5Man.flushPersistentCache();
+
 	return DetectionResults(candidates);
 }
 
@@ -21,7 +21,9 @@
  */
 
 #include "common/archive.h"
+#include "common/atomic.h"
 #include "common/fs.h"
+#include "common/mutex.h"
 #include "common/system.h"
 #include "common/textconsole.h"
 
@@ -63,6 +65,29 @@ int Archive::listMatchingMembers(ArchiveMemberList &list, const Path &pattern) c
 
 
 
+volatile int32 SearchSet::_lastGeneration = 0;
+
+SearchSet::~SearchSet() {
+	clear();
+	delete _indexMutex;
+}
+
+void SearchSet::contentsChanged() {
+	atomicStore(&_generation, atomicAdd(&_lastGeneration, 1));
+}
+
+int32 SearchSet::getContentsGeneration() const {
+	int32 generation = atomicLoad(&_generation);
+	if (_nestedSets) {
+		for (ArchiveNodeList::const_iterator it = _list.begin(); it != _list.end(); ++it) {
+			const SearchSet *nested = dynamic_cast<const SearchSet *>(it->_arc);
+			if (nested)
+				generation = MAX(generation, nested->getContentsGeneration());
+		}
+	}
+	return generation;
+}
+
 SearchSet::ArchiveNodeList::iterator SearchSet::find(const String &name) {
 	ArchiveNodeList::iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
@@ -99,6 +124,9 @@ void SearchSet::add(const String &name, Archive *archive, int priority, bool aut
 	if (find(name) == _list.end()) {
 		Node node(priority, name, archive, autoFree);
 		insert(node);
+		if (dynamic_cast<SearchSet *>(archive))
+			_nestedSets++;
+		contentsChanged();
 	} else {
 		if (autoFree)
 			delete archive;
@@ -171,9 +199,12 @@ void SearchSet::addSubDirectoriesMatching(const FSNode &directory, String origPa
 void SearchSet::remove(const String &name) {
 	ArchiveNodeList::iterator it = find(name);
 	if (it != _list.end()) {
+		if (dynamic_cast<SearchSet *>(it->_arc))
+			_nestedSets--;
 		if (it->_autoFree)
 			delete it->_arc;
 		_list.erase(it);
+		contentsChanged();
 	}
 }
 
@@ -188,6 +219,8 @@ void SearchSet::clear() {
 	}
 
 	_list.clear();
+	_nestedSets = 0;
+	contentsChanged();
 }
 
 void SearchSet::setPriority(const String &name, int priority) {
@@ -204,19 +237,82 @@ void SearchSet::setPriority(const String &name, int priority) {
 	_list.erase(it);
 	node._priority = priority;
 	insert(node);
+	contentsChanged();
 }
 
-bool SearchSet::hasFile(const Path &path) const {
-	if (path.empty())
-		return false;
+void SearchSet::enableIndex(bool enable) {
+	if (enable && !_indexMutex)
+		_indexMutex = new Mutex();
 
+	if (_indexMutex) {
+		StackLock lock(*_indexMutex);
+		_index.clear();
+		_indexGeneration = getContentsGeneration();
+	}
+
+	_indexEnabled = enable;
+}
+
+Archive *SearchSet::searchArchive(const Path &path) const {
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		if (it->_arc->hasFile(path))
-			return true;
+			return it->_arc;
+	}
+	return nullptr;
+}
+
+Archive *SearchSet::findArchive(const Path &path) const {
+	const String key = path.rawString();
+	const int32 generation = getContentsGeneration();
+	Archive *known = nullptr;
+
+	{
+		StackLock lock(*_indexMutex);
+
+		if (_indexGeneration != generation) {
+			_index.clear();
+			_indexGeneration = generation;
+		}
+
+		MemberIndex::const_iterator i = _index.find(key);
+		if (i != _index.end()) {
+			if (!i->_value._arc && i->_value._missingPath == key) {
+				_indexHits++;
+				return nullptr;
+			}
+			known = i->_value._arc;
+		}
+	}
+
+	// The remembered archive may not have the path in this case
+	if (known && known->hasFile(path)) {
+		StackLock lock(*_indexMutex);
+		_indexHits++;
+		return known;
 	}
 
-	return false;
+	Archive *arc = searchArchive(path);
+
+	// Archives may have changed while searching without the lock
+	StackLock lock(*_indexMutex);
+	_indexMisses++;
+	if (_indexGeneration == generation && getContentsGeneration() == generation && (arc || !known)) {
+		IndexEntry &entry = _index[key];
+		entry._arc = arc;
+		entry._missingPath = arc ? String() : key;
+	}
+	return arc;
+}
+
+bool SearchSet::hasFile(const Path &path) const {
+	if (path.empty())
+		return false;
+
+	if (_indexEnabled)
+		return findArchive(path) != nullptr;
+
+	return searchArchive(path) != nullptr;
 }
 
 int SearchSet::listMatchingMembers(ArchiveMemberList &list, const Path &pattern) const {
@@ -243,19 +339,26 @@ const ArchiveMemberPtr SearchSet::getMember(const Path &path) const {
 	if (path.empty())
 		return ArchiveMemberPtr();
 
-	ArchiveNodeList::const_iterator it = _list.begin();
-	for (; it != _list.end(); ++it) {
-		if (it->_arc->hasFile(path))
-			return it->_arc->getMember(path);
-	}
-
-	return ArchiveMemberPtr();
+	Archive *arc = _indexEnabled ? findArchive(path) : searchArchive(path);
+	return arc ? arc->getMember(path) : ArchiveMemberPtr();
 }
 
 SeekableReadStream *SearchSet::createReadStreamForMember(const Path &path) const {
 	if (path.empty())
 		return nullptr;
 
+	if (_indexEnabled) {
+		Archive *arc = findArchive(path);
+		if (!arc)
+			return nullptr;
+
+		SeekableReadStream *stream = arc->createReadStreamForMember(path);
+		if (stream)
+			return stream;
+
+		// Opening failed, fall back to trying every archive as usual
+	}
+
 	ArchiveNodeList::const_iterator it = _list.begin();
 	for (; it != _list.end(); ++it) {
 		SeekableReadStream *stream = it->_arc->createReadStreamForMember(path);
@@ -269,6 +372,11 @@ SeekableReadStream *SearchSet::createReadStreamForMember(const Path &path) const
 
 SearchManager::SearchManager() {
 	clear(); // Force a reset
+
+	// Engines look up the same files over and over, often in a long list of
+	// directories. The index needs a mutex, so it needs the backend.
+	if (g_system)
+		enableIndex(true);
 }
 
 void SearchManager::clear() {
@@ -24,6 +24,7 @@
 #define COMMON_ARCHIVE_H
 
 #include "common/str.h"
+#include "common/hash-str.h"
 #include "common/list.h"
 #include "common/path.h"
 #include "common/ptr.h"
@@ -42,6 +43,7 @@ namespace Common {
  */
 
 class FSNode;
+class Mutex;
 class SeekableReadStream;
 
 
@@ -169,9 +171,35 @@ class SearchSet : public Archive {
 
 	bool _ignoreClashes;
 
+	// Lookup index, mapping member paths to the archive which provides them.
+	// Paths are compared ignoring case. An entry without an archive records
+	// a path that is in none of the archives, spelled as in _missingPath.
+	struct IndexEntry {
+		Archive *_arc;
+		String _missingPath;
+	};
+	typedef HashMap<String, IndexEntry, IgnoreCase_Hash, IgnoreCase_EqualTo> MemberIndex;
+	mutable MemberIndex _index;
+	mutable int32 _indexGeneration;
+	mutable uint32 _indexHits, _indexMisses;
+	bool _indexEnabled;
+	// Guards the fields above, created by enableIndex()
+	Mutex *_indexMutex;
+
+	// Stamp of the last change to the archives of this set, drawn from a
+	// counter shared by all sets so that stamps of nested sets can be compared
+	volatile int32 _generation;
+	uint _nestedSets;
+	static volatile int32 _lastGeneration;
+
+	void contentsChanged();
+	int32 getContentsGeneration() const; //!< Latest stamp of this set and the sets nested in it.
+	Archive *findArchive(const Path &path) const; //!< Find the first archive containing a path, via the index.
+	Archive *searchArchive(const Path &path) const; //!< Find the first archive containing a path, asking each.
+
 public:
-	SearchSet() : _ignoreClashes(false) { }
-	virtual ~SearchSet() { clear(); }
+	SearchSet() : _ignoreClashes(false), _indexGeneration(0), _indexHits(0), _indexMisses(0), _indexEnabled(false), _indexMutex(nullptr), _generation(0), _nestedSets(0) { }
+	virtual ~SearchSet();
 
 	/**
 	 * Add a new archive to the searchable set.
@@ -269,6 +297,46 @@ public:
 	 * in @ref FSDirectory documentation.
 	 */
 	void setIgnoreClashes(bool ignoreClashes) { _ignoreClashes = ignoreClashes; }
+
+	/**
+	 * Enable or disable the lookup index.
+	 *
+	 * When enabled, the archive which provides a path is remembered the first
+	 * time the path is looked up, so that later calls to hasFile, getMember and
+	 * createReadStreamForMember for the same path go straight to that archive
+	 * instead of asking every archive in turn. Paths which are not found are
+	 * remembered as well. Lookups from several threads are safe, but this has
+	 * to be called before the set is shared with other threads.
+	 *
+	 * Paths are looked up ignoring case, like FSDirectory and most archives
+	 * do. A remembered archive is asked again whether it has the path in the
+	 * requested case, and a missing path is only remembered in the case it
+	 * was looked up in, so case sensitive archives still find their files.
+	 * However, if a file exists in a case sensitive archive and, spelled
+	 * differently, in a case insensitive archive, the archive found first is
+	 * used for both spellings, regardless of priority.
+	 *
+	 * The index is dropped whenever an archive is added, removed or
+	 * reprioritized in this set or in a SearchSet nested in it. Archives
+	 * which change their contents in other ways must not be part of a set
+	 * with an index. SearchMan has the index enabled.
+	 */
+	void enableIndex(bool enable);
+
+	/**
+	 * Number of lookups answered by the lookup index.
+	 */
+	uint32 getIndexHits() const { return _indexHits; }
+
+	/**
+	 * Number of lookups which had to search the archives.
+	 */
+	uint32 getIndexMisses() const { return _indexMisses; }
+
+	/**
+	 * Reset the lookup index hit and miss counters.
+	 */
+	void resetIndexStats() { _indexHits = _indexMisses = 0; }
 };
 
 
@@ -0,0 +1,122 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic operations
+ * @ingroup common
+ *
+ * @brief Atomic operations on 32-bit integers shared between threads.
+ *
+ * Loads have acquire and stores release semantics, the read-modify-write
+ * operations are sequentially consistent.
+ *
+ * HAVE_ATOMICS is defined when the compiler provides real atomic
+ * operations. Otherwise plain memory accesses are used, which is only
+ * correct on backends without threads. Code which must never block, like
+ * lock-free queues, should fall back to a mutex in that case.
+ * @{
+ */
+
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+
+#define HAVE_ATOMICS
+
+inline int32 atomicLoad(const volatile int32 *value) {
+	return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+inline void atomicStore(volatile int32 *value, int32 newValue) {
+	__atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+}
+
+/** Add @p delta to @p value and return the new value. */
+inline int32 atomicAdd(volatile int32 *value, int32 delta) {
+	return __atomic_add_fetch(value, delta, __ATOMIC_SEQ_CST);
+}
+
+/** Set @p value to @p newValue if it equals @p expected. Return whether it did. */
+inline bool atomicCompareExchange(volatile int32 *value, int32 expected, int32 newValue) {
+	return __atomic_compare_exchange_n(value, &expected, newValue, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(_MSC_VER)
+
+#define HAVE_ATOMICS
+
+// The interlocked functions are full barriers, which includes acquire and
+// release semantics on every architecture MSVC targets.
+
+inline int32 atomicLoad(const volatile int32 *value) {
+	return _InterlockedCompareExchange((volatile long *)value, 0, 0);
+}
+
+inline void atomicStore(volatile int32 *value, int32 newValue) {
+	_InterlockedExchange((volatile long *)value, newValue);
+}
+
+inline int32 atomicAdd(volatile int32 *value, int32 delta) {
+	return _InterlockedExchangeAdd((volatile long *)value, delta) + delta;
+}
+
+inline bool atomicCompareExchange(volatile int32 *value, int32 expected, int32 newValue) {
+	return _InterlockedCompareExchange((volatile long *)value, newValue, expected) == expected;
+}
+
+#else
+
+inline int32 atomicLoad(const volatile int32 *value) {
+	return *value;
+}
+
+inline void atomicStore(volatile int32 *value, int32 newValue) {
+	*value = newValue;
+}
+
+inline int32 atomicAdd(volatile int32 *value, int32 delta) {
+	return *value += delta;
+}
+
+inline bool atomicCompareExchange(volatile int32 *value, int32 expected, int32 newValue) {
+	if (*value != expected)
+		return false;
+	*value = newValue;
+	return true;
+}
+
+#endif
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
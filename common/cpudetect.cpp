@@ -0,0 +1,64 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/cpudetect.h"
+
+namespace Common {
+
+static uint32 detectCpuFeatures() {
+	uint32 features = 0;
+
+#ifdef SCUMMVM_TARGET_AVX2
+	// This also checks that the OS saves the AVX registers
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		features |= 1 << kCpuFeatureSSE2;
+	if (__builtin_cpu_supports("sse4.1"))
+		features |= 1 << kCpuFeatureSSE41;
+	if (__builtin_cpu_supports("avx2"))
+		features |= 1 << kCpuFeatureAVX2;
+#elif defined(__SSE2__)
+	features |= 1 << kCpuFeatureSSE2;
+#endif
+
+#ifdef __ARM_NEON
+	features |= 1 << kCpuFeatureNEON;
+#endif
+
+	return features;
+}
+
+static uint32 s_disabledFeatures = 0;
+
+bool hasCpuFeature(CpuFeature feature) {
+	static const uint32 features = detectCpuFeatures();
+	return (features & ~s_disabledFeatures & (1 << feature)) != 0;
+}
+
+void enableCpuFeature(CpuFeature feature, bool enable) {
+	if (enable)
+		s_disabledFeatures &= ~(1 << feature);
+	else
+		s_disabledFeatures |= 1 << feature;
+}
+
+} // End of namespace Common
@@ -0,0 +1,75 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_CPUDETECT_H
+#define COMMON_CPUDETECT_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_cpudetect CPU feature detection
+ * @ingroup common
+ *
+ * @brief Runtime detection of the SIMD instruction sets of the CPU.
+ *
+ * The build only enables the instruction sets every CPU of the target
+ * has, which are SSE2 on x86-64 and NEON on AArch64. SIMD code limited to
+ * them checks __SSE2__ or __ARM_NEON at compile time.
+ *
+ * Newer instruction sets, like SSE4.1 and AVX2, are not enabled by the
+ * build flags. Functions using them are compiled for them one by one with
+ * SCUMMVM_TARGET_SSE41 or SCUMMVM_TARGET_AVX2, which are only defined for
+ * compilers supporting that, and may only be called once hasCpuFeature()
+ * confirmed the CPU has the instruction set. Such functions cannot be
+ * inlined into the code calling them, so they should handle whole rows
+ * and be selected once per row or frame, not per pixel.
+ * @{
+ */
+
+enum CpuFeature {
+	kCpuFeatureSSE2,
+	kCpuFeatureSSE41,
+	kCpuFeatureAVX2,
+	kCpuFeatureNEON
+};
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define SCUMMVM_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SCUMMVM_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/** Return whether the CPU supports @p feature and it has not been disabled. */
+bool hasCpuFeature(CpuFeature feature);
+
+/**
+ * Enable or disable using a feature of the CPU. Disabling the newer
+ * features allows testing the code for older CPUs on newer ones.
+ */
+void enableCpuFeature(CpuFeature feature, bool enable);
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
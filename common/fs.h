@@ -224,6 +224,18 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Retrieve the size and the last modification time of the file referred
+	 * to by this node, without opening it.
+	 *
+	 * The modification time is only meaningful when compared to another value
+	 * returned by this method for the same file.
+	 *
+	 * @return True if the backend supports this and the values were retrieved,
+	 *         false otherwise.
+	 */
+	bool getFileStats(int64 &size, int64 &mtime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
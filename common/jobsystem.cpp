@@ -0,0 +1,232 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/jobsystem.h"
+#include "common/debug.h"
+#include "common/system.h"
+
+namespace Common {
+
+DECLARE_SINGLETON(JobSystem);
+
+// Upper bound for the number of workers, more rarely help with
+// the kind of work the engines split off.
+static const uint kMaxWorkers = 15;
+
+// Marks threads that are not workers in takeJob()
+static const uint kNoWorker = 0xFFFFFFFF;
+
+JobSystem::JobSystem() : _nextWorker(0), _queuedJobs(0), _quit(false) {
+	// The calling thread helps while waiting, so one core is left for it
+	startWorkers(MIN<uint>(g_system->getHardwareThreadCount(), kMaxWorkers + 1) - 1);
+}
+
+JobSystem::JobSystem(uint workerCount) : _nextWorker(0), _queuedJobs(0), _quit(false) {
+	startWorkers(MIN<uint>(workerCount, kMaxWorkers));
+}
+
+void JobSystem::startWorkers(uint count) {
+	if (count == 0)
+		return;
+
+	// The workers look at each other's queues, so they have to exist
+	// before any of them starts running.
+	for (uint i = 0; i < count; ++i) {
+		Worker *worker = new Worker();
+		worker->system = this;
+		worker->index = i;
+		_workers.push_back(worker);
+	}
+
+	for (uint i = 0; i < count; ++i) {
+		if (!_workers[i]->thread.start(workerProc, _workers[i])) {
+			warning("JobSystem: Could not start worker threads, running jobs inline");
+			stopWorkers();
+			return;
+		}
+	}
+
+	debug(1, "JobSystem: Started %d worker threads", count);
+}
+
+JobSystem::~JobSystem() {
+	stopWorkers();
+}
+
+void JobSystem::stopWorkers() {
+	{
+		StackLock lock(_mutex);
+		_quit = true;
+	}
+	_workAvailable.broadcast();
+
+	// Workers only quit once all the queued jobs are done
+	for (uint i = 0; i < _workers.size(); ++i) {
+		_workers[i]->thread.join();
+		delete _workers[i];
+	}
+	_workers.clear();
+}
+
+void JobSystem::submit(Job *job, JobGroup *group, DisposeAfterUse::Flag disposeAfterUse) {
+	assert(job && !job->_done);
+	job->_group = group;
+	job->_disposeAfterUse = disposeAfterUse;
+
+	if (_workers.empty()) {
+		job->run();
+		job->_done = true;
+		if (disposeAfterUse == DisposeAfterUse::YES)
+			delete job;
+		return;
+	}
+
+	// Jobs are submitted from several threads, including jobs themselves
+	Worker *worker;
+	{
+		StackLock lock(_mutex);
+		if (group)
+			group->_pending++;
+		worker = _workers[_nextWorker++ % _workers.size()];
+	}
+
+	{
+		StackLock lock(worker->mutex);
+		worker->queue.push_back(job);
+	}
+
+	{
+		StackLock lock(_mutex);
+		_queuedJobs++;
+	}
+	_workAvailable.signal();
+}
+
+Job *JobSystem::takeJob(uint worker) {
+	Job *job = nullptr;
+
+	// The own queue is used as a stack, for locality
+	if (worker != kNoWorker) {
+		Worker *own = _workers[worker];
+		StackLock lock(own->mutex);
+		if (!own->queue.empty()) {
+			job = own->queue.back();
+			own->queue.pop_back();
+		}
+	}
+
+	// Other queues are stolen from in submission order
+	for (uint i = 0; !job && i < _workers.size(); ++i) {
+		Worker *victim = _workers[(worker + 1 + i) % _workers.size()];
+		StackLock lock(victim->mutex);
+		if (!victim->queue.empty()) {
+			job = victim->queue.front();
+			victim->queue.pop_front();
+		}
+	}
+
+	if (job) {
+		StackLock lock(_mutex);
+		_queuedJobs--;
+	}
+	return job;
+}
+
+void JobSystem::runJob(Job *job) {
+	job->run();
+
+	// Once the job is marked as done, its owner may delete it
+	const bool dispose = job->_disposeAfterUse == DisposeAfterUse::YES;
+	{
+		StackLock lock(_mutex);
+		if (job->_group)
+			job->_group->_pending--;
+		job->_done = true;
+	}
+	_jobDone.broadcast();
+
+	if (dispose)
+		delete job;
+}
+
+void JobSystem::workerProc(void *data) {
+	Worker *worker = (Worker *)data;
+	JobSystem *system = worker->system;
+
+	while (true) {
+		Job *job = system->takeJob(worker->index);
+		if (job) {
+			system->runJob(job);
+			continue;
+		}
+
+		StackLock lock(system->_mutex);
+		while (system->_queuedJobs <= 0 && !system->_quit)
+			system->_workAvailable.wait(system->_mutex);
+		if (system->_queuedJobs <= 0 && system->_quit)
+			return;
+	}
+}
+
+void JobSystem::wait(Job &job) {
+	assert(job._disposeAfterUse == DisposeAfterUse::NO);
+
+	while (true) {
+		{
+			StackLock lock(_mutex);
+			if (job._done)
+				return;
+		}
+
+		Job *other = takeJob(kNoWorker);
+		if (other) {
+			runJob(other);
+			continue;
+		}
+
+		StackLock lock(_mutex);
+		if (!job._done && _queuedJobs <= 0)
+			_jobDone.wait(_mutex);
+	}
+}
+
+void JobSystem::wait(JobGroup &group) {
+	while (true) {
+		{
+			StackLock lock(_mutex);
+			if (group._pending == 0)
+				return;
+		}
+
+		Job *other = takeJob(kNoWorker);
+		if (other) {
+			runJob(other);
+			continue;
+		}
+
+		StackLock lock(_mutex);
+		if (group._pending != 0 && _queuedJobs <= 0)
+			_jobDone.wait(_mutex);
+	}
+}
+
+} // End of namespace Common
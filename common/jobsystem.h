@@ -0,0 +1,190 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_JOBSYSTEM_H
+#define COMMON_JOBSYSTEM_H
+
+#include "common/array.h"
+#include "common/func.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/ptr.h"
+#include "common/singleton.h"
+#include "common/thread.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_jobsystem Job system
+ * @ingroup common
+ *
+ * @brief A pool of worker threads for running independent work in parallel.
+ *
+ * Every worker owns a queue. Submitted jobs are spread over the queues,
+ * workers take the newest job from their own queue and steal the oldest
+ * ones from the others when it is empty. Threads waiting for a job or a
+ * group help by running queued jobs themselves.
+ *
+ * On backends without thread support, or with a single core, there are no
+ * workers and jobs run inline when they are submitted.
+ *
+ * Singleton::instance() is not thread safe, so scummvm_main() creates the
+ * shared job system before any engine or command starts other threads.
+ *
+ * Jobs must not use the OSystem API beyond the mutex, thread and condition
+ * variable functions, and must not touch engine state that is not protected
+ * by a mutex.
+ * @{
+ */
+
+class JobGroup;
+
+/**
+ * A unit of work for the job system.
+ */
+class Job : NonCopyable {
+	friend class JobSystem;
+
+	JobGroup *_group;
+	bool _done;
+	DisposeAfterUse::Flag _disposeAfterUse;
+
+public:
+	Job() : _group(nullptr), _done(false), _disposeAfterUse(DisposeAfterUse::NO) {}
+	virtual ~Job() {}
+
+	/** Do the work. Called from a worker thread or from the submitting one. */
+	virtual void run() = 0;
+};
+
+/**
+ * A set of jobs that can be waited for together. The group has to be
+ * waited for before it is destroyed.
+ */
+class JobGroup : NonCopyable {
+	friend class JobSystem;
+
+	uint _pending;
+
+public:
+	JobGroup() : _pending(0) {}
+
+	/** Wait until all the jobs of the group are done. */
+	void wait();
+};
+
+/**
+ * A job computing a value through a functor. Call get() to wait for it.
+ */
+template<class T>
+class Future : public Job {
+	ScopedPtr<Functor0<T> > _func;
+	T _result;
+
+public:
+	explicit Future(Functor0<T> *func) : _func(func), _result() {}
+
+	virtual void run() override { _result = (*_func)(); }
+
+	/** Wait for the job, then return its result. */
+	const T &get();
+};
+
+class JobSystem : public Singleton<JobSystem> {
+public:
+	/**
+	 * Queue a job, or run it right away if there are no workers.
+	 *
+	 * @param job             The job to run. A job can only be submitted once.
+	 * @param group           Optional group to add the job to.
+	 * @param disposeAfterUse Whether to delete the job once it is done.
+	 *                        Such jobs cannot be waited for directly.
+	 */
+	void submit(Job *job, JobGroup *group = nullptr, DisposeAfterUse::Flag disposeAfterUse = DisposeAfterUse::NO);
+
+	/** Wait until the given job is done. */
+	void wait(Job &job);
+
+	/** Wait until all the jobs of the given group are done. */
+	void wait(JobGroup &group);
+
+	/** Return the number of worker threads. 0 means that jobs run inline. */
+	uint getWorkerCount() const { return _workers.size(); }
+
+	/**
+	 * Create a job system with its own workers, besides the shared one.
+	 * JobGroup::wait() and Future::get() use the shared one, so jobs of
+	 * this system have to be waited for through wait().
+	 */
+	explicit JobSystem(uint workerCount);
+	~JobSystem();
+
+private:
+	friend class Singleton<SingletonBaseType>;
+	JobSystem();
+
+	struct Worker {
+		JobSystem *system;
+		uint index;
+		Thread thread;
+		Mutex mutex;
+		List<Job *> queue;
+	};
+
+	static void workerProc(void *data);
+
+	void startWorkers(uint count);
+
+	Job *takeJob(uint worker);
+	void runJob(Job *job);
+	void stopWorkers();
+
+	Array<Worker *> _workers;
+
+	/** Protects the fields below, and the state of the jobs and groups */
+	Mutex _mutex;
+	uint _nextWorker;
+	ConditionVariable _workAvailable;
+	ConditionVariable _jobDone;
+	int _queuedJobs;
+	bool _quit;
+};
+
+inline void JobGroup::wait() {
+	JobSystem::instance().wait(*this);
+}
+
+template<class T>
+const T &Future<T>::get() {
+	JobSystem::instance().wait(*this);
+	return _result;
+}
+
+/** @} */
+
+} // End of namespace Common
+
+/** Shortcut for accessing the job system. */
+#define JobSys Common::JobSystem::instance()
+
+#endif
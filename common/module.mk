@@ -6,6 +6,7 @@ MODULE_OBJS := \
 	base-str.o \
 	config-manager.o \
 	coroutines.o \
+	cpudetect.o \
 	dcl.o \
 	debug.o \
 	error.o \
@@ -18,6 +19,7 @@ MODULE_OBJS := \
 	ini-file.o \
 	installshield_cab.o \
 	installshieldv3_archive.o \
+	jobsystem.o \
 	json.o \
 	language.o \
 	localization.o \
@@ -44,6 +46,7 @@ MODULE_OBJS := \
 	system.o \
 	textconsole.o \
 	text-to-speech.o \
+	thread.o \
 	tokenizer.o \
 	translation.o \
 	unarj.o \
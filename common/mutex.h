@@ -59,6 +59,7 @@ public:
  */
 class Mutex {
 	friend class StackLock;
+	friend class ConditionVariable;
 
 	OSystem::MutexRef _mutex;
 
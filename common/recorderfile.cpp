@@ -335,6 +335,7 @@ bool PlaybackFile::hasNextEvent() const {
 RecorderEvent PlaybackFile::getNextEvent() {
 	if (!hasNextEvent()) {
 		debug(3, "end of recorder file reached.");
+		g_eventRec.reportBenchmark();
 		g_system->quit();
 	}
 
@@ -794,6 +795,7 @@ void PlaybackFile::checkRecordedMD5() {
 	if (!g_eventRec.grabScreenAndComputeMD5(screen, currentMD5)) {
 		return;
 	}
+	g_eventRec.processScreenChecksum(savedMD5, currentMD5);
 	uint32 seconds = g_system->getMillis(true) / 1000;
 	String screenTime = String::format("%.2d:%.2d:%.2d", seconds / 3600 % 24, seconds / 60 % 60, seconds % 60);
 	if (memcmp(savedMD5, currentMD5, 16) != 0) {
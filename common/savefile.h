@@ -277,6 +277,38 @@ public:
 	 * @return true if the file exists. false otherwise.
 	 */
 	virtual bool exists(const String &name) = 0;
+
+	/**
+	 * Open the metadata which was stored for a save file with
+	 * setSavefileMetadata(), provided the save file did not change since.
+	 *
+	 * The metadata is opaque to the save file manager. It is used by
+	 * MetaEngine to avoid parsing every save file whenever the saves of
+	 * a target are listed.
+	 *
+	 * @param name Name of the save file.
+	 *
+	 * @return Stream with the metadata, or nullptr if there is none.
+	 */
+	virtual SeekableReadStream *openSavefileMetadata(const String &name) { return nullptr; }
+
+	/**
+	 * Store metadata for the current contents of a save file. It is dropped
+	 * when the save file is saved again or removed.
+	 *
+	 * Implementations are allowed to ignore this.
+	 *
+	 * @param name Name of the save file.
+	 * @param data Metadata to store.
+	 * @param size Size of the metadata in bytes.
+	 */
+	virtual void setSavefileMetadata(const String &name, const byte *data, uint32 size) {}
+
+	/**
+	 * Write out metadata stored with setSavefileMetadata(), if the
+	 * implementation defers this.
+	 */
+	virtual void flushSavefileMetadata() {}
 };
 
 /** @} */
@@ -1477,6 +1477,81 @@ public:
 
 	/** @} */
 
+	/**
+	 * @defgroup common_system_threads Thread handling
+	 * @ingroup common_system
+	 * @{
+	 *
+	 * Threads are optional. They are only meant for work that can be split
+	 * off the engine thread without touching the rest of the OSystem API,
+	 * like decoding or scaling into private buffers. Code using them should
+	 * go through Common::JobSystem, which runs the work inline on backends
+	 * that do not support threads.
+	 *
+	 * The default implementations report that no threads are available.
+	 */
+
+	typedef struct OpaqueThread *ThreadRef;
+	typedef struct OpaqueCondition *ConditionRef;
+	typedef void (*ThreadProc)(void *data);
+
+	/**
+	 * Return the number of threads that can run in parallel, including the
+	 * calling one. A value of 1 means that threads should not be used.
+	 */
+	virtual uint getHardwareThreadCount() { return 1; }
+
+	/**
+	 * Create a new thread running the given function.
+	 *
+	 * @return The newly created thread, or 0 if threads are not supported
+	 *         or an error occurred.
+	 */
+	virtual ThreadRef createThread(ThreadProc proc, void *data) { return 0; }
+
+	/**
+	 * Wait for the given thread to finish and free it.
+	 *
+	 * @param thread	The thread to join.
+	 */
+	virtual void joinThread(ThreadRef thread) {}
+
+	/**
+	 * Create a new condition variable.
+	 *
+	 * @return The newly created condition variable, or 0 if an error occurred.
+	 */
+	virtual ConditionRef createCondition() { return 0; }
+
+	/**
+	 * Wait on the given condition variable.
+	 *
+	 * The mutex must have been created with createMutex() and be locked exactly
+	 * once by the calling thread. It is unlocked while waiting, and locked again
+	 * before returning. Spurious wakeups are possible.
+	 *
+	 * @param cond	The condition variable to wait on.
+	 * @param mutex	The mutex protecting the condition.
+	 */
+	virtual void waitCondition(ConditionRef cond, MutexRef mutex) {}
+
+	/**
+	 * Wake up threads waiting on the given condition variable.
+	 *
+	 * @param cond	The condition variable to signal.
+	 * @param all	Whether to wake up all the waiting threads or just one.
+	 */
+	virtual void signalCondition(ConditionRef cond, bool all) {}
+
+	/**
+	 * Delete the given condition variable.
+	 *
+	 * @param cond	The condition variable to delete.
+	 */
+	virtual void deleteCondition(ConditionRef cond) {}
+
+	/** @} */
+
 
 
 	/** @defgroup common_system_sound Sound
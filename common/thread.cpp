@@ -0,0 +1,78 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/thread.h"
+#include "common/mutex.h"
+
+namespace Common {
+
+Thread::Thread() : _thread(0) {
+}
+
+Thread::~Thread() {
+	join();
+}
+
+bool Thread::start(OSystem::ThreadProc proc, void *data) {
+	assert(g_system);
+	assert(!_thread);
+	_thread = g_system->createThread(proc, data);
+	return _thread != 0;
+}
+
+void Thread::join() {
+	if (_thread) {
+		g_system->joinThread(_thread);
+		_thread = 0;
+	}
+}
+
+
+#pragma mark -
+
+
+ConditionVariable::ConditionVariable() {
+	assert(g_system);
+	_cond = g_system->createCondition();
+}
+
+ConditionVariable::~ConditionVariable() {
+	if (_cond)
+		g_system->deleteCondition(_cond);
+}
+
+void ConditionVariable::wait(Mutex &mutex) {
+	assert(_cond);
+	g_system->waitCondition(_cond, mutex._mutex);
+}
+
+void ConditionVariable::signal() {
+	if (_cond)
+		g_system->signalCondition(_cond, false);
+}
+
+void ConditionVariable::broadcast() {
+	if (_cond)
+		g_system->signalCondition(_cond, true);
+}
+
+} // End of namespace Common
@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_THREAD_H
+#define COMMON_THREAD_H
+
+#include "common/scummsys.h"
+#include "common/system.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_thread Threads
+ * @ingroup common
+ *
+ * @brief API for threads and condition variables.
+ *
+ * Threads are optional, see the OSystem thread handling functions.
+ * Most code should use Common::JobSystem instead of creating threads.
+ * @{
+ */
+
+class Mutex;
+
+/**
+ * Wrapper class around the OSystem thread functions.
+ */
+class Thread : NonCopyable {
+	OSystem::ThreadRef _thread;
+
+public:
+	Thread();
+	~Thread();
+
+	/**
+	 * Start running the given function in a new thread.
+	 *
+	 * @return False if the backend does not support threads or the thread
+	 *         could not be created.
+	 */
+	bool start(OSystem::ThreadProc proc, void *data);
+
+	/**
+	 * Wait for the thread to finish. Does nothing if it was not started.
+	 */
+	void join();
+
+	bool isStarted() const { return _thread != 0; }
+};
+
+/**
+ * Wrapper class around the OSystem condition variable functions.
+ */
+class ConditionVariable : NonCopyable {
+	OSystem::ConditionRef _cond;
+
+public:
+	ConditionVariable();
+	~ConditionVariable();
+
+	/**
+	 * Wait until the condition is signalled. The mutex has to be locked
+	 * once by the calling thread.
+	 */
+	void wait(Mutex &mutex);
+
+	/** Wake up one waiting thread. */
+	void signal();
+
+	/** Wake up all the waiting threads. */
+	void broadcast();
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -106,6 +106,9 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/textconsole.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -382,6 +385,7 @@ typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_H
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamOwner; /* keeps _stream alive while members are open */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +548,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamOwner = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +600,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -644,7 +648,7 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != nullptr)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
+	// The stream itself is only deleted once no member stream uses it anymore
 	delete s;
 	return UNZ_OK;
 }
@@ -1420,7 +1424,176 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 namespace Common {
 
 
+/**
+ * Stream for a stored (uncompressed) member of a zip archive.
+ *
+ * Reads directly from the archive stream, repositioning it before every
+ * read. Several members can thus be read at the same time, and the member
+ * keeps the archive stream alive even when the archive is closed first.
+ */
+class ZipStoredReadStream : public SafeSeekableSubReadStream {
+	SharedPtr<SeekableReadStream> _archiveStream;
+
+public:
+	ZipStoredReadStream(const SharedPtr<SeekableReadStream> &archiveStream, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(archiveStream.get(), begin, end, DisposeAfterUse::NO), _archiveStream(archiveStream) {
+	}
+};
+
+#ifdef USE_ZLIB
+
+/**
+ * Stream for a deflated member of a zip archive, which inflates the data
+ * as it is read.
+ *
+ * Like ZipStoredReadStream, it keeps its own position in the archive stream.
+ * Seeking forward inflates and skips the data in between, seeking backward
+ * restarts inflating from the start of the member.
+ */
+class ZipInflateReadStream : public SeekableReadStream {
+	enum {
+		BUFSIZE = UNZ_BUFSIZE
+	};
+
+	SharedPtr<SeekableReadStream> _archiveStream;
+	const uint32 _dataOffset;
+	const uint32 _compressedSize;
+	const uint32 _uncompressedSize;
+	const uint32 _crc;
+
+	byte _buf[BUFSIZE];
+	z_stream _stream;
+	int _zlibErr;
+	uint32 _compressedPos;
+	uint32 _pos;
+	uLong _crcData;
+	bool _eos;
+
+	bool reset() {
+		_compressedPos = 0;
+		_pos = 0;
+		_crcData = crc32(0, nullptr, 0);
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_zlibErr = inflateReset(&_stream);
+		return _zlibErr == Z_OK;
+	}
+
+public:
+	ZipInflateReadStream(const SharedPtr<SeekableReadStream> &archiveStream, uint32 dataOffset,
+	                     uint32 compressedSize, uint32 uncompressedSize, uint32 crc)
+		: _archiveStream(archiveStream), _dataOffset(dataOffset), _compressedSize(compressedSize),
+		  _uncompressedSize(uncompressedSize), _crc(crc), _stream(), _compressedPos(0), _pos(0),
+		  _eos(false) {
+		_crcData = crc32(0, nullptr, 0);
+
+		// windowBits is passed < 0 to tell that there is no zlib header.
+		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+	}
+
+	~ZipInflateReadStream() {
+		inflateEnd(&_stream);
+	}
+
+	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
+	void clearErr() {
+		// only reset _eos; I/O and data errors are not recoverable
+		_eos = false;
+	}
+
+	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (_pos + dataSize > _uncompressedSize) {
+			dataSize = _uncompressedSize - _pos;
+			_eos = true;
+		}
+
+		_stream.next_out = (byte *)dataPtr;
+		_stream.avail_out = dataSize;
+
+		while (_zlibErr == Z_OK && _stream.avail_out) {
+			if (_stream.avail_in == 0 && _compressedPos < _compressedSize) {
+				// Refill the input buffer from our own position in the archive
+				const uint32 toRead = MIN<uint32>(BUFSIZE, _compressedSize - _compressedPos);
+				_archiveStream->seek(_dataOffset + _compressedPos, SEEK_SET);
+				if (_archiveStream->read(_buf, toRead) != toRead) {
+					_zlibErr = Z_ERRNO;
+					break;
+				}
+				_compressedPos += toRead;
+				_stream.next_in = _buf;
+				_stream.avail_in = toRead;
+			}
+
+			_zlibErr = inflate(&_stream, Z_SYNC_FLUSH);
+			if (_zlibErr == Z_BUF_ERROR && _stream.avail_in == 0 && _compressedPos >= _compressedSize) {
+				// Ran out of compressed data before the member was complete
+				_zlibErr = Z_DATA_ERROR;
+			}
+		}
+
+		const uint32 bytesRead = dataSize - _stream.avail_out;
+		_crcData = crc32(_crcData, (const Bytef *)dataPtr, bytesRead);
+		_pos += bytesRead;
+
+		if (_pos == _uncompressedSize && _crcData != _crc && !err()) {
+			warning("ZipInflateReadStream: CRC mismatch");
+			_zlibErr = Z_DATA_ERROR;
+		}
+
+		return bytesRead;
+	}
+
+	bool eos() const { return _eos; }
+	int64 pos() const { return _pos; }
+	int64 size() const { return _uncompressedSize; }
+
+	bool seek(int64 offset, int whence = SEEK_SET) {
+		int64 newPos = 0;
+		switch (whence) {
+		default:
+			// fallthrough intended
+		case SEEK_SET:
+			newPos = offset;
+			break;
+		case SEEK_CUR:
+			newPos = _pos + offset;
+			break;
+		case SEEK_END:
+			newPos = _uncompressedSize + offset;
+			break;
+		}
+
+		if (newPos < 0 || newPos > _uncompressedSize)
+			return false;
+
+		// To search backward, we have to restart inflating from the start
+		// of the member
+		if (newPos < _pos && !reset())
+			return false;
+
+		// Skip the data in between by inflating it
+		byte tmpBuf[1024];
+		while (!err() && _pos < newPos)
+			read(tmpBuf, MIN<int64>(sizeof(tmpBuf), newPos - _pos));
+
+		_eos = false;
+		return !err();
+	}
+};
+
+#endif
+
 class ZipArchive : public Archive {
+	enum {
+		/**
+		 * Deflated members up to this size are inflated into memory when
+		 * opened. Larger members are inflated on the fly.
+		 */
+		kMaxInflateToMemorySize = 512 * 1024
+	};
+
 	unzFile _zipFile;
 
 public:
@@ -1492,32 +1665,43 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const Path &path) cons
 	if (unzLocateFile(_zipFile, name.c_str(), 2) != UNZ_OK)
 		return nullptr;
 
-	unz_file_info fileInfo;
 	if (unzOpenCurrentFile(_zipFile) != UNZ_OK)
 		return nullptr;
 
-	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, nullptr, 0, nullptr, 0, nullptr, 0) != UNZ_OK)
-		return nullptr;
+	unz_s *const archive = (unz_s *)_zipFile;
+	const file_in_zip_read_info_s *const info = archive->pfile_in_zip_read;
+	const uint32 dataOffset = info->pos_in_zipfile + info->byte_before_the_zipfile;
+	const uint32 uncompressedSize = info->rest_read_uncompressed;
+#ifdef USE_ZLIB
+	const uint32 compressedSize = info->rest_read_compressed;
+	const uint32 crc = info->crc32_wait;
+#endif
+	const bool stored = (info->compression_method == 0);
+	unzCloseCurrentFile(_zipFile);
 
-	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
-	assert(buffer);
+	// Stored members are served straight from the archive stream
+	if (stored)
+		return new ZipStoredReadStream(archive->_streamOwner, dataOffset, dataOffset + uncompressedSize);
 
-	if (unzReadCurrentFile(_zipFile, buffer, fileInfo.uncompressed_size) != (int)fileInfo.uncompressed_size) {
-		free(buffer);
-		return nullptr;
-	}
+#ifdef USE_ZLIB
+	// Small members are inflated in one go, which keeps backward seeks cheap
+	if (uncompressedSize > kMaxInflateToMemorySize)
+		return new ZipInflateReadStream(archive->_streamOwner, dataOffset, compressedSize, uncompressedSize, crc);
+
+	ZipInflateReadStream inflateStream(archive->_streamOwner, dataOffset, compressedSize, uncompressedSize, crc);
+	byte *buffer = (byte *)malloc(uncompressedSize);
+	assert(buffer);
 
-	if (unzCloseCurrentFile(_zipFile) != UNZ_OK) {
+	if (inflateStream.read(buffer, uncompressedSize) != uncompressedSize || inflateStream.err()) {
 		free(buffer);
 		return nullptr;
 	}
 
-	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
+	return new MemoryReadStream(buffer, uncompressedSize, DisposeAfterUse::YES);
+#else
+	// Cannot decompress the file without zlib.
+	return nullptr;
+#endif
 }
 
 Archive *makeZipArchive(const String &name) {
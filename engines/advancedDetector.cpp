@@ -23,9 +23,12 @@
 #include "common/debug.h"
 #include "common/util.h"
 #include "common/file.h"
+#include "common/fs.h"
+#include "common/jobsystem.h"
 #include "common/macresman.h"
 #include "common/md5.h"
 #include "common/config-manager.h"
+#include "common/ptr.h"
 #include "common/punycode.h"
 #include "common/system.h"
 #include "common/textconsole.h"
@@ -486,6 +489,132 @@ namespace Common {
 	DECLARE_SINGLETON(MD5CacheManager);
 }
 
+#define MD5CACHE_FILENAME "scummvm-md5cache.txt"
+
+/**
+ * The persistent cache holds local paths, so it is kept next to the config
+ * file rather than in the save path, which may be synced to other machines.
+ */
+static Common::FSNode getMD5CacheNode() {
+	Common::String configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	Common::FSNode dir = Common::FSNode(configFile).getParent();
+	if (!dir.isDirectory())
+		return Common::FSNode();
+
+	return dir.getChild(MD5CACHE_FILENAME);
+}
+
+void MD5CacheManager::loadPersistentCache() {
+	_persistentLoaded = true;
+	_persistentSession = 1;
+
+	Common::FSNode node = getMD5CacheNode();
+	if (!node.exists())
+		return;
+
+	Common::ScopedPtr<Common::SeekableReadStream> loadFile(node.createReadStream());
+	if (!loadFile)
+		return;
+
+	// Each line holds the MD5, the size, the modification time, the last
+	// session which used the entry and the key
+	while (!loadFile->eos() && !loadFile->err()) {
+		Common::String line = loadFile->readLine();
+		const char *p = line.c_str();
+		char *end;
+
+		const char *md5End = strchr(p, ' ');
+		if (!md5End)
+			continue;
+
+		PersistentEntry entry;
+		entry.md5 = Common::String(p, md5End);
+		entry.size = strtoll(md5End + 1, &end, 10);
+		if (*end != ' ')
+			continue;
+		entry.mtime = strtoll(end + 1, &end, 10);
+		if (*end != ' ')
+			continue;
+		entry.session = strtoul(end + 1, &end, 10);
+		if (*end != ' ' || !end[1])
+			continue;
+
+		_persistent[end + 1] = entry;
+		_persistentSession = MAX(_persistentSession, entry.session + 1);
+	}
+
+	// The files are only checked when they are looked up. Entries of files
+	// which were deleted or moved are never looked up again, so drop the
+	// ones no session used for a while.
+	for (PersistentMap::iterator i = _persistent.begin(); i != _persistent.end(); ++i) {
+		if (i->_value.session + kMaxUnusedSessions < _persistentSession) {
+			_persistent.erase(i);
+			_persistentDirty = true;
+		}
+	}
+
+	debugC(2, kDebugGlobalDetection, "Read %d entries from %s", _persistent.size(), node.getPath().c_str());
+}
+
+bool MD5CacheManager::getPersistentMD5(const Common::String &key, int64 size, int64 mtime, Common::String &md5) {
+	if (!_persistentLoaded)
+		loadPersistentCache();
+
+	PersistentMap::iterator i = _persistent.find(key);
+	if (i == _persistent.end()) {
+		_persistentMisses++;
+		return false;
+	}
+
+	// The file changed since it was hashed
+	if (i->_value.size != size || i->_value.mtime != mtime) {
+		_persistent.erase(i);
+		_persistentDirty = true;
+		_persistentMisses++;
+		return false;
+	}
+
+	_persistentHits++;
+	i->_value.session = _persistentSession;
+	md5 = i->_value.md5;
+	return true;
+}
+
+void MD5CacheManager::setPersistentMD5(const Common::String &key, int64 size, int64 mtime, const Common::String &md5) {
+	if (!_persistentLoaded)
+		loadPersistentCache();
+
+	PersistentEntry &entry = _persistent[key];
+	entry.size = size;
+	entry.mtime = mtime;
+	entry.session = _persistentSession;
+	entry.md5 = md5;
+	_persistentDirty = true;
+}
+
+void MD5CacheManager::flushPersistentCache() {
+	if (!_persistentDirty || _deferFlush)
+		return;
+
+	Common::FSNode node = getMD5CacheNode();
+	Common::ScopedPtr<Common::WriteStream> saveFile(node.getPath().empty() ? nullptr : node.createWriteStream());
+	if (!saveFile) {
+		warning("Failed to open " MD5CACHE_FILENAME " for writing");
+		return;
+	}
+
+	for (PersistentMap::const_iterator i = _persistent.begin(); i != _persistent.end(); ++i) {
+		saveFile->writeString(Common::String::format("%s %lld %lld %u %s\n", i->_value.md5.c_str(),
+			(long long)i->_value.size, (long long)i->_value.mtime, i->_value.session, i->_key.c_str()));
+	}
+
+	saveFile->finalize();
+	_persistentDirty = false;
+}
+
 static char flagsToMD5Prefix(uint32 flags) {
 	if (flags & ADGF_MACRESFORK) {
 		if (flags & ADGF_TAILMD5)
@@ -500,8 +629,16 @@ static char flagsToMD5Prefix(uint32 flags) {
 
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngine::FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps);
 
+static Common::String md5HashName(uint32 flags, const Common::String &fname, uint md5Bytes) {
+	return Common::String::format("%c:%s:%d", flagsToMD5Prefix(flags), fname.c_str(), md5Bytes);
+}
+
+static Common::String persistentMD5Key(uint32 flags, const Common::FSNode &node, uint md5Bytes) {
+	return Common::String::format("%c:%d:%s", flagsToMD5Prefix(flags), md5Bytes, node.getPath().c_str());
+}
+
 bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
-	Common::String hashname = Common::String::format("%c:%s:%d", flagsToMD5Prefix(game.flags), fname.c_str(), _md5Bytes);
+	Common::String hashname = md5HashName(game.flags, fname, _md5Bytes);
 
 	if (MD5Man.contains(hashname)) {
 		fileProps.md5 = MD5Man.getMD5(hashname);
@@ -509,16 +646,133 @@ bool AdvancedMetaEngineDetection::getFileProperties(const FileMap &allFiles, con
 		return true;
 	}
 
+	// Plain files may be found in the persistent cache, which is keyed by their full path
+	Common::String persistentKey;
+	int64 size, mtime;
+	if (!(game.flags & ADGF_MACRESFORK) && allFiles.contains(fname) && allFiles[fname].getFileStats(size, mtime)) {
+		persistentKey = persistentMD5Key(game.flags, allFiles[fname], _md5Bytes);
+
+		if (MD5Man.getPersistentMD5(persistentKey, size, mtime, fileProps.md5)) {
+			fileProps.size = size;
+			MD5Man.setMD5(hashname, fileProps.md5);
+			MD5Man.setSize(hashname, fileProps.size);
+			return true;
+		}
+	}
+
 	bool res = getFilePropertiesIntern(_md5Bytes, allFiles, game, fname, fileProps);
 
 	if (res) {
 		MD5Man.setMD5(hashname, fileProps.md5);
 		MD5Man.setSize(hashname, fileProps.size);
+
+		if (!persistentKey.empty() && fileProps.size == size)
+			MD5Man.setPersistentMD5(persistentKey, size, mtime, fileProps.md5);
 	}
 
 	return res;
 }
 
+namespace {
+
+/**
+ * Hashes a plain file on the job system, like getFilePropertiesIntern().
+ * Everything but the file contents is prepared and used by the thread
+ * submitting the job.
+ */
+class MD5Job : public Common::Job {
+public:
+	MD5Job(const Common::FSNode &node, uint md5Bytes, bool tail) :
+		_node(node), _md5Bytes(md5Bytes), _tail(tail), _hashed(false), _statSize(-1), _mtime(0) {
+		_props.size = -1;
+	}
+
+	virtual void run() override {
+		Common::SeekableReadStream *stream = _node.createReadStream();
+		if (!stream)
+			return;
+
+		if (_tail && stream->size() > _md5Bytes)
+			stream->seek(-(int64)_md5Bytes, SEEK_END);
+
+		_props.size = stream->size();
+		_props.md5 = Common::computeStreamMD5AsString(*stream, _md5Bytes);
+		_hashed = true;
+		delete stream;
+	}
+
+	const Common::FSNode &_node;
+	const uint _md5Bytes;
+	const bool _tail;
+
+	bool _hashed;
+	FileProperties _props;
+
+	Common::String _hashName;
+	Common::String _persistentKey;
+	int64 _statSize;
+	int64 _mtime;
+};
+
+} // End of anonymous namespace
+
+void AdvancedMetaEngineDetection::hashFilesInParallel(const FileMap &allFiles) const {
+	Common::Array<MD5Job *> jobs;
+	Common::HashMap<Common::String, bool> queued;
+	Common::JobGroup group;
+
+	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
+		const ADGameDescription *g = (const ADGameDescription *)descPtr;
+		if (g->flags & ADGF_MACRESFORK)
+			continue;
+
+		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
+			const Common::String fname = Common::punycode_decodefilename(fileDesc->fileName);
+			if (!allFiles.contains(fname))
+				continue;
+
+			const Common::String hashname = md5HashName(g->flags, fname, _md5Bytes);
+			if (queued.contains(hashname) || MD5Man.contains(hashname))
+				continue;
+			queued[hashname] = true;
+
+			const Common::FSNode &node = allFiles[fname];
+			MD5Job *job = new MD5Job(node, _md5Bytes, (g->flags & ADGF_TAILMD5) != 0);
+			job->_hashName = hashname;
+
+			if (node.getFileStats(job->_statSize, job->_mtime)) {
+				job->_persistentKey = persistentMD5Key(g->flags, node, _md5Bytes);
+
+				FileProperties props;
+				if (MD5Man.getPersistentMD5(job->_persistentKey, job->_statSize, job->_mtime, props.md5)) {
+					MD5Man.setMD5(hashname, props.md5);
+					MD5Man.setSize(hashname, job->_statSize);
+					delete job;
+					continue;
+				}
+			}
+
+			jobs.push_back(job);
+			JobSys.submit(job, &group);
+		}
+	}
+
+	group.wait();
+
+	// Let getFileProperties() find the results in the caches
+	for (uint i = 0; i < jobs.size(); ++i) {
+		const MD5Job *job = jobs[i];
+		if (job->_hashed) {
+			MD5Man.setMD5(job->_hashName, job->_props.md5);
+			MD5Man.setSize(job->_hashName, job->_props.size);
+
+			if (!job->_persistentKey.empty() && job->_props.size == job->_statSize)
+				MD5Man.setPersistentMD5(job->_persistentKey, job->_statSize, job->_mtime, job->_props.md5);
+		}
+		delete job;
+	}
+}
+
 bool AdvancedMetaEngine::getFilePropertiesExtern(uint md5Bytes, const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const {
 	return getFilePropertiesIntern(md5Bytes, allFiles, game, fname, fileProps);
 }
@@ -567,6 +821,9 @@ ADDetectedGames AdvancedMetaEngineDetection::detectGame(const Common::FSNode &pa
 
 	debugC(3, kDebugGlobalDetection, "Starting detection in dir '%s'", parent.getPath().c_str());
 
+	if (MD5Man.getParallelHashing() && JobSys.getWorkerCount() > 0)
+		hashFilesInParallel(allFiles);
+
 	// Check which files are included in some ADGameDescription *and* whether
 	// they are present. Compute MD5s and file sizes for the available files.
 	for (descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
@@ -446,6 +446,14 @@ protected:
 	/** Get the properties (size and MD5) of this file. */
 	bool getFileProperties(const FileMap &allFiles, const ADGameDescription &game, const Common::String fname, FileProperties &fileProps) const;
 
+	/**
+	 * Hash the files asked for by the game descriptions which are in neither
+	 * MD5 cache yet on the job system, and add them to the caches so that
+	 * getFileProperties() finds them. Mac resource forks are left to
+	 * getFileProperties().
+	 */
+	void hashFilesInParallel(const FileMap &allFiles) const;
+
 	/** Convert an AD game description into the shared game description format. */
 	virtual DetectedGame toDetectedGame(const ADDetectedGame &adGame, ADDetectedGameExtraInfo *extraInfo = nullptr) const;
 
@@ -518,6 +526,14 @@ public:
 
 /**
  * Singleton Cache Storage for Computed MD5s
+ *
+ * Besides the per-detection cache, which is keyed by the file name and
+ * cleared before each detection run, it keeps a persistent cache keyed by
+ * the full path of the file. Entries of the persistent cache are only used
+ * while the size and the modification time of the file are unchanged, and
+ * the cache is kept next to the config file so that it survives restarts.
+ * The files are only checked when they are looked up, and entries which
+ * no recent session used are dropped.
  */
 class MD5CacheManager : public Common::Singleton<MD5CacheManager> {
 public:
@@ -541,7 +557,7 @@ public:
 		return (md5HashMap.contains(fname) && sizeHashMap.contains(fname));
 	}
 
-	MD5CacheManager() {
+	MD5CacheManager() : _persistentLoaded(false), _persistentDirty(false), _persistentSession(0), _deferFlush(false), _parallelHashing(false), _persistentHits(0), _persistentMisses(0) {
 		clear();
 	}
 
@@ -550,9 +566,70 @@ public:
 		sizeHashMap.clear(true);
 	}
 
+	/**
+	 * Look up a file in the persistent cache. Entries whose size or
+	 * modification time differ are removed.
+	 */
+	bool getPersistentMD5(const Common::String &key, int64 size, int64 mtime, Common::String &md5);
+
+	/**
+	 * Add or update an entry of the persistent cache.
+	 */
+	void setPersistentMD5(const Common::String &key, int64 size, int64 mtime, const Common::String &md5);
+
+	/**
+	 * Write the persistent cache back if it was modified, unless flushing is
+	 * deferred with @ref setDeferFlush.
+	 */
+	void flushPersistentCache();
+
+	/**
+	 * Defer writing the persistent cache while scanning many directories.
+	 * Disabling it writes any pending changes.
+	 */
+	void setDeferFlush(bool defer) {
+		_deferFlush = defer;
+		if (!defer)
+			flushPersistentCache();
+	}
+
+	/**
+	 * Hash the files a detection needs on the job system, before the
+	 * detection looks at them one by one. Used while scanning many
+	 * directories.
+	 */
+	void setParallelHashing(bool enable) { _parallelHashing = enable; }
+	bool getParallelHashing() const { return _parallelHashing; }
+
+	uint getPersistentHits() const { return _persistentHits; }
+	uint getPersistentMisses() const { return _persistentMisses; }
+	void resetPersistentStats() { _persistentHits = _persistentMisses = 0; }
+
 private:
 	friend class Common::Singleton<MD5CacheManager>;
 
+	/** Number of sessions writing the cache an entry survives without being used */
+	static const uint kMaxUnusedSessions = 50;
+
+	struct PersistentEntry {
+		int64 size;
+		int64 mtime;
+		uint session;
+		Common::String md5;
+	};
+
+	typedef Common::HashMap<Common::String, PersistentEntry> PersistentMap;
+	PersistentMap _persistent;
+	bool _persistentLoaded;
+	bool _persistentDirty;
+	uint _persistentSession;
+	bool _deferFlush;
+	bool _parallelHashing;
+	uint _persistentHits;
+	uint _persistentMisses;
+
+	void loadPersistentCache();
+
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	FileHashMap md5HashMap;
@@ -31,6 +31,8 @@
 #include "ags/engine/ac/draw.h"
 #include "ags/engine/ac/game_state.h"
 #include "ags/shared/ac/game_setup_struct.h"
+#include "ags/shared/ac/sprite_cache.h"
+#include "ags/shared/ac/view.h"
 #include "ags/engine/ac/global_character.h"
 #include "ags/engine/ac/lip_sync.h"
 #include "ags/engine/ac/overlay.h"
@@ -415,6 +417,35 @@ void update_sierra_speech() {
 	}
 }
 
+// Number of upcoming animation frames whose sprites are prefetched
+#define PREFETCH_FRAMES 3
+
+static void prefetch_loop_frames(int view, int loop, int frame) {
+	if (view < 0 || view >= _GP(game).numviews)
+		return;
+	const ViewStruct &vs = _G(views)[view];
+	if (loop < 0 || loop >= vs.numLoops || vs.loops[loop].numFrames <= 0)
+		return;
+	const ViewLoopNew &vl = vs.loops[loop];
+	for (int i = 1; i <= PREFETCH_FRAMES; ++i)
+		_GP(spriteset).PrefetchSprite(vl.frames[(frame + i) % vl.numFrames].pic);
+}
+
+void update_sprite_prefetch() {
+	// let the sprite cache load the next frames of the animations in the room
+	// in the background, so that they are ready when they are drawn
+	for (int aa = 0; aa < _GP(game).numcharacters; aa++) {
+		const CharacterInfo &chi = _GP(game).chars[aa];
+		if (chi.on != 1 || chi.room != _G(displayed_room)) continue;
+		prefetch_loop_frames(chi.view, chi.loop, chi.frame);
+	}
+	for (int i = 0; i < _G(croom)->numobj; ++i) {
+		const RoomObject &obj = _G(objs)[i];
+		if (obj.on && obj.cycling)
+			prefetch_loop_frames(obj.view, obj.loop, obj.frame);
+	}
+}
+
 // update_stuff: moves and animates objects, executes repeat scripts, and
 // the like.
 void update_stuff() {
@@ -449,6 +480,8 @@ void update_stuff() {
 	update_sierra_speech();
 
 	_G(our_eip) = 25;
+
+	update_sprite_prefetch();
 }
 
 } // namespace AGS3
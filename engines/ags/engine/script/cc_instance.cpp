@@ -224,6 +224,9 @@ ccInstance::ccInstance() {
 	numimports = 0;
 	resolved_imports = nullptr;
 	code_fixups         = nullptr;
+	code_ops            = nullptr;
+	code_op_index       = nullptr;
+	code_op_args        = nullptr;
 
 	memset(callStackLineNumber, 0, sizeof(callStackLineNumber));
 	memset(callStackAddr, 0, sizeof(callStackAddr));
@@ -418,7 +421,13 @@ int ccInstance::Run(int32_t curpc) {
 	ccInstance *codeInst = runningInst;
 	bool write_debug_dump = ccGetOption(SCOPT_DEBUGRUN) ||
 		(gDebugLevel > 0 && DebugMan.isDebugChannelEnabled(::AGS::kDebugScript));
+	const bool use_code_ops = ccGetOption(SCOPT_NOPREDECODE) == 0;
 	ScriptOperation codeOp;
+	// current instruction and pointers to its arguments, which are either in
+	// codeOp or in the instance's pre-decoded argument table
+	int32_t op_code, op_instance_id, op_argcount;
+	const RuntimeScriptValue *op_args[MAX_SCMD_ARGS];
+	RuntimeScriptValue runtime_args[MAX_SCMD_ARGS];
 
 	FunctionCallStack func_callstack;
 
@@ -426,88 +435,128 @@ int ccInstance::Run(int32_t curpc) {
 		if (_G(abort_engine))
 			return -1;
 
-		/*
-		if (!codeInst->ReadOperation(codeOp, pc))
-		{
-		    return -1;
-		}
-		*/
-		/* ReadOperation */
-		//=====================================================================
-		codeOp.Instruction.Code         = codeInst->code[pc];
-		codeOp.Instruction.InstanceId   = (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-		codeOp.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
-
-		if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS) {
-			cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
-			return -1;
-		}
+		const int32_t op_index = use_code_ops ? codeInst->code_op_index[pc] : -1;
+		if (op_index >= 0) {
+			const ScriptCodeOp &op = codeInst->code_ops[op_index];
+			op_code = op.Code;
+			op_instance_id = op.InstanceId;
+			op_argcount = op.ArgCount;
+			op_args[0] = &codeInst->code_op_args[op.Args[0]];
+			op_args[1] = &codeInst->code_op_args[op.Args[1]];
+			op_args[2] = &codeInst->code_op_args[op.Args[2]];
+			if (op.HasRuntimeFixups) {
+				for (int i = 0; i < op_argcount; ++i) {
+					if (op.ArgFixups[i] == FIXUP_STACK) {
+						runtime_args[i] = GetStackPtrOffsetFw(op_args[i]->IValue);
+						op_args[i] = &runtime_args[i];
+					} else if (op.ArgFixups[i] == FIXUP_IMPORT) {
+						const ScriptImport *import = _GP(simp).getByIndex(op_args[i]->IValue);
+						if (!import) {
+							cc_error("cannot resolve import, key = %d", op_args[i]->IValue);
+							return -1;
+						}
+						runtime_args[i] = import->Value;
+						op_args[i] = &runtime_args[i];
+					}
+				}
+			}
+			if (write_debug_dump) {
+				codeOp.Instruction.Code = op_code;
+				codeOp.Instruction.InstanceId = op_instance_id;
+				codeOp.ArgCount = op_argcount;
+				for (int i = 0; i < MAX_SCMD_ARGS; ++i)
+					codeOp.Args[i] = *op_args[i];
+			}
+		} else {
+			/*
+			if (!codeInst->ReadOperation(codeOp, pc))
+			{
+			    return -1;
+			}
+			*/
+			/* ReadOperation */
+			//=====================================================================
+			codeOp.Instruction.Code         = codeInst->code[pc];
+			codeOp.Instruction.InstanceId   = (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+			codeOp.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+
+			if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS) {
+				cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
+				return -1;
+			}
 
-		codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
-		if (pc + codeOp.ArgCount >= codeInst->codesize) {
-			cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
-			return -1;
-		}
+			codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
+			if (pc + codeOp.ArgCount >= codeInst->codesize) {
+				cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
+				return -1;
+			}
 
-		int pc_at = pc + 1;
-		for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at) {
-			char fixup = codeInst->code_fixups[pc_at];
-			if (fixup > 0) {
-				// could be relative pointer or import address
-				/*
-				if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
-				{
-				    return -1;
-				}
-				*/
-				/* FixupArgument */
-				//=====================================================================
-				switch (fixup) {
-				case FIXUP_GLOBALDATA: {
-					ScriptVariable *gl_var = (ScriptVariable *)codeInst->code[pc_at];
-					codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
-				}
-				break;
-				case FIXUP_FUNCTION:
-					// originally commented -- CHECKME: could this be used in very old versions of AGS?
-					//      code[fixup] += (long)&code[0];
-					// This is a program counter value, presumably will be used as SCMD_CALL argument
-					codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
+			int pc_at = pc + 1;
+			for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at) {
+				char fixup = codeInst->code_fixups[pc_at];
+				if (fixup > 0) {
+					// could be relative pointer or import address
+					/*
+					if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
+					{
+					    return -1;
+					}
+					*/
+					/* FixupArgument */
+					//=====================================================================
+					switch (fixup) {
+					case FIXUP_GLOBALDATA: {
+						ScriptVariable *gl_var = (ScriptVariable *)codeInst->code[pc_at];
+						codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
+					}
 					break;
-				case FIXUP_STRING:
-					codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
+					case FIXUP_FUNCTION:
+						// originally commented -- CHECKME: could this be used in very old versions of AGS?
+						//      code[fixup] += (long)&code[0];
+						// This is a program counter value, presumably will be used as SCMD_CALL argument
+						codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
+						break;
+					case FIXUP_STRING:
+						codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
+						break;
+					case FIXUP_IMPORT: {
+						const ScriptImport *import = _GP(simp).getByIndex((int32_t)codeInst->code[pc_at]);
+						if (import) {
+							codeOp.Args[i] = import->Value;
+						} else {
+							cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
+							return -1;
+						}
+					}
 					break;
-				case FIXUP_IMPORT: {
-					const ScriptImport *import = _GP(simp).getByIndex((int32_t)codeInst->code[pc_at]);
-					if (import) {
-						codeOp.Args[i] = import->Value;
-					} else {
-						cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
+					case FIXUP_STACK:
+						codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
+						break;
+					default:
+						cc_error("internal fixup type error: %d", fixup);
 						return -1;
 					}
+					/* End FixupArgument */
+					//=====================================================================
+				} else {
+					// should be a numeric literal (int32 or float)
+					codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
 				}
-				break;
-				case FIXUP_STACK:
-					codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
-					break;
-				default:
-					cc_error("internal fixup type error: %d", fixup);
-					return -1;
-				}
-				/* End FixupArgument */
-				//=====================================================================
-			} else {
-				// should be a numeric literal (int32 or float)
-				codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
 			}
+			/* End ReadOperation */
+			//=====================================================================
+			op_code = codeOp.Instruction.Code;
+			op_instance_id = codeOp.Instruction.InstanceId;
+			op_argcount = codeOp.ArgCount;
+			op_args[0] = &codeOp.Args[0];
+			op_args[1] = &codeOp.Args[1];
+			op_args[2] = &codeOp.Args[2];
 		}
-		/* End ReadOperation */
-		//=====================================================================
 
 		// save the arguments for quick access
-		RuntimeScriptValue &arg1 = codeOp.Args[0];
-		RuntimeScriptValue &arg2 = codeOp.Args[1];
-		RuntimeScriptValue &arg3 = codeOp.Args[2];
+		const RuntimeScriptValue &arg1 = *op_args[0];
+		const RuntimeScriptValue &arg2 = *op_args[1];
+		const RuntimeScriptValue &arg3 = *op_args[2];
 		RuntimeScriptValue &reg1 =
 		    registers[arg1.IValue >= 0 && arg1.IValue < CC_NUM_REGISTERS ? arg1.IValue : 0];
 		RuntimeScriptValue &reg2 =
@@ -520,7 +569,7 @@ int ccInstance::Run(int32_t curpc) {
 			DumpInstruction(codeOp);
 		}
 
-		switch (codeOp.Instruction.Code) {
+		switch (op_code) {
 		case SCMD_LINENUM:
 			line_number = arg1.IValue;
 			_G(currentline) = arg1.IValue;
@@ -699,7 +748,7 @@ int ccInstance::Run(int32_t curpc) {
 			PUSH_CALL_STACK;
 
 			ASSERT_STACK_SPACE_AVAILABLE(1);
-			PushValueToStack(RuntimeScriptValue().SetInt32(pc + codeOp.ArgCount + 1));
+			PushValueToStack(RuntimeScriptValue().SetInt32(pc + op_argcount + 1));
 			if (_G(ccError)) {
 				return -1;
 			}
@@ -940,7 +989,7 @@ int ccInstance::Run(int32_t curpc) {
 			ccInstance *wasRunning = runningInst;
 
 			// extract the instance ID
-			int32_t instId = codeOp.Instruction.InstanceId;
+			int32_t instId = op_instance_id;
 			// determine the offset into the code of the instance we want
 			runningInst = _G(loadedInstances)[instId];
 			intptr_t callAddr = reg1.Ptr - (char *)&runningInst->code[0];
@@ -1201,14 +1250,14 @@ int ccInstance::Run(int32_t curpc) {
 				loopIterationCheckDisabled++;
 			break;
 		default:
-			cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
+			cc_error("instruction %d is not implemented", op_code);
 			return -1;
 		}
 
 		if (flags & INSTF_ABORTED)
 			return 0;
 
-		pc += codeOp.ArgCount + 1;
+		pc += op_argcount + 1;
 	}
 }
 
@@ -1392,6 +1441,9 @@ bool ccInstance::_Create(PScript scri, ccInstance *joined) {
 	if (joined) {
 		resolved_imports = joined->resolved_imports;
 		code_fixups = joined->code_fixups;
+		code_ops = joined->code_ops;
+		code_op_index = joined->code_op_index;
+		code_op_args = joined->code_op_args;
 	} else {
 		if (!ResolveScriptImports(scri)) {
 			return false;
@@ -1402,6 +1454,7 @@ bool ccInstance::_Create(PScript scri, ccInstance *joined) {
 		if (!CreateRuntimeCodeFixups(scri)) {
 			return false;
 		}
+		CreateCodeOps();
 	}
 
 	exports = new RuntimeScriptValue[scri->numexports];
@@ -1477,9 +1530,15 @@ void ccInstance::Free() {
 	if ((flags & INSTF_SHAREDATA) == 0) {
 		delete[] resolved_imports;
 		delete[] code_fixups;
+		delete[] code_ops;
+		delete[] code_op_index;
+		delete[] code_op_args;
 	}
 	resolved_imports = nullptr;
 	code_fixups = nullptr;
+	code_ops = nullptr;
+	code_op_index = nullptr;
+	code_op_args = nullptr;
 }
 
 bool ccInstance::ResolveScriptImports(PScript scri) {
@@ -1658,6 +1717,81 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri) {
 	return true;
 }
 
+void ccInstance::CreateCodeOps() {
+	std::vector<ScriptCodeOp> ops;
+	std::vector<RuntimeScriptValue> args;
+	std::unordered_map<int32_t, int32_t> literals;
+	// Arguments of the instructions which take less than the maximum refer to this
+	args.push_back(RuntimeScriptValue());
+
+	code_op_index = new int32_t[codesize];
+	for (int32_t i = 0; i < codesize; ++i)
+		code_op_index[i] = -1;
+
+	// The code is walked linearly; if anything which does not look like an
+	// instruction is met, the rest is left to be decoded when it is run
+	for (int32_t at = 0; at < codesize; ) {
+		ScriptCodeOp op;
+		op.Code = (int32_t)(code[at] & INSTANCE_ID_REMOVEMASK);
+		op.InstanceId = (int32_t)((code[at] >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK);
+		if (op.Code < 0 || op.Code >= CC_NUM_SCCMDS)
+			break;
+		op.ArgCount = sccmd_info[op.Code].ArgCount;
+		if (at + op.ArgCount >= codesize)
+			break;
+
+		op.HasRuntimeFixups = false;
+		for (int i = 0; i < MAX_SCMD_ARGS; ++i) {
+			op.Args[i] = 0;
+			op.ArgFixups[i] = 0;
+		}
+
+		for (int i = 0; i < op.ArgCount; ++i) {
+			const int32_t arg_at = at + 1 + i;
+			RuntimeScriptValue arg;
+			switch (code_fixups[arg_at]) {
+			case FIXUP_GLOBALDATA:
+				arg.SetGlobalVar(&((ScriptVariable *)code[arg_at])->RValue);
+				break;
+			case FIXUP_STRING:
+				arg.SetStringLiteral(&strings[0] + code[arg_at]);
+				break;
+			case FIXUP_IMPORT:
+			case FIXUP_STACK:
+				// keep the raw value, it is resolved when the instruction is run
+				op.ArgFixups[i] = code_fixups[arg_at];
+				op.HasRuntimeFixups = true;
+				// fall through
+			default: {
+				// numeric literal or function address; these are shared
+				const int32_t value = (int32_t)code[arg_at];
+				std::unordered_map<int32_t, int32_t>::const_iterator it = literals.find(value);
+				if (it != literals.end()) {
+					op.Args[i] = it->_value;
+					continue;
+				}
+				arg.SetInt32(value);
+				literals[value] = (int32_t)args.size();
+				break;
+			}
+			}
+			op.Args[i] = (int32_t)args.size();
+			args.push_back(arg);
+		}
+
+		code_op_index[at] = (int32_t)ops.size();
+		ops.push_back(op);
+		at += op.ArgCount + 1;
+	}
+
+	code_ops = new ScriptCodeOp[ops.size()];
+	for (size_t i = 0; i < ops.size(); ++i)
+		code_ops[i] = ops[i];
+	code_op_args = new RuntimeScriptValue[args.size()];
+	for (size_t i = 0; i < args.size(); ++i)
+		code_op_args[i] = args[i];
+}
+
 /*
 bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
 {
@@ -72,6 +72,19 @@ struct ScriptOperation {
 	int                 ArgCount;
 };
 
+// Instruction decoded ahead of execution. The arguments are indexes in the
+// instance's table of resolved argument values; those which depend on the
+// state at the time of execution (stack offsets and imports) are marked in
+// ArgFixups and resolved from the stored raw value on each run.
+struct ScriptCodeOp {
+	int32_t Code;
+	int32_t InstanceId;
+	int32_t ArgCount;
+	int32_t Args[MAX_SCMD_ARGS];
+	char    ArgFixups[MAX_SCMD_ARGS];
+	bool    HasRuntimeFixups;
+};
+
 struct ScriptVariable {
 	ScriptVariable() {
 		ScAddress = -1; // address = 0 is valid one, -1 means undefined
@@ -144,6 +157,11 @@ public:
 
 	char *code_fixups;
 
+	// Byte-code decoded when the instance is created, see CreateCodeOps()
+	ScriptCodeOp *code_ops;
+	int32_t *code_op_index;             // code_ops index per code position, or -1
+	RuntimeScriptValue *code_op_args;   // argument values referenced by code_ops
+
 	// returns the currently executing instance, or NULL if none
 	static ccInstance *GetCurrentInstance(void);
 	// create a runnable instance of the supplied script
@@ -185,6 +203,8 @@ protected:
 	bool    AddGlobalVar(const ScriptVariable &glvar);
 	ScriptVariable *FindGlobalVar(int32_t var_addr);
 	bool    CreateRuntimeCodeFixups(PScript scri);
+	// Decode the instructions and their constant arguments for Run()
+	void    CreateCodeOps();
 	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
 
 	// Runtime fixups
@@ -28,6 +28,12 @@
 #include "common/textconsole.h"
 #include "graphics/screen.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace AGS3 {
 
 BITMAP::BITMAP(Graphics::ManagedSurface *owner) : _owner(owner),
@@ -108,6 +114,471 @@ void BITMAP::floodfill(int x, int y, int color) {
 const int SCALE_THRESHOLD = 0x100;
 #define VGA_COLOR_TRANS(x) ((x) * 255 / 63)
 
+struct BITMAP::DrawInnerArgs {
+	const Graphics::PixelFormat &srcFormat;
+	bool skipTrans;
+	int srcAlpha;
+	bool useTint;
+	byte tintRed, tintGreen, tintBlue;
+
+	/** Step in the source per destination pixel, in 1/SCALE_THRESHOLD pixels */
+	int xStep;
+
+	uint32 transColor, alphaMask;
+
+	/** Palette of 8-bit sources, as RGB and converted to the destination format */
+	PALETTE palette;
+	uint32 paletteColors[PAL_SIZE];
+
+	DrawInnerArgs(const BITMAP *dest, const BITMAP *src, bool skipTrans_, int srcAlpha_,
+	              int tintRed_, int tintGreen_, int tintBlue_, int xStep_) :
+		srcFormat(src->format), skipTrans(skipTrans_), srcAlpha(srcAlpha_),
+		useTint(tintRed_ >= 0 && tintGreen_ >= 0 && tintBlue_ >= 0),
+		tintRed(tintRed_), tintGreen(tintGreen_), tintBlue(tintBlue_), xStep(xStep_),
+		transColor(0), alphaMask(0xff) {
+		if (srcFormat.bytesPerPixel == 1 && dest->format.bytesPerPixel != 1) {
+			for (int i = 0; i < PAL_SIZE; ++i) {
+				palette[i].r = VGA_COLOR_TRANS(_G(current_palette)[i].r);
+				palette[i].g = VGA_COLOR_TRANS(_G(current_palette)[i].g);
+				palette[i].b = VGA_COLOR_TRANS(_G(current_palette)[i].b);
+				paletteColors[i] = dest->format.ARGBToColor(0xff, palette[i].r, palette[i].g, palette[i].b);
+			}
+		}
+
+		if (skipTrans && srcFormat.bytesPerPixel != 1) {
+			transColor = srcFormat.ARGBToColor(0, 255, 0, 255);
+			alphaMask = srcFormat.ARGBToColor(255, 0, 0, 0);
+			alphaMask = ~alphaMask;
+		}
+	}
+
+	inline bool isContiguous() const {
+		return xStep == SCALE_THRESHOLD;
+	}
+
+	/** Returns the source column of the given column of the blitted area */
+	inline int srcX(int xCtr) const {
+		return xCtr * xStep / SCALE_THRESHOLD;
+	}
+};
+
+#if defined(__SSE2__)
+
+/** Returns the low 32 bits of the products of the four lanes */
+static inline __m128i mullo32(__m128i a, __m128i b) {
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+	                          _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+/** Adds one to every non-zero lane, as done by BITMAP::rgbBlend() */
+static inline __m128i incrementNonZero(__m128i a) {
+	const __m128i nonZero = _mm_xor_si128(_mm_cmpeq_epi32(a, _mm_setzero_si128()), _mm_set1_epi32(-1));
+	return _mm_sub_epi32(a, nonZero);
+}
+
+/**
+ * Does the same as BITMAP::rgbBlend() for four ARGB8888 pixels, including
+ * the wrap around of the original's unsigned arithmetic. The alpha of the
+ * result is zero.
+ */
+static inline __m128i rgbBlend4(__m128i x, __m128i y, __m128i alpha) {
+	const __m128i rbMask = _mm_set1_epi32(0xFF00FF);
+	const __m128i gMask = _mm_set1_epi32(0xFF00);
+
+	const __m128i yRb = _mm_and_si128(y, rbMask);
+	const __m128i yG = _mm_and_si128(y, gMask);
+	__m128i rb = _mm_sub_epi32(_mm_and_si128(x, rbMask), yRb);
+	rb = _mm_add_epi32(_mm_srli_epi32(mullo32(rb, alpha), 8), _mm_or_si128(yRb, yG));
+	__m128i g = _mm_sub_epi32(_mm_and_si128(x, gMask), yG);
+	g = _mm_add_epi32(_mm_srli_epi32(mullo32(g, alpha), 8), yG);
+
+	return _mm_or_si128(_mm_and_si128(rb, rbMask), _mm_and_si128(g, gMask));
+}
+
+#elif defined(__ARM_NEON)
+
+static inline uint32x4_t incrementNonZero(uint32x4_t a) {
+	return vsubq_u32(a, vmvnq_u32(vceqq_u32(a, vdupq_n_u32(0))));
+}
+
+static inline uint32x4_t rgbBlend4(uint32x4_t x, uint32x4_t y, uint32x4_t alpha) {
+	const uint32x4_t rbMask = vdupq_n_u32(0xFF00FF);
+	const uint32x4_t gMask = vdupq_n_u32(0xFF00);
+
+	const uint32x4_t yRb = vandq_u32(y, rbMask);
+	const uint32x4_t yG = vandq_u32(y, gMask);
+	uint32x4_t rb = vsubq_u32(vandq_u32(x, rbMask), yRb);
+	rb = vaddq_u32(vshrq_n_u32(vmulq_u32(rb, alpha), 8), vorrq_u32(yRb, yG));
+	uint32x4_t g = vsubq_u32(vandq_u32(x, gMask), yG);
+	g = vaddq_u32(vshrq_n_u32(vmulq_u32(g, alpha), 8), yG);
+
+	return vorrq_u32(vandq_u32(rb, rbMask), vandq_u32(g, gMask));
+}
+
+#endif
+
+template<int Bpp>
+static inline uint32 readPixel(const byte *data) {
+	if (Bpp == 1)
+		return *data;
+	else if (Bpp == 2)
+		return *(const uint16 *)data;
+	else
+		return *(const uint32 *)data;
+}
+
+template<int Bpp>
+static inline void writePixel(byte *data, uint32 color) {
+	if (Bpp == 1)
+		*data = color;
+	else if (Bpp == 2)
+		*(uint16 *)data = color;
+	else
+		*(uint32 *)data = color;
+}
+
+template<int Bpp, bool SkipTrans>
+void BITMAP::drawRowCopy(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const {
+	int i = 0;
+
+	if (args.isContiguous()) {
+		srcP += xCtr * Bpp;
+		if (!SkipTrans) {
+			memcpy(destP, srcP, count * Bpp);
+			return;
+		}
+
+#if defined(__SSE2__)
+		// Transparent pixels keep the destination
+		if (Bpp == 4) {
+			const __m128i alphaMask = _mm_set1_epi32(args.alphaMask);
+			const __m128i transColor = _mm_set1_epi32(args.transColor);
+			for (; i + 4 <= count; i += 4) {
+				const __m128i src = _mm_loadu_si128((const __m128i *)(srcP + i * 4));
+				const __m128i dest = _mm_loadu_si128((const __m128i *)(destP + i * 4));
+				const __m128i trans = _mm_cmpeq_epi32(_mm_and_si128(src, alphaMask), transColor);
+				_mm_storeu_si128((__m128i *)(destP + i * 4),
+				                 _mm_or_si128(_mm_and_si128(trans, dest), _mm_andnot_si128(trans, src)));
+			}
+		} else {
+			const __m128i alphaMask = Bpp == 2 ? _mm_set1_epi16(args.alphaMask) : _mm_set1_epi8(args.alphaMask);
+			const __m128i transColor = Bpp == 2 ? _mm_set1_epi16(args.transColor) : _mm_set1_epi8(args.transColor);
+			for (; i + 16 / Bpp <= count; i += 16 / Bpp) {
+				const __m128i src = _mm_loadu_si128((const __m128i *)(srcP + i * Bpp));
+				const __m128i dest = _mm_loadu_si128((const __m128i *)(destP + i * Bpp));
+				const __m128i masked = _mm_and_si128(src, alphaMask);
+				const __m128i trans = Bpp == 2 ? _mm_cmpeq_epi16(masked, transColor) : _mm_cmpeq_epi8(masked, transColor);
+				_mm_storeu_si128((__m128i *)(destP + i * Bpp),
+				                 _mm_or_si128(_mm_and_si128(trans, dest), _mm_andnot_si128(trans, src)));
+			}
+		}
+#elif defined(__ARM_NEON)
+		if (Bpp == 4) {
+			const uint32x4_t alphaMask = vdupq_n_u32(args.alphaMask);
+			const uint32x4_t transColor = vdupq_n_u32(args.transColor);
+			for (; i + 4 <= count; i += 4) {
+				const uint32x4_t src = vld1q_u32((const uint32 *)(srcP + i * 4));
+				const uint32x4_t dest = vld1q_u32((const uint32 *)(destP + i * 4));
+				const uint32x4_t trans = vceqq_u32(vandq_u32(src, alphaMask), transColor);
+				vst1q_u32((uint32 *)(destP + i * 4), vbslq_u32(trans, dest, src));
+			}
+		} else if (Bpp == 2) {
+			const uint16x8_t alphaMask = vdupq_n_u16(args.alphaMask);
+			const uint16x8_t transColor = vdupq_n_u16(args.transColor);
+			for (; i + 8 <= count; i += 8) {
+				const uint16x8_t src = vld1q_u16((const uint16 *)(srcP + i * 2));
+				const uint16x8_t dest = vld1q_u16((const uint16 *)(destP + i * 2));
+				const uint16x8_t trans = vceqq_u16(vandq_u16(src, alphaMask), transColor);
+				vst1q_u16((uint16 *)(destP + i * 2), vbslq_u16(trans, dest, src));
+			}
+		} else {
+			const uint8x16_t alphaMask = vdupq_n_u8(args.alphaMask);
+			const uint8x16_t transColor = vdupq_n_u8(args.transColor);
+			for (; i + 16 <= count; i += 16) {
+				const uint8x16_t src = vld1q_u8(srcP + i);
+				const uint8x16_t dest = vld1q_u8(destP + i);
+				const uint8x16_t trans = vceqq_u8(vandq_u8(src, alphaMask), transColor);
+				vst1q_u8(destP + i, vbslq_u8(trans, dest, src));
+			}
+		}
+#endif
+
+		for (; i < count; ++i) {
+			const uint32 srcCol = readPixel<Bpp>(srcP + i * Bpp);
+			if ((srcCol & args.alphaMask) != args.transColor)
+				writePixel<Bpp>(destP + i * Bpp, srcCol);
+		}
+		return;
+	}
+
+	for (; i < count; ++i) {
+		const uint32 srcCol = readPixel<Bpp>(srcP + args.srcX(xCtr + i) * Bpp);
+		if (!SkipTrans || (srcCol & args.alphaMask) != args.transColor)
+			writePixel<Bpp>(destP + i * Bpp, srcCol);
+	}
+}
+
+template<int DestBpp, bool SkipTrans>
+void BITMAP::drawRowPalette(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const {
+	if (args.isContiguous()) {
+		srcP += xCtr;
+		for (int i = 0; i < count; ++i) {
+			if (!SkipTrans || srcP[i] != args.transColor)
+				writePixel<DestBpp>(destP + i * DestBpp, args.paletteColors[srcP[i]]);
+		}
+	} else {
+		for (int i = 0; i < count; ++i) {
+			const byte srcCol = srcP[args.srcX(xCtr + i)];
+			if (!SkipTrans || srcCol != args.transColor)
+				writePixel<DestBpp>(destP + i * DestBpp, args.paletteColors[srcCol]);
+		}
+	}
+}
+
+template<int Mode, bool UseTint>
+inline uint32 BITMAP::blendArgb8888(const DrawInnerArgs &args, uint32 srcCol, uint32 destCol) const {
+	byte aSrc = srcCol >> 24, rSrc = srcCol >> 16, gSrc = srcCol >> 8, bSrc = srcCol;
+	byte aDest, rDest, gDest, bDest;
+
+	if (UseTint) {
+		aDest = aSrc;
+		rDest = rSrc;
+		gDest = gSrc;
+		bDest = bSrc;
+		aSrc = args.srcAlpha;
+		rSrc = args.tintRed;
+		gSrc = args.tintGreen;
+		bSrc = args.tintBlue;
+	} else {
+		aDest = destCol >> 24;
+		rDest = destCol >> 16;
+		gDest = destCol >> 8;
+		bDest = destCol;
+	}
+
+	switch (Mode) {
+	case kRgbToRgbBlender:
+		blendRgbToRgb(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, args.srcAlpha);
+		break;
+	case kAlphaPreservedBlenderMode:
+		blendPreserveAlpha(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, args.srcAlpha);
+		break;
+	case kSourceAlphaBlender:
+		blendSourceAlpha(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, args.srcAlpha);
+		break;
+	case kArgbToRgbBlender:
+		blendArgbToRgb(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, args.srcAlpha);
+		break;
+	default:
+		blendPixel(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, args.srcAlpha);
+		break;
+	}
+
+	return ((uint32)aDest << 24) | ((uint32)rDest << 16) | ((uint32)gDest << 8) | bDest;
+}
+
+template<int Mode, bool SkipTrans, bool UseTint>
+void BITMAP::drawRowArgb8888(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const {
+	uint32 *dest = (uint32 *)destP;
+	const uint32 *src = (const uint32 *)srcP;
+	int i = 0;
+
+	if (!args.isContiguous()) {
+		for (; i < count; ++i) {
+			const uint32 srcCol = src[args.srcX(xCtr + i)];
+			if (!SkipTrans || (srcCol & args.alphaMask) != args.transColor)
+				dest[i] = blendArgb8888<Mode, UseTint>(args, srcCol, dest[i]);
+		}
+		return;
+	}
+
+	src += xCtr;
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	// Only the blenders built on rgbBlend() have vector versions. Their
+	// arithmetic is done exactly like the original's, so the results match
+	// the scalar loop bit for bit.
+	if (!UseTint && (Mode == kRgbToRgbBlender || Mode == kAlphaPreservedBlenderMode ||
+	                 Mode == kSourceAlphaBlender || Mode == kArgbToRgbBlender)) {
+		// kArgbToRgbBlender scales the source alpha, unless srcAlpha is 0
+		const bool scaleAlpha = args.srcAlpha != 0;
+		const uint32 srcAlpha = args.srcAlpha & 0xff;
+#if defined(__SSE2__)
+		const __m128i alphaMask = _mm_set1_epi32(args.alphaMask);
+		const __m128i transColor = _mm_set1_epi32(args.transColor);
+		const __m128i constAlpha = incrementNonZero(_mm_set1_epi32(args.srcAlpha));
+		const __m128i alphaFactor = _mm_set1_epi32(srcAlpha + 1);
+		for (; i + 4 <= count; i += 4) {
+			const __m128i x = _mm_loadu_si128((const __m128i *)(src + i));
+			const __m128i y = _mm_loadu_si128((const __m128i *)(dest + i));
+
+			__m128i alpha;
+			if (Mode == kRgbToRgbBlender || Mode == kAlphaPreservedBlenderMode) {
+				alpha = constAlpha;
+			} else {
+				alpha = _mm_srli_epi32(x, 24);
+				if (Mode == kArgbToRgbBlender && scaleAlpha)
+					alpha = _mm_srli_epi32(mullo32(alpha, alphaFactor), 8);
+				alpha = incrementNonZero(alpha);
+			}
+
+			__m128i result = rgbBlend4(x, y, alpha);
+			if (Mode == kAlphaPreservedBlenderMode)
+				result = _mm_or_si128(result, _mm_and_si128(y, _mm_set1_epi32((int)0xFF000000)));
+
+			if (SkipTrans) {
+				const __m128i trans = _mm_cmpeq_epi32(_mm_and_si128(x, alphaMask), transColor);
+				result = _mm_or_si128(_mm_and_si128(trans, y), _mm_andnot_si128(trans, result));
+			}
+			_mm_storeu_si128((__m128i *)(dest + i), result);
+		}
+#else
+		const uint32x4_t alphaMask = vdupq_n_u32(args.alphaMask);
+		const uint32x4_t transColor = vdupq_n_u32(args.transColor);
+		const uint32x4_t constAlpha = incrementNonZero(vdupq_n_u32(args.srcAlpha));
+		const uint32x4_t alphaFactor = vdupq_n_u32(srcAlpha + 1);
+		for (; i + 4 <= count; i += 4) {
+			const uint32x4_t x = vld1q_u32(src + i);
+			const uint32x4_t y = vld1q_u32(dest + i);
+
+			uint32x4_t alpha;
+			if (Mode == kRgbToRgbBlender || Mode == kAlphaPreservedBlenderMode) {
+				alpha = constAlpha;
+			} else {
+				alpha = vshrq_n_u32(x, 24);
+				if (Mode == kArgbToRgbBlender && scaleAlpha)
+					alpha = vshrq_n_u32(vmulq_u32(alpha, alphaFactor), 8);
+				alpha = incrementNonZero(alpha);
+			}
+
+			uint32x4_t result = rgbBlend4(x, y, alpha);
+			if (Mode == kAlphaPreservedBlenderMode)
+				result = vorrq_u32(result, vandq_u32(y, vdupq_n_u32(0xFF000000)));
+
+			if (SkipTrans)
+				result = vbslq_u32(vceqq_u32(vandq_u32(x, alphaMask), transColor), y, result);
+			vst1q_u32(dest + i, result);
+		}
+#endif
+	}
+#endif
+
+	for (; i < count; ++i) {
+		const uint32 srcCol = src[i];
+		if (!SkipTrans || (srcCol & args.alphaMask) != args.transColor)
+			dest[i] = blendArgb8888<Mode, UseTint>(args, srcCol, dest[i]);
+	}
+}
+
+template<int DestBpp, int SrcBpp, bool SkipTrans>
+void BITMAP::drawRowGeneric(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const {
+	byte rSrc, gSrc, bSrc, aSrc;
+	byte rDest = 0, gDest = 0, bDest = 0, aDest = 0;
+
+	for (int i = 0; i < count; ++i, destP += DestBpp) {
+		uint32 srcCol = readPixel<SrcBpp>(srcP + args.srcX(xCtr + i) * SrcBpp);
+
+		// Check if this is a transparent color we should skip
+		if (SkipTrans && ((srcCol & args.alphaMask) == args.transColor))
+			continue;
+
+		// We need the rgb values to do blending and/or convert between formats
+		if (SrcBpp == 1) {
+			const RGB &rgb = args.palette[srcCol];
+			aSrc = 0xff;
+			rSrc = rgb.r;
+			gSrc = rgb.g;
+			bSrc = rgb.b;
+		} else
+			args.srcFormat.colorToARGB(srcCol, aSrc, rSrc, gSrc, bSrc);
+
+		if (args.srcAlpha == -1) {
+			// This means we don't use blending.
+			aDest = aSrc;
+			rDest = rSrc;
+			gDest = gSrc;
+			bDest = bSrc;
+		} else {
+			if (args.useTint) {
+				rDest = rSrc;
+				gDest = gSrc;
+				bDest = bSrc;
+				aDest = aSrc;
+				rSrc = args.tintRed;
+				gSrc = args.tintGreen;
+				bSrc = args.tintBlue;
+				aSrc = args.srcAlpha;
+			} else {
+				format.colorToARGB(readPixel<DestBpp>(destP), aDest, rDest, gDest, bDest);
+			}
+			blendPixel(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, args.srcAlpha);
+		}
+
+		writePixel<DestBpp>(destP, format.ARGBToColor(aDest, rDest, gDest, bDest));
+	}
+}
+
+#define DRAW_ROW_SKIPTRANS(func, ...) \
+	(args.skipTrans ? &BITMAP::func<__VA_ARGS__, true> : &BITMAP::func<__VA_ARGS__, false>)
+
+BITMAP::DrawInnerRow BITMAP::getDrawInnerRow(const DrawInnerArgs &args) const {
+	const int srcBpp = args.srcFormat.bytesPerPixel;
+	const int destBpp = format.bytesPerPixel;
+
+	// When blitting to the same format we can just copy the color
+	if (destBpp == 1)
+		return DRAW_ROW_SKIPTRANS(drawRowCopy, 1);
+	if (args.srcFormat == format && args.srcAlpha == -1)
+		return destBpp == 4 ? DRAW_ROW_SKIPTRANS(drawRowCopy, 4) : DRAW_ROW_SKIPTRANS(drawRowCopy, 2);
+
+	if (srcBpp == 1 && args.srcAlpha == -1)
+		return destBpp == 4 ? DRAW_ROW_SKIPTRANS(drawRowPalette, 4) : DRAW_ROW_SKIPTRANS(drawRowPalette, 2);
+
+	// The 32-bit format used by AGS games gets loops which work on whole pixels
+	const Graphics::PixelFormat argb8888(4, 8, 8, 8, 8, 16, 8, 0, 24);
+	if (args.srcFormat == argb8888 && format == argb8888) {
+		if (args.useTint)
+			return args.skipTrans ? &BITMAP::drawRowArgb8888<-1, true, true> : &BITMAP::drawRowArgb8888<-1, false, true>;
+
+		switch (_G(_blender_mode)) {
+		case kRgbToRgbBlender:
+			return args.skipTrans ? &BITMAP::drawRowArgb8888<kRgbToRgbBlender, true, false> : &BITMAP::drawRowArgb8888<kRgbToRgbBlender, false, false>;
+		case kAlphaPreservedBlenderMode:
+			return args.skipTrans ? &BITMAP::drawRowArgb8888<kAlphaPreservedBlenderMode, true, false> : &BITMAP::drawRowArgb8888<kAlphaPreservedBlenderMode, false, false>;
+		case kSourceAlphaBlender:
+			return args.skipTrans ? &BITMAP::drawRowArgb8888<kSourceAlphaBlender, true, false> : &BITMAP::drawRowArgb8888<kSourceAlphaBlender, false, false>;
+		case kArgbToRgbBlender:
+			return args.skipTrans ? &BITMAP::drawRowArgb8888<kArgbToRgbBlender, true, false> : &BITMAP::drawRowArgb8888<kArgbToRgbBlender, false, false>;
+		default:
+			return args.skipTrans ? &BITMAP::drawRowArgb8888<-1, true, false> : &BITMAP::drawRowArgb8888<-1, false, false>;
+		}
+	}
+
+	if (destBpp == 4) {
+		switch (srcBpp) {
+		case 1:
+			return DRAW_ROW_SKIPTRANS(drawRowGeneric, 4, 1);
+		case 2:
+			return DRAW_ROW_SKIPTRANS(drawRowGeneric, 4, 2);
+		default:
+			return DRAW_ROW_SKIPTRANS(drawRowGeneric, 4, 4);
+		}
+	} else {
+		switch (srcBpp) {
+		case 1:
+			return DRAW_ROW_SKIPTRANS(drawRowGeneric, 2, 1);
+		case 2:
+			return DRAW_ROW_SKIPTRANS(drawRowGeneric, 2, 2);
+		default:
+			return DRAW_ROW_SKIPTRANS(drawRowGeneric, 2, 4);
+		}
+	}
+}
+
+#undef DRAW_ROW_SKIPTRANS
+
 void BITMAP::draw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
                   int dstX, int dstY, bool horizFlip, bool vertFlip,
                   bool skipTrans, int srcAlpha, int tintRed, int tintGreen,
@@ -140,6 +611,109 @@ void BITMAP::draw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
 	Graphics::ManagedSurface &dest = *_owner;
 	Graphics::Surface destArea = dest.getSubArea(destRect);
 
+	// The pixel loop is chosen once for the whole blit
+	const DrawInnerArgs args(this, srcBitmap, skipTrans, srcAlpha, tintRed, tintGreen, tintBlue,
+	                         horizFlip ? -SCALE_THRESHOLD : SCALE_THRESHOLD);
+	const DrawInnerRow drawRow = getDrawInnerRow(args);
+
+	// Only the part of the blitted area which is inside the clipping area is drawn
+	int xStart = (dstRect.left < destRect.left) ? dstRect.left - destRect.left : 0;
+	int yStart = (dstRect.top < destRect.top) ? dstRect.top - destRect.top : 0;
+	const int xBegin = -xStart, xEnd = MIN<int>(dstRect.width(), destArea.w - xStart);
+	const int yBegin = -yStart, yEnd = MIN<int>(dstRect.height(), destArea.h - yStart);
+
+	for (int yCtr = yBegin; yCtr < yEnd; ++yCtr) {
+		byte *destP = (byte *)destArea.getBasePtr(0, yStart + yCtr);
+		const byte *srcP = (const byte *)src.getBasePtr(
+		                       horizFlip ? srcArea.right - 1 : srcArea.left,
+		                       vertFlip ? srcArea.bottom - 1 - yCtr :
+		                       srcArea.top + yCtr);
+
+		(this->*drawRow)(args, destP, srcP, xBegin, xEnd - xBegin);
+	}
+}
+
+void BITMAP::stretchDraw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
+                         const Common::Rect &dstRect, bool skipTrans, int srcAlpha) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4 ||
+	       (format.bytesPerPixel == 1 && srcBitmap->format.bytesPerPixel == 1));
+
+	// Allegro disables draw when the clipping rect has negative width/height.
+	// Common::Rect instead asserts, which we don't want.
+	if (cr <= cl || cb <= ct)
+		return;
+
+	// Figure out the dest area that will be updated
+	Common::Rect destRect = dstRect.findIntersectingRect(
+	                            Common::Rect(cl, ct, cr, cb));
+	if (destRect.isEmpty())
+		// Area is entirely outside the clipping area, so nothing to draw
+		return;
+
+	// Get source and dest surface. Note that for the destination we create
+	// a temporary sub-surface based on the allowed clipping area
+	const Graphics::ManagedSurface &src = **srcBitmap;
+	Graphics::ManagedSurface &dest = *_owner;
+	Graphics::Surface destArea = dest.getSubArea(destRect);
+
+	// Define scaling and other stuff used by the drawing loops
+	const int scaleX = SCALE_THRESHOLD * srcRect.width() / dstRect.width();
+	const int scaleY = SCALE_THRESHOLD * srcRect.height() / dstRect.height();
+
+	// The pixel loop is chosen once for the whole blit
+	const DrawInnerArgs args(this, srcBitmap, skipTrans, srcAlpha, -1, -1, -1, scaleX);
+	const DrawInnerRow drawRow = getDrawInnerRow(args);
+
+	// Only the part of the blitted area which is inside the clipping area is drawn
+	int xStart = (dstRect.left < destRect.left) ? dstRect.left - destRect.left : 0;
+	int yStart = (dstRect.top < destRect.top) ? dstRect.top - destRect.top : 0;
+	const int xBegin = -xStart, xEnd = MIN<int>(dstRect.width(), destArea.w - xStart);
+	const int yBegin = -yStart, yEnd = MIN<int>(dstRect.height(), destArea.h - yStart);
+
+	for (int yCtr = yBegin; yCtr < yEnd; ++yCtr) {
+		byte *destP = (byte *)destArea.getBasePtr(0, yStart + yCtr);
+		const byte *srcP = (const byte *)src.getBasePtr(
+		                       srcRect.left, srcRect.top + yCtr * scaleY / SCALE_THRESHOLD);
+
+		(this->*drawRow)(args, destP, srcP, xBegin, xEnd - xBegin);
+	}
+}
+
+#ifdef ENABLE_AGS_TESTS
+// The per pixel loops of draw() and stretchDraw() from before they chose
+// a row loop per call. The tests check the row loops against them.
+void BITMAP::drawReference(const BITMAP *srcBitmap, const Common::Rect &srcRect,
+                           int dstX, int dstY, bool horizFlip, bool vertFlip,
+                           bool skipTrans, int srcAlpha, int tintRed, int tintGreen,
+                           int tintBlue) {
+	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4 ||
+	       (format.bytesPerPixel == 1 && srcBitmap->format.bytesPerPixel == 1));
+
+	// Allegro disables draw when the clipping rect has negative width/height.
+	// Common::Rect instead asserts, which we don't want.
+	if (cr <= cl || cb <= ct)
+		return;
+
+	// Ensure the src rect is constrained to the source bitmap
+	Common::Rect srcArea = srcRect;
+	srcArea.clip(Common::Rect(0, 0, srcBitmap->w, srcBitmap->h));
+	if (srcArea.isEmpty())
+		return;
+
+	// Figure out the dest area that will be updated
+	Common::Rect dstRect(dstX, dstY, dstX + srcArea.width(), dstY + srcArea.height());
+	Common::Rect destRect = dstRect.findIntersectingRect(
+	                            Common::Rect(cl, ct, cr, cb));
+	if (destRect.isEmpty())
+		// Area is entirely outside the clipping area, so nothing to draw
+		return;
+
+	// Get source and dest surface. Note that for the destination we create
+	// a temporary sub-surface based on the allowed clipping area
+	const Graphics::ManagedSurface &src = **srcBitmap;
+	Graphics::ManagedSurface &dest = *_owner;
+	Graphics::Surface destArea = dest.getSubArea(destRect);
+
 	// Define scaling and other stuff used by the drawing loops
 	const int xDir = horizFlip ? -1 : 1;
 	bool useTint = (tintRed >= 0 && tintGreen >= 0 && tintBlue >= 0);
@@ -244,8 +818,8 @@ void BITMAP::draw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
 	}
 }
 
-void BITMAP::stretchDraw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
-                         const Common::Rect &dstRect, bool skipTrans, int srcAlpha) {
+void BITMAP::stretchDrawReference(const BITMAP *srcBitmap, const Common::Rect &srcRect,
+                                  const Common::Rect &dstRect, bool skipTrans, int srcAlpha) {
 	assert(format.bytesPerPixel == 2 || format.bytesPerPixel == 4 ||
 	       (format.bytesPerPixel == 1 && srcBitmap->format.bytesPerPixel == 1));
 
@@ -359,6 +933,7 @@ void BITMAP::stretchDraw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
 		}
 	}
 }
+#endif
 
 void BITMAP::blendPixel(uint8 aSrc, uint8 rSrc, uint8 gSrc, uint8 bSrc, uint8 &aDest, uint8 &rDest, uint8 &gDest, uint8 &bDest, uint32 alpha) const {
 	switch (_G(_blender_mode)) {
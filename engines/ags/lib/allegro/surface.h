@@ -120,11 +120,51 @@ public:
 	void stretchDraw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
 					 const Common::Rect &destRect, bool skipTrans, int srcAlpha);
 
+#ifdef ENABLE_AGS_TESTS
+	/**
+	 * Reference versions of draw() and stretchDraw(), which handle every
+	 * pixel on its own
+	 */
+	void drawReference(const BITMAP *srcBitmap, const Common::Rect &srcRect,
+	                   int dstX, int dstY, bool horizFlip, bool vertFlip,
+	                   bool skipTrans, int srcAlpha, int tintRed = -1, int tintGreen = -1,
+	                   int tintBlue = -1);
+	void stretchDrawReference(const BITMAP *srcBitmap, const Common::Rect &srcRect,
+	                          const Common::Rect &destRect, bool skipTrans, int srcAlpha);
+#endif
+
 	inline bool isSubBitmap() const {
 		return _owner->disposeAfterUse() == DisposeAfterUse::NO;
 	}
 
 	private:
+	/**
+	 * Parameters of a draw() or stretchDraw() call, which are shared by
+	 * the pixel loops below
+	 */
+	struct DrawInnerArgs;
+
+	/**
+	 * Draws count pixels of a row, starting with destination pixel destP and
+	 * column xCtr of the blitted area. srcP points to the start of the source
+	 * row, and the rows are clipped beforehand.
+	 */
+	typedef void (BITMAP::*DrawInnerRow)(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const;
+
+	DrawInnerRow getDrawInnerRow(const DrawInnerArgs &args) const;
+
+	template<int Bpp, bool SkipTrans>
+	void drawRowCopy(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const;
+	template<int DestBpp, bool SkipTrans>
+	void drawRowPalette(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const;
+	template<int Mode, bool SkipTrans, bool UseTint>
+	void drawRowArgb8888(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const;
+	template<int DestBpp, int SrcBpp, bool SkipTrans>
+	void drawRowGeneric(const DrawInnerArgs &args, byte *destP, const byte *srcP, int xCtr, int count) const;
+
+	template<int Mode, bool UseTint>
+	inline uint32 blendArgb8888(const DrawInnerArgs &args, uint32 srcCol, uint32 destCol) const;
+
 	// True color blender functions
 	// In Allegro all the blender functions are of the form
 	// unsigned int blender_func(unsigned long x, unsigned long y, unsigned long n)
@@ -87,7 +87,10 @@ SpriteFile::SpriteFile() {
 }
 
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos)
-	: _sprInfos(sprInfos) {
+	: _sprInfos(sprInfos)
+	, _prefetchedSize(0)
+	, _prefetchJob(nullptr)
+	, _prefetchRunning(false) {
 	Init();
 }
 
@@ -132,6 +135,7 @@ void SpriteCache::Init() {
 }
 
 void SpriteCache::Reset() {
+	CancelPrefetch();
 	_file.Reset();
 	// TODO: find out if it's safe to simply always delete _spriteData.Image with array element
 	for (size_t i = 0; i < _spriteData.size(); ++i) {
@@ -157,6 +161,7 @@ void SpriteCache::SetSprite(sprkey_t index, Bitmap *sprite) {
 		Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SetSprite: attempt to assign nullptr to index %d", index);
 		return;
 	}
+	DropPrefetched(index);
 	_spriteData[index].Image = sprite;
 	_spriteData[index].Flags = SPRCACHEFLAG_LOCKED; // NOT from asset file
 	_spriteData[index].Size = 0;
@@ -170,6 +175,7 @@ void SpriteCache::SetEmptySprite(sprkey_t index, bool as_asset) {
 		Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SetEmptySprite: unable to use index %d", index);
 		return;
 	}
+	DropPrefetched(index);
 	if (as_asset)
 		_spriteData[index].Flags = SPRCACHEFLAG_ISASSET;
 	RemapSpriteToSprite0(index);
@@ -187,6 +193,7 @@ void SpriteCache::SubstituteBitmap(sprkey_t index, Bitmap *sprite) {
 }
 
 void SpriteCache::RemoveSprite(sprkey_t index, bool freeMemory) {
+	DropPrefetched(index);
 	if (freeMemory)
 		delete _spriteData[index].Image;
 	InitNullSpriteParams(index);
@@ -255,8 +262,12 @@ Bitmap *SpriteCache::operator [] (sprkey_t index) {
 		return _spriteData[index].Image;
 
 	// Sprite exists in file but is not in mem, load it
-	if ((_spriteData[index].Image == nullptr) && _spriteData[index].IsAssetSprite())
+	if ((_spriteData[index].Image == nullptr) && _spriteData[index].IsAssetSprite()) {
+		_stats.Misses++;
 		LoadSprite(index);
+	} else {
+		_stats.Hits++;
+	}
 
 	// Locked sprite that shouldn't be put into MRU list
 	if (_spriteData[index].IsLocked())
@@ -404,8 +415,10 @@ size_t SpriteCache::LoadSprite(sprkey_t index) {
 		quit("sprite cache array index out of bounds");
 
 	sprkey_t load_index = GetDataIndex(index);
-	Bitmap *image;
-	HError err = _file.LoadSprite(load_index, image);
+	Bitmap *image = (load_index == index) ? TakePrefetched(index) : nullptr;
+	HError err = HError::None();
+	if (!image)
+		err = _file.LoadSprite(load_index, image);
 	if (!image) {
 		Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
 			"LoadSprite: failed to load sprite %d:\n%s\n - remapping to sprite 0.", index,
@@ -446,6 +459,140 @@ size_t SpriteCache::LoadSprite(sprkey_t index) {
 	return size;
 }
 
+void SpriteCache::PrefetchSprite(sprkey_t index) {
+	if (index < 0 || (size_t)index >= _spriteData.size())
+		return;
+	// Only sprites which would be loaded from the file are prefetched
+	const SpriteData &data = _spriteData[index];
+	if (data.Image != nullptr || !data.IsAssetSprite() || (data.Flags & SPRCACHEFLAG_REMAPPED) != 0)
+		return;
+	if (JobSys.getWorkerCount() == 0 || !_file.CanPrefetch())
+		return;
+
+	{
+		Common::StackLock lock(_prefetchMutex);
+		if (_prefetched.contains(index) ||
+			std::find(_prefetchQueue.begin(), _prefetchQueue.end(), index) != _prefetchQueue.end())
+			return;
+		// Don't let the prefetched sprites grow beyond a part of the cache
+		if (_prefetchQueue.size() + _prefetched.size() >= MAX_PREFETCH_SPRITES ||
+			_prefetchedSize >= _maxCacheSize / 4)
+			return;
+		_prefetchQueue.push_back(index);
+		if (_prefetchRunning)
+			return;
+		_prefetchRunning = true;
+	}
+
+	// The previous job has run out of work, but might not be marked as done yet
+	if (_prefetchJob) {
+		JobSys.wait(*_prefetchJob);
+		delete _prefetchJob;
+	}
+	_prefetchJob = new PrefetchJob(this);
+	JobSys.submit(_prefetchJob);
+}
+
+void SpriteCache::PrefetchJob::run() {
+	while (true) {
+		sprkey_t index;
+		uint32_t generation;
+		{
+			Common::StackLock lock(_cache->_prefetchMutex);
+			if (_cache->_prefetchQueue.empty()) {
+				_cache->_prefetchRunning = false;
+				return;
+			}
+			index = _cache->_prefetchQueue.front();
+			_cache->_prefetchQueue.erase(_cache->_prefetchQueue.begin());
+			generation = _cache->GetSlotGeneration(index);
+		}
+
+		Bitmap *image = nullptr;
+		_cache->_file.LoadSpriteForPrefetch(index, image);
+		if (!image)
+			continue;
+
+		Common::StackLock lock(_cache->_prefetchMutex);
+		// The slot may have been assigned another sprite while loading
+		if (_cache->GetSlotGeneration(index) != generation) {
+			delete image;
+			_cache->_stats.PrefetchWasted++;
+			continue;
+		}
+		PrefetchedSprite &prefetched = _cache->_prefetched[index];
+		prefetched.Image = image;
+		prefetched.Generation = generation;
+		_cache->_prefetchedSize += image->GetDataSize();
+		_cache->_stats.Prefetched++;
+	}
+}
+
+uint32_t SpriteCache::GetSlotGeneration(sprkey_t index) const {
+	Common::HashMap<sprkey_t, uint32_t>::const_iterator it = _slotGenerations.find(index);
+	return (it != _slotGenerations.end()) ? it->_value : 0;
+}
+
+Bitmap *SpriteCache::TakePrefetched(sprkey_t index) {
+	Common::StackLock lock(_prefetchMutex);
+	// A sprite which is still waiting is loaded right away instead
+	std::vector<sprkey_t>::iterator it = std::find(_prefetchQueue.begin(), _prefetchQueue.end(), index);
+	if (it != _prefetchQueue.end())
+		_prefetchQueue.erase(it);
+
+	if (!_prefetched.contains(index))
+		return nullptr;
+	PrefetchedSprite prefetched = _prefetched.getVal(index);
+	_prefetched.erase(index);
+	_prefetchedSize -= prefetched.Image->GetDataSize();
+	if (prefetched.Generation != GetSlotGeneration(index)) {
+		delete prefetched.Image;
+		_stats.PrefetchWasted++;
+		return nullptr;
+	}
+	_stats.PrefetchHits++;
+	return prefetched.Image;
+}
+
+void SpriteCache::DropPrefetched(sprkey_t index) {
+	Common::StackLock lock(_prefetchMutex);
+	// Loads in progress for the old sprite are discarded when they finish
+	_slotGenerations[index] = GetSlotGeneration(index) + 1;
+
+	std::vector<sprkey_t>::iterator it = std::find(_prefetchQueue.begin(), _prefetchQueue.end(), index);
+	if (it != _prefetchQueue.end())
+		_prefetchQueue.erase(it);
+
+	if (!_prefetched.contains(index))
+		return;
+	Bitmap *image = _prefetched.getVal(index).Image;
+	_prefetched.erase(index);
+	_prefetchedSize -= image->GetDataSize();
+	_stats.PrefetchWasted++;
+	delete image;
+}
+
+void SpriteCache::CancelPrefetch() {
+	{
+		Common::StackLock lock(_prefetchMutex);
+		_prefetchQueue.clear();
+	}
+	// The job stops once it has found the queue empty
+	if (_prefetchJob) {
+		JobSys.wait(*_prefetchJob);
+		delete _prefetchJob;
+		_prefetchJob = nullptr;
+	}
+
+	Common::StackLock lock(_prefetchMutex);
+	for (Common::HashMap<sprkey_t, PrefetchedSprite>::iterator it = _prefetched.begin(); it != _prefetched.end(); ++it) {
+		delete it->_value.Image;
+		_stats.PrefetchWasted++;
+	}
+	_prefetched.clear();
+	_prefetchedSize = 0;
+}
+
 void SpriteCache::RemapSpriteToSprite0(sprkey_t index) {
 	_sprInfos[index].Flags = _sprInfos[0].Flags;
 	_sprInfos[index].Width = _sprInfos[0].Width;
@@ -739,6 +886,7 @@ bool SpriteFile::LoadSpriteIndexFile(const String &filename, int expectedFileID,
 }
 
 void SpriteCache::DetachFile() {
+	CancelPrefetch();
 	_file.Reset();
 }
 
@@ -750,8 +898,13 @@ sprkey_t SpriteFile::GetTopmostSprite() const {
 	return (sprkey_t)_spriteData.size() - 1;
 }
 
+bool SpriteFile::CanPrefetch() const {
+	return _prefetchStream != nullptr;
+}
+
 void SpriteFile::Reset() {
 	_stream.reset();
+	_prefetchStream.reset();
 	_curPos = -2;
 }
 
@@ -767,13 +920,29 @@ HAGSError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	SeekToSprite(index);
 	_curPos = -2; // mark undefined pos
 
-	int coldep = _stream->ReadInt16();
+	HError err = ReadSprite(_stream.get(), index, sprite);
+	if (sprite)
+		_curPos = index + 1; // mark correct pos
+	return err;
+}
+
+HAGSError SpriteFile::LoadSpriteForPrefetch(sprkey_t index, Shared::Bitmap *&sprite) {
+	sprite = nullptr;
+	if (index < 0 || (size_t)index >= _spriteData.size() || _spriteData[index].Offset == 0)
+		return HError::None();
+
+	_prefetchStream->Seek(_spriteData[index].Offset, kSeekBegin);
+	return ReadSprite(_prefetchStream.get(), index, sprite);
+}
+
+HAGSError SpriteFile::ReadSprite(Stream *in, sprkey_t index, Shared::Bitmap *&sprite) {
+	int coldep = in->ReadInt16();
 	if (coldep == 0) { // empty slot, this is normal
 		return HError::None();
 	}
 
-	int wdd = _stream->ReadInt16();
-	int htt = _stream->ReadInt16();
+	int wdd = in->ReadInt16();
+	int htt = in->ReadInt16();
 	Bitmap *image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
 	if (image == nullptr) {
 		return new Error(String::FromFormat("LoadSprite: failed to allocate bitmap %d (%dx%d%d).",
@@ -781,26 +950,33 @@ HAGSError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	}
 
 	if (_compressed) {
-		size_t data_size = _stream->ReadInt32();
+		size_t data_size = in->ReadInt32();
 		if (data_size == 0) {
 			delete image;
 			return new Error(String::FromFormat("LoadSprite: bad compressed data for sprite %d.", index));
 		}
-		rle_decompress(image, _stream.get());
+		rle_decompress(image, in);
+	} else if (image->GetLineLength() == wdd * coldep) {
+		// The rows are contiguous, so the whole sprite is read at once
+		if (coldep == 1)
+			in->ReadArray(image->GetDataForWriting(), wdd, htt);
+		else if (coldep == 2)
+			in->ReadArrayOfInt16((int16_t *)image->GetDataForWriting(), wdd * htt);
+		else
+			in->ReadArrayOfInt32((int32_t *)image->GetDataForWriting(), wdd * htt);
 	} else {
 		if (coldep == 1) {
 			for (int h = 0; h < htt; ++h)
-				_stream->ReadArray(&image->GetScanLineForWriting(h)[0], coldep, wdd);
+				in->ReadArray(&image->GetScanLineForWriting(h)[0], coldep, wdd);
 		} else if (coldep == 2) {
 			for (int h = 0; h < htt; ++h)
-				_stream->ReadArrayOfInt16((int16_t *)&image->GetScanLineForWriting(h)[0], wdd);
+				in->ReadArrayOfInt16((int16_t *)&image->GetScanLineForWriting(h)[0], wdd);
 		} else {
 			for (int h = 0; h < htt; ++h)
-				_stream->ReadArrayOfInt32((int32_t *)&image->GetScanLineForWriting(h)[0], wdd);
+				in->ReadArrayOfInt32((int32_t *)&image->GetScanLineForWriting(h)[0], wdd);
 		}
 	}
 	sprite = image;
-	_curPos = index + 1; // mark correct pos
 	return HError::None();
 }
 
@@ -897,6 +1073,9 @@ HAGSError SpriteFile::OpenFile(const String &filename, const String &sprindex_fi
 	_spriteData.resize(topmost + 1);
 	metrics.resize(topmost + 1);
 
+	// A second stream lets sprites be prefetched on another thread
+	_prefetchStream.reset(_GP(AssetMgr)->OpenAsset(filename));
+
 	// if there is a sprite index file, use it
 	if (LoadSpriteIndexFile(sprindex_filename, spriteFileID,
 		spr_initial_offs, topmost, metrics)) {
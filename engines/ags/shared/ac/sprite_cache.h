@@ -42,6 +42,9 @@
 #ifndef AGS_SHARED_AC_SPRITE_CACHE_H
 #define AGS_SHARED_AC_SPRITE_CACHE_H
 
+#include "common/hashmap.h"
+#include "common/jobsystem.h"
+#include "common/mutex.h"
 #include "ags/lib/std/memory.h"
 #include "ags/lib/std/vector.h"
 #include "ags/shared/core/platform.h"
@@ -133,6 +136,11 @@ public:
 		std::vector<Size> &metrics);
 
 	HAGSError LoadSprite(sprkey_t index, Shared::Bitmap *&sprite);
+	// Loads sprite through a second stream, which may be used from another
+	// thread while the main stream is in use
+	HAGSError LoadSpriteForPrefetch(sprkey_t index, Shared::Bitmap *&sprite);
+	// Tells if the sprites can be loaded through LoadSpriteForPrefetch
+	bool        CanPrefetch() const;
 	HAGSError LoadSpriteData(sprkey_t index, Size &metric, int &bpp, std::vector<char> &data);
 
 	// Saves all sprites to file; fills in index data for external use
@@ -149,6 +157,8 @@ private:
 	static sprkey_t FindTopmostSprite(const std::vector<Shared::Bitmap *> &sprites);
 	// Seek stream to sprite
 	void        SeekToSprite(sprkey_t index);
+	// Reads the sprite at the current position of the given stream
+	HAGSError   ReadSprite(Shared::Stream *in, sprkey_t index, Shared::Bitmap *&sprite);
 
 	// Internal sprite reference
 	struct SpriteRef {
@@ -159,10 +169,20 @@ private:
 	// Array of sprite references
 	std::vector<SpriteRef> _spriteData;
 	std::unique_ptr<Shared::Stream> _stream; // the sprite stream
+	std::unique_ptr<Shared::Stream> _prefetchStream; // the sprite stream used for prefetching
 	bool _compressed; // are sprites compressed
 	sprkey_t _curPos; // current stream position (sprite slot)
 };
 
+// Counters of the sprite cache, shown by the debugger
+struct SpriteCacheStats {
+	uint32_t Hits = 0;          // requests for sprites which were in memory
+	uint32_t Misses = 0;        // requests for sprites which had to be loaded
+	uint32_t PrefetchHits = 0;  // misses which were served by a prefetched sprite
+	uint32_t Prefetched = 0;    // sprites loaded by the prefetch worker
+	uint32_t PrefetchWasted = 0; // prefetched sprites dropped before they were used
+};
+
 class SpriteCache {
 public:
 	static const sprkey_t MIN_SPRITE_INDEX = 1; // 0 is reserved for "empty sprite"
@@ -223,6 +243,15 @@ public:
 	// Loads (if it's not in cache yet) and returns bitmap by the sprite index
 	Shared::Bitmap *operator[] (sprkey_t index);
 
+	// Asks for the sprite to be loaded in the background, as it is likely to
+	// be needed soon; does nothing if the job system has no worker threads
+	void        PrefetchSprite(sprkey_t index);
+	// Waits for the prefetching in progress and drops the prefetched sprites
+	void        CancelPrefetch();
+
+	const SpriteCacheStats &GetStats() const { return _stats; }
+	void        ResetStats() { _stats = SpriteCacheStats(); }
+
 private:
 	void        Init();
 	// Load sprite from game resource
@@ -276,6 +305,42 @@ private:
 
 	// Initialize the empty sprite slot
 	void        InitNullSpriteParams(sprkey_t index);
+
+	// Loads the queued prefetch requests, on a worker thread
+	class PrefetchJob : public Common::Job {
+	public:
+		PrefetchJob(SpriteCache *cache) : _cache(cache) {}
+		void run() override;
+	private:
+		SpriteCache *_cache;
+	};
+	friend class PrefetchJob;
+
+	// Takes the prefetched bitmap for the given sprite, if there is one
+	Shared::Bitmap *TakePrefetched(sprkey_t index);
+	// Drops any prefetched or queued bitmap for the given sprite, because
+	// the slot is assigned something else
+	void        DropPrefetched(sprkey_t index);
+	// Gets the generation of a slot, requires _prefetchMutex
+	uint32_t    GetSlotGeneration(sprkey_t index) const;
+
+	// Max number of sprites waiting to be prefetched or used
+	static const size_t MAX_PREFETCH_SPRITES = 256;
+
+	Common::Mutex _prefetchMutex; // protects the prefetch queue and results
+	std::vector<sprkey_t> _prefetchQueue; // sprites to load, oldest first
+	struct PrefetchedSprite {
+		Shared::Bitmap *Image;
+		uint32_t Generation; // of the slot when the sprite was loaded
+	};
+	Common::HashMap<sprkey_t, PrefetchedSprite> _prefetched; // loaded, not yet used
+	// Bumped whenever a slot is reassigned, so that sprites which were
+	// being loaded meanwhile are thrown away. Slots not in here are at 0.
+	Common::HashMap<sprkey_t, uint32_t> _slotGenerations;
+	size_t _prefetchedSize; // size in bytes of the prefetched bitmaps
+	PrefetchJob *_prefetchJob; // the last submitted job
+	bool _prefetchRunning; // the job is queued or running
+	SpriteCacheStats _stats;
 };
 
 } // namespace AGS3
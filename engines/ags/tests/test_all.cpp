@@ -36,6 +36,7 @@ void Test_DoAllTests() {
 	Test_IniFile();
 
 	Test_Gfx();
+	Test_Script();
 }
 
 } // namespace AGS3
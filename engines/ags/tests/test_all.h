@@ -36,6 +36,9 @@ extern void Test_IniFile();
 // Graphics tests
 extern void Test_Gfx();
 
+// Script interpreter tests
+extern void Test_Script();
+
 // Memory / bit-byte operations
 extern void Test_Memory();
 
@@ -45,4 +48,9 @@ extern void Test_String();
 extern void Test_Path();
 extern void Test_Version();
 
+#ifdef ENABLE_AGS_BENCHMARKS
+// Timings, which are not checked and only printed to the debug output
+extern void Benchmark_Gfx();
+#endif
+
 } // namespace AGS3
@@ -24,11 +24,174 @@
 #include "ags/shared/core/platform.h"
 #include "ags/shared/gfx/gfx_def.h"
 #include "ags/shared/debugging/assert.h"
+#include "ags/lib/allegro/color.h"
+#include "ags/lib/allegro/surface.h"
+#include "ags/globals.h"
+#include "common/debug.h"
+#include "common/system.h"
 
 namespace AGS3 {
 
 namespace GfxDef = AGS::Shared::GfxDef;
 
+/**
+ * Fills a bitmap with reproducible pixels, some of which are transparent
+ */
+static void fillTestBitmap(BITMAP *bmp, uint32 seed) {
+	const uint32 transColor = bmp->getTransparentColor();
+	for (int y = 0; y < bmp->h; ++y) {
+		for (int x = 0; x < bmp->w; ++x) {
+			seed = seed * 1103515245 + 12345;
+			uint32 color = seed >> 8;
+			if ((seed >> 28) == 0)
+				color = transColor;
+			switch (bmp->format.bytesPerPixel) {
+			case 1:
+				*bmp->getBasePtr(x, y) = color;
+				break;
+			case 2:
+				*(uint16 *)bmp->getBasePtr(x, y) = color;
+				break;
+			default:
+				*(uint32 *)bmp->getBasePtr(x, y) = (color == transColor) ? color : (color | (seed << 24));
+				break;
+			}
+		}
+	}
+}
+
+static bool sameBitmaps(const BITMAP *bmp1, const BITMAP *bmp2) {
+	for (int y = 0; y < bmp1->h; ++y)
+		if (memcmp(bmp1->getBasePtr(0, y), bmp2->getBasePtr(0, y), bmp1->w * bmp1->format.bytesPerPixel))
+			return false;
+	return true;
+}
+
+/**
+ * Checks that the row loops of BITMAP::draw and BITMAP::stretchDraw give the
+ * same results as the per pixel loops they replaced, for all the color
+ * depths, blender modes, tints, flips and clipping the games use.
+ */
+static void Test_DrawingLoops() {
+	// The 8-bit sources are expanded through the current palette
+	uint32 seed = 3;
+	for (int i = 0; i < PAL_SIZE; ++i) {
+		seed = seed * 1103515245 + 12345;
+		_G(current_palette)[i].r = (seed >> 8) & 63;
+		_G(current_palette)[i].g = (seed >> 16) & 63;
+		_G(current_palette)[i].b = (seed >> 24) & 63;
+	}
+
+	const int depths[][2] = { { 8, 8 }, { 16, 16 }, { 32, 32 }, { 8, 16 }, { 8, 32 }, { 16, 32 }, { 32, 16 } };
+	const int positions[][2] = { { 3, 2 }, { -5, -3 }, { 40, 9 } };
+	const int alphas[] = { -1, 0, 100, 255 };
+	const int tints[][3] = { { -1, -1, -1 }, { 200, 40, 90 } };
+	const Common::Rect stretched[] = { Common::Rect(2, 1, 52, 16), Common::Rect(-7, 4, 13, 11) };
+
+	for (int d = 0; d < ARRAYSIZE(depths); ++d) {
+		BITMAP *src = create_bitmap_ex(depths[d][0], 37, 11);
+		fillTestBitmap(src, 1);
+		BITMAP *dest = create_bitmap_ex(depths[d][1], 64, 16);
+		BITMAP *reference = create_bitmap_ex(depths[d][1], 64, 16);
+		const Common::Rect srcRect(0, 0, src->w, src->h);
+
+		for (int mode = kSourceAlphaBlender; mode <= kTintLightBlenderMode; ++mode) {
+			set_blender_mode((BlenderMode)mode, 0, 0, 0, 0);
+			for (int skipTrans = 0; skipTrans < 2; ++skipTrans) {
+				for (int a = 0; a < ARRAYSIZE(alphas); ++a) {
+					// tint_image() only uses this mode for luminances below 250
+					if (mode == kTintLightBlenderMode && alphas[a] > 250)
+						continue;
+					for (int t = 0; t < ARRAYSIZE(tints); ++t) {
+						for (int flip = 0; flip < 4; ++flip) {
+							for (int p = 0; p < ARRAYSIZE(positions); ++p) {
+								fillTestBitmap(dest, 2);
+								fillTestBitmap(reference, 2);
+								dest->draw(src, srcRect, positions[p][0], positions[p][1], flip & 1, flip & 2,
+								           skipTrans, alphas[a], tints[t][0], tints[t][1], tints[t][2]);
+								reference->drawReference(src, srcRect, positions[p][0], positions[p][1], flip & 1, flip & 2,
+								                         skipTrans, alphas[a], tints[t][0], tints[t][1], tints[t][2]);
+								assert(sameBitmaps(dest, reference));
+							}
+						}
+					}
+
+					for (int r = 0; r < ARRAYSIZE(stretched); ++r) {
+						fillTestBitmap(dest, 2);
+						fillTestBitmap(reference, 2);
+						dest->stretchDraw(src, srcRect, stretched[r], skipTrans, alphas[a]);
+						reference->stretchDrawReference(src, srcRect, stretched[r], skipTrans, alphas[a]);
+						assert(sameBitmaps(dest, reference));
+					}
+				}
+			}
+		}
+
+		destroy_bitmap(src);
+		destroy_bitmap(dest);
+		destroy_bitmap(reference);
+	}
+
+	set_blender_mode(kRgbToRgbBlender, 0, 0, 0, 0);
+}
+
+#ifdef ENABLE_AGS_BENCHMARKS
+static const char *const BLENDER_MODE_NAMES[] = {
+	"kSourceAlphaBlender",
+	"kArgbToArgbBlender",
+	"kArgbToRgbBlender",
+	"kRgbToArgbBlender",
+	"kRgbToRgbBlender",
+	"kAlphaPreservedBlenderMode",
+	"kOpaqueBlenderMode",
+	"kAdditiveBlenderMode",
+	"kTintBlenderMode",
+	"kTintLightBlenderMode"
+};
+
+/**
+ * Times BITMAP::draw for each blender mode on a fixed set of sprites, as
+ * well as the plain copies between bitmaps of the same color depth.
+ */
+void Benchmark_Gfx() {
+	const int kIterations = 20;
+	const int sizes[][2] = { { 16, 16 }, { 64, 64 }, { 128, 96 }, { 320, 200 }, { 640, 480 } };
+
+	const int depths[][2] = { { 8, 8 }, { 16, 16 }, { 8, 32 }, { 32, 32 } };
+	for (int d = 0; d < ARRAYSIZE(depths); ++d) {
+		const int srcDepth = depths[d][0], destDepth = depths[d][1];
+		BITMAP *dest = create_bitmap_ex(destDepth, 1280, 720);
+		BITMAP *sprites[ARRAYSIZE(sizes)];
+		for (int i = 0; i < ARRAYSIZE(sizes); ++i) {
+			sprites[i] = create_bitmap_ex(srcDepth, sizes[i][0], sizes[i][1]);
+			fillTestBitmap(sprites[i], i);
+		}
+
+		const int numModes = (destDepth == 32 && srcDepth == 32) ? ARRAYSIZE(BLENDER_MODE_NAMES) : 1;
+		for (int mode = 0; mode < numModes; ++mode) {
+			set_blender_mode((BlenderMode)mode, 0, 0, 0, 0);
+			for (int skipTrans = 0; skipTrans < 2; ++skipTrans) {
+				const int srcAlpha = numModes > 1 ? 128 : -1;
+				const uint32 start = g_system->getMillis();
+				for (int n = 0; n < kIterations; ++n)
+					for (int i = 0; i < ARRAYSIZE(sizes); ++i)
+						dest->draw(sprites[i], Common::Rect(0, 0, sprites[i]->w, sprites[i]->h), (n * 37) % 640, (n * 23) % 240, false, false, skipTrans, srcAlpha);
+
+				debug("draw %d->%d bpp, %s, skipTrans %d: %d ms",
+				      srcDepth, destDepth, numModes > 1 ? BLENDER_MODE_NAMES[mode] : "copy",
+				      skipTrans, g_system->getMillis() - start);
+			}
+		}
+
+		for (int i = 0; i < ARRAYSIZE(sizes); ++i)
+			destroy_bitmap(sprites[i]);
+		destroy_bitmap(dest);
+	}
+
+	set_blender_mode(kRgbToRgbBlender, 0, 0, 0, 0);
+}
+#endif
+
 void Test_Gfx() {
 	// Test that every transparency which is a multiple of 10 is converted
 	// forth and back without loosing precision
@@ -42,6 +205,8 @@ void Test_Gfx() {
 		trans100_back[i] = GfxDef::LegacyTrans255ToTrans100(trans255[i]);
 		assert(trans100[i] == trans100_back[i]);
 	}
+
+	Test_DrawingLoops();
 }
 
 } // namespace AGS3
@@ -0,0 +1,108 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/scummsys.h"
+#include "ags/shared/core/platform.h"
+#include "ags/shared/debugging/assert.h"
+#include "ags/shared/script/cc_options.h"
+#include "ags/shared/script/cc_script.h"
+#include "ags/shared/script/script_common.h"
+#include "ags/shared/util/memory.h"
+#include "ags/shared/util/string_compat.h"
+#include "ags/engine/script/cc_instance.h"
+#include "common/debug.h"
+#include "common/system.h"
+
+namespace AGS3 {
+
+using namespace AGS::Shared;
+
+/**
+ * Creates a script exporting "Loop", which adds 3 to a global variable
+ * the given number of times
+ */
+static PScript createLoopScript(int32_t iterations) {
+	const int32_t code[] = {
+		SCMD_LITTOREG, SREG_CX, iterations,
+		SCMD_LITTOREG, SREG_MAR, 0,         // global variable at offset 0
+		SCMD_MEMREAD, SREG_AX,
+		SCMD_ADD, SREG_AX, 3,
+		SCMD_MEMWRITE, SREG_AX,
+		SCMD_SUB, SREG_CX, 1,
+		SCMD_REGTOREG, SREG_CX, SREG_AX,
+		SCMD_JNZ, -18,                      // back to the second instruction
+		SCMD_RET
+	};
+
+	ccScript *scri = new ccScript();
+	scri->codesize = ARRAYSIZE(code);
+	scri->code = (int32_t *)malloc(sizeof(code));
+	memcpy(scri->code, code, sizeof(code));
+	scri->globaldatasize = sizeof(int32_t);
+	scri->globaldata = (char *)calloc(1, sizeof(int32_t));
+
+	scri->numfixups = 1;
+	scri->fixups = (int32_t *)malloc(sizeof(int32_t));
+	scri->fixups[0] = 5;
+	scri->fixuptypes = (char *)malloc(1);
+	scri->fixuptypes[0] = FIXUP_GLOBALDATA;
+
+	// An instance can not be created for a script without imports
+	scri->numimports = 1;
+	scri->imports = (char **)malloc(sizeof(char *));
+	scri->imports[0] = nullptr;
+
+	scri->numexports = 1;
+	scri->exports = (char **)malloc(sizeof(char *));
+	scri->exports[0] = ags_strdup("Loop$0");
+	scri->export_addr = (int32_t *)malloc(sizeof(int32_t));
+	scri->export_addr[0] = EXPORT_FUNCTION << 24;
+	return PScript(scri);
+}
+
+/**
+ * Runs the same script with the pre-decoded instructions and with the ones
+ * decoded while running, and compares the result and the time taken.
+ */
+void Test_Script() {
+	const int32_t kIterations = 1000000;
+	PScript scri = createLoopScript(kIterations);
+	const int oldNoPredecode = ccGetOption(SCOPT_NOPREDECODE);
+
+	for (int predecode = 0; predecode < 2; ++predecode) {
+		ccSetOption(SCOPT_NOPREDECODE, predecode == 0);
+		ccInstance *inst = ccInstance::CreateFromScript(scri);
+		assert(inst);
+
+		const uint32 start = g_system->getMillis();
+		const int ret = inst->CallScriptFunction("Loop", 0, nullptr);
+		debug("script loop, %s: %d ms", predecode ? "pre-decoded" : "decoded while running",
+		      g_system->getMillis() - start);
+		assert(ret == 0);
+		assert(Memory::ReadInt32LE(inst->globaldata) == 3 * kIterations);
+		delete inst;
+	}
+
+	ccSetOption(SCOPT_NOPREDECODE, oldNoPredecode);
+}
+
+} // namespace AGS3
@@ -106,6 +106,11 @@ static struct FuncDescr {
 	{ LC::c_le,				"c_le",				"" },
 	{ LC::c_lineToOf,		"c_lineToOf",		"" },	// D3
 	{ LC::c_lineToOfRef,	"c_lineToOfRef",	"" },	// D3
+	{ LC::c_linkedassign,	"c_linkedassign",	"N" },
+	{ LC::c_linkedcallcmd,	"c_linkedcallcmd",	"Ni" },
+	{ LC::c_linkedcallfunc,	"c_linkedcallfunc",	"Ni" },
+	{ LC::c_linkedpush,		"c_linkedpush",		"N" },
+	{ LC::c_linkedrefpush,	"c_linkedrefpush",	"N" },
 	{ LC::c_localpush,		"c_localpush",		"s" },
 	{ LC::c_localrefpush,	"c_localrefpush",	"s" },
 	{ LC::c_lt,				"c_lt",				"" },
@@ -176,6 +181,29 @@ static struct FuncDescr {
 	{ 0, 0, 0 }
 };
 
+// Instructions with an inline name which linkScript() replaces
+static const struct LinkDescr {
+	const inst func;
+	const inst linked;
+	DatumType type;
+} linkDescr[] = {
+	{ LC::c_callcmd,		LC::c_linkedcallcmd,	SYMBOL },
+	{ LC::c_callfunc,		LC::c_linkedcallfunc,	SYMBOL },
+	{ LC::c_globalpush,		LC::c_linkedpush,		GLOBALREF },
+	{ LC::c_globalrefpush,	LC::c_linkedrefpush,	GLOBALREF },
+	{ LC::c_localpush,		LC::c_linkedpush,		LOCALREF },
+	{ LC::c_localrefpush,	LC::c_linkedrefpush,	LOCALREF },
+	{ LC::c_proppush,		LC::c_linkedpush,		PROPREF },
+	{ LC::c_proprefpush,	LC::c_linkedrefpush,	PROPREF },
+	{ LC::c_varpush,		LC::c_linkedpush,		VARREF },
+	{ LC::c_varrefpush,		LC::c_linkedrefpush,	VARREF },
+	{ LC::cb_globalassign,	LC::c_linkedassign,		GLOBALREF },
+	{ LC::cb_globalpush,	LC::c_linkedpush,		GLOBALREF },
+	{ LC::cb_varassign,		LC::c_linkedassign,		LOCALREF },
+	{ LC::cb_varpush,		LC::c_linkedpush,		LOCALREF },
+	{ 0, 0, VOID }
+};
+
 void Lingo::initFuncs() {
 	Symbol sym;
 	for (FuncDescr *fnc = funcDescr; fnc->name; fnc++) {
@@ -187,6 +215,73 @@ void Lingo::initFuncs() {
 void Lingo::cleanupFuncs() {
 	for (FuncHash::iterator it = _functions.begin(); it != _functions.end(); ++it)
 		delete it->_value;
+
+	for (LinkedRefHash::iterator it = _linkedRefs.begin(); it != _linkedRefs.end(); ++it)
+		delete it->_value;
+	_linkedRefs.clear();
+}
+
+/**
+ * Replace the instructions which look up a variable or handler by its
+ * inline name with linked ones, which take a shared, prebuilt reference
+ * instead. The name slots stay in place, so jump offsets are unaffected.
+ */
+void Lingo::linkScript(ScriptData *sd) {
+	uint pc = 0;
+
+	while (pc < sd->size()) {
+		Symbol sym;
+		sym.u.func = (*sd)[pc];
+
+		FuncHash::iterator fn = _functions.find((void *)sym.u.s);
+		if (fn == _functions.end()) {
+			warning("Lingo::linkScript(): Unknown instruction at %d, not linking the rest", pc);
+			return;
+		}
+
+		const LinkDescr *link = linkDescr;
+		while (link->func && link->func != sym.u.func)
+			link++;
+
+		uint opPc = pc++;
+
+		for (const char *pars = fn->_value->proto; *pars; pars++) {
+			switch (*pars) {
+			case 'f':
+				pc += calcCodeAlignment(sizeof(double));
+				break;
+			case 's':
+				{
+					const char *name = (const char *)&(*sd)[pc];
+					uint size = calcStringAlignment(name);
+
+					if (link->func) {
+						// Types are kept apart, since a link holds a reference of one type
+						Common::String key = Common::String::format("%d:%s", link->type, name);
+						LinkedRefHash::iterator it = _linkedRefs.find(key);
+						LinkedRef *ref;
+						if (it != _linkedRefs.end()) {
+							ref = it->_value;
+						} else {
+							ref = new LinkedRef(name, link->type, size);
+							_linkedRefs[key] = ref;
+						}
+
+						(*sd)[opPc] = link->linked;
+						*(LinkedRef **)&(*sd)[pc] = ref;
+					}
+					pc += size;
+					break;
+				}
+			case 'N':
+				pc += (*(LinkedRef **)&(*sd)[pc])->size;
+				break;
+			default:
+				pc++;
+				break;
+			}
+		}
+	}
 }
 
 void Lingo::push(Datum d) {
@@ -549,6 +644,21 @@ void LC::c_proppush() {
 	g_lingo->push(g_lingo->varFetch(d));
 }
 
+void LC::c_linkedrefpush() {
+	g_lingo->push(g_lingo->readLinkedRef()->ref);
+}
+
+void LC::c_linkedpush() {
+	LinkedRef *ref = g_lingo->readLinkedRef();
+	g_lingo->push(g_lingo->varFetch(ref->ref));
+}
+
+void LC::c_linkedassign() {
+	LinkedRef *ref = g_lingo->readLinkedRef();
+	Datum value = g_lingo->pop();
+	g_lingo->varAssign(ref->ref, value);
+}
+
 void LC::c_stackpeek() {
 	int peekOffset = g_lingo->readInt();
 	g_lingo->push(g_lingo->peek(peekOffset));
@@ -1441,6 +1551,22 @@ void LC::c_callfunc() {
 	LC::call(name, nargs, true);
 }
 
+void LC::c_linkedcallcmd() {
+	LinkedRef *ref = g_lingo->readLinkedRef();
+
+	int nargs = g_lingo->readInt();
+
+	LC::call(*ref->ref.u.s, nargs, false);
+}
+
+void LC::c_linkedcallfunc() {
+	LinkedRef *ref = g_lingo->readLinkedRef();
+
+	int nargs = g_lingo->readInt();
+
+	LC::call(*ref->ref.u.s, nargs, true);
+}
+
 void LC::call(const Common::String &name, int nargs, bool allowRetVal) {
 	if (debugChannelSet(3, kDebugLingoExec))
 		g_lingo->printSTUBWithArglist(name.c_str(), nargs, "call:");
@@ -1489,19 +1615,14 @@ void LC::call(const Common::String &name, int nargs, bool allowRetVal) {
 		}
 	}
 
-	// Handler
-	funcSym = g_lingo->getHandler(name);
-
-	// Builtin
-	if (allowRetVal) {
-		if (g_lingo->_builtinFuncs.contains(name)) {
-			funcSym = g_lingo->_builtinFuncs[name];
-		}
-	} else {
-		if (g_lingo->_builtinCmds.contains(name)) {
-			funcSym = g_lingo->_builtinCmds[name];
-		}
-	}
+	// Builtins take precedence over handlers, so only look for a handler
+	// when there is no builtin of that name
+	SymbolHash &builtins = allowRetVal ? g_lingo->_builtinFuncs : g_lingo->_builtinCmds;
+	SymbolHash::iterator builtin = builtins.find(name);
+	if (builtin != builtins.end())
+		funcSym = builtin->_value;
+	else
+		funcSym = g_lingo->getHandler(name);
 
 	// use lingo-the as fallback. we can only use functions as fallback, not properties
 	if (funcSym.type == VOIDSYM && g_lingo->_theEntities.contains(name) && g_lingo->_theEntities[name]->isFunction) {
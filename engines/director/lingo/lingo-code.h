@@ -85,6 +85,9 @@ void c_globalinit();
 void c_globalpush();
 void c_localpush();
 void c_proppush();
+void c_linkedrefpush();
+void c_linkedpush();
+void c_linkedassign();
 void c_argcpush();
 void c_argcnoretpush();
 void c_arraypush();
@@ -123,6 +126,8 @@ void c_jump();
 void c_jumpifz();
 void c_callcmd();
 void c_callfunc();
+void c_linkedcallcmd();
+void c_linkedcallfunc();
 
 void call(const Symbol &targetSym, int nargs, bool allowRetVal);
 void call(const Common::String &name, int nargs, bool allowRetVal);
@@ -205,6 +205,7 @@ ScriptContext *LingoCompiler::compileLingo(const Common::U32String &code, LingoA
 
 		currentFunc.argNames = argNames;
 		currentFunc.varNames = varNames;
+		g_lingo->linkScript(_currentAssembly);
 		_assemblyContext->_eventHandlers[kEventGeneric] = currentFunc;
 	} else {
 		delete _currentAssembly;
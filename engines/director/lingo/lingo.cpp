@@ -22,6 +22,7 @@
 
 #include "common/file.h"
 #include "common/config-manager.h"
+#include "common/system.h"
 
 #include "graphics/macgui/macwindowmanager.h"
 
@@ -374,6 +375,14 @@ Common::String Lingo::decodeInstruction(ScriptData *sd, uint pc, uint *newPc) {
 					res += Common::String::format(" \"%s\"", s);
 					break;
 				}
+			case 'N':
+				{
+					LinkedRef *ref = *(LinkedRef **)&(*sd)[pc];
+					pc += ref->size;
+
+					res += Common::String::format(" %s \"%s\"", ref->ref.type2str(), ref->ref.u.s->c_str());
+					break;
+				}
 			case 'E':
 				{
 					i = (*sd)[pc++];
@@ -410,8 +419,15 @@ Common::String Lingo::decodeInstruction(ScriptData *sd, uint pc, uint *newPc) {
 void Lingo::execute() {
 	uint localCounter = 0;
 
+	// Checking the debug channels is slow compared to most instructions,
+	// so they are only looked at again when events are processed
+	bool traceInstructions = debugChannelSet(3, kDebugLingoExec);
+	bool traceStack = debugChannelSet(5, kDebugLingoExec);
+	bool traceVars = debugChannelSet(9, kDebugLingoExec);
+	bool fewFramesOnly = debugChannelSet(-1, kDebugFewFramesOnly);
+
 	while (!_abort && !_freezeContext && (*_currentScript)[_pc] != STOP) {
-		if (_globalCounter > 1000 && debugChannelSet(-1, kDebugFewFramesOnly)) {
+		if (_globalCounter > 1000 && fewFramesOnly) {
 			warning("Lingo::execute(): Stopping due to debug few frames only");
 			_vm->getCurrentMovie()->getScore()->_playState = kPlayStopped;
 			break;
@@ -422,30 +438,35 @@ void Lingo::execute() {
 			_vm->processEvents();
 			if (_vm->getCurrentMovie()->getScore()->_playState == kPlayStopped)
 				break;
+
+			traceInstructions = debugChannelSet(3, kDebugLingoExec);
+			traceStack = debugChannelSet(5, kDebugLingoExec);
+			traceVars = debugChannelSet(9, kDebugLingoExec);
+			fewFramesOnly = debugChannelSet(-1, kDebugFewFramesOnly);
 		}
 
-		Common::String instr = decodeInstruction(_currentScript, _pc);
 		uint current = _pc;
 
-		if (debugChannelSet(5, kDebugLingoExec))
+		if (traceStack)
 			printStack("Stack before: ", current);
 
-		if (debugChannelSet(9, kDebugLingoExec)) {
+		if (traceVars) {
 			debug("Vars before");
 			printAllVars();
 			if (_currentMe.type == OBJECT)
 				debug("me: %s", _currentMe.asString(true).c_str());
 		}
 
-		debugC(3, kDebugLingoExec, "[%3d]: %s", current, instr.c_str());
+		if (traceInstructions)
+			debugC(3, kDebugLingoExec, "[%3d]: %s", current, decodeInstruction(_currentScript, current).c_str());
 
 		_pc++;
 		(*((*_currentScript)[_pc - 1]))();
 
-		if (debugChannelSet(5, kDebugLingoExec))
+		if (traceStack)
 			printStack("Stack after: ", current);
 
-		if (debugChannelSet(9, kDebugLingoExec)) {
+		if (traceVars) {
 			debug("Vars after");
 			printAllVars();
 		}
@@ -1104,6 +1125,12 @@ void Lingo::runTests() {
 
 	int counter = 1;
 
+	// With the benchmark debug channel, every test is run several more times
+	// after the first run and the time taken is reported
+	const int benchmarkRuns = 20;
+	uint benchmarkInstructions = 0;
+	uint32 benchmarkTime = 0;
+
 	for (uint i = 0; i < fileList.size(); i++) {
 		Common::SeekableReadStream *const  stream = SearchMan.createReadStreamForMember(fileList[i]);
 		if (stream) {
@@ -1118,10 +1145,26 @@ void Lingo::runTests() {
 			mainArchive->addCode(Common::U32String(script, Common::kMacRoman), kTestScript, counter);
 
 			if (!debugChannelSet(-1, kDebugCompileOnly)) {
-				if (!_compiler->_hadError)
+				if (!_compiler->_hadError) {
 					executeScript(kTestScript, CastMemberID(counter, 0));
-				else
+
+					if (debugChannelSet(-1, kDebugBenchmark)) {
+						uint startCounter = _globalCounter;
+						uint32 startTime = g_system->getMillis();
+
+						for (int run = 0; run < benchmarkRuns; run++)
+							executeScript(kTestScript, CastMemberID(counter, 0));
+
+						uint instructions = _globalCounter - startCounter;
+						uint32 time = g_system->getMillis() - startTime;
+						debug(">> Benchmark: %d runs of %s, %d instructions in %d ms", benchmarkRuns, fileList[i].c_str(), instructions, time);
+
+						benchmarkInstructions += instructions;
+						benchmarkTime += time;
+					}
+				} else {
 					debug(">> Skipping execution");
+				}
 			}
 
 			free(script);
@@ -1131,6 +1174,9 @@ void Lingo::runTests() {
 
 		inFile.close();
 	}
+
+	if (debugChannelSet(-1, kDebugBenchmark))
+		debug(">> Benchmark: %d instructions in %d ms", benchmarkInstructions, benchmarkTime);
 }
 
 void Lingo::executeImmediateScripts(Frame *frame) {
@@ -1205,10 +1251,13 @@ void Lingo::varAssign(const Datum &var, const Datum &value) {
 	switch (var.type) {
 	case VARREF:
 		{
-			Common::String name = *var.u.s;
-			if (_localvars && _localvars->contains(name)) {
-				(*_localvars)[name] = value;
-				return;
+			const Common::String &name = *var.u.s;
+			if (_localvars) {
+				DatumHash::iterator it = _localvars->find(name);
+				if (it != _localvars->end()) {
+					it->_value = value;
+					return;
+				}
 			}
 			if (_currentMe.type == OBJECT && _currentMe.u.obj->hasProp(name)) {
 				_currentMe.u.obj->setProp(name, value);
@@ -1226,9 +1275,10 @@ void Lingo::varAssign(const Datum &var, const Datum &value) {
 		break;
 	case LOCALREF:
 		{
-			Common::String name = *var.u.s;
-			if (_localvars && _localvars->contains(name)) {
-				(*_localvars)[name] = value;
+			const Common::String &name = *var.u.s;
+			DatumHash::iterator it;
+			if (_localvars && (it = _localvars->find(name)) != _localvars->end()) {
+				it->_value = value;
 			} else {
 				warning("varAssign: local variable %s not defined", name.c_str());
 			}
@@ -1316,17 +1366,19 @@ Datum Lingo::varFetch(const Datum &var, bool silent) {
 	switch (var.type) {
 	case VARREF:
 		{
-			Datum d;
-			Common::String name = *var.u.s;
+			const Common::String &name = *var.u.s;
 
-			if (_localvars && _localvars->contains(name)) {
-				return (*_localvars)[name];
+			if (_localvars) {
+				DatumHash::iterator it = _localvars->find(name);
+				if (it != _localvars->end())
+					return it->_value;
 			}
 			if (_currentMe.type == OBJECT && _currentMe.u.obj->hasProp(name)) {
 				return _currentMe.u.obj->getProp(name);
 			}
-			if (_globalvars.contains(name)) {
-				return _globalvars[name];
+			DatumHash::iterator it = _globalvars.find(name);
+			if (it != _globalvars.end()) {
+				return it->_value;
 			}
 
 			if (!silent)
@@ -1336,9 +1388,10 @@ Datum Lingo::varFetch(const Datum &var, bool silent) {
 		break;
 	case GLOBALREF:
 		{
-			Common::String name = *var.u.s;
-			if (_globalvars.contains(name)) {
-				return _globalvars[name];
+			const Common::String &name = *var.u.s;
+			DatumHash::iterator it = _globalvars.find(name);
+			if (it != _globalvars.end()) {
+				return it->_value;
 			}
 			warning("varFetch: global variable %s not defined", name.c_str());
 			return result;
@@ -1346,9 +1399,11 @@ Datum Lingo::varFetch(const Datum &var, bool silent) {
 		break;
 	case LOCALREF:
 		{
-			Common::String name = *var.u.s;
-			if (_localvars && _localvars->contains(name)) {
-				return (*_localvars)[name];
+			const Common::String &name = *var.u.s;
+			if (_localvars) {
+				DatumHash::iterator it = _localvars->find(name);
+				if (it != _localvars->end())
+					return it->_value;
 			}
 			warning("varFetch: local variable %s not defined", name.c_str());
 			return result;
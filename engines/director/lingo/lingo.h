@@ -183,6 +183,21 @@ struct Datum {	/* interpreter stack type */
 	bool operator<=(Datum &d) const;
 };
 
+/**
+ * Variable or handler name which was pulled out of the bytecode by
+ * Lingo::linkScript(). Linked instructions keep a pointer to it in the
+ * first slot of the inline name, so they do not need to build a new
+ * reference from the string each time they run.
+ */
+struct LinkedRef {
+	Datum ref;	// VARREF, GLOBALREF, LOCALREF, PROPREF or SYMBOL
+	uint size;	// Instruction slots taken by the inline name
+
+	LinkedRef(const Common::String &name, DatumType type, uint s) : ref(name), size(s) { ref.type = type; }
+};
+
+typedef Common::HashMap<Common::String, LinkedRef *> LinkedRefHash;
+
 struct ChunkReference {
 	Datum source;
 	ChunkType type;
@@ -297,6 +312,7 @@ public:
 	void cleanupBuiltIns(BuiltinProto protos[]);
 	void initFuncs();
 	void cleanupFuncs();
+	void linkScript(ScriptData *sd);
 	void initBytecode();
 	void initMethods();
 	void cleanupMethods();
@@ -347,6 +363,8 @@ public:
 	double getFloat(uint pc) { return *(double *)(&((*_currentScript)[pc])); }
 	char *readString() { char *s = getString(_pc); _pc += calcStringAlignment(s); return s; }
 	char *getString(uint pc) { return (char *)(&((*_currentScript)[pc])); }
+	LinkedRef *readLinkedRef() { LinkedRef *ref = getLinkedRef(_pc); _pc += ref->size; return ref; }
+	LinkedRef *getLinkedRef(uint pc) { return *(LinkedRef **)(&((*_currentScript)[pc])); }
 
 	void pushVoid();
 
@@ -444,6 +462,7 @@ public:
 	DatumHash *_localvars;
 
 	FuncHash _functions;
+	LinkedRefHash _linkedRefs;
 
 	Common::HashMap<int, LingoV4Bytecode *> _lingoV4;
 	Common::HashMap<int, LingoV4TheEntity *> _lingoV4TheEntity;
@@ -26,6 +26,7 @@
 #include "backends/keymapper/keymap.h"
 #include "backends/keymapper/standard-actions.h"
 
+#include "common/memstream.h"
 #include "common/savefile.h"
 #include "common/system.h"
 #include "common/translation.h"
@@ -341,6 +342,9 @@ SaveStateList MetaEngine::listSaves(const char *target) const {
 		}
 	}
 
+	// Write out any headers which were parsed for the first time
+	saveFileMan->flushSavefileMetadata();
+
 	// Sort saves based on slot number.
 	Common::sort(saveList.begin(), saveList.end(), SaveStateDescriptorSlotComparator());
 	return saveList;
@@ -395,12 +399,78 @@ void MetaEngine::removeSaveState(const char *target, int slot) const {
 	g_system->getSavefileManager()->removeSavefile(getSavegameFile(slot, target));
 }
 
+/**
+ * Write the parts of an extended savegame header needed for a
+ * SaveStateDescriptor as metadata for the save file manager. Thumbnails
+ * larger than the save/load chooser shows them are downscaled.
+ */
+static void storeSavegameMetadata(const Common::String &filename, const ExtendedSavegameHeader &header) {
+	Common::MemoryWriteStreamDynamic out(DisposeAfterUse::YES);
+
+	out.writeUint32LE(header.date);
+	out.writeUint16LE(header.time);
+	out.writeUint32LE(header.playtime);
+	out.writeUint32LE(header.description.size());
+	out.writeString(header.description);
+	out.writeByte(header.isAutosave);
+	if (header.thumbnail) {
+		const Graphics::Surface &thumbnail = *header.thumbnail;
+		if (thumbnail.w > kThumbnailWidth || thumbnail.h > kThumbnailHeight2) {
+			const int scale = MAX<int>((thumbnail.w * 256 + kThumbnailWidth - 1) / kThumbnailWidth,
+			                           (thumbnail.h * 256 + kThumbnailHeight2 - 1) / kThumbnailHeight2);
+			Common::ScopedPtr<Graphics::Surface, Graphics::SurfaceDeleter> preview(
+				thumbnail.scale(MAX<int>(thumbnail.w * 256 / scale, 1), MAX<int>(thumbnail.h * 256 / scale, 1), true));
+			Graphics::saveThumbnail(out, *preview);
+		} else {
+			Graphics::saveThumbnail(out, thumbnail);
+		}
+	}
+
+	g_system->getSavefileManager()->setSavefileMetadata(filename, out.getData(), out.size());
+}
+
+static bool loadSavegameMetadata(Common::SeekableReadStream &in, ExtendedSavegameHeader *header) {
+	header->date = in.readUint32LE();
+	header->time = in.readUint16LE();
+	header->playtime = in.readUint32LE();
+	header->description = in.readString(0, in.readUint32LE());
+	header->isAutosave = in.readByte();
+	if (in.err() || in.eos())
+		return false;
+
+	if (in.pos() < in.size())
+		return Graphics::loadThumbnail(in, header->thumbnail);
+
+	return true;
+}
+
+SaveStateDescriptor MetaEngine::queryIndexedSaveMetaInfos(const Common::String &filename, int slot) {
+	Common::ScopedPtr<Common::SeekableReadStream> metadata(g_system->getSavefileManager()->openSavefileMetadata(filename));
+	if (!metadata)
+		return SaveStateDescriptor();
+
+	ExtendedSavegameHeader header;
+	if (!loadSavegameMetadata(*metadata, &header))
+		return SaveStateDescriptor();
+
+	SaveStateDescriptor desc(slot, Common::U32String());
+	parseSavegameHeader(&header, &desc);
+	desc.setThumbnail(header.thumbnail);
+	return desc;
+}
+
 SaveStateDescriptor MetaEngine::querySaveMetaInfos(const char *target, int slot) const {
 	if (!hasFeature(kSavesUseExtendedFormat))
 		return SaveStateDescriptor();
 
-	Common::ScopedPtr<Common::InSaveFile> f(g_system->getSavefileManager()->openForLoading(
-		getSavegameFile(slot, target)));
+	// Saves which were described before come from the index of the save
+	// file manager
+	const Common::String filename = getSavegameFile(slot, target);
+	SaveStateDescriptor indexed = queryIndexedSaveMetaInfos(filename, slot);
+	if (indexed.getSaveSlot() != -1)
+		return indexed;
+
+	Common::ScopedPtr<Common::InSaveFile> f(g_system->getSavefileManager()->openForLoading(filename));
 
 	if (f) {
 		ExtendedSavegameHeader header;
@@ -408,6 +478,8 @@ SaveStateDescriptor MetaEngine::querySaveMetaInfos(const char *target, int slot)
 			return SaveStateDescriptor();
 		}
 
+		storeSavegameMetadata(filename, header);
+
 		// Create the return descriptor
 		SaveStateDescriptor desc(slot, Common::U32String());
 		parseSavegameHeader(&header, &desc);
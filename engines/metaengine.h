@@ -551,6 +551,14 @@ public:
 	 * Parse the extended savegame header to retrieve the SaveStateDescriptor information.
 	 */
 	static void parseSavegameHeader(ExtendedSavegameHeader *header, SaveStateDescriptor *desc);
+	/**
+	 * Describe a save from the metadata index of the save file manager, which
+	 * the default querySaveMetaInfos() fills and reads. The thumbnail is at
+	 * most as large as the save/load chooser shows it.
+	 *
+	 * @return The descriptor, with slot -1 if the save is not in the index.
+	 */
+	static SaveStateDescriptor queryIndexedSaveMetaInfos(const Common::String &filename, int slot);
 	/**
 	 * Populate the given extended savegame header with dummy values.
 	 *
@@ -84,6 +84,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	// Variables
 	registerVar("sleeptime_factor",	&g_debug_sleeptime_factor);
 	registerVar("gc_interval",		&engine->_gamestate->scriptGCInterval);
+	registerVar("gc_incremental",		&engine->_gamestate->gcIncremental);
 	registerVar("simulated_key",		&g_debug_simulated_key);
 	registerVar("track_mouse_clicks",	&g_debug_track_mouse_clicks);
 	// FIXME: This actually passes an enum type instead of an integer but no
@@ -115,6 +116,7 @@ Console::Console(SciEngine *engine) : GUI::Debugger(),
 	registerCmd("resource_id",		WRAP_METHOD(Console, cmdResourceId));
 	registerCmd("resource_info",		WRAP_METHOD(Console, cmdResourceInfo));
 	registerCmd("resource_types",		WRAP_METHOD(Console, cmdResourceTypes));
+	registerCmd("resource_cache",		WRAP_METHOD(Console, cmdResourceCache));
 	registerCmd("list",				WRAP_METHOD(Console, cmdList));
 	registerCmd("alloc_list",				WRAP_METHOD(Console, cmdAllocList));
 	registerCmd("hexgrep",			WRAP_METHOD(Console, cmdHexgrep));
@@ -309,6 +311,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf("---------\n");
 	debugPrintf("sleeptime_factor: Factor to multiply with wait times in kWait()\n");
 	debugPrintf("gc_interval: Number of kernel calls in between garbage collections\n");
+	debugPrintf("gc_incremental: Spreads the marking of garbage collections over several kernel calls\n");
 	debugPrintf("simulated_key: Add a key with the specified scan code to the event list\n");
 	debugPrintf("track_mouse_clicks: Toggles mouse click tracking to the console\n");
 	debugPrintf("script_abort_flag: Set to 1 to abort script execution. Set to 2 to force a replay afterwards\n");
@@ -345,6 +348,7 @@ bool Console::cmdHelp(int argc, const char **argv) {
 	debugPrintf(" resource_id - Identifies a resource number by splitting it up in resource type and resource number\n");
 	debugPrintf(" resource_info - Shows info about a resource\n");
 	debugPrintf(" resource_types - Shows the valid resource types\n");
+	debugPrintf(" resource_cache - Shows the resource cache counters, or sets its eviction policy\n");
 	debugPrintf(" list - Lists all the resources of a given type\n");
 	debugPrintf(" alloc_list - Lists all allocated resources\n");
 	debugPrintf(" hexgrep - Searches some resources for a particular sequence of bytes, represented as hexadecimal numbers\n");
@@ -1107,6 +1111,43 @@ bool Console::cmdResourceTypes(int argc, const char **argv) {
 	return true;
 }
 
+bool Console::cmdResourceCache(int argc, const char **argv) {
+	ResourceManager *resMan = _engine->getResMan();
+
+	if (argc == 2 && !scumm_stricmp(argv[1], "reset")) {
+		resMan->resetCacheStats();
+		return true;
+	}
+
+	if (argc == 3 && !scumm_stricmp(argv[1], "policy")) {
+		for (int i = 0; i < kResEvictPolicyCount; i++) {
+			if (!scumm_stricmp(argv[2], ResourceManager::getEvictionPolicyName((ResourceEvictionPolicy)i))) {
+				resMan->setEvictionPolicy((ResourceEvictionPolicy)i);
+				return true;
+			}
+		}
+		debugPrintf("Unknown eviction policy %s\n", argv[2]);
+		return true;
+	}
+
+	if (argc != 1) {
+		debugPrintf("Shows the resource cache counters, or changes the cache settings.\n");
+		debugPrintf("Usage: %s [reset | policy <lru | size | type>]\n", argv[0]);
+		return true;
+	}
+
+	const ResourceCacheStats &stats = resMan->getCacheStats();
+	const uint32 requests = stats.hits + stats.misses;
+
+	debugPrintf("Eviction policy: %s\n", ResourceManager::getEvictionPolicyName(resMan->getEvictionPolicy()));
+	debugPrintf("LRU: %d entries, %d of %d bytes\n", resMan->getLRUEntries(), resMan->getMemoryLRU(), resMan->getMaxMemoryLRU());
+	debugPrintf("Locked: %d bytes\n", resMan->getMemoryLocked());
+	debugPrintf("Hits: %d, misses: %d (%d%% hits)\n", stats.hits, stats.misses, requests ? stats.hits * 100 / requests : 0);
+	debugPrintf("Evictions: %d, %d bytes\n", stats.evictions, stats.evictedBytes);
+
+	return true;
+}
+
 bool Console::cmdHexgrep(int argc, const char **argv) {
 	if (argc < 4) {
 		debugPrintf("Searches some resources for a particular sequence of bytes, represented as decimal or hexadecimal numbers.\n");
@@ -22,6 +22,7 @@
 
 #include "sci/engine/gc.h"
 #include "common/array.h"
+#include "common/system.h"
 #include "sci/graphics/ports.h"
 
 #ifdef ENABLE_SCI32
@@ -54,7 +55,7 @@ void WorklistManager::push(reg_t reg) {
 	if (!reg.getSegment()) // No numbers
 		return;
 
-	debugC(kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
+	debugC(2, kDebugLevelGC, "[GC] Adding %04x:%04x", PRINT_REG(reg));
 
 	if (_map.contains(reg))
 		return; // already dealt with it
@@ -68,6 +69,14 @@ void WorklistManager::pushArray(const Common::Array<reg_t> &tmp) {
 		push(*it);
 }
 
+void WorklistManager::pushAgain(reg_t reg) {
+	if (!reg.getSegment())
+		return;
+
+	_map.setVal(reg, true);
+	_worklist.push_back(reg);
+}
+
 static AddrSet *normalizeAddresses(SegManager *segMan, const AddrSet &nonnormal_map) {
 	AddrSet *normal_map = new AddrSet();
 
@@ -90,7 +99,7 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 		reg_t reg = wm._worklist.back();
 		wm._worklist.pop_back();
 		if (reg.getSegment() != stackSegment) { // No need to repeat this one
-			debugC(kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
+			debugC(2, kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
 			if (reg.getSegment() < heap.size() && heap[reg.getSegment()]) {
 				// Valid heap object? Find its outgoing references!
 				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
@@ -99,10 +108,29 @@ static void processWorkList(SegManager *segMan, WorklistManager &wm, const Commo
 	}
 }
 
-AddrSet *findAllActiveReferences(EngineState *s) {
-	assert(!s->_executionStack.empty());
+/**
+ * Processes at most the given number of entries of the work list. Unlike
+ * processWorkList(), this has to cope with references to objects which have
+ * been freed since they were pushed, as the scripts run in between.
+ * @return true if the work list is empty
+ */
+static bool processWorkListSlice(SegManager *segMan, WorklistManager &wm, const Common::Array<SegmentObj *> &heap, uint steps) {
+	SegmentId stackSegment = segMan->findSegmentByType(SEG_TYPE_STACK);
+	while (!wm._worklist.empty() && steps--) {
+		reg_t reg = wm._worklist.back();
+		wm._worklist.pop_back();
+		if (reg.getSegment() != stackSegment) {
+			debugC(2, kDebugLevelGC, "[GC] Checking %04x:%04x", PRINT_REG(reg));
+			if (reg.getSegment() < heap.size() && heap[reg.getSegment()] && heap[reg.getSegment()]->isValidOffset(reg.getOffset()))
+				wm.pushArray(heap[reg.getSegment()]->listAllOutgoingReferences(reg));
+		}
+	}
 
-	WorklistManager wm;
+	return wm._worklist.empty();
+}
+
+static void pushRootSet(EngineState *s, WorklistManager &wm) {
+	assert(!s->_executionStack.empty());
 
 	// Initialize registers
 	wm.push(s->r_acc);
@@ -170,7 +198,14 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	}
 
 	debugC(kDebugLevelGC, "[GC] -- Finished explicitly loaded scripts, done with root set");
+}
+
+AddrSet *findAllActiveReferences(EngineState *s) {
+	WorklistManager wm;
+
+	pushRootSet(s, wm);
 
+	const Common::Array<SegmentObj *> &heap = s->_segMan->getSegments();
 	processWorkList(s->_segMan, wm, heap);
 
 	if (g_sci->_gfxPorts)
@@ -179,11 +214,13 @@ AddrSet *findAllActiveReferences(EngineState *s) {
 	return normalizeAddresses(s->_segMan, wm._map);
 }
 
-void run_gc(EngineState *s) {
-	SegManager *segMan = s->_segMan;
+/**
+ * Frees everything which can be deallocated and is not in the given set.
+ * @return the number of freed objects
+ */
+static uint freeUnreachable(SegManager *segMan, const AddrSet &activeRefs) {
+	uint freed = 0;
 
-	// Some debug stuff
-	debugC(kDebugLevelGC, "[GC] Running...");
 #ifdef GC_DEBUG_CODE
 	const char *segnames[SEG_TYPE_MAX + 1];
 	int segcount[SEG_TYPE_MAX + 1];
@@ -191,9 +228,6 @@ void run_gc(EngineState *s) {
 	memset(segcount, 0, sizeof(segcount));
 #endif
 
-	// Compute the set of all segments references currently in use.
-	AddrSet *activeRefs = findAllActiveReferences(s);
-
 	// Iterate over all segments, and check for each whether it
 	// contains stuff that can be collected.
 	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
@@ -211,10 +245,11 @@ void run_gc(EngineState *s) {
 			const Common::Array<reg_t> tmp = mobj->listAllDeallocatable(seg);
 			for (Common::Array<reg_t>::const_iterator it = tmp.begin(); it != tmp.end(); ++it) {
 				const reg_t addr = *it;
-				if (!activeRefs->contains(addr)) {
+				if (!activeRefs.contains(addr)) {
 					// Not found -> we can free it
 					mobj->freeAtAddress(segMan, addr);
-					debugC(kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					debugC(2, kDebugLevelGC, "[GC] Deallocating %04x:%04x", PRINT_REG(addr));
+					freed++;
 #ifdef GC_DEBUG_CODE
 					segcount[type]++;
 #endif
@@ -224,8 +259,6 @@ void run_gc(EngineState *s) {
 		}
 	}
 
-	delete activeRefs;
-
 #ifdef GC_DEBUG_CODE
 	// Output debug summary of garbage collection
 	debugC(kDebugLevelGC, "[GC] Summary:");
@@ -233,6 +266,97 @@ void run_gc(EngineState *s) {
 		if (segcount[i])
 			debugC(kDebugLevelGC, "\t%d\t* %s", segcount[i], segnames[i]);
 #endif
+
+	return freed;
+}
+
+void run_gc(EngineState *s) {
+	SegManager *segMan = s->_segMan;
+
+	// A full collection supersedes an incremental one which is in progress
+	segMan->setIncrementalGC(nullptr);
+
+	debugC(kDebugLevelGC, "[GC] Running...");
+	const uint32 startTime = g_system->getMillis();
+
+	// Compute the set of all segments references currently in use.
+	AddrSet *activeRefs = findAllActiveReferences(s);
+
+	const uint freed = freeUnreachable(segMan, *activeRefs);
+
+	delete activeRefs;
+
+	debugC(kDebugLevelGC, "[GC] Full collection: %d ms pause, %d objects freed",
+	       g_system->getMillis() - startTime, freed);
+}
+
+void startIncrementalGC(EngineState *s) {
+	IncrementalGC *gc = new IncrementalGC();
+	gc->_startTime = g_system->getMillis();
+
+	debugC(kDebugLevelGC, "[GC] Starting incremental collection...");
+	pushRootSet(s, gc->_wm);
+
+	gc->_markTime = gc->_maxPause = g_system->getMillis() - gc->_startTime;
+	s->_segMan->setIncrementalGC(gc);
+}
+
+void runIncrementalGC(EngineState *s, uint steps) {
+	SegManager *segMan = s->_segMan;
+	IncrementalGC *gc = segMan->getIncrementalGC();
+	assert(gc);
+
+	const uint32 startTime = g_system->getMillis();
+	const Common::Array<SegmentObj *> &heap = segMan->getSegments();
+
+	gc->_slices++;
+	if (!processWorkListSlice(segMan, gc->_wm, heap, steps)) {
+		const uint32 pause = g_system->getMillis() - startTime;
+		gc->_markTime += pause;
+		gc->_maxPause = MAX(gc->_maxPause, pause);
+		return;
+	}
+
+	// The marking is done, so finish it in one go: the stack and the registers
+	// have changed without a write barrier, and (re)allocated segments might
+	// carry marks left over from their previous contents.
+	pushRootSet(s, gc->_wm);
+
+	for (uint i = 0; i < gc->_newSegments.size(); i++) {
+		const SegmentId seg = gc->_newSegments[i];
+		if (seg >= heap.size() || !heap[seg])
+			continue;
+
+		Common::Array<reg_t> refs;
+		if (heap[seg]->getType() == SEG_TYPE_SCRIPT)
+			refs = ((Script *)heap[seg])->listObjectReferences();
+		else
+			refs = heap[seg]->listAllDeallocatable(seg);
+
+		for (uint j = 0; j < refs.size(); j++)
+			gc->_wm.pushAgain(refs[j]);
+	}
+
+	processWorkListSlice(segMan, gc->_wm, heap, (uint)-1);
+
+	if (g_sci->_gfxPorts)
+		g_sci->_gfxPorts->processEngineHunkList(gc->_wm);
+
+	AddrSet *activeRefs = normalizeAddresses(segMan, gc->_wm._map);
+
+	// Stop the write barrier before freeing anything
+	const uint32 markTime = gc->_markTime;
+	const uint32 maxPause = gc->_maxPause;
+	const uint32 totalTime = startTime - gc->_startTime;
+	const uint slices = gc->_slices;
+	segMan->setIncrementalGC(nullptr);
+
+	const uint freed = freeUnreachable(segMan, *activeRefs);
+
+	delete activeRefs;
+
+	debugC(kDebugLevelGC, "[GC] Incremental collection: %d ms final pause, %d ms longest slice, %d ms marking in %d slices over %d ms, %d objects freed",
+	       g_system->getMillis() - startTime, maxPause, markTime, slices, totalTime, freed);
 }
 
 } // End of namespace Sci
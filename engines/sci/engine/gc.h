@@ -55,12 +55,53 @@ AddrSet *findAllActiveReferences(EngineState *s);
  */
 void run_gc(EngineState *s);
 
+/**
+ * Starts an incremental garbage collection: the root set is gathered, and the
+ * rest of the marking is left to runIncrementalGC().
+ * @param s The state in which we should gc
+ */
+void startIncrementalGC(EngineState *s);
+
+/**
+ * Continues an incremental garbage collection for a bounded amount of work.
+ * Once no references are left to examine, the root set is scanned again and
+ * everything that has not been reached is freed.
+ * @param s The state in which we should gc
+ * @param steps The number of references to examine at most
+ */
+void runIncrementalGC(EngineState *s, uint steps = GC_INCREMENTAL_STEPS);
+
 struct WorklistManager {
 	Common::Array<reg_t> _worklist;
 	AddrSet _map;	// used for 2 contains() calls, inside push() and run_gc()
 
 	void push(reg_t reg);
 	void pushArray(const Common::Array<reg_t> &tmp);
+
+	/**
+	 * Pushes a reference even if it has already been dealt with, so that its
+	 * outgoing references are listed again.
+	 */
+	void pushAgain(reg_t reg);
+};
+
+/**
+ * The state of an incremental garbage collection, which is kept by the segment
+ * manager while the marking is in progress. References stored into the heap in
+ * the meantime are pushed through SegManager::writeBarrier(), or the changed
+ * entries through SegManager::rescanReferences(), and anything allocated is
+ * considered reachable until the next collection.
+ */
+struct IncrementalGC {
+	WorklistManager _wm;
+	Common::Array<SegmentId> _newSegments; ///< Segments (re)allocated while marking
+
+	uint32 _startTime; ///< When the collection was started
+	uint32 _markTime;  ///< Time spent marking so far
+	uint32 _maxPause;  ///< Longest pause so far
+	uint _slices;      ///< Number of times the marking was resumed
+
+	IncrementalGC() : _startTime(0), _markTime(0), _maxPause(0), _slices(0) {}
 };
 
 
@@ -943,6 +943,7 @@ void GuestAdditions::syncMessageTypeFromScummVMUsingLSL6HiresStrategy() const {
 	// an error about passing an invalid ScrollWindow ID. Fortunately, the
 	// game scripts store a flag that restores the window when a game is
 	// restored
+	_state->_segMan->writeBarrier(restore);
 	_state->variables[VAR_GLOBAL][kGlobalVarLSL6HiresRestoreTextWindow] = restore;
 	invokeSelector(_state->variables[VAR_GLOBAL][kGlobalVarLSL6HiresGameFlags], selector, 1, params);
 }
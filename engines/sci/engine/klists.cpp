@@ -208,6 +208,9 @@ static void addToFront(EngineState *s, reg_t listRef, reg_t nodeRef) {
 	checkListPointer(s->_segMan, listRef);
 #endif
 
+	s->_segMan->writeBarrier(list->first);
+	s->_segMan->writeBarrier(nodeRef);
+
 	newNode->pred = NULL_REG;
 	newNode->succ = list->first;
 
@@ -234,6 +237,9 @@ static void addToEnd(EngineState *s, reg_t listRef, reg_t nodeRef) {
 	checkListPointer(s->_segMan, listRef);
 #endif
 
+	s->_segMan->writeBarrier(list->last);
+	s->_segMan->writeBarrier(nodeRef);
+
 	newNode->pred = list->last;
 	newNode->succ = NULL_REG;
 
@@ -285,8 +291,10 @@ reg_t kNodeValue(EngineState *s, int argc, reg_t *argv) {
 reg_t kAddToFront(EngineState *s, int argc, reg_t *argv) {
 	addToFront(s, argv[0], argv[1]);
 
-	if (argc == 3)
+	if (argc == 3) {
+		s->_segMan->writeBarrier(argv[2]);
 		s->_segMan->lookupNode(argv[1])->key = argv[2];
+	}
 
 	return s->r_acc;
 }
@@ -294,8 +302,10 @@ reg_t kAddToFront(EngineState *s, int argc, reg_t *argv) {
 reg_t kAddToEnd(EngineState *s, int argc, reg_t *argv) {
 	addToEnd(s, argv[0], argv[1]);
 
-	if (argc == 3)
+	if (argc == 3) {
+		s->_segMan->writeBarrier(argv[2]);
 		s->_segMan->lookupNode(argv[1])->key = argv[2];
+	}
 
 	return s->r_acc;
 }
@@ -319,12 +329,18 @@ reg_t kAddAfter(EngineState *s, int argc, reg_t *argv) {
 		return NULL_REG;
 	}
 
-	if (argc == 4)
+	if (argc == 4) {
+		s->_segMan->writeBarrier(argv[3]);
 		newNode->key = argv[3];
+	}
 
 	if (firstNode) { // We're really appending after
 		const reg_t oldNext = firstNode->succ;
 
+		s->_segMan->writeBarrier(argv[1]);
+		s->_segMan->writeBarrier(argv[2]);
+		s->_segMan->writeBarrier(oldNext);
+
 		newNode->pred = argv[1];
 		firstNode->succ = argv[2];
 		newNode->succ = oldNext;
@@ -361,12 +377,18 @@ reg_t kAddBefore(EngineState *s, int argc, reg_t *argv) {
 		return NULL_REG;
 	}
 
-	if (argc == 4)
+	if (argc == 4) {
+		s->_segMan->writeBarrier(argv[3]);
 		newNode->key = argv[3];
+	}
 
 	if (firstNode) { // We're really appending before
 		const reg_t oldPred = firstNode->pred;
 
+		s->_segMan->writeBarrier(argv[1]);
+		s->_segMan->writeBarrier(argv[2]);
+		s->_segMan->writeBarrier(oldPred);
+
 		newNode->succ = argv[1];
 		firstNode->pred = argv[2];
 		newNode->pred = oldPred;
@@ -423,6 +445,9 @@ reg_t kDeleteKey(EngineState *s, int argc, reg_t *argv) {
 
 	Node *n = s->_segMan->lookupNode(node_pos);
 
+	s->_segMan->writeBarrier(n->pred);
+	s->_segMan->writeBarrier(n->succ);
+
 #ifdef ENABLE_SCI32
 	for (int i = 1; i <= list->numRecursions; ++i) {
 		if (list->nextNodes[i] == node_pos) {
@@ -845,6 +870,8 @@ reg_t kArrayGetElement(EngineState *s, int argc, reg_t *argv) {
 
 reg_t kArraySetElements(EngineState *s, int argc, reg_t *argv) {
 	SciArray &array = *s->_segMan->lookupArray(argv[0]);
+	for (int i = 2; i < argc; ++i)
+		s->_segMan->writeBarrier(argv[i]);
 	array.setElements(argv[1].toUint16(), argc - 2, argv + 2);
 	return argv[0];
 }
@@ -860,6 +887,7 @@ reg_t kArrayFree(EngineState *s, int argc, reg_t *argv) {
 
 reg_t kArrayFill(EngineState *s, int argc, reg_t *argv) {
 	SciArray &array = *s->_segMan->lookupArray(argv[0]);
+	s->_segMan->writeBarrier(argv[3]);
 	array.fill(argv[1].toUint16(), argv[2].toUint16(), argv[3]);
 	return argv[0];
 }
@@ -878,6 +906,7 @@ reg_t kArrayCopy(EngineState *s, int argc, reg_t *argv) {
 		target.copy(source, sourceIndex, targetIndex, count);
 	} else {
 		target.copy(*s->_segMan->lookupArray(argv[2]), sourceIndex, targetIndex, count);
+		s->_segMan->rescanReferences(argv[0]);
 	}
 
 	return argv[0];
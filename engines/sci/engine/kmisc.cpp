@@ -389,6 +389,7 @@ reg_t kMemory(EngineState *s, int argc, reg_t *argv) {
 		} else {
 			if (ref.skipByte)
 				error("Attempt to poke memory at odd offset %04X:%04X", PRINT_REG(argv[1]));
+			s->_segMan->writeBarrier(argv[2]);
 			*(ref.reg) = argv[2];
 		}
 		break;
@@ -46,6 +46,9 @@ reg_t kLoad(EngineState *s, int argc, reg_t *argv) {
 	if (restype == kResourceTypeMemory)
 		return s->_segMan->allocateHunkEntry("kLoad()", resnr);
 
+	// The game expects the resource to stay around until it is unloaded
+	g_sci->getResMan()->pinResource(ResourceId(restype, resnr), true);
+
 	return make_reg(0, ((restype << 11) | resnr)); // Return the resource identifier as handle
 }
 
@@ -63,6 +66,8 @@ reg_t kUnLoad(EngineState *s, int argc, reg_t *argv) {
 
 	if (restype == kResourceTypeMemory)
 		s->_segMan->freeHunkEntry(resnr);
+	else if (resnr.isNumber())
+		g_sci->getResMan()->pinResource(ResourceId(restype, resnr.toUint16()), false);
 
 	return s->r_acc;
 }
@@ -22,6 +22,7 @@
 
 #include "sci/sci.h"
 #include "sci/engine/seg_manager.h"
+#include "sci/engine/gc.h"
 #include "sci/engine/state.h"
 #include "sci/engine/script.h"
 #ifdef ENABLE_SCI32
@@ -48,6 +49,8 @@ SegManager::SegManager(ResourceManager *resMan, ScriptPatcher *scriptPatcher)
 	_bitmapSegId = 0;
 #endif
 
+	_incrementalGC = nullptr;
+
 	createClassTable();
 }
 
@@ -56,6 +59,9 @@ SegManager::~SegManager() {
 }
 
 void SegManager::resetSegMan() {
+	// Any incremental collection refers to the old heap
+	setIncrementalGC(nullptr);
+
 	// Free memory
 	for (uint i = 0; i < _heap.size(); i++) {
 		if (_heap[i])
@@ -126,6 +132,8 @@ SegmentObj *SegManager::allocSegment(SegmentObj *mem, SegmentId *segid) {
 	}
 	_heap[id] = mem;
 
+	shadeSegment(id);
+
 	return mem;
 }
 
@@ -184,6 +192,25 @@ void SegManager::deallocate(SegmentId seg) {
 	_heap[actualSegment] = NULL;
 }
 
+void SegManager::setIncrementalGC(IncrementalGC *gc) {
+	delete _incrementalGC;
+	_incrementalGC = gc;
+}
+
+void SegManager::shadeReference(reg_t value) {
+	_incrementalGC->_wm.push(value);
+}
+
+void SegManager::shadeAllocation(reg_t addr) {
+	if (_incrementalGC)
+		_incrementalGC->_wm.pushAgain(addr);
+}
+
+void SegManager::shadeSegment(SegmentId seg) {
+	if (_incrementalGC)
+		_incrementalGC->_newSegments.push_back(seg);
+}
+
 bool SegManager::isHeapObject(reg_t pos) const {
 	const Object *obj = getObject(pos);
 	if (obj == NULL || (obj && obj->isFreed()))
@@ -461,6 +488,8 @@ reg_t SegManager::allocateHunkEntry(const char *hunk_type, int size) {
 	if (!h)
 		return NULL_REG;
 
+	shadeAllocation(addr);
+
 	h->mem = malloc(size);
 	h->size = size;
 	h->type = hunk_type;
@@ -491,6 +520,7 @@ Clone *SegManager::allocateClone(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_clonesSegId, offset);
+	shadeAllocation(*addr);
 	return &table->at(offset);
 }
 
@@ -505,6 +535,7 @@ List *SegManager::allocateList(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_listsSegId, offset);
+	shadeAllocation(*addr);
 	return &table->at(offset);
 }
 
@@ -519,12 +550,15 @@ Node *SegManager::allocateNode(reg_t *addr) {
 	offset = table->allocEntry();
 
 	*addr = make_reg(_nodesSegId, offset);
+	shadeAllocation(*addr);
 	return &table->at(offset);
 }
 
 reg_t SegManager::newNode(reg_t value, reg_t key) {
 	reg_t nodeRef;
 	Node *n = allocateNode(&nodeRef);
+	writeBarrier(key);
+	writeBarrier(value);
 	n->pred = n->succ = NULL_REG;
 	n->key = key;
 	n->value = value;
@@ -946,6 +980,7 @@ SciArray *SegManager::allocateArray(SciArrayType type, uint16 size, reg_t *addr)
 	offset = table->allocEntry();
 
 	*addr = make_reg(_arraysSegId, offset);
+	shadeAllocation(*addr);
 
 	SciArray *array = &table->at(offset);
 	array->setType(type);
@@ -1002,6 +1037,7 @@ SciBitmap *SegManager::allocateBitmap(reg_t *addr, const int16 width, const int1
 	offset = table->allocEntry();
 
 	*addr = make_reg(_bitmapSegId, offset);
+	shadeAllocation(*addr);
 	SciBitmap &bitmap = table->at(offset);
 
 	bitmap.create(width, height, skipColor, originX, originY, xResolution, yResolution, paletteSize, remap, gc);
@@ -1097,6 +1133,7 @@ int SegManager::instantiateScript(int scriptNum, bool applyScriptPatches) {
 	scr->initializeLocals(this);
 	scr->initializeClasses(this);
 	scr->initializeObjects(this, segmentId, applyScriptPatches);
+	shadeSegment(segmentId);
 #ifdef ENABLE_SCI32
 	g_sci->_guestAdditions->instantiateScriptHook(*scr);
 #endif
@@ -45,6 +45,7 @@ enum ScriptLoadType {
 };
 
 class Script;
+struct IncrementalGC;
 
 class SegManager : public Common::Serializable {
 	friend class Console;
@@ -463,6 +464,37 @@ public:
 
 	const Common::Array<SegmentObj *> &getSegments() const { return _heap; }
 
+	// Incremental garbage collection
+
+	/**
+	 * Sets the state of the incremental garbage collection in progress, or
+	 * nullptr to stop it. The segment manager takes ownership of the state.
+	 */
+	void setIncrementalGC(IncrementalGC *gc);
+	IncrementalGC *getIncrementalGC() const { return _incrementalGC; }
+
+	/**
+	 * Write barrier for the incremental garbage collector. Has to be called
+	 * whenever a reference is stored into an object, list, node or array,
+	 * so that it is not missed by a marking in progress.
+	 * @param value The stored reference
+	 */
+	void writeBarrier(reg_t value) {
+		if (_incrementalGC && value.getSegment())
+			shadeReference(value);
+	}
+
+	/**
+	 * Write barrier for stores which change several references of a table
+	 * entry at once: a marking in progress lists the outgoing references of
+	 * the entry again. Like an allocated entry, it is kept until the next
+	 * collection.
+	 * @param addr The changed entry
+	 */
+	void rescanReferences(reg_t addr) {
+		shadeAllocation(addr);
+	}
+
 private:
 	Common::Array<SegmentObj *> _heap;
 	Common::Array<Class> _classTable; /**< Table of all classes */
@@ -486,11 +518,27 @@ private:
 	SegmentId _bitmapSegId;
 #endif
 
+	IncrementalGC *_incrementalGC;
+
 public:
 	SegmentObj *allocSegment(SegmentObj *mem, SegmentId *segid);
 
 private:
 	void deallocate(SegmentId seg);
+
+	void shadeReference(reg_t value);
+
+	/**
+	 * Tells an incremental garbage collection in progress about an allocated
+	 * table entry, which is considered reachable until the next collection.
+	 */
+	void shadeAllocation(reg_t addr);
+
+	/**
+	 * Tells an incremental garbage collection in progress about a (re)allocated
+	 * segment, whose contents are examined again once the marking is done.
+	 */
+	void shadeSegment(SegmentId seg);
 	void createClassTable();
 
 	SegmentId findFreeSegment() const;
@@ -285,6 +285,7 @@ void writeSelector(SegManager *segMan, reg_t object, Selector selectorId, reg_t
 			                curValue, value, segMan, BREAK_SELECTORWRITE);
 	}
 
+	segMan->writeBarrier(value);
 	*address.getPointer(segMan) = value;
 #ifdef ENABLE_SCI32
 	updateInfoFlagViewVisible(segMan->getObject(object), address.varindex);
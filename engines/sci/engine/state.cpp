@@ -19,6 +19,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  *
  */
+#include "common/config-manager.h"
 #include "common/system.h"
 
 #include "sci/sci.h"	// for INCLUDE_OLDGFX
@@ -71,6 +72,8 @@ EngineState::EngineState(SegManager *segMan)
 : _segMan(segMan),
 	_dirseeker() {
 
+	gcIncremental = ConfMan.hasKey("gc_incremental") && ConfMan.getBool("gc_incremental");
+
 	reset(false);
 }
 
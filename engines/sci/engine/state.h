@@ -179,6 +179,7 @@ public:
 
 	int scriptStepCounter; // Counts the number of steps executed
 	int scriptGCInterval; // Number of steps in between gcs
+	bool gcIncremental; // Spread the gc marking over several kernel calls
 
 	uint16 currentRoomNumber() const;
 	void setRoomNumber(uint16 roomNumber);
@@ -187,6 +187,7 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 				ObjVarRef varp;
 				if (lookupSelector(s->_segMan, stopGroopPos, SELECTOR(client), &varp, NULL) == kSelectorVariable) {
 					reg_t *clientVar = varp.getPointer(s->_segMan);
+					s->_segMan->writeBarrier(value);
 					*clientVar = value;
 				}
 			}
@@ -199,6 +200,7 @@ static void write_var(EngineState *s, int type, int index, reg_t value) {
 		if (type == VAR_TEMP && value.getSegment() == kUninitializedSegment)
 			value.setSegment(0);
 
+		s->_segMan->writeBarrier(value);
 		s->variables[type][index] = value;
 
 		g_sci->_guestAdditions->writeVarHook(type, index, value);
@@ -248,6 +250,7 @@ static void _exec_varselectors(EngineState *s) {
 		} else {
 			// varselector access?
 			if (xs.argc) { // write?
+				s->_segMan->writeBarrier(xs.variables_argp[1]);
 				*var = xs.variables_argp[1];
 
 #ifdef ENABLE_SCI32
@@ -883,9 +886,14 @@ void run_vm(EngineState *s) {
 
 		case op_callk: { // 0x21 (33)
 			// Run the garbage collector, if needed
-			if (s->gcCountDown-- <= 0) {
+			if (s->_segMan->getIncrementalGC()) {
+				runIncrementalGC(s);
+			} else if (s->gcCountDown-- <= 0) {
 				s->gcCountDown = s->scriptGCInterval;
-				run_gc(s);
+				if (s->gcIncremental)
+					startIncrementalGC(s);
+				else
+					run_gc(s);
 			}
 
 			// Call kernel function
@@ -966,6 +974,7 @@ void run_vm(EngineState *s) {
 					// varselector access?
 					reg_t *var = old_xs->getVarPointer(s->_segMan);
 					if (old_xs->argc) { // write?
+						s->_segMan->writeBarrier(old_xs->variables_argp[1]);
 						*var = old_xs->variables_argp[1];
 
 #ifdef ENABLE_SCI32
@@ -1152,6 +1161,7 @@ void run_vm(EngineState *s) {
 				                    s->_segMan, BREAK_SELECTORWRITE);
 			}
 
+			s->_segMan->writeBarrier(s->r_acc);
 			opProperty = s->r_acc;
 #ifdef ENABLE_SCI32
 			updateInfoFlagViewVisible(obj, opparams[0], true);
@@ -1182,6 +1192,7 @@ void run_vm(EngineState *s) {
 				                    opProperty, newValue,
 				                    s->_segMan, BREAK_SELECTORWRITE);
 			}
+			s->_segMan->writeBarrier(newValue);
 			opProperty = newValue;
 #ifdef ENABLE_SCI32
 			updateInfoFlagViewVisible(obj, opparams[0], true);
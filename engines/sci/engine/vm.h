@@ -189,6 +189,11 @@ enum {
 	GC_INTERVAL = 0x8000
 };
 
+/** Number of references examined per kernel call by the incremental gc */
+enum {
+	GC_INCREMENTAL_STEPS = 256
+};
+
 enum SciOpcodes {
 	op_bnot     = 0x00,	// 000
 	op_add      = 0x01,	// 001
@@ -108,6 +108,11 @@ MODULE_OBJS += \
 	video/robot_decoder.o
 endif
 
+ifdef ENABLE_SCI_TESTS
+MODULE_OBJS += \
+	tests/test_gc.o
+endif
+
 # This module can be built as a plugin
 ifeq ($(ENABLE_SCI), DYNAMIC_PLUGIN)
 PLUGIN := 1
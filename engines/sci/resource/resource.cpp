@@ -213,6 +213,9 @@ Resource::Resource(ResourceManager *resMan, ResourceId id) : SciSpan<const byte>
 	_fileOffset = 0;
 	_status = kResStatusNoMalloc;
 	_lockers = 0;
+	_pinned = false;
+	_lruPrev = nullptr;
+	_lruNext = nullptr;
 	_source = nullptr;
 	_header = nullptr;
 	_headerSize = 0;
@@ -1011,7 +1014,10 @@ void ResourceManager::init() {
 	_maxMemoryLRU = 256 * 1024; // 256KiB
 	_memoryLocked = 0;
 	_memoryLRU = 0;
-	_LRU.clear();
+	_lruHead = _lruTail = nullptr;
+	_lruEntries = 0;
+	_evictionPolicy = kResEvictLRU;
+	_cacheStats = ResourceCacheStats();
 	_resMap.clear();
 	_audioMapSCI1 = NULL;
 #ifdef ENABLE_SCI32
@@ -1085,6 +1091,14 @@ void ResourceManager::init() {
 		_maxMemoryLRU = 4096 * 1024; // 4MiB
 	}
 
+	if (ConfMan.hasKey("resource_eviction")) {
+		const Common::String policy = ConfMan.get("resource_eviction");
+		for (int i = 0; i < kResEvictPolicyCount; ++i) {
+			if (policy.equalsIgnoreCase(getEvictionPolicyName((ResourceEvictionPolicy)i)))
+				_evictionPolicy = (ResourceEvictionPolicy)i;
+		}
+	}
+
 	switch (_viewType) {
 	case kViewEga:
 		debugC(1, kDebugLevelResMan, "resMan: Detected EGA graphic resources");
@@ -1131,7 +1145,16 @@ void ResourceManager::removeFromLRU(Resource *res) {
 		warning("resMan: trying to remove resource that isn't enqueued");
 		return;
 	}
-	_LRU.remove(res);
+	if (res->_lruPrev)
+		res->_lruPrev->_lruNext = res->_lruNext;
+	else
+		_lruHead = res->_lruNext;
+	if (res->_lruNext)
+		res->_lruNext->_lruPrev = res->_lruPrev;
+	else
+		_lruTail = res->_lruPrev;
+	res->_lruPrev = res->_lruNext = nullptr;
+	_lruEntries--;
 	_memoryLRU -= res->size();
 	res->_status = kResStatusAllocated;
 }
@@ -1141,7 +1164,14 @@ void ResourceManager::addToLRU(Resource *res) {
 		warning("resMan: trying to enqueue resource with state %d", res->_status);
 		return;
 	}
-	_LRU.push_front(res);
+	res->_lruPrev = nullptr;
+	res->_lruNext = _lruHead;
+	if (_lruHead)
+		_lruHead->_lruPrev = res;
+	else
+		_lruTail = res;
+	_lruHead = res;
+	_lruEntries++;
 	_memoryLRU += res->size();
 #if SCI_VERBOSE_RESMAN
 	debug("Adding %s (%d bytes) to lru control: %d bytes total",
@@ -1154,24 +1184,101 @@ void ResourceManager::addToLRU(Resource *res) {
 void ResourceManager::printLRU() {
 	int mem = 0;
 	int entries = 0;
-	Common::List<Resource *>::iterator it = _LRU.begin();
-	Resource *res;
 
-	while (it != _LRU.end()) {
-		res = *it;
-		debug("\t%s: %u bytes", res->_id.toString().c_str(), res->size());
+	for (Resource *res = _lruHead; res; res = res->_lruNext) {
+		debug("\t%s: %u bytes%s", res->_id.toString().c_str(), res->size(), res->_pinned ? " (pinned)" : "");
 		mem += res->size();
 		++entries;
-		++it;
 	}
 
 	debug("Total: %d entries, %d bytes (mgr says %d)", entries, mem, _memoryLRU);
 }
 
+void ResourceManager::pinResource(ResourceId id, bool pin) {
+	Resource *res = testResource(id);
+	if (res)
+		res->_pinned = pin;
+}
+
+const char *ResourceManager::getEvictionPolicyName(ResourceEvictionPolicy policy) {
+	switch (policy) {
+	case kResEvictLRU:
+		return "lru";
+	case kResEvictSizeAware:
+		return "size";
+	case kResEvictTypePriority:
+		return "type";
+	default:
+		return "unknown";
+	}
+}
+
+/**
+ * Returns how cheap it is to bring back a resource of the given type once it
+ * has been freed. Streamed media is usually played only once, while pictures
+ * and views are needed again as soon as the room is redrawn.
+ */
+static int getEvictionPriority(ResourceType type) {
+	switch (type) {
+	case kResourceTypeAudio:
+	case kResourceTypeAudio36:
+	case kResourceTypeSync:
+	case kResourceTypeSync36:
+	case kResourceTypeRave:
+	case kResourceTypeRobot:
+	case kResourceTypeVMD:
+	case kResourceTypeDuck:
+	case kResourceTypeSound:
+		return 0;
+	case kResourceTypePic:
+	case kResourceTypeText:
+	case kResourceTypeMessage:
+		return 1;
+	case kResourceTypeView:
+	case kResourceTypeBitmap:
+		return 2;
+	default:
+		return 3;
+	}
+}
+
+Resource *ResourceManager::findEvictionCandidate() const {
+	if (_evictionPolicy == kResEvictLRU)
+		return _lruTail;
+
+	// Only the oldest entries are considered, so that eviction stays cheap
+	// and recently used resources are never freed in favour of stale ones.
+	// Preloaded resources are skipped without counting against the window.
+	const int kEvictionWindow = 16;
+
+	Resource *best = nullptr;
+	int n = 0;
+	for (Resource *res = _lruTail; res && n < kEvictionWindow; res = res->_lruPrev) {
+		if (res->_pinned)
+			continue;
+
+		++n;
+		if (!best) {
+			best = res;
+		} else if (_evictionPolicy == kResEvictSizeAware) {
+			if (res->size() > best->size())
+				best = res;
+		} else if (getEvictionPriority(res->getType()) < getEvictionPriority(best->getType())) {
+			best = res;
+		}
+	}
+
+	return best;
+}
+
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
-		assert(!_LRU.empty());
-		Resource *goner = _LRU.back();
+		assert(_lruTail);
+		Resource *goner = findEvictionCandidate();
+		if (!goner) // Only preloaded resources are left
+			break;
+		_cacheStats.evictions++;
+		_cacheStats.evictedBytes += goner->size();
 		removeFromLRU(goner);
 		goner->unalloc();
 #ifdef SCI_VERBOSE_RESMAN
@@ -1216,9 +1323,14 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return NULL;
 
-	if (retval->_status == kResStatusNoMalloc)
+	if (retval->_status == kResStatusNoMalloc) {
+		_cacheStats.misses++;
 		loadResource(retval);
-	else if (retval->_status == kResStatusEnqueued)
+	} else {
+		_cacheStats.hits++;
+	}
+
+	if (retval->_status == kResStatusEnqueued)
 		// The resource is removed from its current position
 		// in the LRU list because it has been requested
 		// again. Below, it will either be locked, or it
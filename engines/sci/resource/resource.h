@@ -62,6 +62,25 @@ enum ResourceStatus {
 	kResStatusLocked /**< Allocated and in use */
 };
 
+/** Strategies for choosing which resources are freed when the LRU is full */
+enum ResourceEvictionPolicy {
+	kResEvictLRU = 0,      /**< Least recently used first */
+	kResEvictSizeAware,    /**< Largest of the least recently used first */
+	kResEvictTypePriority, /**< Least recently used of the cheapest type first */
+
+	kResEvictPolicyCount
+};
+
+/** Counters for the resource cache, shown by the debugger */
+struct ResourceCacheStats {
+	uint32 hits;         /**< Requests for resources which were in memory */
+	uint32 misses;       /**< Requests for resources which had to be loaded */
+	uint32 evictions;    /**< Resources freed to stay below the LRU limit */
+	uint32 evictedBytes; /**< Amount of resource bytes freed by evictions */
+
+	ResourceCacheStats() : hits(0), misses(0), evictions(0), evictedBytes(0) {}
+};
+
 /** Resource error codes. Should be in sync with s_errorDescriptions */
 enum ResourceErrorCodes {
 	SCI_ERROR_NONE = 0,
@@ -298,6 +317,9 @@ protected:
 	int32 _fileOffset; /**< Offset in file */
 	ResourceStatus _status;
 	uint16 _lockers; /**< Number of places where this resource was locked */
+	bool _pinned; /**< Preloaded by the game scripts, kept by the size and type eviction policies */
+	Resource *_lruPrev; /**< More recently used neighbour in the LRU */
+	Resource *_lruNext; /**< Less recently used neighbour in the LRU */
 	ResourceSource *_source;
 	ResourceManager *_resMan;
 
@@ -369,6 +391,25 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Marks a resource as preloaded, so that the eviction policies other
+	 * than plain LRU keep it in memory, even beyond the memory limit.
+	 * @param id	The resource to mark
+	 * @param pin	true to pin the resource, false to release it
+	 */
+	void pinResource(ResourceId id, bool pin);
+
+	void setEvictionPolicy(ResourceEvictionPolicy policy) { _evictionPolicy = policy; }
+	ResourceEvictionPolicy getEvictionPolicy() const { return _evictionPolicy; }
+	static const char *getEvictionPolicyName(ResourceEvictionPolicy policy);
+
+	const ResourceCacheStats &getCacheStats() const { return _cacheStats; }
+	void resetCacheStats() { _cacheStats = ResourceCacheStats(); }
+	int getMemoryLRU() const { return _memoryLRU; }
+	int getMaxMemoryLRU() const { return _maxMemoryLRU; }
+	int getMemoryLocked() const { return _memoryLocked; }
+	uint getLRUEntries() const { return _lruEntries; }
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -489,7 +530,11 @@ protected:
 	SourcesList _sources;
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
-	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Resource *_lruHead; ///< Most recently used resource
+	Resource *_lruTail; ///< Least recently used resource
+	uint _lruEntries; ///< Number of resources under LRU control
+	ResourceEvictionPolicy _evictionPolicy;
+	ResourceCacheStats _cacheStats;
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
@@ -636,6 +681,13 @@ protected:
 	void addToLRU(Resource *res);
 	void removeFromLRU(Resource *res);
 
+	/**
+	 * Picks the next resource to free from the least recently used ones,
+	 * according to the eviction policy.
+	 * @return the resource to free, or nullptr if all of them are pinned
+	 */
+	Resource *findEvictionCandidate() const;
+
 	ResourceCompression getViewCompression();
 	ViewType detectViewType();
 	bool hasSci0Voc999();
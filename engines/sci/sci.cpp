@@ -79,6 +79,10 @@
 #include "sci/sound/audio32.h"
 #endif
 
+#ifdef ENABLE_SCI_TESTS
+#include "sci/tests/test_all.h"
+#endif
+
 namespace Sci {
 
 SciEngine *g_sci = nullptr;
@@ -322,6 +326,11 @@ Common::Error SciEngine::run() {
 	_console = new Console(this);
 	setDebugger(_console);
 
+#ifdef ENABLE_SCI_TESTS
+	Test_GC();
+	return Common::kNoError;
+#endif
+
 	// The game needs to be initialized before the graphics system is initialized, as
 	// the graphics code checks parts of the seg manager upon initialization (e.g. for
 	// the presence of the fastCast object)
@@ -0,0 +1,242 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "sci/sci.h"
+#include "sci/engine/gc.h"
+#include "sci/engine/kernel.h"
+#include "sci/engine/seg_manager.h"
+#include "sci/engine/state.h"
+#include "sci/tests/test_all.h"
+
+namespace Sci {
+
+enum {
+	kRootCount = 3,
+	kEntryCount = 64
+};
+
+/**
+ * A heap of its own, whose roots are the first entries of the value stack, so
+ * that the tests do not depend on the state of the game.
+ */
+class TestHeap {
+public:
+	TestHeap() {
+		_segMan = new SegManager(g_sci->getResMan(), g_sci->getScriptPatcher());
+		_state = new EngineState(_segMan);
+
+		DataStack *stack = _segMan->allocateStack(VM_STACK_SIZE, nullptr);
+		_state->stack_base = stack->_entries;
+		_state->stack_top = stack->_entries + stack->_capacity;
+		_state->_executionStack.push_back(ExecStack(NULL_REG, NULL_REG, _state->stack_base + kRootCount, 0,
+			_state->stack_base, kUninitializedSegment, NULL_REG, -1, -1, -1, -1, -1, -1, EXEC_STACK_TYPE_CALL));
+	}
+
+	~TestHeap() {
+		delete _state;
+		delete _segMan;
+	}
+
+	EngineState *state() { return _state; }
+	SegManager *segMan() { return _segMan; }
+	reg_t &root(int index) { return _state->stack_base[index]; }
+
+private:
+	SegManager *_segMan;
+	EngineState *_state;
+};
+
+static reg_t newList(EngineState *s) {
+	return kNewList(s, 0, nullptr);
+}
+
+static reg_t addNode(EngineState *s, reg_t list, reg_t value, reg_t key) {
+	reg_t nodeArgs[] = { value, key };
+	reg_t listArgs[] = { list, kNewNode(s, 2, nodeArgs) };
+	kAddToEnd(s, 2, listArgs);
+	return listArgs[1];
+}
+
+static reg_t removeNode(EngineState *s, reg_t list, reg_t key) {
+	reg_t args[] = { list, key };
+	const reg_t node = kFindKey(s, 2, args);
+	kDeleteKey(s, 2, args);
+	return node;
+}
+
+static bool isAllocated(SegManager *segMan, reg_t addr, SegmentType type) {
+	const SegmentObj *mobj = segMan->getSegmentObj(addr.getSegment());
+	return mobj && mobj->getType() == type && mobj->isValidOffset(addr.getOffset());
+}
+
+static int countNodes(SegManager *segMan, reg_t list) {
+	int count = 0;
+	for (reg_t node = segMan->lookupList(list)->first; !node.isNull(); node = segMan->lookupNode(node)->succ)
+		++count;
+	return count;
+}
+
+/**
+ * Nodes are moved from one list to another while the lists are marked, in an
+ * order which moves some of them before and some after they are reached.
+ */
+static void Test_GC_MoveNodes() {
+	TestHeap heap;
+	EngineState *s = heap.state();
+	SegManager *segMan = heap.segMan();
+
+	const reg_t source = heap.root(0) = newList(s);
+	const reg_t target = heap.root(1) = newList(s);
+	reg_t nodes[kEntryCount];
+	for (int i = 0; i < kEntryCount; ++i)
+		nodes[i] = addNode(s, source, newList(s), make_reg(0, i));
+	const reg_t garbage = newList(s);
+
+	// The marking examines one reference per step
+	startIncrementalGC(s);
+	for (int step = 0; segMan->getIncrementalGC(); ++step) {
+		if (step < kEntryCount) {
+			const reg_t key = make_reg(0, step * 37 % kEntryCount);
+			reg_t args[] = { target, removeNode(s, source, key), key };
+			kAddToEnd(s, 3, args);
+		}
+		runIncrementalGC(s, 1);
+	}
+
+	assert(countNodes(segMan, source) == 0);
+	assert(countNodes(segMan, target) == kEntryCount);
+	for (int i = 0; i < kEntryCount; ++i) {
+		assert(isAllocated(segMan, nodes[i], SEG_TYPE_NODES));
+		assert(isAllocated(segMan, segMan->lookupNode(nodes[i])->value, SEG_TYPE_LISTS));
+	}
+	assert(!isAllocated(segMan, garbage, SEG_TYPE_LISTS));
+}
+
+/**
+ * The values of nodes are handed over to new nodes, while the old nodes are
+ * dropped.
+ */
+static void Test_GC_ReplaceNodes() {
+	TestHeap heap;
+	EngineState *s = heap.state();
+	SegManager *segMan = heap.segMan();
+
+	const reg_t list = heap.root(0) = newList(s);
+	reg_t values[kEntryCount];
+	reg_t nodes[kEntryCount];
+	for (int i = 0; i < kEntryCount; ++i) {
+		values[i] = newList(s);
+		nodes[i] = addNode(s, list, values[i], make_reg(0, i));
+	}
+
+	startIncrementalGC(s);
+	for (int step = 0; segMan->getIncrementalGC(); ++step) {
+		if (step < kEntryCount) {
+			const int i = step * 37 % kEntryCount;
+			removeNode(s, list, make_reg(0, i));
+			addNode(s, list, values[i], make_reg(0, kEntryCount + i));
+		}
+		runIncrementalGC(s, 1);
+	}
+
+	assert(countNodes(segMan, list) == kEntryCount);
+	for (int i = 0; i < kEntryCount; ++i)
+		assert(isAllocated(segMan, values[i], SEG_TYPE_LISTS));
+
+	// Dropped nodes which had been reached before are only freed by the next
+	// collection
+	run_gc(s);
+	for (int i = 0; i < kEntryCount; ++i) {
+		assert(!isAllocated(segMan, nodes[i], SEG_TYPE_NODES));
+		assert(isAllocated(segMan, values[i], SEG_TYPE_LISTS));
+	}
+}
+
+#ifdef ENABLE_SCI32
+/**
+ * References are moved from one array to others, which have already been
+ * examined, one at a time and by copying ranges of the array.
+ */
+static void Test_GC_MoveArrayElements() {
+	TestHeap heap;
+	EngineState *s = heap.state();
+	SegManager *segMan = heap.segMan();
+
+	reg_t newArgs[] = { make_reg(0, kEntryCount), make_reg(0, kArrayTypeID) };
+	const reg_t source = kArrayNew(s, 2, newArgs);
+	const reg_t elementTarget = heap.root(1) = kArrayNew(s, 2, newArgs);
+	const reg_t copyTarget = heap.root(2) = kArrayNew(s, 2, newArgs);
+	reg_t values[kEntryCount];
+	for (int i = 0; i < kEntryCount; ++i) {
+		values[i] = newList(s);
+		reg_t args[] = { source, make_reg(0, i), values[i] };
+		kArraySetElements(s, 3, args);
+	}
+
+	// An array is examined in one step, so the source array is hidden at the
+	// end of a chain of lists, which takes longer to examine than moving all
+	// the elements
+	reg_t chain = source;
+	for (int i = 0; i < kEntryCount; ++i) {
+		const reg_t list = newList(s);
+		addNode(s, list, chain, NULL_REG);
+		chain = list;
+	}
+	heap.root(0) = chain;
+
+	// The roots are examined from the last one, so both target arrays have
+	// been examined after two steps
+	startIncrementalGC(s);
+	for (int step = 0; segMan->getIncrementalGC(); ++step) {
+		if (step >= 2 && step < kEntryCount + 2) {
+			const reg_t index = make_reg(0, (step - 2) * 37 % kEntryCount);
+			if (index.getOffset() & 1) {
+				reg_t args[] = { copyTarget, index, source, index, make_reg(0, 1) };
+				kArrayCopy(s, 5, args);
+			} else {
+				reg_t args[] = { elementTarget, index, segMan->lookupArray(source)->getAsID(index.getOffset()) };
+				kArraySetElements(s, 3, args);
+			}
+
+			reg_t args[] = { source, index, NULL_REG };
+			kArraySetElements(s, 3, args);
+		}
+		runIncrementalGC(s, 1);
+	}
+
+	for (int i = 0; i < kEntryCount; ++i) {
+		const reg_t target = (i & 1) ? copyTarget : elementTarget;
+		assert(segMan->lookupArray(target)->getAsID(i) == values[i]);
+		assert(isAllocated(segMan, values[i], SEG_TYPE_LISTS));
+	}
+}
+#endif
+
+void Test_GC() {
+	Test_GC_MoveNodes();
+	Test_GC_ReplaceNodes();
+#ifdef ENABLE_SCI32
+	Test_GC_MoveArrayElements();
+#endif
+}
+
+} // End of namespace Sci
@@ -67,6 +67,10 @@ bool MoviePlayer::loadMovie(const Common::String &filename, uint z) {
 	_decoder.loadStream(in);
 	_decoder.start();
 
+	// Decode the frames in a worker thread where possible, so that a slow
+	// frame does not hold up the game loop
+	_decoder.setDecodeAhead(true);
+
 	GraphicEngine *pGfx = Kernel::getInstance()->getGfx();
 
 #ifdef THEORA_INDIRECT_RENDERING
@@ -34,12 +34,20 @@
 #include "engines/wintermute/math/math_util.h"
 #include "engines/wintermute/base/base_game.h"
 #include "engines/wintermute/base/base_sprite.h"
+#include "engines/wintermute/base/font/base_font.h"
 #include "engines/util.h"
 #include "common/system.h"
 #include "common/queue.h"
 #include "common/config-manager.h"
+#include "common/algorithm.h"
 
 #define DIRTY_RECT_LIMIT 800
+// Maximum number of separate dirty rects, beyond which they get merged
+#define MAX_DIRTY_RECTS 16
+// Size of the cells of the grid used to find the tickets overlapping a dirty rect
+#define TICKET_GRID_CELL_SIZE 64
+// Number of opaque tickets checked for hiding the ones below them
+#define MAX_OCCLUDING_TICKETS 8
 
 namespace Wintermute {
 
@@ -57,7 +65,7 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 
 	_borderLeft = _borderRight = _borderTop = _borderBottom = 0;
 	_ratioX = _ratioY = 1.0f;
-	_dirtyRect = nullptr;
+	_gridWidth = _gridHeight = 0;
 	_disableDirtyRects = false;
 	if (ConfMan.hasKey("dirty_rects")) {
 		_disableDirtyRects = !ConfMan.getBool("dirty_rects");
@@ -68,14 +76,7 @@ BaseRenderOSystem::BaseRenderOSystem(BaseGame *inGame) : BaseRenderer(inGame) {
 
 //////////////////////////////////////////////////////////////////////////
 BaseRenderOSystem::~BaseRenderOSystem() {
-	RenderQueueIterator it = _renderQueue.begin();
-	while (it != _renderQueue.end()) {
-		RenderTicket *ticket = *it;
-		it = _renderQueue.erase(it);
-		delete ticket;
-	}
-
-	delete _dirtyRect;
+	deleteAllTickets();
 
 	_renderSurface->free();
 	delete _renderSurface;
@@ -160,8 +161,7 @@ bool BaseRenderOSystem::forcedFlip() {
 bool BaseRenderOSystem::flip() {
 	if (_skipThisFrame) {
 		_skipThisFrame = false;
-		delete _dirtyRect;
-		_dirtyRect = nullptr;
+		_dirtyRects.clear();
 		g_system->updateScreen();
 		_needsFlip = false;
 
@@ -182,9 +182,7 @@ bool BaseRenderOSystem::flip() {
 		RenderQueueIterator it = _renderQueue.begin();
 		while (it != _renderQueue.end()) {
 			if ((*it)->_wantsDraw == false) {
-				RenderTicket *ticket = *it;
-				it = _renderQueue.erase(it);
-				delete ticket;
+				it = eraseTicket(it);
 			} else {
 				(*it)->_wantsDraw = false;
 				++it;
@@ -200,9 +198,7 @@ bool BaseRenderOSystem::flip() {
 		if (_disableDirtyRects || screenChanged) {
 			g_system->copyRectToScreen((byte *)_renderSurface->getPixels(), _renderSurface->pitch, 0, 0, _renderSurface->w, _renderSurface->h);
 		}
-		//  g_system->copyRectToScreen((byte *)_renderSurface->getPixels(), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
-		delete _dirtyRect;
-		_dirtyRect = nullptr;
+		_dirtyRects.clear();
 		_needsFlip = false;
 	}
 	_lastFrameIter = _renderQueue.end();
@@ -304,31 +300,16 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 
 	if (owner) { // Fade-tickets are owner-less
 		RenderTicket compare(owner, nullptr, srcRect, dstRect, transform);
-		RenderQueueIterator it = _lastFrameIter;
-		++it;
-		// Avoid calling end() and operator* every time, when potentially going through
-		// LOTS of tickets.
-		RenderQueueIterator endIterator = _renderQueue.end();
-		RenderTicket *compareTicket = nullptr;
-		for (; it != endIterator; ++it) {
-			compareTicket = *it;
-			if (*(compareTicket) == compare && compareTicket->_isValid) {
-				if (_disableDirtyRects) {
-					drawFromSurface(compareTicket);
-				} else {
-					drawFromQueuedTicket(it);
-				}
-				return;
-			}
+		RenderQueueIterator it = findReusableTicket(compare);
+		if (it != _renderQueue.end()) {
+			drawFromQueuedTicket(it);
+			return;
 		}
 	}
 	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
-	if (!_disableDirtyRects) {
-		drawFromTicket(ticket);
-	} else {
-		ticket->_wantsDraw = true;
-		_renderQueue.push_back(ticket);
-		drawFromSurface(ticket);
+	drawFromTicket(ticket);
+	if (owner) {
+		addToTicketIndex(_lastFrameIter);
 	}
 }
 
@@ -377,19 +358,164 @@ void BaseRenderOSystem::drawFromQueuedTicket(const RenderQueueIterator &ticket)
 		--_lastFrameIter;
 		// Remove the ticket from the list
 		assert(*_lastFrameIter != renderTicket);
+		removeFromTicketIndex(ticket);
 		_renderQueue.erase(ticket);
 		// Is not in order, so readd it as if it was a new ticket
 		drawFromTicket(renderTicket);
+		addToTicketIndex(_lastFrameIter);
 	}
 }
 
+static int rectArea(const Common::Rect &rect) {
+	return rect.width() * rect.height();
+}
+
 void BaseRenderOSystem::addDirtyRect(const Common::Rect &rect) {
-	if (!_dirtyRect) {
-		_dirtyRect = new Common::Rect(rect);
-	} else {
-		_dirtyRect->extend(rect);
+	Common::Rect dirty(rect);
+	dirty.clip(_renderRect);
+	if (dirty.isEmpty()) {
+		return;
+	}
+
+	// Merge the rect with the ones it overlaps or touches, as long as the
+	// merged rect is not larger than both of them, and retry with the result
+	bool merged;
+	do {
+		merged = false;
+		for (uint i = 0; i < _dirtyRects.size(); ++i) {
+			if (_dirtyRects[i].contains(dirty)) {
+				return;
+			}
+			Common::Rect united(_dirtyRects[i]);
+			united.extend(dirty);
+			if (rectArea(united) <= rectArea(_dirtyRects[i]) + rectArea(dirty)) {
+				dirty = united;
+				_dirtyRects.remove_at(i);
+				merged = true;
+				break;
+			}
+		}
+	} while (merged);
+
+	if (_dirtyRects.size() < MAX_DIRTY_RECTS) {
+		_dirtyRects.push_back(dirty);
+		return;
+	}
+
+	// Too many rects already, extend the one which grows the least
+	uint best = 0;
+	int bestGrowth = 0;
+	for (uint i = 0; i < _dirtyRects.size(); ++i) {
+		Common::Rect united(_dirtyRects[i]);
+		united.extend(dirty);
+		int growth = rectArea(united) - rectArea(_dirtyRects[i]);
+		if (i == 0 || growth < bestGrowth) {
+			best = i;
+			bestGrowth = growth;
+		}
+	}
+	_dirtyRects[best].extend(dirty);
+}
+
+uint32 BaseRenderOSystem::getTicketKey(const RenderTicket &ticket) {
+	return (uint32)((uintptr)ticket._owner >> 3) * 2654435761u ^
+		((uint32)(uint16)ticket._dstRect.left << 16 | (uint16)ticket._dstRect.top);
+}
+
+void BaseRenderOSystem::addToTicketIndex(const RenderQueueIterator &ticket) {
+	_ticketIndex[getTicketKey(**ticket)].push_back(ticket);
+}
+
+void BaseRenderOSystem::removeFromTicketIndex(const RenderQueueIterator &ticket) {
+	TicketIndex::iterator entry = _ticketIndex.find(getTicketKey(**ticket));
+	if (entry == _ticketIndex.end()) {
+		return;
+	}
+	Common::Array<RenderQueueIterator> &tickets = entry->_value;
+	for (uint i = 0; i < tickets.size(); ++i) {
+		if (tickets[i] == ticket) {
+			tickets.remove_at(i);
+			break;
+		}
+	}
+	if (tickets.empty()) {
+		_ticketIndex.erase(entry);
+	}
+}
+
+BaseRenderOSystem::RenderQueueIterator BaseRenderOSystem::findReusableTicket(const RenderTicket &compare) {
+	// Usually the draw calls come in the same order as last frame
+	RenderQueueIterator it = _lastFrameIter;
+	++it;
+	if (it != _renderQueue.end() && **it == compare && (*it)->_isValid) {
+		return it;
+	}
+
+	// Tickets which were not drawn yet this frame are the ones after _lastFrameIter
+	TicketIndex::const_iterator entry = _ticketIndex.find(getTicketKey(compare));
+	if (entry != _ticketIndex.end()) {
+		const Common::Array<RenderQueueIterator> &tickets = entry->_value;
+		for (uint i = 0; i < tickets.size(); ++i) {
+			const RenderTicket *ticket = *tickets[i];
+			if (!ticket->_wantsDraw && ticket->_isValid && *ticket == compare) {
+				return tickets[i];
+			}
+		}
+	}
+	return _renderQueue.end();
+}
+
+BaseRenderOSystem::RenderQueueIterator BaseRenderOSystem::eraseTicket(const RenderQueueIterator &ticket) {
+	RenderTicket *renderTicket = *ticket;
+	if (renderTicket->_owner) {
+		removeFromTicketIndex(ticket);
+	}
+	RenderQueueIterator next = _renderQueue.erase(ticket);
+	delete renderTicket;
+	return next;
+}
+
+void BaseRenderOSystem::deleteAllTickets() {
+	RenderQueueIterator it = _renderQueue.begin();
+	while (it != _renderQueue.end()) {
+		RenderTicket *ticket = *it;
+		it = _renderQueue.erase(it);
+		delete ticket;
+	}
+	_ticketIndex.clear();
+	_lastFrameIter = _renderQueue.end();
+}
+
+void BaseRenderOSystem::buildTicketGrid() {
+	_drawOrder.resize(0);
+	for (RenderQueueIterator it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
+		_drawOrder.push_back(*it);
+	}
+	_drawStamps.resize(_drawOrder.size());
+	for (uint i = 0; i < _drawStamps.size(); ++i) {
+		_drawStamps[i] = 0;
+	}
+
+	_gridWidth = (_renderSurface->w + TICKET_GRID_CELL_SIZE - 1) / TICKET_GRID_CELL_SIZE;
+	_gridHeight = (_renderSurface->h + TICKET_GRID_CELL_SIZE - 1) / TICKET_GRID_CELL_SIZE;
+	_ticketGrid.resize(_gridWidth * _gridHeight);
+	for (uint i = 0; i < _ticketGrid.size(); ++i) {
+		_ticketGrid[i].resize(0);
+	}
+
+	const Common::Rect screen(_renderSurface->w, _renderSurface->h);
+	for (uint i = 0; i < _drawOrder.size(); ++i) {
+		Common::Rect rect(_drawOrder[i]->_dstRect);
+		rect.clip(screen);
+		if (rect.isEmpty()) {
+			continue;
+		}
+		for (int y = rect.top / TICKET_GRID_CELL_SIZE; y <= (rect.bottom - 1) / TICKET_GRID_CELL_SIZE; ++y) {
+			for (int x = rect.left / TICKET_GRID_CELL_SIZE; x <= (rect.right - 1) / TICKET_GRID_CELL_SIZE; ++x) {
+				_ticketGrid[y * _gridWidth + x].push_back(i);
+			}
+		}
 	}
-	_dirtyRect->clip(_renderRect);
 }
 
 void BaseRenderOSystem::drawTickets() {
@@ -400,70 +526,43 @@ void BaseRenderOSystem::drawTickets() {
 	// we have a copy of their data, so their invalidness won't affect us.
 	while (it != _renderQueue.end()) {
 		if ((*it)->_wantsDraw == false) {
-			RenderTicket *ticket = *it;
 			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
+			it = eraseTicket(it);
 		} else {
 			++it;
 		}
 	}
-	if (!_dirtyRect || _dirtyRect->width() == 0 || _dirtyRect->height() == 0) {
+
+	_stats = RenderStats();
+	if (_dirtyRects.empty()) {
 		it = _renderQueue.begin();
 		while (it != _renderQueue.end()) {
 			RenderTicket *ticket = *it;
 			ticket->_wantsDraw = false;
+			++_stats.tickets;
 			++it;
 		}
 		return;
 	}
 
-	it = _renderQueue.begin();
 	_lastFrameIter = _renderQueue.end();
-	// A special case: If the screen has one giant OPAQUE rect to be drawn, then we skip filling
-	// the background color. Typical use-case: Fullscreen FMVs.
-	// Caveat: The FPS-counter will invalidate this.
-	if (it != _lastFrameIter && _renderQueue.front() == _renderQueue.back() && (*it)->_transform._alphaDisable == true) {
-		// If our single opaque rect fills the dirty rect, we can skip filling.
-		if (*_dirtyRect != (*it)->_dstRect) {
-			// Apply the clear-color to the dirty rect.
-			_renderSurface->fillRect(*_dirtyRect, _clearColor);
-		}
-		// Otherwise Do NOT fill.
-	} else {
-		// Apply the clear-color to the dirty rect.
-		_renderSurface->fillRect(*_dirtyRect, _clearColor);
+	buildTicketGrid();
+	_stats.tickets = _drawOrder.size();
+	for (uint i = 0; i < _dirtyRects.size(); ++i) {
+		drawDirtyRect(_dirtyRects[i], i + 1);
 	}
-	for (; it != _renderQueue.end(); ++it) {
-		RenderTicket *ticket = *it;
-		if (ticket->_dstRect.intersects(*_dirtyRect)) {
-			// dstClip is the area we want redrawn.
-			Common::Rect dstClip(ticket->_dstRect);
-			// reduce it to the dirty rect
-			dstClip.clip(*_dirtyRect);
-			// we need to keep track of the position to redraw the dirty rect
-			Common::Rect pos(dstClip);
-			int16 offsetX = ticket->_dstRect.left;
-			int16 offsetY = ticket->_dstRect.top;
-			// convert from screen-coords to surface-coords.
-			dstClip.translate(-offsetX, -offsetY);
-
-			drawFromSurface(ticket, &pos, &dstClip);
-			_needsFlip = true;
-		}
-		// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
-		ticket->_wantsDraw = false;
+	// Some tickets want redraw but don't actually clip the dirty area (typically the ones that shouldnt become clear-color)
+	for (uint i = 0; i < _drawOrder.size(); ++i) {
+		_drawOrder[i]->_wantsDraw = false;
 	}
-	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(_dirtyRect->left, _dirtyRect->top), _renderSurface->pitch, _dirtyRect->left, _dirtyRect->top, _dirtyRect->width(), _dirtyRect->height());
+	_drawOrder.resize(0);
 
 	it = _renderQueue.begin();
 	// Clean out the old tickets
 	while (it != _renderQueue.end()) {
 		if ((*it)->_isValid == false) {
-			RenderTicket *ticket = *it;
 			addDirtyRect((*it)->_dstRect);
-			it = _renderQueue.erase(it);
-			delete ticket;
+			it = eraseTicket(it);
 		} else {
 			++it;
 		}
@@ -471,6 +570,86 @@ void BaseRenderOSystem::drawTickets() {
 
 }
 
+void BaseRenderOSystem::drawDirtyRect(const Common::Rect &rect, uint32 stamp) {
+	// Collect the tickets overlapping the rect from the grid, in drawing order
+	_dirtyTickets.resize(0);
+	const int cellBottom = MIN<int>((rect.bottom - 1) / TICKET_GRID_CELL_SIZE, _gridHeight - 1);
+	const int cellRight = MIN<int>((rect.right - 1) / TICKET_GRID_CELL_SIZE, _gridWidth - 1);
+	for (int y = MAX<int>(rect.top / TICKET_GRID_CELL_SIZE, 0); y <= cellBottom; ++y) {
+		for (int x = MAX<int>(rect.left / TICKET_GRID_CELL_SIZE, 0); x <= cellRight; ++x) {
+			const Common::Array<uint32> &cell = _ticketGrid[y * _gridWidth + x];
+			for (uint i = 0; i < cell.size(); ++i) {
+				if (_drawStamps[cell[i]] != stamp) {
+					_drawStamps[cell[i]] = stamp;
+					if (_drawOrder[cell[i]]->_dstRect.intersects(rect)) {
+						_dirtyTickets.push_back(cell[i]);
+					}
+				}
+			}
+		}
+	}
+	Common::sort(_dirtyTickets.begin(), _dirtyTickets.end());
+
+	// Going from the topmost ticket down, skip the tickets whose part in the
+	// rect is completely covered by opaque tickets drawn after them.
+	Common::Rect occluders[MAX_OCCLUDING_TICKETS];
+	int numOccluders = 0;
+	_visibleTickets.resize(_dirtyTickets.size());
+	for (int i = (int)_dirtyTickets.size() - 1; i >= 0; --i) {
+		RenderTicket *ticket = _drawOrder[_dirtyTickets[i]];
+		Common::Rect visible(ticket->_dstRect);
+		visible.clip(rect);
+		bool hidden = false;
+		for (int j = 0; j < numOccluders && !hidden; ++j) {
+			hidden = occluders[j].contains(visible);
+		}
+		_visibleTickets[i] = !hidden;
+		if (hidden) {
+			++_stats.occludedTickets;
+		} else if (numOccluders < MAX_OCCLUDING_TICKETS && ticket->isOpaque()) {
+			occluders[numOccluders++] = visible;
+		}
+	}
+
+	// If an opaque ticket covers the whole rect, then we skip filling the
+	// background color. Typical use-case: Fullscreen FMVs.
+	bool needsFill = true;
+	for (int j = 0; j < numOccluders && needsFill; ++j) {
+		needsFill = !occluders[j].contains(rect);
+	}
+	if (needsFill) {
+		// Apply the clear-color to the dirty rect.
+		_renderSurface->fillRect(rect, _clearColor);
+		_stats.drawnPixels += rectArea(rect);
+	}
+
+	for (uint i = 0; i < _dirtyTickets.size(); ++i) {
+		if (!_visibleTickets[i]) {
+			continue;
+		}
+		RenderTicket *ticket = _drawOrder[_dirtyTickets[i]];
+		// dstClip is the area we want redrawn.
+		Common::Rect dstClip(ticket->_dstRect);
+		// reduce it to the dirty rect
+		dstClip.clip(rect);
+		// we need to keep track of the position to redraw the dirty rect
+		Common::Rect pos(dstClip);
+		int16 offsetX = ticket->_dstRect.left;
+		int16 offsetY = ticket->_dstRect.top;
+		// convert from screen-coords to surface-coords.
+		dstClip.translate(-offsetX, -offsetY);
+
+		drawFromSurface(ticket, &pos, &dstClip);
+		_needsFlip = true;
+		++_stats.drawnTickets;
+		_stats.drawnPixels += rectArea(pos);
+	}
+	g_system->copyRectToScreen((byte *)_renderSurface->getBasePtr(rect.left, rect.top), _renderSurface->pitch, rect.left, rect.top, rect.width(), rect.height());
+
+	++_stats.dirtyRects;
+	_stats.dirtyPixels += rectArea(rect);
+}
+
 // Replacement for SDL2's SDL_RenderCopy
 void BaseRenderOSystem::drawFromSurface(RenderTicket *ticket) {
 	ticket->drawToSurface(_renderSurface);
@@ -584,12 +763,7 @@ void BaseRenderOSystem::endSaveLoad() {
 	BaseRenderer::endSaveLoad();
 
 	// Clear the scale-buffered tickets as we just loaded.
-	RenderQueueIterator it = _renderQueue.begin();
-	while (it != _renderQueue.end()) {
-		RenderTicket *ticket = *it;
-		it = _renderQueue.erase(it);
-		delete ticket;
-	}
+	deleteAllTickets();
 	// HACK: After a save the buffer will be drawn before the scripts get to update it,
 	// so just skip this single frame.
 	_skipThisFrame = true;
@@ -600,6 +774,21 @@ void BaseRenderOSystem::endSaveLoad() {
 	g_system->updateScreen();
 }
 
+bool BaseRenderOSystem::displayDebugInfo() {
+	BaseFont *font = _gameRef->getSystemFont();
+	if (!font) {
+		return STATUS_FAILED;
+	}
+
+	char str[100];
+	sprintf(str, "Tickets: %u (drawn: %u, occluded: %u)", _stats.tickets, _stats.drawnTickets, _stats.occludedTickets);
+	font->drawText((byte *)str, 0, 90, _width, TAL_RIGHT);
+	sprintf(str, "Dirty rects: %u, pixels: %u/%u (overdraw: %.2f)", _stats.dirtyRects, _stats.drawnPixels, _stats.dirtyPixels,
+	        _stats.dirtyPixels ? (float)_stats.drawnPixels / _stats.dirtyPixels : 0.0f);
+	font->drawText((byte *)str, 0, 110, _width, TAL_RIGHT);
+	return STATUS_OK;
+}
+
 bool BaseRenderOSystem::startSpriteBatch() {
 	return STATUS_OK;
 }
@@ -33,6 +33,8 @@
 #include "common/rect.h"
 #include "graphics/surface.h"
 #include "common/list.h"
+#include "common/array.h"
+#include "common/hashmap.h"
 #include "graphics/transform_struct.h"
 
 namespace Wintermute {
@@ -53,6 +55,11 @@ class RenderTicket;
  * being equal, this information is then used to check whether the draw order changed,
  * which will then create a need for redrawing, as we draw with an alpha-channel here.
  *
+ * The screen areas which need redrawing are kept as a handful of separate dirty
+ * rects. When they are redrawn, the tickets overlapping each of them are looked up
+ * in a grid of screen cells, and tickets which are completely hidden by opaque
+ * tickets drawn after them are skipped.
+ *
  * There is also a draw path that draws without tickets, for debugging purposes,
  * as well as to accomodate situations with large enough amounts of draw calls,
  * that there will be too much overhead involved with comparing the generated tickets.
@@ -64,6 +71,20 @@ public:
 
 	typedef Common::List<RenderTicket *>::iterator RenderQueueIterator;
 
+	/**
+	 * Statistics of the last frame drawn with dirty rects
+	 */
+	struct RenderStats {
+		uint32 tickets;         // tickets in the render queue
+		uint32 drawnTickets;    // tickets drawn into a dirty rect
+		uint32 occludedTickets; // tickets skipped because of later opaque tickets
+		uint32 dirtyRects;
+		uint32 dirtyPixels;     // area of the dirty rects
+		uint32 drawnPixels;     // pixels written, including the clear color
+
+		RenderStats() : tickets(0), drawnTickets(0), occludedTickets(0), dirtyRects(0), dirtyPixels(0), drawnPixels(0) {}
+	};
+
 	Common::String getName() const override;
 
 	bool initRenderer(int width, int height, bool windowed) override;
@@ -113,6 +134,8 @@ public:
 	bool startSpriteBatch() override;
 	bool endSpriteBatch() override;
 	void endSaveLoad() override;
+	bool displayDebugInfo() override;
+	const RenderStats &getRenderStats() const { return _stats; }
 	void drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform);
 	BaseSurface *createSurface() override;
 private:
@@ -125,13 +148,53 @@ private:
 	 * Traverse the tickets that are dirty, and draw them
 	 */
 	void drawTickets();
+	/**
+	 * Clear a dirty rect and draw the visible parts of the tickets overlapping it.
+	 * @param rect the dirty rect
+	 * @param stamp value unique to the rect, used to visit each ticket once
+	 */
+	void drawDirtyRect(const Common::Rect &rect, uint32 stamp);
+	/**
+	 * List the tickets in drawing order, and sort them into the grid cells they cover.
+	 */
+	void buildTicketGrid();
+	/**
+	 * Remove a ticket from the queue and delete it.
+	 * @return iterator pointing to the following ticket.
+	 */
+	RenderQueueIterator eraseTicket(const RenderQueueIterator &ticket);
+	void deleteAllTickets();
+	// The tickets which may be reused are indexed by owner and position
+	static uint32 getTicketKey(const RenderTicket &ticket);
+	void addToTicketIndex(const RenderQueueIterator &ticket);
+	void removeFromTicketIndex(const RenderQueueIterator &ticket);
+	/**
+	 * Find a valid ticket from last frame equal to the given one, which was not drawn yet.
+	 * @return iterator pointing to the ticket, or the end of the queue if there is none.
+	 */
+	RenderQueueIterator findReusableTicket(const RenderTicket &compare);
 	// Non-dirty-rects:
 	void drawFromSurface(RenderTicket *ticket);
 	// Dirty-rects:
 	void drawFromSurface(RenderTicket *ticket, Common::Rect *dstRect, Common::Rect *clipRect);
-	Common::Rect *_dirtyRect;
+	Common::Array<Common::Rect> _dirtyRects;
 	Common::List<RenderTicket *> _renderQueue;
 
+	typedef Common::HashMap<uint32, Common::Array<RenderQueueIterator> > TicketIndex;
+	TicketIndex _ticketIndex;
+
+	// Valid during drawTickets(): the tickets in drawing order, and per grid
+	// cell the indexes of those covering it
+	Common::Array<RenderTicket *> _drawOrder;
+	Common::Array<uint32> _drawStamps;
+	Common::Array<Common::Array<uint32> > _ticketGrid;
+	int _gridWidth;
+	int _gridHeight;
+	Common::Array<uint32> _dirtyTickets;
+	Common::Array<bool> _visibleTickets;
+
+	RenderStats _stats;
+
 	bool _needsFlip;
 	RenderQueueIterator _lastFrameIter;
 	Common::Rect _renderRect;
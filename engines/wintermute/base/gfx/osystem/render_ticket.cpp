@@ -95,6 +95,22 @@ bool RenderTicket::operator==(const RenderTicket &t) const {
 	return true;
 }
 
+bool RenderTicket::isOpaque() const {
+	// Only plain copies of a surface which fills the whole destination qualify,
+	// see the fast path of TransparentSurface::blit()
+	if (!_owner || !_surface ||
+		_transform._angle != Graphics::kDefaultAngle ||
+		_transform._rgbaMod != Graphics::kDefaultRgbaMod ||
+		_transform._blendMode != Graphics::BLEND_NORMAL) {
+		return false;
+	}
+	if (_surface->w * _transform._numTimesX != _dstRect.width() ||
+		_surface->h * _transform._numTimesY != _dstRect.height()) {
+		return false;
+	}
+	return _transform._alphaDisable || _owner->getAlphaType() == Graphics::ALPHA_OPAQUE;
+}
+
 // Replacement for SDL2's SDL_RenderCopy
 void RenderTicket::drawToSurface(Graphics::Surface *_targetSurface) const {
 	Graphics::TransparentSurface src(*getSurface(), false);
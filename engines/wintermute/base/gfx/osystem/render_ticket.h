@@ -58,6 +58,11 @@ public:
 	void drawToSurface(Graphics::Surface *_targetSurface) const;
 	// Dirty-rects:
 	void drawToSurface(Graphics::Surface *_targetSurface, Common::Rect *dstRect, Common::Rect *clipRect) const;
+	/**
+	 * Whether drawing the ticket overwrites every pixel of its destination
+	 * rect, hiding whatever was drawn there before.
+	 */
+	bool isOpaque() const;
 
 	Common::Rect _dstRect;
 
@@ -40,6 +40,14 @@ Common::Rect Font::getBoundingBox(uint32 chr) const {
 	return Common::Rect(getCharWidth(chr), getFontHeight());
 }
 
+const TextRun *Font::getTextRun(const Common::String &str) const {
+	return nullptr;
+}
+
+const TextRun *Font::getTextRun(const Common::U32String &str) const {
+	return nullptr;
+}
+
 namespace {
 
 template<class StringType>
@@ -48,7 +56,8 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 	// that we do allow an empty width to be specified here. This allows us
 	// to obtain the complete bounding box of a string.
 	const int leftX = x, rightX = w ? (x + w + 1) : 0x7FFFFFFF;
-	int width = font.getStringWidth(str);
+	const TextRun *run = font.getTextRun(str);
+	int width = run ? run->width : font.getStringWidth(str);
 
 	if (align == kTextAlignCenter)
 		x = x + (w - width)/2;
@@ -59,6 +68,26 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 	bool first = true;
 	Common::Rect bbox;
 
+	if (run) {
+		for (uint i = 0; i < run->chars.size(); ++i) {
+			const TextRun::Char &c = run->chars[i];
+			if (x + c.x + c.box.right > rightX)
+				break;
+			if (x + c.x + c.box.right >= leftX) {
+				Common::Rect charBox = c.box;
+				charBox.translate(x + c.x, y);
+				if (first) {
+					bbox = charBox;
+					first = false;
+				} else {
+					bbox.extend(charBox);
+				}
+			}
+		}
+
+		return bbox;
+	}
+
 	typename StringType::unsigned_type last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
 		const typename StringType::unsigned_type cur = *i;
@@ -86,6 +115,10 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 
 template<class StringType>
 int getStringWidthImpl(const Font &font, const StringType &str) {
+	const TextRun *run = font.getTextRun(str);
+	if (run)
+		return run->width;
+
 	int space = 0;
 	typename StringType::unsigned_type last = 0;
 
@@ -105,7 +138,8 @@ void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, i
 	assert(dst != 0);
 
 	const int leftX = x, rightX = x + w + 1;
-	int width = font.getStringWidth(str);
+	const TextRun *run = font.getTextRun(str);
+	int width = run ? run->width : font.getStringWidth(str);
 
 	if (align == kTextAlignCenter)
 		x = x + (w - width)/2;
@@ -113,6 +147,18 @@ void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, i
 		x = x + w - width;
 	x += deltax;
 
+	if (run) {
+		for (uint i = 0; i < run->chars.size(); ++i) {
+			const TextRun::Char &c = run->chars[i];
+			if (x + c.x + c.box.right > rightX)
+				break;
+			if (x + c.x + c.box.right >= leftX)
+				font.drawChar(dst, c.chr, x + c.x, y, color);
+		}
+
+		return;
+	}
+
 	typename StringType::unsigned_type last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
 		const typename StringType::unsigned_type cur = *i;
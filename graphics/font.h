@@ -23,14 +23,11 @@
 #ifndef GRAPHICS_FONT_H
 #define GRAPHICS_FONT_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/ustr.h"
 #include "common/rect.h"
 
-namespace Common {
-template<class T> class Array;
-}
-
 namespace Graphics {
 
 /**
@@ -74,6 +71,20 @@ enum WordWrapMode {
  */
 TextAlign convertTextAlignH(TextAlign alignH, bool rtl);
 
+/**
+ * The layout of a string drawn at (0, 0), for fonts that cache it.
+ */
+struct TextRun {
+	struct Char {
+		uint32 chr;        ///< The character.
+		int x;             ///< Where the character is drawn, kerning included.
+		Common::Rect box;  ///< The bounding box of the character drawn at (0, 0).
+	};
+
+	Common::Array<Char> chars;
+	int width;             ///< The same as Font::getStringWidth().
+};
+
 /**
  * Instances of this class represent a distinct font, with a built-in renderer.
  *
@@ -144,6 +155,21 @@ public:
 	 */
 	virtual Common::Rect getBoundingBox(uint32 chr) const;
 
+	/**
+	 * Return the layout of a string, for fonts that are slow to measure
+	 * and cache their layouts. drawString, getStringWidth and getBoundingBox
+	 * use it instead of measuring the string character by character.
+	 *
+	 * The default implementation returns nullptr.
+	 *
+	 * @param str  The string to lay out.
+	 *
+	 * @return The layout, which is valid until the next call, or nullptr.
+	 */
+	virtual const TextRun *getTextRun(const Common::String &str) const;
+	/** @overload */
+	virtual const TextRun *getTextRun(const Common::U32String &str) const;
+
 	/**
 	 * Return the bounding box of a string drawn with drawString.
 	 *
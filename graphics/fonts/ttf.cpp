@@ -39,6 +39,8 @@
 #include "common/stream.h"
 #include "common/memstream.h"
 #include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/list.h"
 #include "common/ptr.h"
 #include "common/unzip.h"
 
@@ -90,6 +92,317 @@ inline int divRoundToNearest(int dividend, int divisor) {
 
 } // End of anonymous namespace
 
+/**
+ * The glyph images of a face at one size and with one set of render
+ * settings, packed into pages. The atlas is shared by all fonts with these
+ * settings, and glyphs are only rendered into it when they are first used.
+ */
+class TTFGlyphAtlas {
+public:
+	struct Glyph {
+		int page;          // -1 if the image is empty
+		Common::Rect area; // The image within the page
+		int xOffset, yOffset;
+		int advance;
+		FT_UInt slot;
+	};
+
+	explicit TTFGlyphAtlas(const Common::String &key);
+	~TTFGlyphAtlas();
+
+	const Common::String &getKey() const { return _key; }
+
+	void ref() { _refCount++; }
+	bool unref() { return --_refCount == 0; }
+
+	/**
+	 * Check whether a glyph was added, or failed to render before.
+	 */
+	bool hasGlyph(FT_UInt slot) const { return _glyphs.contains(slot); }
+
+	/**
+	 * @return the glyph, or nullptr if it was not added or failed to render
+	 */
+	const Glyph *getGlyph(FT_UInt slot) const;
+
+	/**
+	 * Add a glyph with room for an image of the given size. The image is
+	 * cleared, and the metrics are left to the caller.
+	 */
+	Glyph *addGlyph(FT_UInt slot, int w, int h);
+
+	/**
+	 * Remember that a glyph failed to render.
+	 */
+	void addMissingGlyph(FT_UInt slot) { _glyphs[slot] = nullptr; }
+
+	Surface getImage(const Glyph &glyph);
+	const Surface getImage(const Glyph &glyph) const;
+
+	bool findKerning(FT_UInt left, FT_UInt right, int &offset) const;
+	void addKerning(FT_UInt left, FT_UInt right, int offset);
+
+	uint getPageCount() const { return _pages.size(); }
+	uint getGlyphCount() const { return _glyphs.size(); }
+	uint getMemoryUsage() const { return _pageBytes; }
+
+private:
+	enum {
+		kPageSize = 256
+	};
+
+	int addPage(int w, int h);
+
+	Common::String _key;
+	uint _refCount;
+
+	typedef Common::HashMap<FT_UInt, Glyph *> GlyphMap;
+	GlyphMap _glyphs;
+	Common::HashMap<uint32, int> _kerning;
+
+	Common::Array<Surface *> _pages;
+	uint _pageBytes;
+
+	// Glyphs are put next to each other on shelves as high as the highest
+	// glyph on them
+	int _shelfPage;
+	int _shelfX, _shelfY, _shelfHeight;
+};
+
+TTFGlyphAtlas::TTFGlyphAtlas(const Common::String &key)
+	: _key(key), _refCount(0), _pageBytes(0), _shelfPage(-1), _shelfX(0), _shelfY(0), _shelfHeight(0) {
+}
+
+TTFGlyphAtlas::~TTFGlyphAtlas() {
+	for (GlyphMap::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
+		delete i->_value;
+
+	for (uint i = 0; i < _pages.size(); ++i) {
+		_pages[i]->free();
+		delete _pages[i];
+	}
+}
+
+const TTFGlyphAtlas::Glyph *TTFGlyphAtlas::getGlyph(FT_UInt slot) const {
+	GlyphMap::const_iterator glyphEntry = _glyphs.find(slot);
+	if (glyphEntry == _glyphs.end())
+		return nullptr;
+
+	return glyphEntry->_value;
+}
+
+TTFGlyphAtlas::Glyph *TTFGlyphAtlas::addGlyph(FT_UInt slot, int w, int h) {
+	Glyph *glyph = new Glyph();
+	glyph->page = -1;
+	glyph->xOffset = glyph->yOffset = 0;
+	glyph->advance = 0;
+	glyph->slot = slot;
+
+	if (w > kPageSize || h > kPageSize) {
+		// Huge glyphs get a page of their own
+		glyph->page = addPage(w, h);
+		glyph->area = Common::Rect(w, h);
+	} else if (w > 0 && h > 0) {
+		if (_shelfPage < 0 || _shelfX + w > kPageSize) {
+			_shelfX = 0;
+			_shelfY += _shelfHeight;
+			_shelfHeight = 0;
+		}
+
+		if (_shelfPage < 0 || _shelfY + h > kPageSize) {
+			_shelfPage = addPage(kPageSize, kPageSize);
+			_shelfX = _shelfY = _shelfHeight = 0;
+		}
+
+		glyph->page = _shelfPage;
+		glyph->area = Common::Rect(_shelfX, _shelfY, _shelfX + w, _shelfY + h);
+		_shelfX += w;
+		_shelfHeight = MAX(_shelfHeight, h);
+	}
+
+	_glyphs[slot] = glyph;
+	return glyph;
+}
+
+int TTFGlyphAtlas::addPage(int w, int h) {
+	Surface *page = new Surface();
+	page->create(w, h, PixelFormat::createFormatCLUT8());
+	memset(page->getPixels(), 0, page->h * page->pitch);
+
+	_pages.push_back(page);
+	_pageBytes += page->h * page->pitch;
+	return _pages.size() - 1;
+}
+
+Surface TTFGlyphAtlas::getImage(const Glyph &glyph) {
+	if (glyph.page < 0)
+		return Surface();
+
+	return _pages[glyph.page]->getSubArea(glyph.area);
+}
+
+const Surface TTFGlyphAtlas::getImage(const Glyph &glyph) const {
+	if (glyph.page < 0)
+		return Surface();
+
+	return ((const Surface *)_pages[glyph.page])->getSubArea(glyph.area);
+}
+
+bool TTFGlyphAtlas::findKerning(FT_UInt left, FT_UInt right, int &offset) const {
+	if (left > 0xFFFF || right > 0xFFFF)
+		return false;
+
+	Common::HashMap<uint32, int>::const_iterator entry = _kerning.find((left << 16) | right);
+	if (entry == _kerning.end())
+		return false;
+
+	offset = entry->_value;
+	return true;
+}
+
+void TTFGlyphAtlas::addKerning(FT_UInt left, FT_UInt right, int offset) {
+	if (left <= 0xFFFF && right <= 0xFFFF)
+		_kerning[(left << 16) | right] = offset;
+}
+
+/**
+ * The layouts of the strings last drawn or measured with any TTF font.
+ */
+class TTFRunCache {
+public:
+	TTFRunCache() : _bytes(0), _hits(0), _misses(0) {}
+	~TTFRunCache();
+
+	/**
+	 * Find the layout of a string and mark it as the most recently used.
+	 */
+	const TextRun *find(const void *font, const Common::U32String &str);
+
+	/**
+	 * Add the layout of a string, dropping the least recently used layouts
+	 * to make room for it. The cache takes ownership of the run.
+	 */
+	void insert(const void *font, const Common::U32String &str, TextRun *run);
+
+	/**
+	 * Drop all the layouts of a font.
+	 */
+	void removeFont(const void *font);
+
+	uint getRunCount() const { return _entries.size(); }
+	uint getMemoryUsage() const { return _bytes; }
+	uint getHits() const { return _hits; }
+	uint getMisses() const { return _misses; }
+
+private:
+	enum {
+		kMaxRuns = 256,
+		kMaxBytes = 256 * 1024
+	};
+
+	struct Key {
+		const void *font;
+		Common::U32String str;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const {
+			return Common::Hash<Common::U32String>()(key.str) ^ (uint)(size_t)key.font;
+		}
+	};
+
+	struct KeyEqual {
+		bool operator()(const Key &a, const Key &b) const {
+			return a.font == b.font && a.str == b.str;
+		}
+	};
+
+	struct Entry {
+		Key key;
+		TextRun *run;
+		uint bytes;
+	};
+
+	typedef Common::List<Entry *> EntryList;
+	typedef Common::HashMap<Key, EntryList::iterator, KeyHash, KeyEqual> EntryMap;
+
+	void remove(EntryList::iterator entry);
+
+	EntryList _entries; // Most recently used first
+	EntryMap _index;
+	uint _bytes;
+	uint _hits, _misses;
+};
+
+TTFRunCache::~TTFRunCache() {
+	while (!_entries.empty())
+		remove(_entries.begin());
+}
+
+const TextRun *TTFRunCache::find(const void *font, const Common::U32String &str) {
+	Key key;
+	key.font = font;
+	key.str = str;
+
+	EntryMap::iterator i = _index.find(key);
+	if (i == _index.end()) {
+		_misses++;
+		return nullptr;
+	}
+
+	_hits++;
+
+	Entry *entry = *i->_value;
+	if (i->_value != _entries.begin()) {
+		_entries.erase(i->_value);
+		_entries.push_front(entry);
+		i->_value = _entries.begin();
+	}
+
+	return entry->run;
+}
+
+void TTFRunCache::insert(const void *font, const Common::U32String &str, TextRun *run) {
+	Entry *entry = new Entry();
+	entry->key.font = font;
+	entry->key.str = str;
+	entry->run = run;
+	entry->bytes = sizeof(Entry) + sizeof(TextRun) + run->chars.size() * sizeof(TextRun::Char) + 2 * str.size() * sizeof(Common::u32char_type_t);
+
+	EntryMap::iterator i = _index.find(entry->key);
+	if (i != _index.end())
+		remove(i->_value);
+
+	_entries.push_front(entry);
+	_index[entry->key] = _entries.begin();
+	_bytes += entry->bytes;
+
+	while (_entries.size() > 1 && (_entries.size() > kMaxRuns || _bytes > kMaxBytes))
+		remove(--_entries.end());
+}
+
+void TTFRunCache::removeFont(const void *font) {
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end();) {
+		EntryList::iterator next = i;
+		++next;
+
+		if ((*i)->key.font == font)
+			remove(i);
+
+		i = next;
+	}
+}
+
+void TTFRunCache::remove(EntryList::iterator i) {
+	Entry *entry = *i;
+	_index.erase(entry->key);
+	_entries.erase(i);
+	_bytes -= entry->bytes;
+
+	delete entry->run;
+	delete entry;
+}
+
 class TTFLibrary : public Common::Singleton<TTFLibrary> {
 public:
 	TTFLibrary();
@@ -102,9 +415,25 @@ public:
 
 	bool loadFont(const uint8 *file, const int32 face_index, const uint32 size, FT_Face &face);
 	void closeFont(FT_Face &face);
+
+	/**
+	 * Get the glyph atlas for the given face and settings, creating it if
+	 * no font uses it yet. Each call has to be paired with releaseAtlas().
+	 */
+	TTFGlyphAtlas *getAtlas(const Common::String &key);
+	void releaseAtlas(TTFGlyphAtlas *atlas);
+
+	TTFRunCache &getRunCache() { return _runs; }
+
+	TTFCacheStats getCacheStats() const;
+
 private:
 	FT_Library _library;
 	bool _initialized;
+
+	typedef Common::HashMap<Common::String, TTFGlyphAtlas *> AtlasMap;
+	AtlasMap _atlases;
+	TTFRunCache _runs;
 };
 
 void shutdownTTF() {
@@ -119,6 +448,9 @@ TTFLibrary::TTFLibrary() : _library(), _initialized(false) {
 }
 
 TTFLibrary::~TTFLibrary() {
+	for (AtlasMap::iterator i = _atlases.begin(), end = _atlases.end(); i != end; ++i)
+		delete i->_value;
+
 	if (_initialized) {
 		FT_Done_FreeType(_library);
 		_initialized = false;
@@ -137,6 +469,46 @@ void TTFLibrary::closeFont(FT_Face &face) {
 	FT_Done_Face(face);
 }
 
+TTFGlyphAtlas *TTFLibrary::getAtlas(const Common::String &key) {
+	TTFGlyphAtlas *&atlas = _atlases[key];
+	if (!atlas)
+		atlas = new TTFGlyphAtlas(key);
+
+	atlas->ref();
+	return atlas;
+}
+
+void TTFLibrary::releaseAtlas(TTFGlyphAtlas *atlas) {
+	if (atlas->unref()) {
+		_atlases.erase(atlas->getKey());
+		delete atlas;
+	}
+}
+
+TTFCacheStats TTFLibrary::getCacheStats() const {
+	TTFCacheStats stats;
+	stats.atlases = _atlases.size();
+	stats.atlasPages = 0;
+	stats.atlasGlyphs = 0;
+	stats.atlasBytes = 0;
+
+	for (AtlasMap::const_iterator i = _atlases.begin(), end = _atlases.end(); i != end; ++i) {
+		stats.atlasPages += i->_value->getPageCount();
+		stats.atlasGlyphs += i->_value->getGlyphCount();
+		stats.atlasBytes += i->_value->getMemoryUsage();
+	}
+
+	stats.runs = _runs.getRunCount();
+	stats.runBytes = _runs.getMemoryUsage();
+	stats.runHits = _runs.getHits();
+	stats.runMisses = _runs.getMisses();
+	return stats;
+}
+
+TTFCacheStats getTTFCacheStats() {
+	return g_ttf.getCacheStats();
+}
+
 class TTFFont : public Font {
 public:
 	TTFFont();
@@ -159,6 +531,9 @@ public:
 
 	virtual Common::Rect getBoundingBox(uint32 chr) const;
 
+	virtual const TextRun *getTextRun(const Common::String &str) const;
+	virtual const TextRun *getTextRun(const Common::U32String &str) const;
+
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const;
 	virtual void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const;
 
@@ -172,18 +547,23 @@ private:
 	int _width, _height;
 	int _ascent, _descent;
 
-	struct Glyph {
-		Surface image;
-		int xOffset, yOffset;
-		int advance;
-		FT_UInt slot;
-	};
+	typedef TTFGlyphAtlas::Glyph Glyph;
 
-	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
-	typedef Common::HashMap<uint32, Glyph> GlyphCache;
+	// The glyphs are rendered into an atlas shared with the other fonts
+	// using the same face and settings
+	TTFGlyphAtlas *_atlas;
+	const Glyph *cacheGlyph(FT_UInt slot) const;
+
+	// The glyph of each character used so far, nullptr if there is none
+	typedef Common::HashMap<uint32, const Glyph *> GlyphCache;
 	mutable GlyphCache _glyphs;
-	bool _allowLateCaching;
-	void assureCached(uint32 chr) const;
+	const Glyph *findGlyph(uint32 chr) const;
+
+	// Only the characters 0-255 are supported when there is a mapping
+	bool _hasMapping;
+	uint32 _mapping[256];
+
+	void releaseAtlas();
 
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
@@ -203,24 +583,33 @@ private:
 
 TTFFont::TTFFont()
 	: _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
-	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false) {
+	  _descent(0), _atlas(0), _glyphs(), _hasMapping(false), _loadFlags(FT_LOAD_TARGET_NORMAL),
+	  _renderMode(FT_RENDER_MODE_NORMAL), _hasKerning(false), _fakeBold(false), _fakeItalic(false) {
 }
 
 TTFFont::~TTFFont() {
 	if (_initialized) {
+		g_ttf.getRunCache().removeFont(this);
+		releaseAtlas();
+
 		g_ttf.closeFont(_face);
 
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
 }
 
+void TTFFont::releaseAtlas() {
+	if (_atlas) {
+		g_ttf.releaseAtlas(_atlas);
+		_atlas = 0;
+	}
+
+	_glyphs.clear();
+}
+
 bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode,
 				   uint dpi, TTFRenderMode renderMode, const uint32 *mapping, bool stemDarkening) {
 	if (!g_ttf.isInitialized())
@@ -368,40 +757,42 @@ bool TTFFont::load(uint8 *ttfFile, uint32 sizeFile, int32 faceIndex, bool bold,
 		_loadFlags |= FT_LOAD_NO_BITMAP;
 	}
 
-	if (!mapping) {
-		// Allow loading of all unicode characters.
-		_allowLateCaching = true;
+	// Fonts with the same face and settings render the same glyphs, so they
+	// share an atlas. The whole file is hashed, as the table checksums in
+	// its header are not reliable.
+	uint32 fileHash = 2166136261u;
+	for (uint32 i = 0; i < sizeFile; ++i)
+		fileHash = (fileHash ^ ttfFile[i]) * 16777619u;
+
+	_atlas = g_ttf.getAtlas(Common::String::format("%08x:%u:%d:%ld:%ld:%d:%d:%d:%d:%d", fileHash, sizeFile, faceIndex,
+		(long)_face->size->metrics.x_scale, (long)_face->size->metrics.y_scale, (int)_loadFlags, (int)_renderMode,
+		_fakeBold, _fakeItalic, stemDarkening));
+
+	// Glyphs are rendered when first used. All unicode characters can be
+	// used without a mapping, else only the mapped ones.
+	_hasMapping = (mapping != 0);
+	if (_hasMapping) {
+		for (uint i = 0; i < 256; ++i)
+			_mapping[i] = mapping[i] & 0x7FFFFFFF;
+	}
 
-		// Load all ISO-8859-1 characters.
-		for (uint i = 0; i < 256; ++i) {
-			if (!cacheGlyph(_glyphs[i], i)) {
-				_glyphs.erase(i);
-			}
-		}
-	} else {
-		// We have a fixed map of characters do not load more later.
-		_allowLateCaching = false;
-
-		for (uint i = 0; i < 256; ++i) {
-			const uint32 unicode = mapping[i] & 0x7FFFFFFF;
-			const bool isRequired = (mapping[i] & 0x80000000) != 0;
-			// Check whether loading an important glyph fails and error out if
-			// that is the case.
-			if (!cacheGlyph(_glyphs[i], unicode)) {
-				_glyphs.erase(i);
-				if (isRequired) {
-					g_ttf.closeFont(_face);
-
-					// Don't delete ttfFile as we return fail
-					_ttfFile = 0;
-
-					return false;
-				}
-			}
+	bool hasGlyphs = false;
+	for (uint i = 0; i < 256; ++i) {
+		const bool isRequired = mapping && (mapping[i] & 0x80000000) != 0;
+		if (hasGlyphs && !isRequired)
+			continue;
+
+		if (findGlyph(i)) {
+			hasGlyphs = true;
+		} else if (isRequired) {
+			// Loading an important glyph failed, error out
+			hasGlyphs = false;
+			break;
 		}
 	}
 
-	if (_glyphs.size() == 0) {
+	if (!hasGlyphs) {
+		releaseAtlas();
 		g_ttf.closeFont(_face);
 
 		// Don't delete ttfFile as we return fail
@@ -550,57 +941,85 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
-
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
-		return 0;
-	}
-
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
-		return 0;
-	}
-
+	const Glyph *leftGlyph = findGlyph(left);
+	const Glyph *rightGlyph = findGlyph(right);
 	if (!leftGlyph || !rightGlyph)
 		return 0;
 
+	int offset;
+	if (_atlas->findKerning(leftGlyph->slot, rightGlyph->slot, offset))
+		return offset;
+
 	FT_Vector kerningVector;
-	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	FT_Get_Kerning(_face, leftGlyph->slot, rightGlyph->slot, FT_KERNING_DEFAULT, &kerningVector);
+	offset = kerningVector.x / 64;
+
+	_atlas->addKerning(leftGlyph->slot, rightGlyph->slot, offset);
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		const int xOffset = glyph->xOffset;
+		const int yOffset = glyph->yOffset;
+		return Common::Rect(xOffset, yOffset, xOffset + glyph->area.width(), yOffset + glyph->area.height());
+	}
+}
+
+const TextRun *TTFFont::getTextRun(const Common::String &str) const {
+	if (str.empty())
+		return nullptr;
+
+	// The characters are the bytes of the string
+	return getTextRun(Common::U32String(str, Common::kLatin1));
+}
+
+const TextRun *TTFFont::getTextRun(const Common::U32String &str) const {
+	if (str.empty())
+		return nullptr;
+
+	TTFRunCache &runs = g_ttf.getRunCache();
+
+	const TextRun *cachedRun = runs.find(this, str);
+	if (cachedRun)
+		return cachedRun;
+
+	TextRun *run = new TextRun();
+	run->chars.resize(str.size());
+
+	int x = 0;
+	uint32 last = 0;
+	for (uint i = 0; i < str.size(); ++i) {
+		const uint32 cur = str[i];
+		x += getKerningOffset(last, cur);
+		last = cur;
+
+		TextRun::Char &c = run->chars[i];
+		c.chr = cur;
+		c.x = x;
+		c.box = getBoundingBox(cur);
+
+		x += getCharWidth(cur);
 	}
+
+	run->width = x;
+
+	runs.insert(this, str, run);
+	return run;
 }
 
 namespace {
@@ -671,12 +1090,12 @@ void TTFFont::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 col
 
 void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		const uint32 *transparentColor) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyphEntry = findGlyph(chr);
+	if (!glyphEntry || glyphEntry->page < 0)
 		return;
 
-	const Glyph &glyph = glyphEntry->_value;
+	const Glyph &glyph = *glyphEntry;
+	const Surface image = _atlas->getImage(glyph);
 
 	x += glyph.xOffset;
 	y += glyph.yOffset;
@@ -686,10 +1105,10 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = image.w;
+	int h = image.h;
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	const uint8 *srcPos = (const uint8 *)image.getPixels();
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -705,7 +1124,7 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * image.pitch;
 		h += y;
 		y = 0;
 	}
@@ -734,38 +1153,49 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += image.pitch;
 		}
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, image.pitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, image.pitch, w, h, color, dst->format, transparentColor);
 	}
 }
 
-bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
-	FT_UInt slot = FT_Get_Char_Index(_face, chr);
-	if (!slot)
-		return false;
+const TTFFont::Glyph *TTFFont::findGlyph(uint32 chr) const {
+	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry != _glyphs.end())
+		return glyphEntry->_value;
 
-	glyph.slot = slot;
+	const Glyph *glyph = nullptr;
 
-	// We use the light target and render mode to improve the looks of the
-	// glyphs. It is most noticable in FreeSansBold.ttf, where otherwise the
-	// 't' glyph looks like it is cut off on the right side.
-	if (FT_Load_Glyph(_face, slot, _loadFlags))
-		return false;
+	if (!_hasMapping || chr < 256) {
+		FT_UInt slot = FT_Get_Char_Index(_face, _hasMapping ? _mapping[chr] : chr);
 
-	if (FT_Render_Glyph(_face->glyph, _renderMode))
-		return false;
+		if (slot) {
+			if (_atlas->hasGlyph(slot))
+				glyph = _atlas->getGlyph(slot);
+			else
+				glyph = cacheGlyph(slot);
+		}
+	}
 
-	if (_face->glyph->format != FT_GLYPH_FORMAT_BITMAP)
-		return false;
+	_glyphs[chr] = glyph;
+	return glyph;
+}
 
-	glyph.xOffset = _face->glyph->bitmap_left;
-	glyph.yOffset = _ascent - _face->glyph->bitmap_top;
+const TTFFont::Glyph *TTFFont::cacheGlyph(FT_UInt slot) const {
+	// We use the light target and render mode to improve the looks of the
+	// glyphs. It is most noticable in FreeSansBold.ttf, where otherwise the
+	// 't' glyph looks like it is cut off on the right side.
+	if (FT_Load_Glyph(_face, slot, _loadFlags) ||
+	    FT_Render_Glyph(_face->glyph, _renderMode) ||
+	    _face->glyph->format != FT_GLYPH_FORMAT_BITMAP) {
+		_atlas->addMissingGlyph(slot);
+		return nullptr;
+	}
 
-	glyph.advance = ftCeil26_6(_face->glyph->advance.x);
+	int advance = ftCeil26_6(_face->glyph->advance.x);
 
 	const FT_Bitmap *bitmap;
 #if FAKE_BOLD == 1
@@ -775,28 +1205,29 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	if (_fakeBold) {
 #if FAKE_BOLD >= 2
 		// Embolden by 1 pixel in x and 0 in y
-		glyph.advance += 1;
-
-		if (FT_GlyphSlot_Own_Bitmap(_face->glyph))
-			return false;
+		advance += 1;
 
 		// That's 26.6 fixed-point units
-		if (FT_Bitmap_Embolden(_face->glyph->library, &_face->glyph->bitmap, 1 << 6, 0))
-			return false;
+		if (FT_GlyphSlot_Own_Bitmap(_face->glyph) ||
+		    FT_Bitmap_Embolden(_face->glyph->library, &_face->glyph->bitmap, 1 << 6, 0)) {
+			_atlas->addMissingGlyph(slot);
+			return nullptr;
+		}
 
 		bitmap = &_face->glyph->bitmap;
 #elif FAKE_BOLD >= 1
 		FT_Bitmap_New(&ownBitmap);
 
-		if (FT_Bitmap_Copy(_face->glyph->library, &_face->glyph->bitmap, &ownBitmap))
-			return false;
-
 		// Embolden by 1 pixel in x and 0 in y
-		glyph.advance += 1;
+		advance += 1;
 
 		// That's 26.6 fixed-point units
-		if (FT_Bitmap_Embolden(_face->glyph->library, &ownBitmap, 1 << 6, 0))
-			return false;
+		if (FT_Bitmap_Copy(_face->glyph->library, &_face->glyph->bitmap, &ownBitmap) ||
+		    FT_Bitmap_Embolden(_face->glyph->library, &ownBitmap, 1 << 6, 0)) {
+			FT_Bitmap_Done(_face->glyph->library, &ownBitmap);
+			_atlas->addMissingGlyph(slot);
+			return nullptr;
+		}
 
 		bitmap = &ownBitmap;
 #else
@@ -807,8 +1238,20 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		bitmap = &_face->glyph->bitmap;
 	}
 
+	if (bitmap->pixel_mode != FT_PIXEL_MODE_MONO && bitmap->pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
+#if FAKE_BOLD == 1
+		if (_fakeBold)
+			FT_Bitmap_Done(_face->glyph->library, &ownBitmap);
+#endif
+		_atlas->addMissingGlyph(slot);
+		return nullptr;
+	}
 
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
+	Glyph *glyph = _atlas->addGlyph(slot, bitmap->width, bitmap->rows);
+	glyph->xOffset = _face->glyph->bitmap_left;
+	glyph->yOffset = _ascent - _face->glyph->bitmap_top;
+	glyph->advance = advance;
 
 	const uint8 *src = bitmap->buffer;
 	int srcPitch = bitmap->pitch;
@@ -817,8 +1260,9 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		srcPitch = -srcPitch;
 	}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
-	memset(dst, 0, glyph.image.h * glyph.image.pitch);
+	// The image in the atlas is cleared already
+	Surface image = _atlas->getImage(*glyph);
+	uint8 *dst = (uint8 *)image.getPixels();
 
 	switch (bitmap->pixel_mode) {
 	case FT_PIXEL_MODE_MONO:
@@ -831,12 +1275,12 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = 255;
 
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += image.pitch;
 			src += srcPitch;
 		}
 		break;
@@ -844,15 +1288,13 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	case FT_PIXEL_MODE_GRAY:
 		for (int y = 0; y < (int)bitmap->rows; ++y) {
 			memcpy(dst, src, bitmap->width);
-			dst += glyph.image.pitch;
+			dst += image.pitch;
 			src += srcPitch;
 		}
 		break;
 
 	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
-		return false;
+		break;
 	}
 
 #if FAKE_BOLD == 1
@@ -861,18 +1303,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	}
 #endif
 
-	return true;
-}
-
-void TTFFont::assureCached(uint32 chr) const {
-	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
-		return;
-	}
-
-	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
-	}
+	return glyph;
 }
 
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping, bool stemDarkening) {
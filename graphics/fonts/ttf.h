@@ -139,6 +139,25 @@ Font *loadTTFFontFromArchive(const Common::String &filename, int size, TTFSizeMo
  */
 Font *findTTFace(const Common::Array<Common::String> &files, const Common::U32String &faceName, bool bold, bool italic, int size, uint dpi = 0, TTFRenderMode renderMode = kTTFRenderModeLight, const uint32 *mapping = 0);
 
+/**
+ * Statistics about the caches shared by all TTF fonts.
+ */
+struct TTFCacheStats {
+	uint atlases;     ///< Glyph atlases, one for each face, size and render settings in use.
+	uint atlasPages;  ///< Pages the glyph images are packed into.
+	uint atlasGlyphs; ///< Glyphs rendered into the atlases.
+	uint atlasBytes;  ///< Memory used by the pages.
+	uint runs;        ///< Strings whose layout is cached.
+	uint runBytes;    ///< Approximate memory used by the cached layouts.
+	uint runHits;     ///< Layouts found in the cache.
+	uint runMisses;   ///< Layouts that had to be computed.
+};
+
+/**
+ * Get statistics about the glyph atlases and the string layout cache.
+ */
+TTFCacheStats getTTFCacheStats();
+
 void shutdownTTF();
 
 } // End of namespace Graphics
@@ -99,6 +99,12 @@
 #include "graphics/scaler/intern.h"
 #include "graphics/scaler/edge.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /* Randomly XORs one of 2x2 or 3x3 resized pixels in order to indicate
  * which pixels have been redrawn.  Useful for seeing which areas of
  * the screen are being redrawn.  Good for seeing dirty rects, full screen
@@ -306,6 +312,36 @@ uint16 convertTo16Bit(const typename ColorMask::PixelType p) {
 }
 
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+/**
+ * Calculate the deltas of the 8 outer greyscale values of a 3x3 window from
+ * the center one, and return their sum of squares.
+ */
+static inline int32 calcGreyscaleDiffsSIMD(const int16 *bplane, int16 *diffs) {
+#if defined(__SSE2__)
+	// Skip the center value: 0-3 and 5-8.
+	const __m128i window = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)bplane), _mm_loadl_epi64((const __m128i *)(bplane + 5)));
+	const __m128i diff = _mm_sub_epi16(window, _mm_set1_epi16(bplane[4]));
+	_mm_storeu_si128((__m128i *)diffs, diff);
+
+	__m128i sum = _mm_madd_epi16(diff, diff);
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+#else
+	// Skip the center value: 0-3 and 5-8.
+	const int16x8_t window = vcombine_s16(vld1_s16(bplane), vld1_s16(bplane + 5));
+	const int16x8_t diff = vsubq_s16(window, vdupq_n_s16(bplane[4]));
+	vst1q_s16(diffs, diff);
+
+	int32x4_t squares = vmull_s16(vget_low_s16(diff), vget_low_s16(diff));
+	squares = vmlal_s16(squares, vget_high_s16(diff), vget_high_s16(diff));
+	const int64x2_t sum = vpaddlq_s32(squares);
+	return (int32)(vgetq_lane_s64(sum, 0) + vgetq_lane_s64(sum, 1));
+#endif
+}
+#endif
+
 template<typename ColorMask>
 int16 *EdgePlugin::chooseGreyscale(typename ColorMask::PixelType *pixels) {
 	int i, j;
@@ -330,6 +366,13 @@ int16 *EdgePlugin::chooseGreyscale(typename ColorMask::PixelType *pixels) {
 			*bptr++ = grey_ptr[convertTo16Bit<ColorMask>(*pptr++)];
 		bptr = _bplanes[i];
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+		if (_useSimd) {
+			scores[i] = calcGreyscaleDiffsSIMD(bptr, _greyscaleDiffs[i]);
+			continue;
+		}
+#endif
+
 		center = grey_ptr[convertTo16Bit<ColorMask>(pixels[4])];
 		diff_ptr = _greyscaleDiffs[i];
 
@@ -3531,7 +3574,7 @@ void EdgePlugin::initTables(const uint8 *srcPtr, uint32 srcPitch,
 	}
 }
 
-EdgePlugin::EdgePlugin() : SourceScaler() {
+EdgePlugin::EdgePlugin() : SourceScaler(), _useSimd(true) {
 	_factor = 2;
 	_factors.push_back(2);
 	_factors.push_back(3);
@@ -37,6 +37,13 @@ public:
 	virtual const char *getName() const override;
 	virtual const char *getPrettyName() const override;
 
+	/**
+	 * Enable or disable computing the greyscale deltas of a 3x3 window with
+	 * SIMD instructions. The scalar code is kept as the reference. The eight
+	 * deltas fill a single SSE2 or NEON register, so AVX2 would not help.
+	 */
+	void enableSimd(bool enable) { _useSimd = enable; }
+
 protected:
 
 	virtual void internScale(const uint8 *srcPtr, uint32 srcPitch,
@@ -174,6 +181,7 @@ private:
 	int8 _simSum;                          ///< sum of similarity matrix
 	int16 _greyscaleDiffs[3][8];
 	int16 _bplanes[3][9];
+	bool _useSimd;
 };
 
 
@@ -22,6 +22,17 @@
 #include "graphics/scaler/hq.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
+#include "common/array.h"
+#include "common/cpudetect.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef SCUMMVM_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 // RGB-to-YUV lookup table
 extern "C" {
@@ -214,13 +225,227 @@ static inline uint32 ConvertYUV(uint32 x) {
 	return RGBtoYUV[r | g | b];
 }
 
+namespace {
+
+/**
+ * Compute the difference patterns of count pixels from the YUV values of the
+ * rows above, at and below them. Each row starts one pixel left of the first
+ * pixel. Returns the number of pixels handled, the rest is left to the
+ * caller.
+ */
+typedef int (*PatternKernel)(const int32 *yuvAbove, const int32 *yuvRow, const int32 *yuvBelow, int count, uint8 *patterns);
+
+/*
+ * The Y, U and V values are bytes, so the SIMD kernels compare all three at
+ * once with byte arithmetic: a pixel differs from a neighbour when one of
+ * the absolute differences exceeds the threshold of its channel.
+ */
+static const uint32 kYUVThresholds = 0x00300706;
+
+#if defined(__SSE2__)
+
+static int computePatternsSSE2(const int32 *yuvAbove, const int32 *yuvRow, const int32 *yuvBelow, int count, uint8 *patterns) {
+	const __m128i thresholds = _mm_set1_epi32(kYUVThresholds);
+	const __m128i zero = _mm_setzero_si128();
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		const __m128i yuv5 = _mm_loadu_si128((const __m128i *)(yuvRow + x + 1));
+
+		// Neighbours in pattern bit order: w1, w2, w3, w4, w6, w7, w8, w9
+		const int32 *neighbours[8] = {
+			yuvAbove + x, yuvAbove + x + 1, yuvAbove + x + 2,
+			yuvRow + x, yuvRow + x + 2,
+			yuvBelow + x, yuvBelow + x + 1, yuvBelow + x + 2
+		};
+
+		__m128i pattern = zero;
+		for (int i = 0; i < 8; ++i) {
+			const __m128i yuv = _mm_loadu_si128((const __m128i *)neighbours[i]);
+			const __m128i diff = _mm_or_si128(_mm_subs_epu8(yuv5, yuv), _mm_subs_epu8(yuv, yuv5));
+			const __m128i similar = _mm_cmpeq_epi32(_mm_subs_epu8(diff, thresholds), zero);
+			pattern = _mm_or_si128(pattern, _mm_andnot_si128(similar, _mm_set1_epi32(1 << i)));
+		}
+
+		pattern = _mm_packs_epi32(pattern, pattern);
+		pattern = _mm_packus_epi16(pattern, pattern);
+		const uint32 packed = (uint32)_mm_cvtsi128_si32(pattern);
+		memcpy(patterns + x, &packed, 4);
+	}
+	return x;
+}
+
+#ifdef SCUMMVM_TARGET_AVX2
+
+SCUMMVM_TARGET_AVX2
+static int computePatternsAVX2(const int32 *yuvAbove, const int32 *yuvRow, const int32 *yuvBelow, int count, uint8 *patterns) {
+	const __m256i thresholds = _mm256_set1_epi32(kYUVThresholds);
+	const __m256i zero = _mm256_setzero_si256();
+
+	int x = 0;
+	for (; x + 8 <= count; x += 8) {
+		const __m256i yuv5 = _mm256_loadu_si256((const __m256i *)(yuvRow + x + 1));
+
+		// Neighbours in pattern bit order: w1, w2, w3, w4, w6, w7, w8, w9
+		const int32 *neighbours[8] = {
+			yuvAbove + x, yuvAbove + x + 1, yuvAbove + x + 2,
+			yuvRow + x, yuvRow + x + 2,
+			yuvBelow + x, yuvBelow + x + 1, yuvBelow + x + 2
+		};
+
+		__m256i pattern = zero;
+		for (int i = 0; i < 8; ++i) {
+			const __m256i yuv = _mm256_loadu_si256((const __m256i *)neighbours[i]);
+			const __m256i diff = _mm256_or_si256(_mm256_subs_epu8(yuv5, yuv), _mm256_subs_epu8(yuv, yuv5));
+			const __m256i similar = _mm256_cmpeq_epi32(_mm256_subs_epu8(diff, thresholds), zero);
+			pattern = _mm256_or_si256(pattern, _mm256_andnot_si256(similar, _mm256_set1_epi32(1 << i)));
+		}
+
+		// The packs work on each half, which leaves four patterns in each
+		pattern = _mm256_packs_epi32(pattern, pattern);
+		pattern = _mm256_packus_epi16(pattern, pattern);
+		const uint32 low = (uint32)_mm_cvtsi128_si32(_mm256_castsi256_si128(pattern));
+		const uint32 high = (uint32)_mm_cvtsi128_si32(_mm256_extracti128_si256(pattern, 1));
+		memcpy(patterns + x, &low, 4);
+		memcpy(patterns + x + 4, &high, 4);
+	}
+	return x;
+}
+
+#endif
+
+#elif defined(__ARM_NEON)
+
+static int computePatternsNEON(const int32 *yuvAbove, const int32 *yuvRow, const int32 *yuvBelow, int count, uint8 *patterns) {
+	const uint8x16_t thresholds = vreinterpretq_u8_u32(vdupq_n_u32(kYUVThresholds));
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		const uint8x16_t yuv5 = vreinterpretq_u8_s32(vld1q_s32(yuvRow + x + 1));
+
+		// Neighbours in pattern bit order: w1, w2, w3, w4, w6, w7, w8, w9
+		const int32 *neighbours[8] = {
+			yuvAbove + x, yuvAbove + x + 1, yuvAbove + x + 2,
+			yuvRow + x, yuvRow + x + 2,
+			yuvBelow + x, yuvBelow + x + 1, yuvBelow + x + 2
+		};
+
+		uint32x4_t pattern = vdupq_n_u32(0);
+		for (int i = 0; i < 8; ++i) {
+			const uint8x16_t yuv = vreinterpretq_u8_s32(vld1q_s32(neighbours[i]));
+			const uint32x4_t exceeds = vreinterpretq_u32_u8(vcgtq_u8(vabdq_u8(yuv5, yuv), thresholds));
+			const uint32x4_t differs = vtstq_u32(exceeds, exceeds);
+			pattern = vorrq_u32(pattern, vandq_u32(differs, vdupq_n_u32(1 << i)));
+		}
+
+		const uint16x4_t narrow = vmovn_u32(pattern);
+		const uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+		const uint32 packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+		memcpy(patterns + x, &packed, 4);
+	}
+	return x;
+}
+
+#else
+
+static int computePatternsNone(const int32 *yuvAbove, const int32 *yuvRow, const int32 *yuvBelow, int count, uint8 *patterns) {
+	return 0;
+}
+
+#endif
+
+/** The fastest pattern kernel the CPU supports. */
+static PatternKernel selectPatternKernel() {
+#if defined(__SSE2__)
+#ifdef SCUMMVM_TARGET_AVX2
+	if (Common::hasCpuFeature(Common::kCpuFeatureAVX2))
+		return computePatternsAVX2;
+#endif
+	return computePatternsSSE2;
+#elif defined(__ARM_NEON)
+	return computePatternsNEON;
+#else
+	return computePatternsNone;
+#endif
+}
+
+/**
+ * Computes the difference patterns of the rows of a frame, from the top
+ * down. Bit n of a pattern is set when the n-th neighbour (w1 to w9,
+ * skipping the pixel itself) differs noticeably from the pixel. Each source
+ * row is converted to YUV once, instead of once per pixel it surrounds.
+ */
+template<typename ColorMask>
+class PatternRows {
+public:
+	typedef typename ColorMask::PixelType Pixel;
+
+	PatternRows(PatternKernel kernel, int width) : _kernel(kernel), _width(width), _rows(0) {
+		_yuv.resize(3 * (width + 2));
+		_patterns.resize(width);
+		for (int row = 0; row < 3; ++row)
+			_yuvRows[row] = &_yuv[row * (width + 2)];
+	}
+
+	/** Compute the patterns of the next row, which starts at p. */
+	const uint8 *compute(const Pixel *p, uint32 nextlineSrc) {
+		if (_rows++ == 0) {
+			convert(p - nextlineSrc, _yuvRows[0]);
+			convert(p, _yuvRows[1]);
+		} else {
+			int32 *above = _yuvRows[0];
+			_yuvRows[0] = _yuvRows[1];
+			_yuvRows[1] = _yuvRows[2];
+			_yuvRows[2] = above;
+		}
+		convert(p + nextlineSrc, _yuvRows[2]);
+
+		const int32 *yuv[3] = { _yuvRows[0], _yuvRows[1], _yuvRows[2] };
+		uint8 *patterns = &_patterns[0];
+		int x = _kernel(yuv[0], yuv[1], yuv[2], _width, patterns);
+
+		// Equal pixels convert to equal YUV values, so unlike the per pixel
+		// code no pixel comparison is needed.
+		for (; x < _width; ++x) {
+			const int yuv5 = yuv[1][x + 1];
+			int pattern = 0;
+			if (diffYUV(yuv5, yuv[0][x]))     pattern |= 0x0001;
+			if (diffYUV(yuv5, yuv[0][x + 1])) pattern |= 0x0002;
+			if (diffYUV(yuv5, yuv[0][x + 2])) pattern |= 0x0004;
+			if (diffYUV(yuv5, yuv[1][x]))     pattern |= 0x0008;
+			if (diffYUV(yuv5, yuv[1][x + 2])) pattern |= 0x0010;
+			if (diffYUV(yuv5, yuv[2][x]))     pattern |= 0x0020;
+			if (diffYUV(yuv5, yuv[2][x + 1])) pattern |= 0x0040;
+			if (diffYUV(yuv5, yuv[2][x + 2])) pattern |= 0x0080;
+			patterns[x] = pattern;
+		}
+		return patterns;
+	}
+
+private:
+	/** Convert a row and the pixels left and right of it. */
+	void convert(const Pixel *line, int32 *yuv) const {
+		for (int x = -1; x <= _width; ++x)
+			yuv[x + 1] = (sizeof(Pixel) == 2 ? RGBtoYUV[line[x]] : ConvertYUV<ColorMask>(line[x]));
+	}
+
+	PatternKernel _kernel;
+	int _width;
+	int _rows;
+	Common::Array<int32> _yuv;
+	Common::Array<uint8> _patterns;
+	int32 *_yuvRows[3];	///< Above, at and below the current row
+};
+
+} // End of anonymous namespace
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (see http://www.hiend3d.com/hq2x.html).
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, PatternKernel patternKernel) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -242,6 +467,8 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	PatternRows<ColorMask> patternRows(patternKernel, width);
+
 	while (height--) {
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
@@ -251,6 +478,8 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
 
+		const uint8 *patterns = patternKernel ? patternRows.compute(p, nextlineSrc) : nullptr;
+
 		int tmpWidth = width;
 		while (tmpWidth--) {
 			p++;
@@ -260,15 +489,19 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			if (patterns) {
+				pattern = *patterns++;
+			} else {
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
@@ -2157,7 +2390,7 @@ void HQ3x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
+static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, PatternKernel patternKernel) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int  w1, w2, w3, w4, w5, w6, w7, w8, w9;
@@ -2180,6 +2413,8 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	//	 | w7 | w8 | w9 |
 	//	 +----+----+----+
 
+	PatternRows<ColorMask> patternRows(patternKernel, width);
+
 	while (height--) {
 		w1 = *(p - 1 - nextlineSrc);
 		w4 = *(p - 1);
@@ -2189,6 +2424,8 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 		w5 = *(p);
 		w8 = *(p + nextlineSrc);
 
+		const uint8 *patterns = patternKernel ? patternRows.compute(p, nextlineSrc) : nullptr;
+
 		int tmpWidth = width;
 		while (tmpWidth--) {
 			p++;
@@ -2198,15 +2435,19 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			if (patterns) {
+				pattern = *patterns++;
+			} else {
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
@@ -4988,7 +5229,7 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 	}
 }
 
-HQPlugin::HQPlugin() {
+HQPlugin::HQPlugin() : _useSimd(true) {
 	_factor = 2;
 	_factors.push_back(2);
 	_factors.push_back(3);
@@ -5015,6 +5256,8 @@ void HQPlugin::deinitialize() {
 
 void HQPlugin::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) {
+	const PatternKernel patternKernel = _useSimd ? selectPatternKernel() : nullptr;
+
 	if (_format.bytesPerPixel == 2) {
 		switch (_factor) {
 #ifdef USE_NASM
@@ -5028,18 +5271,18 @@ void HQPlugin::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 		case 2:
 			if (_format.gLoss == 2)
 				HQ2x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			else
 				HQ2x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			break;
 		case 3:
 			if (_format.gLoss == 2)
 				HQ3x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			else
 				HQ3x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			break;
 #endif
 		}
@@ -5048,18 +5291,18 @@ void HQPlugin::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 		case 2:
 			if (_format.aLoss == 0)
 				HQ2x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			else
 				HQ2x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			break;
 		case 3:
 			if (_format.aLoss == 0)
 				HQ3x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			else
 				HQ3x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-						dstPitch, width, height);
+						dstPitch, width, height, patternKernel);
 			break;
 		}
 	}
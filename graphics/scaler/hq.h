@@ -32,12 +32,22 @@ public:
 	virtual uint increaseFactor() override;
 	virtual uint decreaseFactor() override;
 	virtual bool canDrawCursor() const override { return false; }
+	virtual bool isBandSafe() const override { return true; }
 	virtual uint extraPixels() const override { return 1; }
 	virtual const char *getName() const override;
 	virtual const char *getPrettyName() const override;
+
+	/**
+	 * Enable or disable computing the difference patterns of a row at once
+	 * with SIMD instructions. The per pixel code is kept as the reference.
+	 * AVX2 is used when the CPU has it, see Common::hasCpuFeature().
+	 */
+	void enableSimd(bool enable) { _useSimd = enable; }
 protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) override;
+private:
+	bool _useSimd;
 };
 
 
@@ -30,6 +30,7 @@ public:
 	virtual uint increaseFactor() override;
 	virtual uint decreaseFactor() override;
 	virtual bool canDrawCursor() const override { return true; }
+	virtual bool isBandSafe() const override { return true; }
 	virtual uint extraPixels() const override { return 0; }
 	virtual const char *getName() const override;
 	virtual const char *getPrettyName() const override;
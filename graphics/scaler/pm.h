@@ -32,6 +32,7 @@ public:
 	virtual uint increaseFactor() override;
 	virtual uint decreaseFactor() override;
 	virtual bool canDrawCursor() const override { return false; }
+	virtual bool isBandSafe() const override { return true; }
 	virtual uint extraPixels() const override { return 1; }
 	virtual const char *getName() const override;
 	virtual const char *getPrettyName() const override;
@@ -49,6 +49,9 @@ public:
 	virtual uint increaseFactor() override;
 	virtual uint decreaseFactor() override;
 	virtual bool canDrawCursor() const override { return true; }
+	// The Scale4x intermediate buffer makes the last column depend on the
+	// rows scaled before, so only the other factors give identical bands.
+	virtual bool isBandSafe() const override { return _factor != 4; }
 	virtual uint extraPixels() const override { return 4; }
 	virtual const char *getName() const override;
 	virtual const char *getPrettyName() const override;
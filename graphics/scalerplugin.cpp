@@ -21,6 +21,9 @@
 
 #include "graphics/scalerplugin.h"
 
+#include "common/jobsystem.h"
+#include "common/util.h"
+
 void ScalerPluginObject::initialize(const Graphics::PixelFormat &format) {
 	_format = format;
 }
@@ -60,6 +63,68 @@ void ScalerPluginObject::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstP
 	}
 }
 
+namespace {
+enum {
+	/** Minimum number of source rows of a band. */
+	kMinBandHeight = 16,
+	/** Maximum number of bands a rect is split into. */
+	kMaxBands = 16
+};
+
+class ScaleBandJob : public Common::Job {
+public:
+	ScalerPluginObject *scaler;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width, height, x, y;
+
+	virtual void run() override {
+		scaler->scale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+	}
+};
+} // End of anonymous namespace
+
+void ScalerPluginObject::scaleBanded(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+	                                 uint32 dstPitch, int width, int height, int x, int y) {
+	int bands = 1;
+	if (isBandSafe()) {
+		bands = MIN<int>(JobSys.getWorkerCount() + 1, height / kMinBandHeight);
+		bands = MIN<int>(bands, kMaxBands);
+	}
+
+	if (bands < 2) {
+		scale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+		return;
+	}
+
+	// Every band reads the rows around it from the shared source, so the
+	// bands only have to be disjoint in the destination.
+	ScaleBandJob jobs[kMaxBands];
+	Common::JobGroup group;
+	int top = 0;
+	for (int i = 0; i < bands; ++i) {
+		const int bottom = height * (i + 1) / bands;
+
+		ScaleBandJob &job = jobs[i];
+		job.scaler = this;
+		job.srcPtr = srcPtr + top * srcPitch;
+		job.srcPitch = srcPitch;
+		job.dstPtr = dstPtr + top * _factor * dstPitch;
+		job.dstPitch = dstPitch;
+		job.width = width;
+		job.height = bottom - top;
+		job.x = x;
+		job.y = y + top;
+		JobSys.submit(&job, &group);
+
+		top = bottom;
+	}
+
+	group.wait();
+}
+
 SourceScaler::SourceScaler() : _width(0), _height(0), _oldSrc(NULL), _enable(false) {
 }
 
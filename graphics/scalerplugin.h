@@ -59,6 +59,19 @@ public:
 	void scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	           uint32 dstPitch, int width, int height, int x, int y);
 
+	/**
+	 * Scale a rect, splitting it into horizontal bands which are scaled in
+	 * parallel by the job system. Falls back to scale() when the scaler is
+	 * not band safe, when there are no worker threads or when the rect is
+	 * too small to be worth splitting.
+	 *
+	 * The parameters are the same as for scale(). The source buffer must
+	 * contain valid data extraPixels() rows above and below the rect, just
+	 * as when scaling the whole rect at once.
+	 */
+	void scaleBanded(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+	                 uint32 dstPitch, int width, int height, int x, int y);
+
 	/**
 	 * Increase the factor of scaling.
 	 * @return The new factor
@@ -110,6 +123,14 @@ public:
 	 */
 	virtual bool canDrawCursor() const = 0;
 
+	/**
+	 * Whether disjoint row ranges of the same rect can be scaled at the same
+	 * time from different threads. Band safe scalers only read the source,
+	 * including the extraPixels() rows around each band, and only write the
+	 * destination rows of the band. They keep no state between calls.
+	 */
+	virtual bool isBandSafe() const { return false; }
+
 	/**
 	 * This value will be displayed on the GUI.
 	 */
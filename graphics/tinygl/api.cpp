@@ -28,6 +28,8 @@
 
 #include "graphics/tinygl/zgl.h"
 
+#include "common/jobsystem.h"
+
 // glVertex
 
 void tglVertex4f(float x, float y, float z, float w) {
@@ -690,3 +692,9 @@ void tglEnableDirtyRects(bool enable) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	c->_enableDirtyRectangles = enable;
 }
+
+void tglEnableTiledRendering(bool enable) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	// The bands are only worth it when other threads render some of them
+	c->_enableTiledRendering = enable && JobSys.getWorkerCount() > 0;
+}
@@ -850,6 +850,7 @@ void tglTexCoordPointer(TGLint size, TGLenum type, TGLsizei stride, const TGLvoi
 void tglPolygonOffset(TGLfloat factor, TGLfloat units);
 
 void tglEnableDirtyRects(bool enable);
+void tglEnableTiledRendering(bool enable);
 
 void tglDebug(int mode);
 
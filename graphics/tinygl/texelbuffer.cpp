@@ -25,6 +25,12 @@
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/texelbuffer.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Graphics {
 
 #define ZB_POINT_ST_UNIT (1 << ZB_POINT_ST_FRAC_BITS)
@@ -77,15 +83,68 @@ void TexelBuffer::getARGBAt(
 	);
 }
 
-// Nearest: store texture in original size.
+void TexelBuffer::getARGBAt(
+	unsigned int wrap_s, unsigned int wrap_t,
+	const int *s, const int *t,
+	uint32 *argb
+) const {
+	unsigned int pixel[4], ds[4], dt[4];
+#if defined(__SSE2__)
+	// Repeating textures, which is what the games use, are wrapped with a
+	// mask. The coordinates are below 2^31, so the signed conversions to
+	// and from float give the same results as the unsigned ones above.
+	if (wrap_s == TGL_REPEAT && wrap_t == TGL_REPEAT) {
+		const __m128i mask = _mm_set1_epi32(_fracTextureMask);
+		const __m128i fracMask = _mm_set1_epi32(ZB_POINT_ST_FRAC_MASK);
+		const __m128i x = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_loadu_si128((const __m128i *)s), mask)), _mm_set1_ps(_widthRatio)));
+		const __m128i y = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_loadu_si128((const __m128i *)t), mask)), _mm_set1_ps(_heightRatio)));
+		// The row and the width both fit in 16 bits
+		const __m128i row = _mm_madd_epi16(_mm_srli_epi32(y, ZB_POINT_ST_FRAC_BITS), _mm_set1_epi32(_width));
+		_mm_storeu_si128((__m128i *)pixel, _mm_add_epi32(_mm_srli_epi32(x, ZB_POINT_ST_FRAC_BITS), row));
+		_mm_storeu_si128((__m128i *)ds, _mm_and_si128(x, fracMask));
+		_mm_storeu_si128((__m128i *)dt, _mm_and_si128(y, fracMask));
+		getARGBAt(pixel, ds, dt, argb);
+		return;
+	}
+#elif defined(__ARM_NEON)
+	// Repeating textures, which is what the games use, are wrapped with a mask
+	if (wrap_s == TGL_REPEAT && wrap_t == TGL_REPEAT) {
+		const uint32x4_t mask = vdupq_n_u32(_fracTextureMask);
+		const uint32x4_t fracMask = vdupq_n_u32(ZB_POINT_ST_FRAC_MASK);
+		const uint32x4_t x = vcvtq_u32_f32(vmulq_n_f32(vcvtq_f32_u32(vandq_u32(vreinterpretq_u32_s32(vld1q_s32(s)), mask)), _widthRatio));
+		const uint32x4_t y = vcvtq_u32_f32(vmulq_n_f32(vcvtq_f32_u32(vandq_u32(vreinterpretq_u32_s32(vld1q_s32(t)), mask)), _heightRatio));
+		vst1q_u32(pixel, vmlaq_n_u32(vshrq_n_u32(x, ZB_POINT_ST_FRAC_BITS), vshrq_n_u32(y, ZB_POINT_ST_FRAC_BITS), _width));
+		vst1q_u32(ds, vandq_u32(x, fracMask));
+		vst1q_u32(dt, vandq_u32(y, fracMask));
+		getARGBAt(pixel, ds, dt, argb);
+		return;
+	}
+#endif
+	for (int i = 0; i < 4; i++) {
+		unsigned int x, y;
+		x = wrap(wrap_s, s[i], _fracTextureUnit, _fracTextureMask) * _widthRatio;
+		y = wrap(wrap_t, t[i], _fracTextureUnit, _fracTextureMask) * _heightRatio;
+		pixel[i] = (x >> ZB_POINT_ST_FRAC_BITS) + (y >> ZB_POINT_ST_FRAC_BITS) * _width;
+		ds[i] = x & ZB_POINT_ST_FRAC_MASK;
+		dt[i] = y & ZB_POINT_ST_FRAC_MASK;
+	}
+	getARGBAt(pixel, ds, dt, argb);
+}
+
+// Nearest: store texture in original size, converted to 0xAARRGGBB so that
+// looking up a texel is a single load.
 NearestTexelBuffer::NearestTexelBuffer(const PixelBuffer &buf, unsigned int width, unsigned int height, unsigned int textureSize) : TexelBuffer(width, height, textureSize) {
 	unsigned int pixel_count = _width * _height;
-	_buf = PixelBuffer(buf.getFormat(), pixel_count, DisposeAfterUse::NO);
-	_buf.copyBuffer(0, pixel_count, buf);
+	_texels = new uint32[pixel_count];
+	for (unsigned int i = 0; i < pixel_count; i++) {
+		uint8 a, r, g, b;
+		buf.getARGBAt(i, a, r, g, b);
+		_texels[i] = ((uint32)a << 24) | (r << 16) | (g << 8) | b;
+	}
 }
 
 NearestTexelBuffer::~NearestTexelBuffer() {
-	_buf.free();
+	delete[] _texels;
 }
 
 void NearestTexelBuffer::getARGBAt(
@@ -93,7 +152,22 @@ void NearestTexelBuffer::getARGBAt(
 	unsigned int, unsigned int,
 	uint8 &a, uint8 &r, uint8 &g, uint8 &b
 ) const {
-	_buf.getARGBAt(pixel, a, r, g, b);
+	uint32 texel = _texels[pixel];
+	a = texel >> 24;
+	r = texel >> 16;
+	g = texel >> 8;
+	b = texel;
+}
+
+void NearestTexelBuffer::getARGBAt(
+	const unsigned int *pixel,
+	const unsigned int *, const unsigned int *,
+	uint32 *argb
+) const {
+	argb[0] = _texels[pixel[0]];
+	argb[1] = _texels[pixel[1]];
+	argb[2] = _texels[pixel[2]];
+	argb[3] = _texels[pixel[3]];
 }
 
 // Bilinear: each texture coordinates corresponds to the 4 original image
@@ -222,4 +296,100 @@ void BilinearTexelBuffer::getARGBAt(
 	);
 }
 
+void BilinearTexelBuffer::getARGBAt(
+	const unsigned int *pixel,
+	const unsigned int *ds, const unsigned int *dt,
+	uint32 *argb
+) const {
+#if defined(__SSE2__)
+	// Transposing the texels of the 4 pixels gives one vector per channel,
+	// with the channel of the 4 corners packed into each lane.
+	__m128i t0 = _mm_loadu_si128((const __m128i *)(_texels + (pixel[0] << PIXEL_PER_TEXEL_SHIFT)));
+	__m128i t1 = _mm_loadu_si128((const __m128i *)(_texels + (pixel[1] << PIXEL_PER_TEXEL_SHIFT)));
+	__m128i t2 = _mm_loadu_si128((const __m128i *)(_texels + (pixel[2] << PIXEL_PER_TEXEL_SHIFT)));
+	__m128i t3 = _mm_loadu_si128((const __m128i *)(_texels + (pixel[3] << PIXEL_PER_TEXEL_SHIFT)));
+	const __m128i t01lo = _mm_unpacklo_epi32(t0, t1), t01hi = _mm_unpackhi_epi32(t0, t1);
+	const __m128i t23lo = _mm_unpacklo_epi32(t2, t3), t23hi = _mm_unpackhi_epi32(t2, t3);
+	const __m128i channels[4] = {
+		_mm_unpacklo_epi64(t01lo, t23lo), _mm_unpackhi_epi64(t01lo, t23lo),
+		_mm_unpacklo_epi64(t01hi, t23hi), _mm_unpackhi_epi64(t01hi, t23hi)
+	};
+
+	const __m128i unit = _mm_set1_epi32(ZB_POINT_ST_UNIT);
+	const __m128i byteMask = _mm_set1_epi32(0xff);
+	__m128i xf = _mm_loadu_si128((const __m128i *)ds);
+	__m128i yf = _mm_loadu_si128((const __m128i *)dt);
+	// The lower right triangle is interpolated from the opposite corner
+	const __m128i flip = _mm_cmpgt_epi32(_mm_add_epi32(xf, yf), unit);
+	xf = _mm_or_si128(_mm_and_si128(flip, _mm_sub_epi32(unit, xf)), _mm_andnot_si128(flip, xf));
+	yf = _mm_or_si128(_mm_and_si128(flip, _mm_sub_epi32(unit, yf)), _mm_andnot_si128(flip, yf));
+	// Both weights are at most 2^14, the differences fit in 16 bits as well
+	const __m128i weights = _mm_or_si128(xf, _mm_slli_epi32(yf, 16));
+
+	__m128i result = _mm_setzero_si128();
+	for (int c = 0; c < 4; c++) {
+		const __m128i p00 = _mm_and_si128(channels[c], byteMask);
+		const __m128i p01 = _mm_and_si128(_mm_srli_epi32(channels[c], 8), byteMask);
+		const __m128i p10 = _mm_and_si128(_mm_srli_epi32(channels[c], 16), byteMask);
+		const __m128i p11 = _mm_srli_epi32(channels[c], 24);
+		const __m128i v00 = _mm_or_si128(_mm_and_si128(flip, p11), _mm_andnot_si128(flip, p00));
+		const __m128i v01 = _mm_or_si128(_mm_and_si128(flip, p10), _mm_andnot_si128(flip, p01));
+		const __m128i v10 = _mm_or_si128(_mm_and_si128(flip, p01), _mm_andnot_si128(flip, p10));
+		const __m128i deltas = _mm_or_si128(_mm_and_si128(_mm_sub_epi32(v01, v00), _mm_set1_epi32(0xffff)),
+		                                    _mm_slli_epi32(_mm_sub_epi32(v10, v00), 16));
+		const __m128i value = _mm_add_epi32(v00, _mm_srai_epi32(_mm_madd_epi16(deltas, weights), ZB_POINT_ST_FRAC_BITS));
+		// Alpha, red, green and blue go from the top byte down
+		result = _mm_or_si128(result, _mm_slli_epi32(_mm_and_si128(value, byteMask), 24 - 8 * c));
+	}
+	_mm_storeu_si128((__m128i *)argb, result);
+#elif defined(__ARM_NEON) && defined(SCUMM_LITTLE_ENDIAN)
+	// Transposing the texels of the 4 pixels gives one vector per channel,
+	// with the channel of the 4 corners packed into each lane.
+	const uint32x4_t t0 = vld1q_u32(_texels + (pixel[0] << PIXEL_PER_TEXEL_SHIFT));
+	const uint32x4_t t1 = vld1q_u32(_texels + (pixel[1] << PIXEL_PER_TEXEL_SHIFT));
+	const uint32x4_t t2 = vld1q_u32(_texels + (pixel[2] << PIXEL_PER_TEXEL_SHIFT));
+	const uint32x4_t t3 = vld1q_u32(_texels + (pixel[3] << PIXEL_PER_TEXEL_SHIFT));
+	const uint32x4x2_t t01 = vtrnq_u32(t0, t1);
+	const uint32x4x2_t t23 = vtrnq_u32(t2, t3);
+	const uint32x4_t channels[4] = {
+		vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])),
+		vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])),
+		vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])),
+		vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1]))
+	};
+
+	const uint32x4_t unit = vdupq_n_u32(ZB_POINT_ST_UNIT);
+	const uint32x4_t byteMask = vdupq_n_u32(0xff);
+	uint32x4_t xf = vld1q_u32(ds);
+	uint32x4_t yf = vld1q_u32(dt);
+	// The lower right triangle is interpolated from the opposite corner
+	const uint32x4_t flip = vcgtq_u32(vaddq_u32(xf, yf), unit);
+	xf = vbslq_u32(flip, vsubq_u32(unit, xf), xf);
+	yf = vbslq_u32(flip, vsubq_u32(unit, yf), yf);
+
+	uint32x4_t result = vdupq_n_u32(0);
+	for (int c = 0; c < 4; c++) {
+		const uint32x4_t p00 = vandq_u32(channels[c], byteMask);
+		const uint32x4_t p01 = vandq_u32(vshrq_n_u32(channels[c], 8), byteMask);
+		const uint32x4_t p10 = vandq_u32(vshrq_n_u32(channels[c], 16), byteMask);
+		const uint32x4_t p11 = vshrq_n_u32(channels[c], 24);
+		const int32x4_t v00 = vreinterpretq_s32_u32(vbslq_u32(flip, p11, p00));
+		const int32x4_t v01 = vreinterpretq_s32_u32(vbslq_u32(flip, p10, p01));
+		const int32x4_t v10 = vreinterpretq_s32_u32(vbslq_u32(flip, p01, p10));
+		const int32x4_t sum = vmlaq_s32(vmulq_s32(vsubq_s32(v01, v00), vreinterpretq_s32_u32(xf)),
+		                                vsubq_s32(v10, v00), vreinterpretq_s32_u32(yf));
+		const uint32x4_t value = vreinterpretq_u32_s32(vaddq_s32(v00, vshrq_n_s32(sum, ZB_POINT_ST_FRAC_BITS)));
+		// Alpha, red, green and blue go from the top byte down
+		result = vorrq_u32(result, vshlq_u32(vandq_u32(value, byteMask), vdupq_n_s32(24 - 8 * c)));
+	}
+	vst1q_u32(argb, result);
+#else
+	for (int i = 0; i < 4; i++) {
+		uint8 a, r, g, b;
+		getARGBAt(pixel[i], ds[i], dt[i], a, r, g, b);
+		argb[i] = ((uint32)a << 24) | (r << 16) | (g << 8) | b;
+	}
+#endif
+}
+
 }
@@ -38,12 +38,27 @@ public:
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
 	) const;
 
+	/**
+	 * Look up the texels of four pixels at once, for the vectorized spans.
+	 * The texels are returned as 0xAARRGGBB.
+	 */
+	void getARGBAt(
+		unsigned int wrap_s, unsigned int wrap_t,
+		const int *s, const int *t,
+		uint32 *argb
+	) const;
+
 protected:
 	virtual void getARGBAt(
 		unsigned int pixel,
 		unsigned int ds, unsigned int dt,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
 	) const = 0;
+	virtual void getARGBAt(
+		const unsigned int *pixel,
+		const unsigned int *ds, const unsigned int *dt,
+		uint32 *argb
+	) const = 0;
 	unsigned int _width, _height, _fracTextureUnit, _fracTextureMask;
 	float _widthRatio, _heightRatio;
 };
@@ -59,9 +74,14 @@ protected:
 		unsigned int, unsigned int,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
 	) const override;
+	void getARGBAt(
+		const unsigned int *pixel,
+		const unsigned int *, const unsigned int *,
+		uint32 *argb
+	) const override;
 
 private:
-	PixelBuffer _buf;
+	uint32 *_texels;
 };
 
 class BilinearTexelBuffer : public TexelBuffer {
@@ -75,6 +95,11 @@ protected:
 		unsigned int ds, unsigned int dt,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
 	) const override;
+	void getARGBAt(
+		const unsigned int *pixel,
+		const unsigned int *ds, const unsigned int *dt,
+		uint32 *argb
+	) const override;
 
 private:
 	uint32 *_texels;
@@ -80,7 +80,7 @@ void memset_l(void *adr, int val, int count) {
 		*p++ = val;
 }
 
-FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &frame_buffer) : _depthWrite(true), _enableScissor(false) {
+FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &frame_buffer) : _depthWrite(true), _enableScissor(false), _isView(false) {
 	this->xsize = width;
 	this->ysize = height;
 	this->cmode = frame_buffer.getFormat();
@@ -104,9 +104,12 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelBuffer &fra
 	_alphaTestEnabled = false;
 	_depthTestEnabled = false;
 	_depthFunc = TGL_LESS;
+	_simdSpansEnabled = true;
+	_useSimdSpans = false;
+	_useSimdTextureSpans = false;
 }
 
-FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &format) : _depthWrite(true), _enableScissor(false) {
+FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &format) : _depthWrite(true), _enableScissor(false), _isView(false) {
 	this->xsize = width;
 	this->ysize = height;
 	this->cmode = format;
@@ -131,12 +134,30 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_alphaTestEnabled = false;
 	_depthTestEnabled = false;
 	_depthFunc = TGL_LESS;
+	_simdSpansEnabled = true;
+	_useSimdSpans = false;
+	_useSimdTextureSpans = false;
 }
 
 FrameBuffer::~FrameBuffer() {
 	if (frame_buffer_allocated)
 		pbuf.free();
-	gl_free(_zbuf);
+	if (!_isView)
+		gl_free(_zbuf);
+}
+
+FrameBuffer *FrameBuffer::createView() const {
+	FrameBuffer *view = new FrameBuffer(*this);
+	view->frame_buffer_allocated = 0;
+	view->_isView = true;
+	return view;
+}
+
+void FrameBuffer::updateView(const FrameBuffer &source) {
+	assert(_isView);
+	*this = source;
+	frame_buffer_allocated = 0;
+	_isView = true;
 }
 
 Buffer *FrameBuffer::genOffscreenBuffer() {
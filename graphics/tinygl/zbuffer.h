@@ -105,6 +105,21 @@ struct FrameBuffer {
 	FrameBuffer(int xsize, int ysize, const Graphics::PixelFormat &format);
 	~FrameBuffer();
 
+	/**
+	 * Create a view of this frame buffer, with a copy of its current state.
+	 * The view draws to the same color and depth buffers, which stay owned
+	 * by this frame buffer, but has its own state and scissor rectangle, so
+	 * that separate bands of the screen can be rasterized at the same time.
+	 */
+	FrameBuffer *createView() const;
+
+	/**
+	 * Update a view created with createView() to a copy of the current state
+	 * of @p source, which may be another frame buffer than the one the view
+	 * was created from.
+	 */
+	void updateView(const FrameBuffer &source);
+
 	Buffer *genOffscreenBuffer();
 	void delOffscreenBuffer(Buffer *buffer);
 	void clear(int clear_z, int z, int clear_color, int r, int g, int b);
@@ -413,6 +428,16 @@ struct FrameBuffer {
 		this->_depthWrite = enable;
 	}
 
+	void enableSimdSpans(bool enable) {
+		_simdSpansEnabled = enable;
+	}
+
+	/**
+	* Choose between the scalar and the vectorized span functions for the
+	* current state. Has to be called again whenever the state changes.
+	*/
+	void selectSpanFunctions();
+
 	bool isAlphaBlendingEnabled() const {
 		return _sourceBlendingFactor == TGL_SRC_ALPHA && _destinationBlendingFactor == TGL_ONE_MINUS_SRC_ALPHA;
 	}
@@ -509,6 +534,16 @@ private:
 	template <bool kEnableScissor>
 	FORCEINLINE void putPixel(unsigned int pixelOffset, int color, int x, int y);
 
+	template <bool kInterpRGB, bool kDepthWrite, bool kEnableScissor>
+	void fillSpanSIMD(int buf, unsigned int *pz, int x, int count, unsigned int z, int dzdx,
+	                  unsigned int r, unsigned int g, unsigned int b, unsigned int a,
+	                  int drdx, int dgdx, int dbdx, int dadx);
+
+	template <bool kSmoothMode, bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor>
+	void fillTextureSpanSIMD(int buf, unsigned int *pz, int x, int y, int count, const Graphics::TexelBuffer *texture,
+	                         unsigned int &z, int &s, int &t, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
+	                         int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, int dadx);
+
 	template <bool kInterpRGB, bool kInterpZ, bool kDepthWrite>
 	void drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2);
 
@@ -526,6 +561,10 @@ private:
 	int _alphaTestFunc;
 	int _alphaTestRefVal;
 	int _depthFunc;
+	bool _simdSpansEnabled;
+	bool _useSimdSpans;
+	bool _useSimdTextureSpans;
+	bool _isView;
 };
 
 // memory.c
@@ -30,13 +30,14 @@
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/gl.h"
 #include "common/debug.h"
+#include "common/jobsystem.h"
 #include "common/math.h"
 
 namespace TinyGL {
 
 void tglIssueDrawCall(Graphics::DrawCall *drawCall) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
-	if (c->_enableDirtyRectangles && drawCall->getDirtyRegion().isEmpty())
+	if ((c->_enableDirtyRectangles || c->_enableTiledRendering) && drawCall->getDirtyRegion().isEmpty())
 		return;
 	c->_drawCallsQueue.push_back(drawCall);
 }
@@ -119,6 +120,150 @@ static inline void _appendDirtyRectangle(const Graphics::DrawCall &call, Common:
 		rectangles.push_back(DirtyRectangle(dirty_region, r, g, b));
 }
 
+// Height of the screen bands used by tiled rendering
+static const int kTiledRenderingBandHeight = 32;
+// Maximum number of jobs the bands of a frame are split between
+static const int kMaxBandJobs = 16;
+
+// Render the bands between top and bottom one after the other, so that the
+// part of the color and depth buffers being drawn to stays in the CPU cache.
+// Every pixel still sees the same draw calls in the same order.
+static void tglExecuteBands(TinyGL::GLContext *c, const Common::List<Graphics::DrawCall *> &drawCalls,
+		const Common::List<DirtyRectangle> &rectangles, int top, int bottom) {
+	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::List<TinyGL::DirtyRectangle>::const_iterator RectangleIterator;
+
+	for (; top < bottom; top += kTiledRenderingBandHeight) {
+		Common::Rect band(c->renderRect.left, top, c->renderRect.right, MIN<int>(top + kTiledRenderingBandHeight, bottom));
+
+		for (DrawCallIterator it = drawCalls.begin(); it != drawCalls.end(); ++it) {
+			// Allow for rasterization rounding at the region border
+			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+			drawCallRegion.grow(1);
+			if (!band.intersects(drawCallRegion))
+				continue;
+
+			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+				Common::Rect dirtyRegion = (*itRect).rectangle.findIntersectingRect(band);
+				if (dirtyRegion.intersects(drawCallRegion)) {
+					// The band contexts are only used for drawing, so there
+					// is no state to restore
+					(*it)->execute(c, dirtyRegion, false);
+				}
+			}
+		}
+	}
+}
+
+// Get the rasterization state for rendering a band on another thread. The
+// contexts are created once and kept with the global one. Everything else
+// the rasterizer reads is set by the draw calls.
+static TinyGL::GLContext *tglGetBandContext(TinyGL::GLContext *c, uint index) {
+	while (c->_bandContexts.size() <= index) {
+		TinyGL::GLContext *band = new TinyGL::GLContext();
+		band->fb = c->fb->createView();
+		c->_bandContexts.push_back(band);
+	}
+
+	TinyGL::GLContext *band = c->_bandContexts[index];
+	band->fb->updateView(*c->fb);
+	band->renderRect = c->renderRect;
+	band->_scissorRect = c->renderRect;
+	band->viewport = c->viewport;
+	band->render_mode = c->render_mode;
+	band->current_cull_face = c->current_cull_face;
+	band->vertex_n = c->vertex_n;
+	band->vertex_cnt = 0;
+	if (band->vertex_max < c->vertex_max) {
+		gl_free(band->vertex);
+		band->vertex = (TinyGL::GLVertex *)gl_malloc(sizeof(TinyGL::GLVertex) * c->vertex_max);
+		band->vertex_max = c->vertex_max;
+	}
+	return band;
+}
+
+void tglDisposeBandContexts(TinyGL::GLContext *c) {
+	for (uint i = 0; i < c->_bandContexts.size(); ++i) {
+		delete c->_bandContexts[i]->fb;
+		gl_free(c->_bandContexts[i]->vertex);
+		delete c->_bandContexts[i];
+	}
+	c->_bandContexts.clear();
+}
+
+namespace {
+
+/**
+ * Renders a range of bands with a band context. The color and depth
+ * buffers are shared, the rows of different jobs do not overlap.
+ */
+class BandJob : public Common::Job {
+public:
+	BandJob() : _context(nullptr), _drawCalls(nullptr), _rectangles(nullptr), _top(0), _bottom(0) {
+	}
+
+	void init(TinyGL::GLContext *context, const Common::List<Graphics::DrawCall *> &drawCalls,
+			const Common::List<DirtyRectangle> &rectangles, int top, int bottom) {
+		_context = context;
+		_drawCalls = &drawCalls;
+		_rectangles = &rectangles;
+		_top = top;
+		_bottom = bottom;
+	}
+
+	virtual void run() override {
+		tglExecuteBands(_context, *_drawCalls, *_rectangles, _top, _bottom);
+	}
+
+private:
+	TinyGL::GLContext *_context;
+	const Common::List<Graphics::DrawCall *> *_drawCalls;
+	const Common::List<DirtyRectangle> *_rectangles;
+	int _top, _bottom;
+};
+
+} // End of anonymous namespace
+
+static void tglExecuteDrawCalls(TinyGL::GLContext *c, const Common::List<DirtyRectangle> &rectangles) {
+	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
+	typedef Common::List<TinyGL::DirtyRectangle>::const_iterator RectangleIterator;
+
+	const int bands = (c->renderRect.height() + kTiledRenderingBandHeight - 1) / kTiledRenderingBandHeight;
+	int jobCount = 1;
+	// Selection mode records hits in the context, so it stays on this thread
+	if (c->_enableTiledRendering && c->render_mode == TGL_RENDER) {
+		jobCount = MIN<int>(JobSys.getWorkerCount() + 1, bands);
+		jobCount = MIN<int>(jobCount, kMaxBandJobs);
+	}
+
+	// Rendering the bands one after the other on this thread is slower
+	// than rendering each rectangle at once
+	if (jobCount < 2) {
+		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
+			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
+			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
+				Common::Rect dirtyRegion = (*itRect).rectangle;
+				if (dirtyRegion.intersects(drawCallRegion)) {
+					(*it)->execute(c, dirtyRegion, true);
+				}
+			}
+		}
+		return;
+	}
+
+	// Each job gets a run of whole bands
+	BandJob jobs[kMaxBandJobs];
+	Common::JobGroup group;
+	for (int i = 0; i < jobCount; ++i) {
+		const int top = c->renderRect.top + bands * i / jobCount * kTiledRenderingBandHeight;
+		const int bottom = MIN<int>(c->renderRect.top + bands * (i + 1) / jobCount * kTiledRenderingBandHeight, c->renderRect.bottom);
+		jobs[i].init(tglGetBandContext(c, i), c->_drawCallsQueue, rectangles, top, bottom);
+		JobSys.submit(&jobs[i], &group);
+	}
+
+	group.wait();
+}
+
 static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
 	typedef Common::List<TinyGL::DirtyRectangle>::iterator RectangleIterator;
@@ -195,15 +340,7 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 
 	if (!rectangles.empty()) {
 		// Execute draw calls.
-		for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-			Common::Rect drawCallRegion = (*it)->getDirtyRegion();
-			for (RectangleIterator itRect = rectangles.begin(); itRect != rectangles.end(); ++itRect) {
-				Common::Rect dirtyRegion = (*itRect).rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					(*it)->execute(dirtyRegion, true);
-				}
-			}
-		}
+		tglExecuteDrawCalls(c, rectangles);
 #if TGL_DIRTY_RECT_SHOW
 		// Draw debug rectangles.
 		// Note: white rectangles are rectangle that contained other rectangles
@@ -242,8 +379,15 @@ static void tglPresentBufferDirtyRects(TinyGL::GLContext *c) {
 static void tglPresentBufferSimple(TinyGL::GLContext *c) {
 	typedef Common::List<Graphics::DrawCall *>::const_iterator DrawCallIterator;
 
+	if (c->_enableTiledRendering) {
+		Common::List<DirtyRectangle> rectangles;
+		rectangles.push_back(DirtyRectangle(c->renderRect, 0, 0, 0));
+		tglExecuteDrawCalls(c, rectangles);
+	}
+
 	for (DrawCallIterator it = c->_drawCallsQueue.begin(); it != c->_drawCallsQueue.end(); ++it) {
-		(*it)->execute(true);
+		if (!c->_enableTiledRendering)
+			(*it)->execute(true);
 		delete *it;
 	}
 
@@ -294,8 +438,8 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(TinyGL::GLVertex) * _vertexCount);
-	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	_state = captureState(c);
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		computeDirtyRegion();
 	}
 }
@@ -334,18 +478,22 @@ void RasterizationDrawCall::computeDirtyRegion() {
 }
 
 void RasterizationDrawCall::execute(bool restoreState) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+	draw(TinyGL::gl_get_context(), restoreState);
+}
 
+void RasterizationDrawCall::draw(TinyGL::GLContext *c, bool restoreState) const {
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
 
-	TinyGL::GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
-	c->vertex = _vertex;
+	// Some primitives modify the vertices while they are drawn, so draw a
+	// copy: the same call may be drawn again for another rectangle, or at
+	// the same time for another band of the screen.
+	memcpy(c->vertex, _vertex, sizeof(TinyGL::GLVertex) * _vertexCount);
 	c->vertex_cnt = _vertexCount;
 	c->draw_triangle_front = (TinyGL::gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (TinyGL::gl_draw_triangle_func)_drawTriangleBack;
@@ -378,18 +526,16 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 		}
 		break;
 	case TGL_TRIANGLE_STRIP:
-		while (cnt >= 3) {
+		for (TinyGL::GLVertex *v = c->vertex; cnt >= 3; cnt--, v++) {
 			// needed to respect triangle orientation
 			switch (cnt & 1) {
 			case 0:
-				gl_draw_triangle(c, &c->vertex[2], &c->vertex[1], &c->vertex[0]);
+				gl_draw_triangle(c, &v[2], &v[1], &v[0]);
 				break;
 			case 1:
-				gl_draw_triangle(c, &c->vertex[0], &c->vertex[1], &c->vertex[2]);
+				gl_draw_triangle(c, &v[0], &v[1], &v[2]);
 				break;
 			}
-			cnt--;
-			c->vertex++;
 		}
 		break;
 	case TGL_TRIANGLE_FAN:
@@ -425,17 +571,15 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 		error("glBegin: type %x not handled", c->begin_type);
 	}
 
-	c->vertex = prevVertex;
 	c->vertex_cnt = prevVertexCount;
 
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(TinyGL::GLContext *c) const {
 	RasterizationState state;
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	state.alphaTest = c->fb->isAlphaTestEnabled();
 	c->fb->getBlendingFactors(state.sfactor, state.dfactor);
 	state.enableBlending = c->fb->isBlendingEnabled();
@@ -469,8 +613,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+void RasterizationDrawCall::applyState(TinyGL::GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -478,6 +621,7 @@ void RasterizationDrawCall::applyState(const RasterizationDrawCall::Rasterizatio
 	c->fb->setDepthFunc(state.depthFunction);
 	c->fb->enableDepthWrite(state.depthWrite);
 	c->fb->enableDepthTest(state.depthTestEnabled);
+	c->fb->selectSpanFunctions();
 
 	c->lighting_enabled = state.lightingEnabled;
 	c->cull_face_enabled = state.cullFaceEnabled;
@@ -499,10 +643,9 @@ void RasterizationDrawCall::applyState(const RasterizationDrawCall::Rasterizatio
 	memcpy(c->viewport.trans._v, state.viewportTranslation, sizeof(c->viewport.trans._v));
 }
 
-void RasterizationDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+void RasterizationDrawCall::execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	c->fb->setScissorRectangle(clippingRectangle);
-	execute(restoreState);
+	draw(c, restoreState);
 	c->fb->resetScissorRectangle();
 }
 
@@ -522,10 +665,11 @@ bool RasterizationDrawCall::operator==(const RasterizationDrawCall &other) const
 }
 
 BlittingDrawCall::BlittingDrawCall(Graphics::BlitImage *image, const BlitTransform &transform, BlittingMode blittingMode) : DrawCall(DrawCall_Blitting), _transform(transform), _mode(blittingMode), _image(image) {
+	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	tglIncBlitImageRef(image);
-	_blitState = captureState();
+	_blitState = captureState(c);
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (TinyGL::gl_get_context()->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		computeDirtyRegion();
 	}
 }
@@ -535,42 +679,45 @@ BlittingDrawCall::~BlittingDrawCall() {
 }
 
 void BlittingDrawCall::execute(bool restoreState) const {
+	draw(TinyGL::gl_get_context(), restoreState);
+}
+
+void BlittingDrawCall::draw(TinyGL::GLContext *c, bool restoreState) const {
 	BlittingState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_blitState);
+	applyState(c, _blitState);
 
 	switch (_mode) {
 	case Graphics::BlittingDrawCall::BlitMode_Regular:
-		Graphics::Internal::tglBlit(_image, _transform);
+		Graphics::Internal::tglBlit(c, _image, _transform);
 		break;
 	case Graphics::BlittingDrawCall::BlitMode_NoBlend:
-		Graphics::Internal::tglBlitNoBlend(_image, _transform);
+		Graphics::Internal::tglBlitNoBlend(c, _image, _transform);
 		break;
 	case Graphics::BlittingDrawCall::BlitMode_Fast:
-		Graphics::Internal::tglBlitFast(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Graphics::Internal::tglBlitFast(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	case Graphics::BlittingDrawCall::BlitMode_ZBuffer:
-		Graphics::Internal::tglBlitZBuffer(_image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
+		Graphics::Internal::tglBlitZBuffer(c, _image, _transform._destinationRectangle.left, _transform._destinationRectangle.top);
 		break;
 	default:
 		break;
 	}
 	if (restoreState) {
-		applyState(backupState);
+		applyState(c, backupState);
 	}
 }
 
-void BlittingDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	Graphics::Internal::tglBlitSetScissorRect(clippingRectangle);
-	execute(restoreState);
-	Graphics::Internal::tglBlitResetScissorRect();
+void BlittingDrawCall::execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
+	Graphics::Internal::tglBlitSetScissorRect(c, clippingRectangle);
+	draw(c, restoreState);
+	Graphics::Internal::tglBlitResetScissorRect(c);
 }
 
-BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
+BlittingDrawCall::BlittingState BlittingDrawCall::captureState(TinyGL::GLContext *c) const {
 	BlittingState state;
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
 	state.alphaTest = c->fb->isAlphaTestEnabled();
 	c->fb->getBlendingFactors(state.sfactor, state.dfactor);
 	state.enableBlending = c->fb->isBlendingEnabled();
@@ -580,8 +727,7 @@ BlittingDrawCall::BlittingState BlittingDrawCall::captureState() const {
 	return state;
 }
 
-void BlittingDrawCall::applyState(const BlittingState &state) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+void BlittingDrawCall::applyState(TinyGL::GLContext *c, const BlittingState &state) const {
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->enableAlphaTest(state.alphaTest);
@@ -630,7 +776,7 @@ bool BlittingDrawCall::operator==(const BlittingDrawCall &other) const {
 ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue, bool clearColorBuffer, int rValue, int gValue, int bValue)
 	: _clearZBuffer(clearZBuffer), _clearColorBuffer(clearColorBuffer), _zValue(zValue), _rValue(rValue), _gValue(gValue), _bValue(bValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = TinyGL::gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		_dirtyRegion = c->renderRect;
 	}
 }
@@ -640,8 +786,7 @@ void ClearBufferDrawCall::execute(bool restoreState) const {
 	c->fb->clear(_clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue);
 }
 
-void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = TinyGL::gl_get_context();
+void ClearBufferDrawCall::execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const {
 	Common::Rect clearRect = clippingRectangle.findIntersectingRect(getDirtyRegion());
 	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(), _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue);
 }
@@ -61,7 +61,12 @@ public:
 		return !(*this == other);
 	}
 	virtual void execute(bool restoreState) const = 0;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const = 0;
+	/**
+	 * Execute the draw call within the clipping rectangle, with the given
+	 * context. That can be a copy of the global context used to render one
+	 * band of the screen.
+	 */
+	virtual void execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const = 0;
 	DrawCallType getType() const { return _type; }
 	virtual const Common::Rect getDirtyRegion() const { return _dirtyRegion; }
 protected:
@@ -76,7 +81,7 @@ public:
 	virtual ~ClearBufferDrawCall() { }
 	bool operator==(const ClearBufferDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	void *operator new(size_t size) {
 		return ::Internal::allocateFrame(size);
@@ -95,7 +100,7 @@ public:
 	virtual ~RasterizationDrawCall() { }
 	bool operator==(const RasterizationDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	void *operator new(size_t size) {
 		return ::Internal::allocateFrame(size);
@@ -140,8 +145,9 @@ private:
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	void draw(TinyGL::GLContext *c, bool restoreState) const;
+	RasterizationState captureState(TinyGL::GLContext *c) const;
+	void applyState(TinyGL::GLContext *c, const RasterizationState &state) const;
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
@@ -158,7 +164,7 @@ public:
 	virtual ~BlittingDrawCall();
 	bool operator==(const BlittingDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
-	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	virtual void execute(TinyGL::GLContext *c, const Common::Rect &clippingRectangle, bool restoreState) const;
 
 	BlittingMode getBlittingMode() const { return _mode; }
 
@@ -192,8 +198,9 @@ private:
 		}
 	};
 
-	BlittingState captureState() const;
-	void applyState(const BlittingState &state) const;
+	void draw(TinyGL::GLContext *c, bool restoreState) const;
+	BlittingState captureState(TinyGL::GLContext *c) const;
+	void applyState(TinyGL::GLContext *c, const BlittingState &state) const;
 
 	BlittingState _blitState;
 };
@@ -387,6 +387,9 @@ struct GLContext {
 	Common::Rect _scissorRect;
 
 	bool _enableDirtyRectangles;
+	bool _enableTiledRendering;
+	// Rasterization state for each band rendered by another thread
+	Common::Array<GLContext *> _bandContexts;
 
 	// blit test
 	Common::List<Graphics::BlitImage *> _blitImages;
@@ -438,6 +441,7 @@ void tglIssueDrawCall(Graphics::DrawCall *drawCall);
 // zdirtyrect.cpp
 void tglDisposeResources(GLContext *c);
 void tglDisposeDrawCallLists(TinyGL::GLContext *c);
+void tglDisposeBandContexts(TinyGL::GLContext *c);
 
 GLContext *gl_get_context();
 
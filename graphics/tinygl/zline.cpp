@@ -93,6 +93,8 @@ void FrameBuffer::drawLine(const ZBufferPoint *p1, const ZBufferPoint *p2) {
 
 	// How many moves
 	int n = dx > dy ? dx : dy;
+	if (n == 0)
+		return;
 
 	// kInterpZ
 	unsigned int z;
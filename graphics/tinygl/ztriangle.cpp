@@ -31,6 +31,12 @@
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace TinyGL {
 
 static const int NB_INTERP = 8;
@@ -107,6 +113,408 @@ FORCEINLINE static void putPixelTextureMappingPerspective(FrameBuffer *buffer, i
 	}
 }
 
+#if defined(__SSE2__)
+
+// SSE2 only has signed comparisons, so both sides are biased to compare them as unsigned values
+FORCEINLINE static __m128i depthTestMaskSSE2(int depthFunc, __m128i zSrc, __m128i zDst) {
+	const __m128i bias = _mm_set1_epi32((int)0x80000000);
+	const __m128i ones = _mm_set1_epi32(-1);
+	zSrc = _mm_xor_si128(zSrc, bias);
+	zDst = _mm_xor_si128(zDst, bias);
+	switch (depthFunc) {
+	case TGL_LESS:
+		return _mm_cmpgt_epi32(zSrc, zDst);
+	case TGL_EQUAL:
+		return _mm_cmpeq_epi32(zSrc, zDst);
+	case TGL_LEQUAL:
+		return _mm_xor_si128(_mm_cmpgt_epi32(zDst, zSrc), ones);
+	case TGL_GREATER:
+		return _mm_cmpgt_epi32(zDst, zSrc);
+	case TGL_NOTEQUAL:
+		return _mm_xor_si128(_mm_cmpeq_epi32(zSrc, zDst), ones);
+	case TGL_GEQUAL:
+		return _mm_xor_si128(_mm_cmpgt_epi32(zSrc, zDst), ones);
+	case TGL_ALWAYS:
+		return ones;
+	default:
+		return _mm_setzero_si128();
+	}
+}
+
+FORCEINLINE static __m128i packChannelSSE2(__m128i v, int bits, __m128i loss, __m128i shift) {
+	v = _mm_and_si128(_mm_srli_epi32(v, bits - 8), _mm_set1_epi32(0xff));
+	return _mm_sll_epi32(_mm_srl_epi32(v, loss), shift);
+}
+
+#elif defined(__ARM_NEON)
+
+FORCEINLINE static uint32x4_t depthTestMaskNEON(int depthFunc, uint32x4_t zSrc, uint32x4_t zDst) {
+	switch (depthFunc) {
+	case TGL_LESS:
+		return vcgtq_u32(zSrc, zDst);
+	case TGL_EQUAL:
+		return vceqq_u32(zSrc, zDst);
+	case TGL_LEQUAL:
+		return vcgeq_u32(zSrc, zDst);
+	case TGL_GREATER:
+		return vcgtq_u32(zDst, zSrc);
+	case TGL_NOTEQUAL:
+		return vmvnq_u32(vceqq_u32(zSrc, zDst));
+	case TGL_GEQUAL:
+		return vcgeq_u32(zDst, zSrc);
+	case TGL_ALWAYS:
+		return vdupq_n_u32(0xffffffff);
+	default:
+		return vdupq_n_u32(0);
+	}
+}
+
+FORCEINLINE static uint32x4_t packChannelNEON(uint32x4_t v, int bits, int loss, int shift) {
+	v = vandq_u32(vshlq_u32(v, vdupq_n_s32(8 - bits)), vdupq_n_u32(0xff));
+	return vshlq_u32(vshlq_u32(v, vdupq_n_s32(-loss)), vdupq_n_s32(shift));
+}
+
+#endif
+
+void FrameBuffer::selectSpanFunctions() {
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	// Only the most common state is vectorized, everything else goes
+	// through the generic per pixel functions. Textured spans also handle
+	// the alpha test, which models use for their transparent parts.
+	_useSimdSpans = _simdSpansEnabled && !_blendingEnabled && !_alphaTestEnabled && pixelbytes == 4;
+	_useSimdTextureSpans = _simdSpansEnabled && !_blendingEnabled && pixelbytes == 4;
+#else
+	_useSimdSpans = false;
+	_useSimdTextureSpans = false;
+#endif
+}
+
+// Vectorized flat and smooth spans, processing 4 pixels at a time. The generic
+// putPixelFlat/putPixelSmooth loops are the reference, the results must match
+// them pixel for pixel.
+template <bool kInterpRGB, bool kDepthWrite, bool kEnableScissor>
+void FrameBuffer::fillSpanSIMD(int buf, unsigned int *pz, int x, int count, unsigned int z, int dzdx,
+                               unsigned int r, unsigned int g, unsigned int b, unsigned int a,
+                               int drdx, int dgdx, int dbdx, int dadx) {
+	if (kEnableScissor) {
+		// Pixels left of the scissor rectangle are skipped by stepping the
+		// interpolated values, which is the same as stepping them one by one.
+		int skip = _clipRectangle.left - x;
+		if (skip > 0) {
+			z += (unsigned int)skip * dzdx;
+			if (kInterpRGB) {
+				r += (unsigned int)skip * drdx;
+				g += (unsigned int)skip * dgdx;
+				b += (unsigned int)skip * dbdx;
+				a += (unsigned int)skip * dadx;
+			}
+			buf += skip;
+			pz += skip;
+			x += skip;
+			count -= skip;
+		}
+		if (x + count > _clipRectangle.right)
+			count = _clipRectangle.right - x;
+	}
+	if (count <= 0)
+		return;
+
+	const int depthFunc = _depthTestEnabled ? _depthFunc : TGL_ALWAYS;
+	uint32 *pixels = (uint32 *)pbuf.getRawBuffer(buf);
+
+#if defined(__SSE2__)
+	const __m128i aLoss = _mm_cvtsi32_si128(cmode.aLoss), aShift = _mm_cvtsi32_si128(cmode.aShift);
+	const __m128i rLoss = _mm_cvtsi32_si128(cmode.rLoss), rShift = _mm_cvtsi32_si128(cmode.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(cmode.gLoss), gShift = _mm_cvtsi32_si128(cmode.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(cmode.bLoss), bShift = _mm_cvtsi32_si128(cmode.bShift);
+
+	__m128i zv = _mm_setr_epi32(z, z + dzdx, z + 2 * (unsigned int)dzdx, z + 3 * (unsigned int)dzdx);
+	__m128i rv = _mm_setr_epi32(r, r + drdx, r + 2 * (unsigned int)drdx, r + 3 * (unsigned int)drdx);
+	__m128i gv = _mm_setr_epi32(g, g + dgdx, g + 2 * (unsigned int)dgdx, g + 3 * (unsigned int)dgdx);
+	__m128i bv = _mm_setr_epi32(b, b + dbdx, b + 2 * (unsigned int)dbdx, b + 3 * (unsigned int)dbdx);
+	__m128i av = _mm_setr_epi32(a, a + dadx, a + 2 * (unsigned int)dadx, a + 3 * (unsigned int)dadx);
+	const __m128i zStep = _mm_set1_epi32(4 * (unsigned int)dzdx);
+	const __m128i rStep = _mm_set1_epi32(4 * (unsigned int)drdx);
+	const __m128i gStep = _mm_set1_epi32(4 * (unsigned int)dgdx);
+	const __m128i bStep = _mm_set1_epi32(4 * (unsigned int)dbdx);
+	const __m128i aStep = _mm_set1_epi32(4 * (unsigned int)dadx);
+	__m128i color = _mm_set1_epi32(cmode.ARGBToColor(a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8),
+	                                                 g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8)));
+
+	while (count >= 4) {
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)pz);
+		const __m128i mask = depthTestMaskSSE2(depthFunc, zv, zDst);
+		if (_mm_movemask_epi8(mask)) {
+			if (kInterpRGB) {
+				color = _mm_or_si128(_mm_or_si128(packChannelSSE2(av, ZB_POINT_ALPHA_BITS, aLoss, aShift),
+				                                  packChannelSSE2(rv, ZB_POINT_RED_BITS, rLoss, rShift)),
+				                     _mm_or_si128(packChannelSSE2(gv, ZB_POINT_GREEN_BITS, gLoss, gShift),
+				                                  packChannelSSE2(bv, ZB_POINT_BLUE_BITS, bLoss, bShift)));
+			}
+			const __m128i dst = _mm_loadu_si128((const __m128i *)pixels);
+			_mm_storeu_si128((__m128i *)pixels, _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, dst)));
+			if (kDepthWrite)
+				_mm_storeu_si128((__m128i *)pz, _mm_or_si128(_mm_and_si128(mask, zv), _mm_andnot_si128(mask, zDst)));
+		}
+		zv = _mm_add_epi32(zv, zStep);
+		if (kInterpRGB) {
+			rv = _mm_add_epi32(rv, rStep);
+			gv = _mm_add_epi32(gv, gStep);
+			bv = _mm_add_epi32(bv, bStep);
+			av = _mm_add_epi32(av, aStep);
+		}
+		z += 4 * (unsigned int)dzdx;
+		if (kInterpRGB) {
+			r += 4 * (unsigned int)drdx;
+			g += 4 * (unsigned int)dgdx;
+			b += 4 * (unsigned int)dbdx;
+			a += 4 * (unsigned int)dadx;
+		}
+		pixels += 4;
+		pz += 4;
+		buf += 4;
+		count -= 4;
+	}
+#elif defined(__ARM_NEON)
+	const uint32 lanes[4] = { 0, 1, 2, 3 };
+	const uint32x4_t lane = vld1q_u32(lanes);
+	uint32x4_t zv = vmlaq_n_u32(vdupq_n_u32(z), lane, dzdx);
+	uint32x4_t rv = vmlaq_n_u32(vdupq_n_u32(r), lane, drdx);
+	uint32x4_t gv = vmlaq_n_u32(vdupq_n_u32(g), lane, dgdx);
+	uint32x4_t bv = vmlaq_n_u32(vdupq_n_u32(b), lane, dbdx);
+	uint32x4_t av = vmlaq_n_u32(vdupq_n_u32(a), lane, dadx);
+	const uint32x4_t zStep = vdupq_n_u32(4 * (unsigned int)dzdx);
+	const uint32x4_t rStep = vdupq_n_u32(4 * (unsigned int)drdx);
+	const uint32x4_t gStep = vdupq_n_u32(4 * (unsigned int)dgdx);
+	const uint32x4_t bStep = vdupq_n_u32(4 * (unsigned int)dbdx);
+	const uint32x4_t aStep = vdupq_n_u32(4 * (unsigned int)dadx);
+	uint32x4_t color = vdupq_n_u32(cmode.ARGBToColor(a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8),
+	                                                 g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8)));
+
+	while (count >= 4) {
+		const uint32x4_t zDst = vld1q_u32(pz);
+		const uint32x4_t mask = depthTestMaskNEON(depthFunc, zv, zDst);
+		if (vgetq_lane_u64(vreinterpretq_u64_u32(mask), 0) | vgetq_lane_u64(vreinterpretq_u64_u32(mask), 1)) {
+			if (kInterpRGB) {
+				color = vorrq_u32(vorrq_u32(packChannelNEON(av, ZB_POINT_ALPHA_BITS, cmode.aLoss, cmode.aShift),
+				                            packChannelNEON(rv, ZB_POINT_RED_BITS, cmode.rLoss, cmode.rShift)),
+				                  vorrq_u32(packChannelNEON(gv, ZB_POINT_GREEN_BITS, cmode.gLoss, cmode.gShift),
+				                            packChannelNEON(bv, ZB_POINT_BLUE_BITS, cmode.bLoss, cmode.bShift)));
+			}
+			vst1q_u32(pixels, vbslq_u32(mask, color, vld1q_u32(pixels)));
+			if (kDepthWrite)
+				vst1q_u32(pz, vbslq_u32(mask, zv, zDst));
+		}
+		zv = vaddq_u32(zv, zStep);
+		if (kInterpRGB) {
+			rv = vaddq_u32(rv, rStep);
+			gv = vaddq_u32(gv, gStep);
+			bv = vaddq_u32(bv, bStep);
+			av = vaddq_u32(av, aStep);
+		}
+		z += 4 * (unsigned int)dzdx;
+		if (kInterpRGB) {
+			r += 4 * (unsigned int)drdx;
+			g += 4 * (unsigned int)dgdx;
+			b += 4 * (unsigned int)dbdx;
+			a += 4 * (unsigned int)dadx;
+		}
+		pixels += 4;
+		pz += 4;
+		buf += 4;
+		count -= 4;
+	}
+#endif
+
+	while (count > 0) {
+		if (compareDepth(z, *pz)) {
+			writePixel<false, false, kDepthWrite>(buf, a >> (ZB_POINT_ALPHA_BITS - 8), r >> (ZB_POINT_RED_BITS - 8),
+			                                      g >> (ZB_POINT_GREEN_BITS - 8), b >> (ZB_POINT_BLUE_BITS - 8), z);
+		}
+		z += dzdx;
+		if (kInterpRGB) {
+			r += drdx;
+			g += dgdx;
+			b += dbdx;
+			a += dadx;
+		}
+		buf++;
+		pz++;
+		count--;
+	}
+}
+
+// Vectorized span of lit, perspective textured pixels, processing 4 pixels at
+// a time. The texels of the 4 pixels are looked up together, everything else
+// is done on all 4 at once. putPixelTextureMappingPerspective is the
+// reference, the results must match it pixel for pixel.
+template <bool kSmoothMode, bool kDepthWrite, bool kEnableAlphaTest, bool kEnableScissor>
+void FrameBuffer::fillTextureSpanSIMD(int buf, unsigned int *pz, int x, int y, int count, const Graphics::TexelBuffer *texture,
+                                      unsigned int &z, int &s, int &t, unsigned int &r, unsigned int &g, unsigned int &b, unsigned int &a,
+                                      int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, int dadx) {
+	const int depthFunc = _depthTestEnabled ? _depthFunc : TGL_ALWAYS;
+	const int alphaFunc = kEnableAlphaTest ? _alphaTestFunc : TGL_ALWAYS;
+	uint32 *pixels = (uint32 *)pbuf.getRawBuffer(buf);
+	int sl[4], tl[4];
+	uint32 texels[4];
+
+#if defined(__SSE2__)
+	const __m128i aLoss = _mm_cvtsi32_si128(cmode.aLoss), aShift = _mm_cvtsi32_si128(cmode.aShift);
+	const __m128i rLoss = _mm_cvtsi32_si128(cmode.rLoss), rShift = _mm_cvtsi32_si128(cmode.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(cmode.gLoss), gShift = _mm_cvtsi32_si128(cmode.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(cmode.bLoss), bShift = _mm_cvtsi32_si128(cmode.bShift);
+	const __m128i lowWord = _mm_set1_epi32(0xffff);
+	const __m128i alphaRef = _mm_set1_epi32(_alphaTestRefVal);
+	const __m128i left = _mm_set1_epi32(_clipRectangle.left - 1), right = _mm_set1_epi32(_clipRectangle.right);
+
+	while (count >= 4) {
+		const __m128i zv = _mm_setr_epi32(z, z + dzdx, z + 2 * (unsigned int)dzdx, z + 3 * (unsigned int)dzdx);
+		const __m128i zDst = _mm_loadu_si128((const __m128i *)pz);
+		__m128i mask = depthTestMaskSSE2(depthFunc, zv, zDst);
+		if (kEnableScissor) {
+			const __m128i xv = _mm_setr_epi32(x, x + 1, x + 2, x + 3);
+			mask = _mm_and_si128(mask, _mm_and_si128(_mm_cmpgt_epi32(xv, left), _mm_cmpgt_epi32(right, xv)));
+		}
+
+		if (_mm_movemask_epi8(mask)) {
+			for (int i = 0; i < 4; i++) {
+				sl[i] = s + i * dsdx;
+				tl[i] = t + i * dtdx;
+			}
+			texture->getARGBAt(wrapS, wrapT, sl, tl, texels);
+			const __m128i texel = _mm_loadu_si128((const __m128i *)texels);
+
+			// The light is 8.8 fixed point, only the low 16 bits of the
+			// products matter for the 8 bits which are kept
+			__m128i lr, lg, lb, la;
+			if (kSmoothMode) {
+				lr = _mm_setr_epi32(r, r + drdx, r + 2 * (unsigned int)drdx, r + 3 * (unsigned int)drdx);
+				lg = _mm_setr_epi32(g, g + dgdx, g + 2 * (unsigned int)dgdx, g + 3 * (unsigned int)dgdx);
+				lb = _mm_setr_epi32(b, b + dbdx, b + 2 * (unsigned int)dbdx, b + 3 * (unsigned int)dbdx);
+				la = _mm_setr_epi32(a, a + dadx, a + 2 * (unsigned int)dadx, a + 3 * (unsigned int)dadx);
+			} else {
+				lr = _mm_set1_epi32(r);
+				lg = _mm_set1_epi32(g);
+				lb = _mm_set1_epi32(b);
+				la = _mm_set1_epi32(a);
+			}
+			const __m128i lightBG = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(lb, ZB_POINT_BLUE_BITS - 8), lowWord),
+			                                     _mm_slli_epi32(_mm_srli_epi32(lg, ZB_POINT_GREEN_BITS - 8), 16));
+			const __m128i lightRA = _mm_or_si128(_mm_and_si128(_mm_srli_epi32(lr, ZB_POINT_RED_BITS - 8), lowWord),
+			                                     _mm_slli_epi32(_mm_srli_epi32(la, ZB_POINT_ALPHA_BITS - 8), 16));
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(texel, zero), _mm_unpacklo_epi32(lightBG, lightRA)), 8);
+			const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(texel, zero), _mm_unpackhi_epi32(lightBG, lightRA)), 8);
+			const __m128i lit = _mm_packus_epi16(lo, hi);
+
+			const __m128i alpha = _mm_srli_epi32(lit, 24);
+			if (kEnableAlphaTest) {
+				// Same comparison as the depth test, the alpha is the value
+				// under test and the reference value the one it is compared with
+				mask = _mm_and_si128(mask, depthTestMaskSSE2(alphaFunc, alphaRef, alpha));
+			}
+
+			const __m128i color = _mm_or_si128(_mm_or_si128(packChannelSSE2(alpha, 8, aLoss, aShift),
+			                                                packChannelSSE2(_mm_srli_epi32(lit, 16), 8, rLoss, rShift)),
+			                                   _mm_or_si128(packChannelSSE2(_mm_srli_epi32(lit, 8), 8, gLoss, gShift),
+			                                                packChannelSSE2(lit, 8, bLoss, bShift)));
+			const __m128i dst = _mm_loadu_si128((const __m128i *)pixels);
+			_mm_storeu_si128((__m128i *)pixels, _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, dst)));
+			if (kDepthWrite)
+				_mm_storeu_si128((__m128i *)pz, _mm_or_si128(_mm_and_si128(mask, zv), _mm_andnot_si128(mask, zDst)));
+		}
+#elif defined(__ARM_NEON)
+	const uint32 lanes[4] = { 0, 1, 2, 3 };
+	const uint32x4_t lane = vld1q_u32(lanes);
+	const uint32x4_t lowWord = vdupq_n_u32(0xffff);
+	const uint32x4_t alphaRef = vdupq_n_u32(_alphaTestRefVal);
+	const int32x4_t left = vdupq_n_s32(_clipRectangle.left), right = vdupq_n_s32(_clipRectangle.right);
+
+	while (count >= 4) {
+		const uint32x4_t zv = vmlaq_n_u32(vdupq_n_u32(z), lane, dzdx);
+		const uint32x4_t zDst = vld1q_u32(pz);
+		uint32x4_t mask = depthTestMaskNEON(depthFunc, zv, zDst);
+		if (kEnableScissor) {
+			const int32x4_t xv = vaddq_s32(vdupq_n_s32(x), vreinterpretq_s32_u32(lane));
+			mask = vandq_u32(mask, vandq_u32(vcgeq_s32(xv, left), vcltq_s32(xv, right)));
+		}
+
+		if (vgetq_lane_u64(vreinterpretq_u64_u32(mask), 0) | vgetq_lane_u64(vreinterpretq_u64_u32(mask), 1)) {
+			for (int i = 0; i < 4; i++) {
+				sl[i] = s + i * dsdx;
+				tl[i] = t + i * dtdx;
+			}
+			texture->getARGBAt(wrapS, wrapT, sl, tl, texels);
+			const uint8x16_t texel = vreinterpretq_u8_u32(vld1q_u32(texels));
+
+			// The light is 8.8 fixed point, only the low 16 bits of the
+			// products matter for the 8 bits which are kept
+			uint32x4_t lr, lg, lb, la;
+			if (kSmoothMode) {
+				lr = vmlaq_n_u32(vdupq_n_u32(r), lane, drdx);
+				lg = vmlaq_n_u32(vdupq_n_u32(g), lane, dgdx);
+				lb = vmlaq_n_u32(vdupq_n_u32(b), lane, dbdx);
+				la = vmlaq_n_u32(vdupq_n_u32(a), lane, dadx);
+			} else {
+				lr = vdupq_n_u32(r);
+				lg = vdupq_n_u32(g);
+				lb = vdupq_n_u32(b);
+				la = vdupq_n_u32(a);
+			}
+			const uint32x4_t lightBG = vorrq_u32(vandq_u32(vshrq_n_u32(lb, ZB_POINT_BLUE_BITS - 8), lowWord),
+			                                     vshlq_n_u32(vshrq_n_u32(lg, ZB_POINT_GREEN_BITS - 8), 16));
+			const uint32x4_t lightRA = vorrq_u32(vandq_u32(vshrq_n_u32(lr, ZB_POINT_RED_BITS - 8), lowWord),
+			                                     vshlq_n_u32(vshrq_n_u32(la, ZB_POINT_ALPHA_BITS - 8), 16));
+			const uint32x4x2_t light = vzipq_u32(lightBG, lightRA);
+			const uint16x8_t lo = vshrq_n_u16(vmulq_u16(vmovl_u8(vget_low_u8(texel)), vreinterpretq_u16_u32(light.val[0])), 8);
+			const uint16x8_t hi = vshrq_n_u16(vmulq_u16(vmovl_u8(vget_high_u8(texel)), vreinterpretq_u16_u32(light.val[1])), 8);
+			const uint32x4_t lit = vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+
+			const uint32x4_t alpha = vshrq_n_u32(lit, 24);
+			if (kEnableAlphaTest) {
+				// Same comparison as the depth test, the alpha is the value
+				// under test and the reference value the one it is compared with
+				mask = vandq_u32(mask, depthTestMaskNEON(alphaFunc, alphaRef, alpha));
+			}
+
+			const uint32x4_t color = vorrq_u32(vorrq_u32(packChannelNEON(alpha, 8, cmode.aLoss, cmode.aShift),
+			                                             packChannelNEON(vshrq_n_u32(lit, 16), 8, cmode.rLoss, cmode.rShift)),
+			                                   vorrq_u32(packChannelNEON(vshrq_n_u32(lit, 8), 8, cmode.gLoss, cmode.gShift),
+			                                             packChannelNEON(lit, 8, cmode.bLoss, cmode.bShift)));
+			vst1q_u32(pixels, vbslq_u32(mask, color, vld1q_u32(pixels)));
+			if (kDepthWrite)
+				vst1q_u32(pz, vbslq_u32(mask, zv, zDst));
+		}
+#endif
+
+#if defined(__SSE2__) || defined(__ARM_NEON)
+		z += 4 * (unsigned int)dzdx;
+		s += 4 * dsdx;
+		t += 4 * dtdx;
+		if (kSmoothMode) {
+			r += 4 * (unsigned int)drdx;
+			g += 4 * (unsigned int)dgdx;
+			b += 4 * (unsigned int)dbdx;
+			a += 4 * (unsigned int)dadx;
+		}
+		pixels += 4;
+		pz += 4;
+		buf += 4;
+		x += 4;
+		count -= 4;
+	}
+#endif
+
+	while (count > 0) {
+		putPixelTextureMappingPerspective<kDepthWrite, true, kSmoothMode, kEnableAlphaTest, kEnableScissor, false>(this, buf, texture, wrapS, wrapT,
+		                           pz, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+		buf++;
+		pz++;
+		x++;
+		count--;
+	}
+}
+
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, int kDrawLogic, bool kDepthWrite, bool kAlphaTestEnabled, bool kEnableScissor, bool kBlendingEnabled>
 void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint *p2) {
 	const Graphics::TexelBuffer *texture;
@@ -360,9 +768,18 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
+			// Scan lines outside of the scissor rectangle are skipped as a whole.
+			// The edges are still stepped, so the visible lines are unchanged.
+			// The shadow mask is not affected by the scissor rectangle.
+			if (kEnableScissor && kDrawLogic != DRAW_SHADOW_MASK && y >= _clipRectangle.bottom)
+				return;
 			int x = x1;
-			{
-				if (kDrawLogic == DRAW_DEPTH_ONLY ||
+			if (!kEnableScissor || kDrawLogic == DRAW_SHADOW_MASK || y >= _clipRectangle.top) {
+				if ((kDrawLogic == DRAW_FLAT || kDrawLogic == DRAW_SMOOTH) && !(kInterpST || kInterpSTZ) &&
+						!kAlphaTestEnabled && !kBlendingEnabled && _useSimdSpans) {
+					fillSpanSIMD<kDrawLogic == DRAW_SMOOTH, kDepthWrite, kEnableScissor>(pp1 + x1, pz1 + x1, x1, (x2 >> 16) - x1 + 1,
+					                                                                    z1, dzdx, r1, g1, b1, a1, drdx, dgdx, dbdx, dadx);
+				} else if (kDrawLogic == DRAW_DEPTH_ONLY ||
 						(kDrawLogic == DRAW_FLAT && !(kInterpST || kInterpSTZ))) {
 					int pp;
 					int n;
@@ -392,7 +809,7 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						if (kDrawLogic == DRAW_FLAT) {
 							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 0, x, y, z, r, g, b, a, dzdx);
 							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 1, x, y, z, r, g, b, a, dzdx);
-							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, g, a, dzdx);
+							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 2, x, y, z, r, g, b, a, dzdx);
 							putPixelFlat<kDepthWrite, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, pp, pz, 3, x, y, z, r, g, b, a, dzdx);
 						}
 						if (kInterpZ) {
@@ -536,9 +953,14 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 							fz += fndzdx;
 							zinv = (float)(1.0 / fz);
 						}
-						for (int _a = 0; _a < NB_INTERP; _a++) {
-							putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
-							                           pz, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						if (kInterpRGB && !kBlendingEnabled && _useSimdTextureSpans) {
+							fillTextureSpanSIMD<kDrawLogic == DRAW_SMOOTH, kDepthWrite, kAlphaTestEnabled, kEnableScissor>(buf, pz, x, y, NB_INTERP, texture,
+							                           z, s, t, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						} else {
+							for (int _a = 0; _a < NB_INTERP; _a++) {
+								putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
+								                           pz, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+							}
 						}
 						pz += NB_INTERP;
 						buf += NB_INTERP;
@@ -558,6 +980,11 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						dtdx = (int)((dtzdx - tt * fdzdx) * zinv);
 					}
 
+					if (kInterpRGB && !kBlendingEnabled && _useSimdTextureSpans && n >= 0) {
+						fillTextureSpanSIMD<kDrawLogic == DRAW_SMOOTH, kDepthWrite, kAlphaTestEnabled, kEnableScissor>(buf, pz, x, y, n + 1, texture,
+						                           z, s, t, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+						n = -1;
+					}
 					while (n >= 0) {
 						putPixelTextureMappingPerspective<kDepthWrite, kInterpRGB, kDrawLogic == DRAW_SMOOTH, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled>(this, buf, texture, wrapS, wrapT,
 						                           pz, 0, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
@@ -23,6 +23,7 @@
 
 
 #include "common/algorithm.h"
+#include "common/cpudetect.h"
 #include "common/endian.h"
 #include "common/util.h"
 #include "common/rect.h"
@@ -33,6 +34,15 @@
 #include "graphics/transparent_surface.h"
 #include "graphics/transform_tools.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#ifdef SCUMMVM_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Graphics {
 
 static const int kBModShift = 8;//img->format.bShift;
@@ -125,6 +135,474 @@ void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 	}
 }
 
+static bool useSimd = true;
+
+void TransparentSurface::enableSimd(bool enable) {
+	useSimd = enable;
+}
+
+#if defined(SCUMM_LITTLE_ENDIAN) && (defined(__SSE2__) || defined(__ARM_NEON))
+
+namespace {
+
+/*
+ * The row blenders load four pixels at a time as a PixelVec, with a byte
+ * per channel, and widen them to two ChannelVec of two pixels each, with
+ * 16 bits per channel, for the arithmetic. In both the channels of a
+ * pixel are in the order A, B, G, R.
+ */
+#if defined(__SSE2__)
+
+typedef __m128i PixelVec;
+typedef __m128i ChannelVec;
+
+inline PixelVec loadPixels(const byte *in, int32 inStep) {
+	if (inStep == 4)
+		return _mm_loadu_si128((const __m128i *)in);
+	if (inStep == -4)
+		return _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+	return _mm_setr_epi32((int)READ_UINT32(in), (int)READ_UINT32(in + inStep), (int)READ_UINT32(in + 2 * inStep), (int)READ_UINT32(in + 3 * inStep));
+}
+
+inline void storePixels(byte *out, PixelVec p) {
+	_mm_storeu_si128((__m128i *)out, p);
+}
+
+/** The alpha of each pixel in all of its channels. */
+inline PixelVec broadcastAlpha(PixelVec p) {
+	p = _mm_and_si128(p, _mm_set1_epi32(0xFF));
+	p = _mm_or_si128(p, _mm_slli_epi32(p, 8));
+	return _mm_or_si128(p, _mm_slli_epi32(p, 16));
+}
+
+inline ChannelVec widenLow(PixelVec p) {
+	return _mm_unpacklo_epi8(p, _mm_setzero_si128());
+}
+
+inline ChannelVec widenHigh(PixelVec p) {
+	return _mm_unpackhi_epi8(p, _mm_setzero_si128());
+}
+
+/** Pack the channels back to bytes, values above 255 saturate. */
+inline PixelVec narrow(ChannelVec lo, ChannelVec hi) {
+	return _mm_packus_epi16(lo, hi);
+}
+
+inline ChannelVec channels(uint16 a, uint16 b, uint16 g, uint16 r) {
+	return _mm_setr_epi16((short)a, (short)b, (short)g, (short)r, (short)a, (short)b, (short)g, (short)r);
+}
+
+inline ChannelVec splat(uint16 v) {
+	return _mm_set1_epi16((short)v);
+}
+
+inline ChannelVec add(ChannelVec a, ChannelVec b) {
+	return _mm_add_epi16(a, b);
+}
+
+inline ChannelVec sub(ChannelVec a, ChannelVec b) {
+	return _mm_sub_epi16(a, b);
+}
+
+/** The low 16 bits of the products. */
+inline ChannelVec mulLow(ChannelVec a, ChannelVec b) {
+	return _mm_mullo_epi16(a, b);
+}
+
+/** The high 16 bits of the unsigned products. */
+inline ChannelVec mulHigh(ChannelVec a, ChannelVec b) {
+	return _mm_mulhi_epu16(a, b);
+}
+
+inline ChannelVec shift8(ChannelVec a) {
+	return _mm_srli_epi16(a, 8);
+}
+
+inline ChannelVec isZero(ChannelVec a) {
+	return _mm_cmpeq_epi16(a, _mm_setzero_si128());
+}
+
+/** Channels of a where mask is set, of b elsewhere. */
+inline ChannelVec selectChannels(ChannelVec mask, ChannelVec a, ChannelVec b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+#elif defined(__ARM_NEON)
+
+typedef uint8x16_t PixelVec;
+typedef uint16x8_t ChannelVec;
+
+inline PixelVec loadPixels(const byte *in, int32 inStep) {
+	if (inStep == 4)
+		return vld1q_u8(in);
+	if (inStep == -4) {
+		const uint32x4_t p = vrev64q_u32(vreinterpretq_u32_u8(vld1q_u8(in - 12)));
+		return vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(p), vget_low_u32(p)));
+	}
+	uint32x4_t p = vdupq_n_u32(READ_UINT32(in));
+	p = vsetq_lane_u32(READ_UINT32(in + inStep), p, 1);
+	p = vsetq_lane_u32(READ_UINT32(in + 2 * inStep), p, 2);
+	p = vsetq_lane_u32(READ_UINT32(in + 3 * inStep), p, 3);
+	return vreinterpretq_u8_u32(p);
+}
+
+inline void storePixels(byte *out, PixelVec p) {
+	vst1q_u8(out, p);
+}
+
+/** The alpha of each pixel in all of its channels. */
+inline PixelVec broadcastAlpha(PixelVec p) {
+	uint32x4_t a = vandq_u32(vreinterpretq_u32_u8(p), vdupq_n_u32(0xFF));
+	a = vorrq_u32(a, vshlq_n_u32(a, 8));
+	return vreinterpretq_u8_u32(vorrq_u32(a, vshlq_n_u32(a, 16)));
+}
+
+inline ChannelVec widenLow(PixelVec p) {
+	return vmovl_u8(vget_low_u8(p));
+}
+
+inline ChannelVec widenHigh(PixelVec p) {
+	return vmovl_u8(vget_high_u8(p));
+}
+
+/** Pack the channels back to bytes, values above 255 saturate. */
+inline PixelVec narrow(ChannelVec lo, ChannelVec hi) {
+	return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+}
+
+inline ChannelVec channels(uint16 a, uint16 b, uint16 g, uint16 r) {
+	const uint16 lanes[8] = { a, b, g, r, a, b, g, r };
+	return vld1q_u16(lanes);
+}
+
+inline ChannelVec splat(uint16 v) {
+	return vdupq_n_u16(v);
+}
+
+inline ChannelVec add(ChannelVec a, ChannelVec b) {
+	return vaddq_u16(a, b);
+}
+
+inline ChannelVec sub(ChannelVec a, ChannelVec b) {
+	return vsubq_u16(a, b);
+}
+
+/** The low 16 bits of the products. */
+inline ChannelVec mulLow(ChannelVec a, ChannelVec b) {
+	return vmulq_u16(a, b);
+}
+
+/** The high 16 bits of the unsigned products. */
+inline ChannelVec mulHigh(ChannelVec a, ChannelVec b) {
+	const uint32x4_t lo = vmull_u16(vget_low_u16(a), vget_low_u16(b));
+	const uint32x4_t hi = vmull_u16(vget_high_u16(a), vget_high_u16(b));
+	return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+}
+
+inline ChannelVec shift8(ChannelVec a) {
+	return vshrq_n_u16(a, 8);
+}
+
+inline ChannelVec isZero(ChannelVec a) {
+	return vceqq_u16(a, vdupq_n_u16(0));
+}
+
+/** Channels of a where mask is set, of b elsewhere. */
+inline ChannelVec selectChannels(ChannelVec mask, ChannelVec a, ChannelVec b) {
+	return vbslq_u16(mask, a, b);
+}
+
+#endif
+
+#if defined(__SSE2__) && defined(SCUMMVM_TARGET_AVX2)
+
+/*
+ * The AVX2 helpers work on eight pixels in a __m256i. Unpacking and packing
+ * work on each 128-bit half, which keeps the pixels in order. The helpers
+ * taking no vectors are suffixed to tell them from the SSE2 ones.
+ */
+
+SCUMMVM_TARGET_AVX2
+inline __m256i loadPixelsAVX2(const byte *in, int32 inStep) {
+	if (inStep == 4)
+		return _mm256_loadu_si256((const __m256i *)in);
+	if (inStep == -4)
+		return _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i *)(in - 28)), _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+	return _mm256_setr_epi32((int)READ_UINT32(in), (int)READ_UINT32(in + inStep), (int)READ_UINT32(in + 2 * inStep), (int)READ_UINT32(in + 3 * inStep),
+	                         (int)READ_UINT32(in + 4 * inStep), (int)READ_UINT32(in + 5 * inStep), (int)READ_UINT32(in + 6 * inStep), (int)READ_UINT32(in + 7 * inStep));
+}
+
+SCUMMVM_TARGET_AVX2
+inline void storePixels(byte *out, __m256i p) {
+	_mm256_storeu_si256((__m256i *)out, p);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i broadcastAlpha(__m256i p) {
+	p = _mm256_and_si256(p, _mm256_set1_epi32(0xFF));
+	p = _mm256_or_si256(p, _mm256_slli_epi32(p, 8));
+	return _mm256_or_si256(p, _mm256_slli_epi32(p, 16));
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i widenLow(__m256i p) {
+	return _mm256_unpacklo_epi8(p, _mm256_setzero_si256());
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i widenHigh(__m256i p) {
+	return _mm256_unpackhi_epi8(p, _mm256_setzero_si256());
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i narrow(__m256i lo, __m256i hi) {
+	return _mm256_packus_epi16(lo, hi);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i channelsAVX2(uint16 a, uint16 b, uint16 g, uint16 r) {
+	return _mm256_setr_epi16((short)a, (short)b, (short)g, (short)r, (short)a, (short)b, (short)g, (short)r,
+	                         (short)a, (short)b, (short)g, (short)r, (short)a, (short)b, (short)g, (short)r);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i splatAVX2(uint16 v) {
+	return _mm256_set1_epi16((short)v);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i add(__m256i a, __m256i b) {
+	return _mm256_add_epi16(a, b);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i sub(__m256i a, __m256i b) {
+	return _mm256_sub_epi16(a, b);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i mulLow(__m256i a, __m256i b) {
+	return _mm256_mullo_epi16(a, b);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i mulHigh(__m256i a, __m256i b) {
+	return _mm256_mulhi_epu16(a, b);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i shift8(__m256i a) {
+	return _mm256_srli_epi16(a, 8);
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i isZero(__m256i a) {
+	return _mm256_cmpeq_epi16(a, _mm256_setzero_si256());
+}
+
+SCUMMVM_TARGET_AVX2
+inline __m256i selectChannels(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_blendv_epi8(b, a, mask);
+}
+
+#endif
+
+/**
+ * Blends rows of pixels four at a time, for one blend mode with or without
+ * a color modulation. The channels are computed with the same integer
+ * arithmetic as the scalar loops, so the result is identical:
+ *
+ * - Products of two bytes fit in 16 bits. The products of three or four
+ *   bytes are only needed shifted right by 16 or 24, which is the high
+ *   half of a 16x16 bit product, shifted right by 8 for the latter.
+ * - A color modulation of 255 is special cased to >> 8 instead of * c >> 16
+ *   by all modes but BLEND_NORMAL. Multiplying the high half by 256
+ *   instead gives the same.
+ * - Alpha blending may only be skipped where the scalar loops skip it;
+ *   the other modes leave the pixels they skip unchanged anyway.
+ */
+template<TSpriteBlendMode blendMode, bool tinted>
+class RowBlender {
+public:
+	RowBlender(uint32 color);
+
+	/**
+	 * Blend as many pixels of a row as possible four at a time and advance
+	 * in and out past them. Returns the number of pixels blended; the rest
+	 * is left to the scalar loop.
+	 */
+	uint32 blendRow(byte *&in, byte *&out, uint32 width, int32 inStep) const {
+		if (!useSimd)
+			return 0;
+
+		uint32 j = 0;
+#if defined(__SSE2__) && defined(SCUMMVM_TARGET_AVX2)
+		if (_useAVX2)
+			j = blendRowAVX2(in, out, width, inStep);
+#endif
+		for (; j + 4 <= width; j += 4) {
+			const PixelVec src = loadPixels(in, inStep);
+			const PixelVec dst = loadPixels(out, 4);
+			const PixelVec alpha = broadcastAlpha(src);
+			storePixels(out, narrow(blend(widenLow(src), widenLow(dst), widenLow(alpha)),
+			                        blend(widenHigh(src), widenHigh(dst), widenHigh(alpha))));
+			in += 4 * inStep;
+			out += 16;
+		}
+		return j;
+	}
+
+private:
+	ChannelVec blend(ChannelVec in, ChannelVec out, ChannelVec inA) const;
+
+#if defined(__SSE2__) && defined(SCUMMVM_TARGET_AVX2)
+	/** blendRow() for eight pixels at a time, for CPUs with AVX2. */
+	SCUMMVM_TARGET_AVX2 uint32 blendRowAVX2(byte *&in, byte *&out, uint32 width, int32 inStep) const;
+	SCUMMVM_TARGET_AVX2 __m256i blendAVX2(__m256i in, __m256i out, __m256i inA, __m256i alphaLanes,
+	                                      __m256i full, __m256i alphaMod, __m256i colorMod) const;
+
+	bool _useAVX2;
+#endif
+
+	uint16 _ca, _cb, _cg, _cr;	///< The alpha and color modulations
+	ChannelVec _alphaLanes;	///< 0xFFFF in the alpha channels
+	ChannelVec _full;		///< 255 in all channels
+	ChannelVec _alphaMod;	///< The alpha modulation in all channels
+	ChannelVec _colorMod;	///< The color modulation of each channel, 0 for alpha
+};
+
+template<TSpriteBlendMode blendMode, bool tinted>
+RowBlender<blendMode, tinted>::RowBlender(uint32 color) {
+	_ca = (color >> kAModShift) & 0xFF;
+	_cr = (color >> kRModShift) & 0xFF;
+	_cg = (color >> kGModShift) & 0xFF;
+	_cb = (color >> kBModShift) & 0xFF;
+
+	if (blendMode != BLEND_NORMAL) {
+		_cr = (_cr == 255) ? 256 : _cr;
+		_cg = (_cg == 255) ? 256 : _cg;
+		_cb = (_cb == 255) ? 256 : _cb;
+	}
+
+	_alphaLanes = channels(0xFFFF, 0, 0, 0);
+	_full = splat(255);
+	_alphaMod = splat(_ca);
+	_colorMod = channels(0, _cb, _cg, _cr);
+
+#if defined(__SSE2__) && defined(SCUMMVM_TARGET_AVX2)
+	_useAVX2 = Common::hasCpuFeature(Common::kCpuFeatureAVX2);
+#endif
+}
+
+template<TSpriteBlendMode blendMode, bool tinted>
+ChannelVec RowBlender<blendMode, tinted>::blend(ChannelVec in, ChannelVec out, ChannelVec inA) const {
+	// The alpha modulated by the color, for the modes which use it
+	const ChannelVec ina = tinted ? shift8(mulLow(inA, _alphaMod)) : inA;
+	ChannelVec result;
+
+	switch (blendMode) {
+	case BLEND_ADDITIVE:
+		// MIN(out + (in * ina * c >> 16), 255), the minimum is the saturation in narrow()
+		return add(out, mulHigh(mulLow(in, ina), _colorMod));
+
+	case BLEND_SUBTRACTIVE:
+		// out - (in * out * inA * c >> 24), which never goes below 0
+		result = sub(out, shift8(mulHigh(mulLow(in, out), mulLow(inA, _colorMod))));
+		return tinted ? selectChannels(_alphaLanes, _full, result) : result;
+
+	case BLEND_MULTIPLY:
+		// out * (in * ina * c >> 16) >> 8, which never goes above 255
+		result = shift8(mulLow(mulHigh(mulLow(in, ina), _colorMod), out));
+		result = selectChannels(_alphaLanes, out, result);
+		return tinted ? result : selectChannels(isZero(inA), out, result);
+
+	default:
+		if (tinted) {
+			// (out * (255 - ina) >> 8) + (in * ina * c >> 16)
+			result = add(shift8(mulLow(out, sub(_full, ina))), mulHigh(mulLow(in, ina), _colorMod));
+		} else {
+			// (in * inA + out * (255 - inA)) >> 8
+			result = shift8(add(mulLow(in, inA), mulLow(out, sub(_full, inA))));
+		}
+		result = selectChannels(_alphaLanes, _full, result);
+		return selectChannels(isZero(ina), out, result);
+	}
+}
+
+#if defined(__SSE2__) && defined(SCUMMVM_TARGET_AVX2)
+
+template<TSpriteBlendMode blendMode, bool tinted>
+uint32 RowBlender<blendMode, tinted>::blendRowAVX2(byte *&in, byte *&out, uint32 width, int32 inStep) const {
+	const __m256i alphaLanes = channelsAVX2(0xFFFF, 0, 0, 0);
+	const __m256i full = splatAVX2(255);
+	const __m256i alphaMod = splatAVX2(_ca);
+	const __m256i colorMod = channelsAVX2(0, _cb, _cg, _cr);
+
+	uint32 j = 0;
+	for (; j + 8 <= width; j += 8) {
+		const __m256i src = loadPixelsAVX2(in, inStep);
+		const __m256i dst = loadPixelsAVX2(out, 4);
+		const __m256i alpha = broadcastAlpha(src);
+		storePixels(out, narrow(blendAVX2(widenLow(src), widenLow(dst), widenLow(alpha), alphaLanes, full, alphaMod, colorMod),
+		                        blendAVX2(widenHigh(src), widenHigh(dst), widenHigh(alpha), alphaLanes, full, alphaMod, colorMod)));
+		in += 8 * inStep;
+		out += 32;
+	}
+	return j;
+}
+
+/** blend() on the AVX2 helpers. */
+template<TSpriteBlendMode blendMode, bool tinted>
+__m256i RowBlender<blendMode, tinted>::blendAVX2(__m256i in, __m256i out, __m256i inA, __m256i alphaLanes,
+                                                 __m256i full, __m256i alphaMod, __m256i colorMod) const {
+	const __m256i ina = tinted ? shift8(mulLow(inA, alphaMod)) : inA;
+	__m256i result;
+
+	switch (blendMode) {
+	case BLEND_ADDITIVE:
+		return add(out, mulHigh(mulLow(in, ina), colorMod));
+
+	case BLEND_SUBTRACTIVE:
+		result = sub(out, shift8(mulHigh(mulLow(in, out), mulLow(inA, colorMod))));
+		return tinted ? selectChannels(alphaLanes, full, result) : result;
+
+	case BLEND_MULTIPLY:
+		result = shift8(mulLow(mulHigh(mulLow(in, ina), colorMod), out));
+		result = selectChannels(alphaLanes, out, result);
+		return tinted ? result : selectChannels(isZero(inA), out, result);
+
+	default:
+		if (tinted)
+			result = add(shift8(mulLow(out, sub(full, ina))), mulHigh(mulLow(in, ina), colorMod));
+		else
+			result = shift8(add(mulLow(in, inA), mulLow(out, sub(full, inA))));
+		result = selectChannels(alphaLanes, full, result);
+		return selectChannels(isZero(ina), out, result);
+	}
+}
+
+#endif
+
+} // End of anonymous namespace
+
+#else
+
+namespace {
+
+template<TSpriteBlendMode blendMode, bool tinted>
+class RowBlender {
+public:
+	RowBlender(uint32) {}
+
+	uint32 blendRow(byte *&, byte *&, uint32, int32) const {
+		return 0;
+	}
+};
+
+} // End of anonymous namespace
+
+#endif
+
 /**
  * Optimized version of doBlit to be used with alpha blended blitting
  * @param ino a pointer to the input surface
@@ -142,10 +620,12 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 
 	if (color == 0xffffffff) {
 
+		const RowBlender<BLEND_NORMAL, false> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kAIndex] = 255;
@@ -167,10 +647,12 @@ void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32
 		byte cg = (color >> kGModShift) & 0xFF;
 		byte cb = (color >> kBModShift) & 0xFF;
 
+		const RowBlender<BLEND_NORMAL, true> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -203,10 +685,12 @@ void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 
 	if (color == 0xffffffff) {
 
+		const RowBlender<BLEND_ADDITIVE, false> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) + out[kRIndex], 255);
@@ -227,10 +711,12 @@ void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 		byte cg = (color >> kGModShift) & 0xFF;
 		byte cb = (color >> kBModShift) & 0xFF;
 
+		const RowBlender<BLEND_ADDITIVE, true> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -270,10 +756,12 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 
 	if (color == 0xffffffff) {
 
+		const RowBlender<BLEND_SUBTRACTIVE, false> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * out[kRIndex]) * in[kAIndex] >> 16), 0);
@@ -293,10 +781,12 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 		byte cg = (color >> kGModShift) & 0xFF;
 		byte cb = (color >> kBModShift) & 0xFF;
 
+		const RowBlender<BLEND_SUBTRACTIVE, true> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				out[kAIndex] = 255;
 				if (cb != 255) {
@@ -334,10 +824,12 @@ void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 	byte *out;
 
 	if (color == 0xffffffff) {
+		const RowBlender<BLEND_MULTIPLY, false> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				if (in[kAIndex] != 0) {
 					out[kRIndex] = MIN((in[kRIndex] * in[kAIndex] >> 8) * out[kRIndex] >> 8, 255);
@@ -357,10 +849,12 @@ void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 height, uin
 		byte cg = (color >> kGModShift) & 0xFF;
 		byte cb = (color >> kBModShift) & 0xFF;
 
+		const RowBlender<BLEND_MULTIPLY, true> rowBlender(color);
+
 		for (uint32 i = 0; i < height; i++) {
 			out = outo;
 			in = ino;
-			for (uint32 j = 0; j < width; j++) {
+			for (uint32 j = rowBlender.blendRow(in, out, width, inStep); j < width; j++) {
 
 				uint32 ina = in[kAIndex] * ca >> 8;
 
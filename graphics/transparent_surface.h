@@ -91,6 +91,13 @@ struct TransparentSurface : public Graphics::Surface {
 		return PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
 	}
 
+	/**
+	 * Enable or disable blending four pixels at a time with SSE2/NEON in
+	 * all blend modes, when available, or eight at a time on CPUs with
+	 * AVX2. The output is the same either way.
+	 */
+	static void enableSimd(bool enable);
+
 	/**
 	 @brief renders the surface to another surface
 	 @param target a pointer to the target surface. In most cases this is the framebuffer.
@@ -83,9 +83,18 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/jobsystem.h"
+#include "common/util.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 }
@@ -98,22 +107,39 @@ public:
 
 	Graphics::PixelFormat getFormat() const { return _format; }
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
+	bool getAlphaMode() const { return _alphaMode; }
 	const uint32 *getRGBToPix() const { return _rgbToPix; }
 	const uint32 *getAlphaToPix() const { return _alphaToPix; }
 
+	/** The alpha bits of every pixel when not in alpha mode */
+	uint32 getAlphaBits() const { return _alphaBits; }
+	/** Whether the alpha plane ends up in the pixels */
+	bool hasAlphaChannel() const { return _alphaMode && _format.aBits() == 8; }
+
 private:
+	friend class YUVToRGBManager;
+
+	/** References by the cache and by conversions in progress */
+	uint _refCount;
+
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
+	bool _alphaMode;
+	uint32 _alphaBits;
 	uint32 _rgbToPix[3 * 768]; // 9216 bytes
 	uint32 _alphaToPix[256];   // 958 bytes
 };
 
 YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale, bool alphaMode) {
+	_refCount = 0;
 	_format = format;
 	_scale = scale;
+	_alphaMode = alphaMode;
 
 	int alphaValue = alphaMode ? 0 : 255;
 
+	_alphaBits = format.ARGBToColor(alphaValue, 0, 0, 0);
+
 	uint32 *r_2_pix_alloc = &_rgbToPix[0 * 768];
 	uint32 *g_2_pix_alloc = &_rgbToPix[1 * 768];
 	uint32 *b_2_pix_alloc = &_rgbToPix[2 * 768];
@@ -167,9 +193,8 @@ YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::Lu
 }
 
 YUVToRGBManager::YUVToRGBManager() {
-	_lookup = 0;
-	_alphaMode = false;
-
+	_useSimd = true;
+	_useBands = true;
 	int16 *Cr_r_tab = &_colorTab[0 * 256];
 	int16 *Cr_g_tab = &_colorTab[1 * 256];
 	int16 *Cb_g_tab = &_colorTab[2 * 256];
@@ -190,32 +215,106 @@ YUVToRGBManager::YUVToRGBManager() {
 }
 
 YUVToRGBManager::~YUVToRGBManager() {
-	delete _lookup;
+	for (uint i = 0; i < _lookups.size(); i++)
+		delete _lookups[i];
 }
 
+namespace {
+enum {
+	/** Number of lookups kept around for decoders using different formats */
+	kMaxLookups = 4
+};
+} // End of anonymous namespace
+
 const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale, bool alphaMode) {
-	if (_lookup && _lookup->getFormat() == format && _lookup->getScale() == scale && _alphaMode == alphaMode)
-		return _lookup;
+	// Videos may be decoded on several threads at once
+	Common::StackLock lock(_lookupMutex);
+
+	for (uint i = 0; i < _lookups.size(); i++) {
+		YUVToRGBLookup *lookup = _lookups[i];
+		if (lookup->getFormat() == format && lookup->getScale() == scale && lookup->getAlphaMode() == alphaMode) {
+			// Move it to the front so the least recently used one is evicted
+			for (; i > 0; i--)
+				_lookups[i] = _lookups[i - 1];
+			_lookups[0] = lookup;
+			lookup->_refCount++;
+			return lookup;
+		}
+	}
 
-	_alphaMode = alphaMode;
-	delete _lookup;
-	_lookup = new YUVToRGBLookup(format, scale, alphaMode);
-	return _lookup;
+	if (_lookups.size() == kMaxLookups) {
+		// Conversions still using it release it when they are done
+		YUVToRGBLookup *evicted = _lookups.back();
+		_lookups.pop_back();
+		if (--evicted->_refCount == 0)
+			delete evicted;
+	}
+
+	// One reference for the cache and one for the caller
+	YUVToRGBLookup *lookup = new YUVToRGBLookup(format, scale, alphaMode);
+	lookup->_refCount = 2;
+	_lookups.insert_at(0, lookup);
+	return lookup;
 }
 
+void YUVToRGBManager::releaseLookup(const YUVToRGBLookup *lookup) {
+	Common::StackLock lock(_lookupMutex);
+
+	YUVToRGBLookup *released = const_cast<YUVToRGBLookup *>(lookup);
+	if (--released->_refCount == 0)
+		delete released;
+}
+
+namespace {
+
+/** The planes and destination of a conversion, or of a band of it */
+struct YUVFrame {
+	byte *dstPtr;
+	int dstPitch;
+	const YUVToRGBLookup *lookup;
+	const int16 *colorTab;
+	const byte *ySrc;
+	const byte *uSrc;
+	const byte *vSrc;
+	const byte *aSrc;
+	int yWidth;
+	int yHeight;
+	int yPitch;
+	int uvPitch;
+};
+
+typedef void (*ConvertFunc)(const YUVFrame &frame);
+
+enum {
+	/** Number of pixels of a 410 row the chroma is interpolated for at once */
+	kRowChunk = 256,
+	/** Minimum number of pixels of a frame to convert it in bands */
+	kMinBandedPixels = 640 * 360,
+	/** Minimum number of rows of a band */
+	kMinBandHeight = 32,
+	/** Maximum number of bands a frame is split into */
+	kMaxBands = 16
+};
+
+} // End of anonymous namespace
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
 
 template<typename PixelInt>
-void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV444ToRGB(const YUVFrame &frame) {
+	byte *dstPtr = frame.dstPtr;
+	const byte *ySrc = frame.ySrc, *uSrc = frame.uSrc, *vSrc = frame.vSrc;
+	const int dstPitch = frame.dstPitch, yWidth = frame.yWidth, yHeight = frame.yHeight;
+	const int yPitch = frame.yPitch, uvPitch = frame.uvPitch;
+
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = frame.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-
+	const uint32 *rgbToPix = frame.lookup->getRGBToPix();
 	for (int h = 0; h < yHeight; h++) {
 		for (int w = 0; w < yWidth; w++) {
 			const uint32 *L;
@@ -238,32 +337,21 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
-void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
-	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
-
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-}
-
 template<typename PixelInt>
-void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfHeight = yHeight >> 1;
+void convertYUV420ToRGB(const YUVFrame &frame) {
+	byte *dstPtr = frame.dstPtr;
+	const byte *ySrc = frame.ySrc, *uSrc = frame.uSrc, *vSrc = frame.vSrc;
+	const int dstPitch = frame.dstPitch, yWidth = frame.yWidth;
+	const int yPitch = frame.yPitch, uvPitch = frame.uvPitch;
+	int halfHeight = frame.yHeight >> 1;
 	int halfWidth = yWidth >> 1;
 
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = frame.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
+	const uint32 *rgbToPix = frame.lookup->getRGBToPix();
 
 	for (int h = 0; h < halfHeight; h++) {
 		for (int w = 0; w < halfWidth; w++) {
@@ -292,39 +380,26 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
-void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
-	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
-	assert((yWidth & 1) == 0);
-	assert((yHeight & 1) == 0);
-
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-}
-
 #define PUT_PIXELA(s, a, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b] | aToPix[a])
 
 template<typename PixelInt>
-void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	int halfHeight = yHeight >> 1;
+void convertYUVA420ToRGBA(const YUVFrame &frame) {
+	byte *dstPtr = frame.dstPtr;
+	const byte *ySrc = frame.ySrc, *uSrc = frame.uSrc, *vSrc = frame.vSrc, *aSrc = frame.aSrc;
+	const int dstPitch = frame.dstPitch, yWidth = frame.yWidth;
+	const int yPitch = frame.yPitch, uvPitch = frame.uvPitch;
+	int halfHeight = frame.yHeight >> 1;
 	int halfWidth = yWidth >> 1;
 
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = frame.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
-	const uint32 *aToPix = lookup->getAlphaToPix();
+	const uint32 *rgbToPix = frame.lookup->getRGBToPix();
+	const uint32 *aToPix = frame.lookup->getAlphaToPix();
 
 	for (int h = 0; h < halfHeight; h++) {
 		for (int w = 0; w < halfWidth; w++) {
@@ -356,23 +431,6 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 	}
 }
 
-void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
-	// Sanity checks
-	assert(dst && dst->getPixels());
-	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
-	assert(ySrc && uSrc && vSrc);
-	assert((yWidth & 1) == 0);
-	assert((yHeight & 1) == 0);
-
-	const YUVToRGBLookup *lookup = getLookup(dst->format, scale, true);
-
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUVA420ToRGBA<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUVA420ToRGBA<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
-}
-
 #define READ_QUAD(ptr, prefix) \
 	byte prefix##A = ptr[index]; \
 	byte prefix##B = ptr[index + 1]; \
@@ -398,13 +456,18 @@ void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::L
 	xDiff++
 
 template<typename PixelInt>
-void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup, int16 *colorTab, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+void convertYUV410ToRGB(const YUVFrame &frame) {
+	byte *dstPtr = frame.dstPtr;
+	const byte *ySrc = frame.ySrc, *uSrc = frame.uSrc, *vSrc = frame.vSrc;
+	const int dstPitch = frame.dstPitch, yWidth = frame.yWidth, yHeight = frame.yHeight;
+	const int yPitch = frame.yPitch, uvPitch = frame.uvPitch;
+
 	// Keep the tables in pointers here to avoid a dereference on each pixel
-	const int16 *Cr_r_tab = colorTab;
+	const int16 *Cr_r_tab = frame.colorTab;
 	const int16 *Cr_g_tab = Cr_r_tab + 256;
 	const int16 *Cb_g_tab = Cr_g_tab + 256;
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
-	const uint32 *rgbToPix = lookup->getRGBToPix();
+	const uint32 *rgbToPix = frame.lookup->getRGBToPix();
 
 	int quarterWidth = yWidth >> 2;
 
@@ -437,10 +500,560 @@ void convertYUV410ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	}
 }
 
+#if defined(__SSE2__) || defined(__ARM_NEON)
+
+namespace {
+
+/**
+ * Converts rows of pixels to a 32bpp format with a byte per channel, 16 or
+ * 8 at a time. The channels are clipped and scaled in vector registers,
+ * packed to bytes and interleaved, which gives the same pixels as the
+ * lookups. The template parameters are the bytes of a pixel in memory the
+ * channels go to; without an alpha channel its byte is zero.
+ *
+ * The color tables hold trunc(k * (c - 128)) for the four coefficients k.
+ * For |c - 128| <= 128 that equals ((|c - 128| << shift) * mul) >> 16 with
+ * the constants used below, so the chroma is computed rather than looked
+ * up. For the ITU scale, (i - 16) * 255 / 219 is computed as
+ * i + ((i * 10775) >> 16), which is exact for 0 <= i - 16 <= 219.
+ */
+template<int rPos, int gPos, int bPos, int aPos>
+class RowConverterSIMD {
+public:
+	RowConverterSIMD(const YUVToRGBLookup *lookup, const int16 *colorTab);
+
+	/** Convert count pixels which each have their own chroma. */
+	void convertRow(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int count) const;
+
+	/**
+	 * Convert two rows of count pixels which share the chroma of each 2x2
+	 * block. aSrc may be null.
+	 */
+	void convertRowPair(uint32 *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int count) const;
+
+private:
+	/** Convert one pixel through the lookup tables. */
+	uint32 convertPixel(byte y, byte u, byte v) const {
+		const uint32 *L = &_rgbToPix[y];
+		return L[_crRTab[v]] | L[_crGTab[v] + _cbGTab[u]] | L[_cbBTab[u]];
+	}
+
+	const uint32 *_rgbToPix;
+	const uint32 *_aToPix;
+	const int16 *_crRTab;
+	const int16 *_crGTab;
+	const int16 *_cbGTab;
+	const int16 *_cbBTab;
+	bool _itu;
+	byte _alpha;
+
+#if defined(__SSE2__)
+	void computeChroma(__m128i u, __m128i v, __m128i &dr, __m128i &dg, __m128i &db) const;
+	__m128i channelBytes(__m128i y, const __m128i *d) const;
+	void storePixels(uint32 *dst, __m128i y, const __m128i *dr, const __m128i *dg, const __m128i *db, __m128i a) const;
+#elif defined(__ARM_NEON)
+	void computeChroma(uint8x8_t u, uint8x8_t v, int16x8_t &dr, int16x8_t &dg, int16x8_t &db) const;
+	uint8x8_t channelBytes(uint8x8_t y, int16x8_t d) const;
+	void storePixels(uint32 *dst, uint8x8_t y, int16x8_t dr, int16x8_t dg, int16x8_t db, uint8x8_t a) const;
+#endif
+};
+
+template<int rPos, int gPos, int bPos, int aPos>
+RowConverterSIMD<rPos, gPos, bPos, aPos>::RowConverterSIMD(const YUVToRGBLookup *lookup, const int16 *colorTab) {
+	const Graphics::PixelFormat format = lookup->getFormat();
+
+	_rgbToPix = lookup->getRGBToPix();
+	_aToPix = lookup->getAlphaToPix();
+	_crRTab = colorTab;
+	_crGTab = _crRTab + 256;
+	_cbGTab = _crGTab + 256;
+	_cbBTab = _cbGTab + 256;
+	_itu = lookup->getScale() == YUVToRGBManager::kScaleITU;
+
+	_alpha = (lookup->getAlphaBits() >> format.aShift) & 0xFF;
+}
+
+#if defined(__SSE2__)
+
+inline __m128i mulChroma(__m128i c, int shift, int mul) {
+	const __m128i sign = _mm_srai_epi16(c, 15);
+	const __m128i magnitude = _mm_sub_epi16(_mm_xor_si128(c, sign), sign);
+	const __m128i product = _mm_mulhi_epu16(_mm_sll_epi16(magnitude, _mm_cvtsi32_si128(shift)), _mm_set1_epi16(mul));
+	return _mm_sub_epi16(_mm_xor_si128(product, sign), sign);
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+inline void RowConverterSIMD<rPos, gPos, bPos, aPos>::computeChroma(__m128i u, __m128i v, __m128i &dr, __m128i &dg, __m128i &db) const {
+	const __m128i cb = _mm_sub_epi16(u, _mm_set1_epi16(128));
+	const __m128i cr = _mm_sub_epi16(v, _mm_set1_epi16(128));
+
+	dr = mulChroma(cr, 7, 717);
+	dg = _mm_sub_epi16(_mm_setzero_si128(), _mm_add_epi16(mulChroma(cr, 6, 731), mulChroma(cb, 3, 2821)));
+	db = mulChroma(cb, 2, 29055);
+}
+
+/** Compute a channel of 16 pixels from their luminance and chroma terms. */
+template<int rPos, int gPos, int bPos, int aPos>
+inline __m128i RowConverterSIMD<rPos, gPos, bPos, aPos>::channelBytes(__m128i y, const __m128i *d) const {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(y, zero), d[0]);
+	__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(y, zero), d[1]);
+
+	if (_itu) {
+		const __m128i minimum = _mm_set1_epi16(16);
+		const __m128i maximum = _mm_set1_epi16(235);
+		const __m128i scale = _mm_set1_epi16(10775);
+		low = _mm_sub_epi16(_mm_max_epi16(_mm_min_epi16(low, maximum), minimum), minimum);
+		high = _mm_sub_epi16(_mm_max_epi16(_mm_min_epi16(high, maximum), minimum), minimum);
+		low = _mm_add_epi16(low, _mm_mulhi_epu16(low, scale));
+		high = _mm_add_epi16(high, _mm_mulhi_epu16(high, scale));
+	}
+
+	// Saturating takes care of the clipping of the full scale
+	return _mm_packus_epi16(low, high);
+}
+
+/** Store 16 pixels, each chroma term given for the low and high 8. */
+template<int rPos, int gPos, int bPos, int aPos>
+inline void RowConverterSIMD<rPos, gPos, bPos, aPos>::storePixels(uint32 *dst, __m128i y, const __m128i *dr, const __m128i *dg, const __m128i *db, __m128i a) const {
+	__m128i bytes[4];
+	bytes[rPos] = channelBytes(y, dr);
+	bytes[gPos] = channelBytes(y, dg);
+	bytes[bPos] = channelBytes(y, db);
+	bytes[aPos] = a;
+
+	const __m128i low01 = _mm_unpacklo_epi8(bytes[0], bytes[1]);
+	const __m128i high01 = _mm_unpackhi_epi8(bytes[0], bytes[1]);
+	const __m128i low23 = _mm_unpacklo_epi8(bytes[2], bytes[3]);
+	const __m128i high23 = _mm_unpackhi_epi8(bytes[2], bytes[3]);
+
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(low01, low23));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(low01, low23));
+	_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpacklo_epi16(high01, high23));
+	_mm_storeu_si128((__m128i *)(dst + 12), _mm_unpackhi_epi16(high01, high23));
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+void RowConverterSIMD<rPos, gPos, bPos, aPos>::convertRow(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int count) const {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi8(_alpha);
+	int x = 0;
+
+	for (; x + 16 <= count; x += 16) {
+		const __m128i u = _mm_loadu_si128((const __m128i *)(uSrc + x));
+		const __m128i v = _mm_loadu_si128((const __m128i *)(vSrc + x));
+
+		__m128i dr[2], dg[2], db[2];
+		computeChroma(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(v, zero), dr[0], dg[0], db[0]);
+		computeChroma(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(v, zero), dr[1], dg[1], db[1]);
+
+		storePixels(dst + x, _mm_loadu_si128((const __m128i *)(ySrc + x)), dr, dg, db, alpha);
+	}
+
+	for (; x < count; x++)
+		dst[x] = convertPixel(ySrc[x], uSrc[x], vSrc[x]);
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+void RowConverterSIMD<rPos, gPos, bPos, aPos>::convertRowPair(uint32 *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int count) const {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alpha = _mm_set1_epi8(_alpha);
+	uint32 *dst2 = (uint32 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+	const byte *aSrc2 = aSrc ? aSrc + yPitch : nullptr;
+	int x = 0;
+
+	for (; x + 16 <= count; x += 16) {
+		const __m128i u = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(uSrc + (x >> 1))), zero);
+		const __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(vSrc + (x >> 1))), zero);
+
+		__m128i r, g, b;
+		computeChroma(u, v, r, g, b);
+
+		// Each chroma value covers two pixels of both rows
+		const __m128i dr[2] = { _mm_unpacklo_epi16(r, r), _mm_unpackhi_epi16(r, r) };
+		const __m128i dg[2] = { _mm_unpacklo_epi16(g, g), _mm_unpackhi_epi16(g, g) };
+		const __m128i db[2] = { _mm_unpacklo_epi16(b, b), _mm_unpackhi_epi16(b, b) };
+
+		storePixels(dst + x, _mm_loadu_si128((const __m128i *)(ySrc + x)), dr, dg, db,
+		            aSrc ? _mm_loadu_si128((const __m128i *)(aSrc + x)) : alpha);
+		storePixels(dst2 + x, _mm_loadu_si128((const __m128i *)(ySrc2 + x)), dr, dg, db,
+		            aSrc2 ? _mm_loadu_si128((const __m128i *)(aSrc2 + x)) : alpha);
+	}
+
+	for (; x < count; x++) {
+		dst[x] = convertPixel(ySrc[x], uSrc[x >> 1], vSrc[x >> 1]);
+		dst2[x] = convertPixel(ySrc2[x], uSrc[x >> 1], vSrc[x >> 1]);
+		if (aSrc) {
+			dst[x] |= _aToPix[aSrc[x]];
+			dst2[x] |= _aToPix[aSrc2[x]];
+		}
+	}
+}
+
+#elif defined(__ARM_NEON)
+
+inline int16x8_t mulChroma(int16x8_t c, uint32 mul) {
+	const uint16x8_t magnitude = vreinterpretq_u16_s16(vabsq_s16(c));
+	const uint16x4_t productLow = vshrn_n_u32(vmulq_n_u32(vmovl_u16(vget_low_u16(magnitude)), mul), 16);
+	const uint16x4_t productHigh = vshrn_n_u32(vmulq_n_u32(vmovl_u16(vget_high_u16(magnitude)), mul), 16);
+	const int16x8_t product = vreinterpretq_s16_u16(vcombine_u16(productLow, productHigh));
+	return vbslq_s16(vcltq_s16(c, vdupq_n_s16(0)), vnegq_s16(product), product);
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+inline void RowConverterSIMD<rPos, gPos, bPos, aPos>::computeChroma(uint8x8_t u, uint8x8_t v, int16x8_t &dr, int16x8_t &dg, int16x8_t &db) const {
+	const int16x8_t cb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+	const int16x8_t cr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+
+	dr = mulChroma(cr, 717 << 7);
+	dg = vnegq_s16(vaddq_s16(mulChroma(cr, 731 << 6), mulChroma(cb, 2821 << 3)));
+	db = mulChroma(cb, 29055 << 2);
+}
+
+/** Compute a channel of 8 pixels from their luminance and chroma terms. */
+template<int rPos, int gPos, int bPos, int aPos>
+inline uint8x8_t RowConverterSIMD<rPos, gPos, bPos, aPos>::channelBytes(uint8x8_t y, int16x8_t d) const {
+	int16x8_t c = vaddq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), d);
+
+	if (_itu) {
+		c = vsubq_s16(vmaxq_s16(vminq_s16(c, vdupq_n_s16(235)), vdupq_n_s16(16)), vdupq_n_s16(16));
+		const uint16x8_t value = vreinterpretq_u16_s16(c);
+		const uint16x4_t scaledLow = vshrn_n_u32(vmull_n_u16(vget_low_u16(value), 10775), 16);
+		const uint16x4_t scaledHigh = vshrn_n_u32(vmull_n_u16(vget_high_u16(value), 10775), 16);
+		c = vreinterpretq_s16_u16(vaddq_u16(value, vcombine_u16(scaledLow, scaledHigh)));
+	}
+
+	// Saturating takes care of the clipping of the full scale
+	return vqmovun_s16(c);
+}
+
+/** Store 8 pixels. */
+template<int rPos, int gPos, int bPos, int aPos>
+inline void RowConverterSIMD<rPos, gPos, bPos, aPos>::storePixels(uint32 *dst, uint8x8_t y, int16x8_t dr, int16x8_t dg, int16x8_t db, uint8x8_t a) const {
+	uint8x8x4_t bytes;
+	bytes.val[rPos] = channelBytes(y, dr);
+	bytes.val[gPos] = channelBytes(y, dg);
+	bytes.val[bPos] = channelBytes(y, db);
+	bytes.val[aPos] = a;
+	vst4_u8((uint8 *)dst, bytes);
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+void RowConverterSIMD<rPos, gPos, bPos, aPos>::convertRow(uint32 *dst, const byte *ySrc, const byte *uSrc, const byte *vSrc, int count) const {
+	const uint8x8_t alpha = vdup_n_u8(_alpha);
+	int x = 0;
+
+	for (; x + 8 <= count; x += 8) {
+		int16x8_t dr, dg, db;
+		computeChroma(vld1_u8(uSrc + x), vld1_u8(vSrc + x), dr, dg, db);
+		storePixels(dst + x, vld1_u8(ySrc + x), dr, dg, db, alpha);
+	}
+
+	for (; x < count; x++)
+		dst[x] = convertPixel(ySrc[x], uSrc[x], vSrc[x]);
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+void RowConverterSIMD<rPos, gPos, bPos, aPos>::convertRowPair(uint32 *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int count) const {
+	const uint8x8_t alpha = vdup_n_u8(_alpha);
+	uint32 *dst2 = (uint32 *)((byte *)dst + dstPitch);
+	const byte *ySrc2 = ySrc + yPitch;
+	const byte *aSrc2 = aSrc ? aSrc + yPitch : nullptr;
+	int x = 0;
+
+	for (; x + 16 <= count; x += 16) {
+		int16x8_t r, g, b;
+		computeChroma(vld1_u8(uSrc + (x >> 1)), vld1_u8(vSrc + (x >> 1)), r, g, b);
+
+		// Each chroma value covers two pixels of both rows
+		const int16x8x2_t dr = vzipq_s16(r, r);
+		const int16x8x2_t dg = vzipq_s16(g, g);
+		const int16x8x2_t db = vzipq_s16(b, b);
+
+		for (int half = 0; half < 2; half++) {
+			const int offset = x + half * 8;
+			storePixels(dst + offset, vld1_u8(ySrc + offset), dr.val[half], dg.val[half], db.val[half],
+			            aSrc ? vld1_u8(aSrc + offset) : alpha);
+			storePixels(dst2 + offset, vld1_u8(ySrc2 + offset), dr.val[half], dg.val[half], db.val[half],
+			            aSrc2 ? vld1_u8(aSrc2 + offset) : alpha);
+		}
+	}
+
+	for (; x < count; x++) {
+		dst[x] = convertPixel(ySrc[x], uSrc[x >> 1], vSrc[x >> 1]);
+		dst2[x] = convertPixel(ySrc2[x], uSrc[x >> 1], vSrc[x >> 1]);
+		if (aSrc) {
+			dst[x] |= _aToPix[aSrc[x]];
+			dst2[x] |= _aToPix[aSrc2[x]];
+		}
+	}
+}
+
+#endif
+
+template<int rPos, int gPos, int bPos, int aPos>
+void convertYUV444ToRGBSIMD(const YUVFrame &frame) {
+	const RowConverterSIMD<rPos, gPos, bPos, aPos> converter(frame.lookup, frame.colorTab);
+
+	for (int h = 0; h < frame.yHeight; h++) {
+		converter.convertRow((uint32 *)(frame.dstPtr + h * frame.dstPitch), frame.ySrc + h * frame.yPitch,
+		                     frame.uSrc + h * frame.uvPitch, frame.vSrc + h * frame.uvPitch, frame.yWidth);
+	}
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+void convertYUV420ToRGBSIMD(const YUVFrame &frame) {
+	const RowConverterSIMD<rPos, gPos, bPos, aPos> converter(frame.lookup, frame.colorTab);
+	const bool hasAlpha = frame.aSrc && frame.lookup->hasAlphaChannel();
+
+	for (int h = 0; h < frame.yHeight; h += 2) {
+		converter.convertRowPair((uint32 *)(frame.dstPtr + h * frame.dstPitch), frame.dstPitch,
+		                         frame.ySrc + h * frame.yPitch, hasAlpha ? frame.aSrc + h * frame.yPitch : nullptr, frame.yPitch,
+		                         frame.uSrc + (h >> 1) * frame.uvPitch, frame.vSrc + (h >> 1) * frame.uvPitch, frame.yWidth);
+	}
+}
+
+template<int rPos, int gPos, int bPos, int aPos>
+void convertYUV410ToRGBSIMD(const YUVFrame &frame) {
+	const RowConverterSIMD<rPos, gPos, bPos, aPos> converter(frame.lookup, frame.colorTab);
+	const int uvPitch = frame.uvPitch;
+	byte uRow[kRowChunk], vRow[kRowChunk];
+
+	for (int y = 0; y < frame.yHeight; y++) {
+		uint32 *dst = (uint32 *)(frame.dstPtr + y * frame.dstPitch);
+		const byte *ySrc = frame.ySrc + y * frame.yPitch;
+		const int yDiff = y & 3;
+
+		for (int x = 0; x < frame.yWidth; x += kRowChunk) {
+			const int count = MIN<int>(kRowChunk, frame.yWidth - x);
+
+			// The same bilinear interpolation as convertYUV410ToRGB
+			for (int i = 0; i < count; i += 4) {
+				const int index = (y >> 2) * uvPitch + ((x + i) >> 2);
+				const byte *uSrc = frame.uSrc;
+				const byte *vSrc = frame.vSrc;
+				READ_QUAD(uSrc, u);
+				READ_QUAD(vSrc, v);
+
+				for (int xDiff = 0; xDiff < 4; xDiff++) {
+					byte u, v;
+					DO_INTERPOLATION(u);
+					DO_INTERPOLATION(v);
+					uRow[i + xDiff] = u;
+					vRow[i + xDiff] = v;
+				}
+			}
+
+			converter.convertRow(dst + x, ySrc + x, uRow, vRow, count);
+		}
+	}
+}
+
+/** The bytes of the red, green, blue and alpha channels in memory */
+struct ByteOrder {
+	int r, g, b, a;
+};
+
+static const ByteOrder kByteOrders[] = {
+	{ 2, 1, 0, 3 },
+	{ 3, 2, 1, 0 },
+	{ 0, 1, 2, 3 },
+	{ 1, 2, 3, 0 }
+};
+
+#define BYTE_ORDER_CONVERTERS(name) { \
+	name<2, 1, 0, 3>, \
+	name<3, 2, 1, 0>, \
+	name<0, 1, 2, 3>, \
+	name<1, 2, 3, 0>  \
+}
+
+static const ConvertFunc kConverters444[] = BYTE_ORDER_CONVERTERS(convertYUV444ToRGBSIMD);
+static const ConvertFunc kConverters420[] = BYTE_ORDER_CONVERTERS(convertYUV420ToRGBSIMD);
+static const ConvertFunc kConverters410[] = BYTE_ORDER_CONVERTERS(convertYUV410ToRGBSIMD);
+
+#undef BYTE_ORDER_CONVERTERS
+
+int getChannelByte(uint shift) {
+#ifdef SCUMM_BIG_ENDIAN
+	return 3 - shift / 8;
+#else
+	return shift / 8;
+#endif
+}
+
+/**
+ * Return the index in kByteOrders of the byte order of a format, or -1 if
+ * there are no SIMD converters for it.
+ */
+int findByteOrder(const Graphics::PixelFormat &format) {
+	if (format.bytesPerPixel != 4 || format.rBits() != 8 || format.gBits() != 8 || format.bBits() != 8)
+		return -1;
+	if (format.aBits() != 8 && format.aBits() != 0)
+		return -1;
+	if ((format.rShift | format.gShift | format.bShift | format.aShift) % 8 != 0)
+		return -1;
+
+	const int r = getChannelByte(format.rShift);
+	const int g = getChannelByte(format.gShift);
+	const int b = getChannelByte(format.bShift);
+	const int a = format.aBits() ? getChannelByte(format.aShift) : 6 - r - g - b;
+
+	for (int i = 0; i < (int)ARRAYSIZE(kByteOrders); i++) {
+		if (kByteOrders[i].r == r && kByteOrders[i].g == g && kByteOrders[i].b == b && kByteOrders[i].a == a)
+			return i;
+	}
+
+	return -1;
+}
+
+} // End of anonymous namespace
+
+#endif
+
 #undef READ_QUAD
 #undef DO_INTERPOLATION
 #undef DO_YUV410_PIXEL
 
+namespace {
+
+class ConvertBandJob : public Common::Job {
+public:
+	ConvertFunc func;
+	YUVFrame frame;
+
+	virtual void run() override {
+		func(frame);
+	}
+};
+
+/**
+ * Convert a frame, splitting it into bands of rows for the job system when
+ * it is large enough. Each band starts on a chroma row, which covers
+ * 1 << chromaShift luminance rows.
+ */
+void convertFrame(ConvertFunc func, const YUVFrame &frame, int chromaShift, bool useBands) {
+	int bands = 1;
+	if (useBands && frame.yWidth * frame.yHeight >= kMinBandedPixels) {
+		bands = MIN<int>(JobSys.getWorkerCount() + 1, frame.yHeight / kMinBandHeight);
+		bands = MIN<int>(bands, kMaxBands);
+	}
+
+	if (bands < 2) {
+		func(frame);
+		return;
+	}
+
+	ConvertBandJob jobs[kMaxBands];
+	Common::JobGroup group;
+	const int chromaRows = frame.yHeight >> chromaShift;
+	int top = 0;
+	for (int i = 0; i < bands; i++) {
+		const int bottom = (i == bands - 1) ? frame.yHeight : (chromaRows * (i + 1) / bands) << chromaShift;
+
+		ConvertBandJob &job = jobs[i];
+		job.func = func;
+		job.frame = frame;
+		job.frame.dstPtr += top * frame.dstPitch;
+		job.frame.ySrc += top * frame.yPitch;
+		if (frame.aSrc)
+			job.frame.aSrc += top * frame.yPitch;
+		job.frame.uSrc += (top >> chromaShift) * frame.uvPitch;
+		job.frame.vSrc += (top >> chromaShift) * frame.uvPitch;
+		job.frame.yHeight = bottom - top;
+		JobSys.submit(&job, &group);
+
+		top = bottom;
+	}
+
+	group.wait();
+}
+
+} // End of anonymous namespace
+
+void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc);
+
+	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVFrame frame = { (byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch };
+
+	// Use a templated function to avoid an if check on every pixel
+	ConvertFunc func;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	const int byteOrder = _useSimd ? findByteOrder(dst->format) : -1;
+	if (byteOrder >= 0)
+		func = kConverters444[byteOrder];
+	else
+#endif
+	if (dst->format.bytesPerPixel == 2)
+		func = convertYUV444ToRGB<uint16>;
+	else
+		func = convertYUV444ToRGB<uint32>;
+
+	convertFrame(func, frame, 0, _useBands);
+	releaseLookup(lookup);
+}
+
+void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc);
+	assert((yWidth & 1) == 0);
+	assert((yHeight & 1) == 0);
+
+	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVFrame frame = { (byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch };
+
+	// Use a templated function to avoid an if check on every pixel
+	ConvertFunc func;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	const int byteOrder = _useSimd ? findByteOrder(dst->format) : -1;
+	if (byteOrder >= 0)
+		func = kConverters420[byteOrder];
+	else
+#endif
+	if (dst->format.bytesPerPixel == 2)
+		func = convertYUV420ToRGB<uint16>;
+	else
+		func = convertYUV420ToRGB<uint32>;
+
+	convertFrame(func, frame, 1, _useBands);
+	releaseLookup(lookup);
+}
+
+void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, const byte *aSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	// Sanity checks
+	assert(dst && dst->getPixels());
+	assert(dst->format.bytesPerPixel == 2 || dst->format.bytesPerPixel == 4);
+	assert(ySrc && uSrc && vSrc);
+	assert((yWidth & 1) == 0);
+	assert((yHeight & 1) == 0);
+
+	const YUVToRGBLookup *lookup = getLookup(dst->format, scale, true);
+	const YUVFrame frame = { (byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch };
+
+	// Use a templated function to avoid an if check on every pixel
+	ConvertFunc func;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	const int byteOrder = _useSimd ? findByteOrder(dst->format) : -1;
+	if (byteOrder >= 0)
+		func = kConverters420[byteOrder];
+	else
+#endif
+	if (dst->format.bytesPerPixel == 2)
+		func = convertYUVA420ToRGBA<uint16>;
+	else
+		func = convertYUVA420ToRGBA<uint32>;
+
+	convertFrame(func, frame, 1, _useBands);
+	releaseLookup(lookup);
+}
+
 void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
 	// Sanity checks
 	assert(dst && dst->getPixels());
@@ -450,12 +1063,23 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yHeight & 3) == 0);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	const YUVFrame frame = { (byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, nullptr, yWidth, yHeight, yPitch, uvPitch };
 
 	// Use a templated function to avoid an if check on every pixel
+	ConvertFunc func;
+#if defined(__SSE2__) || defined(__ARM_NEON)
+	const int byteOrder = _useSimd ? findByteOrder(dst->format) : -1;
+	if (byteOrder >= 0)
+		func = kConverters410[byteOrder];
+	else
+#endif
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		func = convertYUV410ToRGB<uint16>;
 	else
-		convertYUV410ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		func = convertYUV410ToRGB<uint32>;
+
+	convertFrame(func, frame, 2, _useBands);
+	releaseLookup(lookup);
 }
 
 } // End of namespace Graphics
@@ -39,6 +39,8 @@
 #define GRAPHICS_YUV_TO_RGB_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
+#include "common/mutex.h"
 #include "common/singleton.h"
 #include "graphics/surface.h"
 
@@ -121,16 +123,37 @@ public:
 	 */
 	void convert410(Graphics::Surface *dst, LuminanceScale scale, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
 
+	/**
+	 * Enable or disable the SSE2/NEON row converters, which are used for
+	 * 32bpp formats with 8 bits per channel when available. The output is
+	 * the same either way.
+	 */
+	void enableSimd(bool enable) { _useSimd = enable; }
+
+	/**
+	 * Enable or disable splitting large frames into bands of rows which
+	 * are converted in parallel by the job system.
+	 */
+	void enableBands(bool enable) { _useBands = enable; }
+
 private:
 	friend class Common::Singleton<SingletonBaseType>;
 	YUVToRGBManager();
 	~YUVToRGBManager();
 
+	/**
+	 * Get a lookup for the format, which stays valid until it is passed to
+	 * releaseLookup(), even if it is evicted from the cache meanwhile.
+	 */
 	const YUVToRGBLookup *getLookup(Graphics::PixelFormat format, LuminanceScale scale, bool alphaMode = false);
+	void releaseLookup(const YUVToRGBLookup *lookup);
 
-	YUVToRGBLookup *_lookup;
+	/** Cached lookups, the most recently used first, guarded by _lookupMutex */
+	Common::Array<YUVToRGBLookup *> _lookups;
+	Common::Mutex _lookupMutex;
 	int16 _colorTab[4 * 256]; // 2048 bytes
-	bool _alphaMode;
+	bool _useSimd;
+	bool _useBands;
 };
  /** @} */
 } // End of namespace Graphics
@@ -30,9 +30,12 @@ DECLARE_SINGLETON(GUI::EventRecorder);
 }
 
 #include "common/debug-channels.h"
+#ifdef SDL_BACKEND
 #include "backends/timer/sdl/sdl-timer.h"
+#endif
 #include "backends/mixer/mixer.h"
 #include "common/config-manager.h"
+#include "common/fs.h"
 #include "common/md5.h"
 #include "gui/gui-manager.h"
 #include "gui/widget.h"
@@ -79,6 +82,11 @@ EventRecorder::EventRecorder() {
 	_screenshotPeriod = 0;
 	_playbackFile = nullptr;
 	_recordFile = nullptr;
+	_benchmark = false;
+	_benchmarkStart = 0;
+	_lastFrameTime = 0;
+	_benchmarkFrames = 0;
+	memset(_frameTimes, 0, sizeof(_frameTimes));
 }
 
 EventRecorder::~EventRecorder() {
@@ -89,6 +97,7 @@ void EventRecorder::deinit() {
 	if (!_initialized) {
 		return;
 	}
+	reportBenchmark();
 	setFileHeader();
 	_needRedraw = false;
 	_initialized = false;
@@ -244,6 +253,9 @@ void EventRecorder::processScreenUpdate() {
 	if (!_initialized) {
 		return;
 	}
+	if (_benchmark) {
+		processBenchmarkFrame();
+	}
 
 	Common::RecorderEvent screenUpdateEvent;
 	switch (_recordMode) {
@@ -381,7 +393,7 @@ Common::String EventRecorder::generateRecordFileName(const Common::String &targe
 }
 
 
-void EventRecorder::init(const Common::String &recordFileName, RecordMode mode) {
+void EventRecorder::init(const Common::String &recordFileName, RecordMode mode, bool benchmark) {
 	_fakeMixerManager = new NullMixerManager();
 	_fakeMixerManager->init();
 	_fakeMixerManager->suspendAudio();
@@ -390,6 +402,14 @@ void EventRecorder::init(const Common::String &recordFileName, RecordMode mode)
 	_lastScreenshotTime = 0;
 	_recordMode = mode;
 	_needcontinueGame = false;
+	_benchmark = benchmark;
+	if (_benchmark) {
+		_fastPlayback = true;
+		_benchmarkStart = _lastFrameTime = _lastMillis;
+		_benchmarkFrames = 0;
+		memset(_frameTimes, 0, sizeof(_frameTimes));
+		_benchmarkChecksums.clear();
+	}
 	if (ConfMan.hasKey("disable_display")) {
 		DebugMan.enableDebugChannel("EventRec");
 		gDebugLevel = 1;
@@ -558,7 +578,12 @@ void EventRecorder::registerTimerManager(DefaultTimerManager *timerManager) {
 void EventRecorder::switchTimerManagers() {
 	delete _timerManager;
 	if (_recordMode == kPassthrough) {
+#ifdef SDL_BACKEND
 		_timerManager = new SdlTimerManager();
+#else
+		// Backends without timer threads drive it from their event loop
+		_timerManager = new DefaultTimerManager();
+#endif
 	} else {
 		_timerManager = new DefaultTimerManager();
 	}
@@ -670,6 +695,92 @@ bool EventRecorder::grabScreenAndComputeMD5(Graphics::Surface &screen, uint8 md5
 	return true;
 }
 
+static Common::String md5ToString(const uint8 md5[16]) {
+	Common::String result;
+	for (int i = 0; i < 16; i++) {
+		result += Common::String::format("%02x", md5[i]);
+	}
+	return result;
+}
+
+void EventRecorder::processScreenChecksum(const uint8 recordedMD5[16], const uint8 currentMD5[16]) {
+	if (!_benchmark) {
+		return;
+	}
+	BenchmarkChecksum checksum;
+	checksum.time = _fakeTimer;
+	checksum.recordedMD5 = md5ToString(recordedMD5);
+	checksum.currentMD5 = md5ToString(currentMD5);
+	_benchmarkChecksums.push_back(checksum);
+}
+
+uint32 EventRecorder::getRealMillis() {
+	// The backend only reports the fake timer while the recording is active
+	acquireRecording();
+	uint32 millis = g_system->getMillis();
+	releaseRecording();
+	return millis;
+}
+
+void EventRecorder::processBenchmarkFrame() {
+	uint32 now = getRealMillis();
+	uint32 frameTime = now - _lastFrameTime;
+	_lastFrameTime = now;
+
+	int bucket = 0;
+	while (frameTime && bucket < kBenchmarkBuckets - 1) {
+		frameTime >>= 1;
+		bucket++;
+	}
+	_frameTimes[bucket]++;
+	_benchmarkFrames++;
+}
+
+/**
+ * Get the peak resident set size in kB, which is only known on systems
+ * providing /proc/self/status.
+ */
+static Common::String getPeakRSS() {
+	Common::FSNode node("/proc/self/status");
+	Common::SeekableReadStream *stream = node.createReadStream();
+	if (!stream) {
+		return "unknown";
+	}
+	Common::String result = "unknown";
+	while (!stream->eos() && !stream->err()) {
+		Common::String line = stream->readLine();
+		if (line.hasPrefix("VmHWM:")) {
+			result = Common::String::format("%d", atoi(line.c_str() + 6));
+			break;
+		}
+	}
+	delete stream;
+	return result;
+}
+
+void EventRecorder::reportBenchmark() {
+	if (!_benchmark) {
+		return;
+	}
+	_benchmark = false;
+
+	uint32 wallTime = getRealMillis() - _benchmarkStart;
+	debug("benchmark:action=report walltime=%u replayedtime=%u frames=%u peakrss=%s", wallTime, _fakeTimer, _benchmarkFrames, getPeakRSS().c_str());
+	for (int i = 0; i < kBenchmarkBuckets; i++) {
+		uint32 minTime = i ? 1 << (i - 1) : 0;
+		if (i == kBenchmarkBuckets - 1) {
+			debug("benchmark:action=frametime min=%u max=inf frames=%u", minTime, _frameTimes[i]);
+		} else {
+			debug("benchmark:action=frametime min=%u max=%u frames=%u", minTime, i ? (1 << i) - 1 : 0, _frameTimes[i]);
+		}
+	}
+	for (uint i = 0; i < _benchmarkChecksums.size(); i++) {
+		const BenchmarkChecksum &checksum = _benchmarkChecksums[i];
+		debug("benchmark:action=checksum time=%u recorded=%s current=%s result=%s", checksum.time, checksum.recordedMD5.c_str(), checksum.currentMD5.c_str(),
+		      checksum.recordedMD5 == checksum.currentMD5 ? "equal" : "different");
+	}
+}
+
 Common::SeekableReadStream *EventRecorder::processSaveStream(const Common::String &fileName) {
 	Common::InSaveFile *saveFile;
 	switch (_recordMode) {
@@ -698,6 +809,9 @@ Common::SaveFileManager *EventRecorder::getSaveManager(Common::SaveFileManager *
 }
 
 void EventRecorder::preDrawOverlayGui() {
+	if (_benchmark) {
+		return;
+	}
 	if ((_initialized) || (_needRedraw)) {
 		RecordMode oldMode = _recordMode;
 		_recordMode = kPassthrough;
@@ -715,6 +829,9 @@ void EventRecorder::preDrawOverlayGui() {
 }
 
 void EventRecorder::postDrawOverlayGui() {
+	if (_benchmark) {
+		return;
+	}
 	if ((_initialized) || (_needRedraw)) {
 		RecordMode oldMode = _recordMode;
 		_recordMode = kPassthrough;
@@ -755,10 +872,12 @@ void EventRecorder::setFileHeader() {
 	_recordFile->getHeader().name = _name;
 }
 
+#ifdef SDL_BACKEND
 SDL_Surface *EventRecorder::getSurface(int width, int height) {
 	// Create a RGB565 surface of the requested dimensions.
 	return SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 16, 0xF800, 0x07E0, 0x001F, 0x0000);
 }
+#endif
 
 bool EventRecorder::switchMode() {
 	const Plugin *plugin = EngineMan.findPlugin(ConfMan.get("engineid"));
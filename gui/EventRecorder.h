@@ -39,7 +39,10 @@
 #include "backends/mixer/mixer.h"
 #include "common/hashmap.h"
 #include "common/hash-str.h"
-#include "backends/timer/sdl/sdl-timer.h"
+#include "backends/timer/default/default-timer.h"
+#ifdef SDL_BACKEND
+#include "backends/platform/sdl/sdl-sys.h"
+#endif
 #include "common/config-manager.h"
 #include "common/recorderfile.h"
 #include "backends/saves/recorder/recorder-saves.h"
@@ -78,7 +81,14 @@ public:
 		kRecorderUpdate = 4			/**< kRecorderUpdate, playback existing recording and update all hashes */
 	};
 
-	void init(const Common::String &recordFileName, RecordMode mode);
+	/**
+	 * Start recording or playing back.
+	 *
+	 * @param benchmark  Play back as fast as possible, without drawing the
+	 *                   control panel, and print a report with the timings
+	 *                   and checked screenshots at the end.
+	 */
+	void init(const Common::String &recordFileName, RecordMode mode, bool benchmark = false);
 	void deinit();
 	bool processDelayMillis();
 	uint32 getRandomSeed(const Common::String &name);
@@ -178,12 +188,20 @@ public:
 	Common::String generateRecordFileName(const Common::String &target);
 
 	Common::SaveFileManager *getSaveManager(Common::SaveFileManager *realSaveManager);
+#ifdef SDL_BACKEND
 	SDL_Surface *getSurface(int width, int height);
+#endif
 	void RegisterEventSource();
 
 	/** Retrieve game screenshot and compute its checksum for comparison */
 	bool grabScreenAndComputeMD5(Graphics::Surface &screen, uint8 md5[16]);
 
+	/** Remember the result of comparing a recorded screenshot for the benchmark report */
+	void processScreenChecksum(const uint8 recordedMD5[16], const uint8 currentMD5[16]);
+
+	/** Print the benchmark report, if benchmarking and it was not printed yet */
+	void reportBenchmark();
+
 	void updateSubsystems();
 	bool switchMode();
 	void switchFastMode();
@@ -250,6 +268,25 @@ private:
 	bool _fastPlayback;
 	bool _needRedraw;
 	bool _processingMillis;
+
+	/** Frame times are counted in buckets of powers of two milliseconds */
+	static const int kBenchmarkBuckets = 12;
+
+	struct BenchmarkChecksum {
+		uint32 time;
+		Common::String recordedMD5;
+		Common::String currentMD5;
+	};
+
+	uint32 getRealMillis();
+	void processBenchmarkFrame();
+
+	bool _benchmark;
+	uint32 _benchmarkStart;
+	uint32 _lastFrameTime;
+	uint32 _benchmarkFrames;
+	uint32 _frameTimes[kBenchmarkBuckets];
+	Common::Array<BenchmarkChecksum> _benchmarkChecksums;
 };
 
 } // End of namespace GUI
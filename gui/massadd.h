@@ -39,6 +39,7 @@ class MassAddDialog : public Dialog {
 	typedef Common::Array<Common::U32String> U32StringArray;
 public:
 	MassAddDialog(const Common::FSNode &startDir);
+	~MassAddDialog() override;
 
 	//void open();
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
@@ -64,6 +65,7 @@ private:
 	int _dirsScanned;
 	int _oldGamesCount;
 	int _dirTotal;
+	uint32 _scanStartTime;
 
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
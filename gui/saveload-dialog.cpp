@@ -1166,6 +1166,9 @@ void SaveLoadChooserGrid::updateSaves() {
 		curButton.description->setEnabled(!desc.getLocked());
 	}
 
+	// Keep the headers of saves which were not in the metadata index yet
+	g_system->getSavefileManager()->flushSavefileMetadata();
+
 	const uint numPages = (_entriesPerPage != 0 && !_saveList.empty()) ? ((_saveList.size() + _entriesPerPage - 1) / _entriesPerPage) : 1;
 	_pageDisplay->setLabel(Common::String::format("%u/%u", _curPage + 1, numPages));
 
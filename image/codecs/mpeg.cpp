@@ -101,9 +101,12 @@ bool MPEGDecoder::decodePacket(Common::SeekableReadStream &packet, uint32 &frame
 					dst = _surface;
 				}
 
+				const uint32 convertStart = g_system->getMillis(true);
 				YUVToRGBMan.convert420(dst, Graphics::YUVToRGBManager::kScaleITU, _mpegInfo->display_fbuf->buf[0],
 						_mpegInfo->display_fbuf->buf[1], _mpegInfo->display_fbuf->buf[2], sequence->picture_width,
 						sequence->picture_height, sequence->width, sequence->chroma_width);
+				debug(9, "MPEG: Converted %dx%d frame to RGB in %d ms", sequence->picture_width,
+						sequence->picture_height, g_system->getMillis(true) - convertStart);
 			}
 			break;
 		default:
@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/random.h"
+#include "common/util.h"
+
+class MixBusTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_mix_to_bus() {
+		// Use an odd number of sample pairs, so that the scalar tail of the
+		// vectorized implementations is exercised as well.
+		const uint len = 301;
+		const Audio::st_volume_t volumes[] = { 0, 1, 100, 255, Audio::Mixer::kMaxMixerVolume };
+
+		Common::RandomSource rnd("mixbus");
+		int16 src[2 * len];
+		for (uint i = 0; i < 2 * len; ++i)
+			src[i] = (int16)(rnd.getRandomNumber(0xFFFF) - 0x8000);
+		src[0] = -32768;
+		src[1] = 32767;
+
+		for (int l = 0; l < ARRAYSIZE(volumes); ++l) {
+			for (int r = 0; r < ARRAYSIZE(volumes); ++r) {
+				int32 bus[2 * len];
+				for (uint i = 0; i < 2 * len; ++i)
+					bus[i] = (int32)i - 100;
+
+				Audio::mixToBus(bus, src, len, volumes[l], volumes[r]);
+
+				for (uint i = 0; i < 2 * len; ++i) {
+					const int vol = (i & 1) ? volumes[r] : volumes[l];
+					TS_ASSERT_EQUALS(bus[i], (int32)i - 100 + (src[i] * vol) / Audio::Mixer::kMaxMixerVolume);
+				}
+			}
+		}
+	}
+
+	void test_mix_submix_to_bus() {
+		const uint len = 7;
+		const Audio::st_volume_t volumes[] = { 0, 1, 128, 255, Audio::Mixer::kMaxMixerVolume };
+
+		int32 submix[2 * len];
+		for (uint i = 0; i < 2 * len; ++i)
+			submix[i] = ((int32)i - (int32)len) * 3000000 + 1;
+
+		for (int v = 0; v < ARRAYSIZE(volumes); ++v) {
+			int32 bus[2 * len];
+			for (uint i = 0; i < 2 * len; ++i)
+				bus[i] = (int32)i;
+
+			Audio::mixSubmixToBus(bus, submix, len, volumes[v]);
+
+			for (uint i = 0; i < 2 * len; ++i)
+				TS_ASSERT_EQUALS(bus[i], (int32)i + (int32)(((int64)submix[i] * volumes[v]) / Audio::Mixer::kMaxMixerVolume));
+		}
+	}
+
+	void test_clamp_bus_to_output() {
+		const uint len = 13;
+		int32 bus[2 * len];
+		int16 out[2 * len];
+
+		for (uint i = 0; i < 2 * len; ++i)
+			bus[i] = ((int32)i - (int32)len) * 5000;
+
+		Audio::clampBusToOutput(out, bus, len);
+
+		for (uint i = 0; i < 2 * len; ++i)
+			TS_ASSERT_EQUALS(out[i], (int16)CLIP<int32>(bus[i], -32768, 32767));
+	}
+};
@@ -0,0 +1,114 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mixer_intern.h"
+#include "audio/decoders/raw.h"
+#include "audio/audiostream.h"
+
+#include "common/thread.h"
+#include "../null_osystem.h"
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+	static const int kRate = 22050;
+	static const int kSample = 10000;
+
+	/** Play a looping stereo stream of a constant sample */
+	static Audio::SoundHandle playConstant(Audio::MixerImpl &mixer) {
+		const int count = 2 * 1024;
+		int16 *samples = (int16 *)malloc(count * sizeof(int16));
+		for (int i = 0; i < count; ++i)
+			samples[i] = kSample;
+
+		Audio::RewindableAudioStream *stream = Audio::makeRawStream((byte *)samples, count * sizeof(int16), kRate,
+#ifdef SCUMM_LITTLE_ENDIAN
+			Audio::FLAG_LITTLE_ENDIAN |
+#endif
+			Audio::FLAG_16BITS | Audio::FLAG_STEREO);
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, Audio::makeLoopingAudioStream(stream, 0),
+		                 -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false, false);
+		return handle;
+	}
+
+	struct PostData {
+		Audio::MixerImpl *mixer;
+		Audio::SoundHandle handle;
+		byte volume;
+	};
+
+	static void postVolumes(void *data) {
+		PostData *post = (PostData *)data;
+		for (int i = 0; i < 5000; ++i)
+			post->mixer->setChannelVolume(post->handle, (i & 1) ? post->volume : 0);
+		post->mixer->setChannelVolume(post->handle, post->volume);
+	}
+
+	public:
+	void test_queued_channel_changes() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerImpl mixer(kRate);
+		mixer.setReady(true);
+		const Audio::SoundHandle handle = playConstant(mixer);
+
+		// More changes than the queue holds, the last one wins
+		for (int i = 0; i < 1000; ++i) {
+			mixer.setChannelVolume(handle, i & 0xFF);
+			mixer.setChannelBalance(handle, (int8)(i % 127));
+		}
+		mixer.setChannelVolume(handle, Audio::Mixer::kMaxChannelVolume);
+		mixer.setChannelBalance(handle, 0);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), Audio::Mixer::kMaxChannelVolume);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), 0);
+
+		int16 out[2 * 64];
+		mixer.mixCallback((byte *)out, sizeof(out));
+		for (int i = 0; i < ARRAYSIZE(out); ++i)
+			TS_ASSERT_EQUALS(out[i], kSample);
+
+		// Queued changes are applied before the next mix
+		mixer.setChannelVolume(handle, 0);
+		mixer.mixCallback((byte *)out, sizeof(out));
+		for (int i = 0; i < ARRAYSIZE(out); ++i)
+			TS_ASSERT_EQUALS(out[i], 0);
+
+		// Changes to stopped sounds are ignored
+		mixer.stopHandle(handle);
+		mixer.setChannelVolume(handle, 100);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 0);
+#endif
+	}
+
+	void test_concurrent_channel_changes() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Audio::MixerImpl mixer(kRate);
+		mixer.setReady(true);
+		const Audio::SoundHandle handle = playConstant(mixer);
+
+		PostData post[2];
+		Common::Thread threads[2];
+		for (int i = 0; i < 2; ++i) {
+			post[i].mixer = &mixer;
+			post[i].handle = handle;
+			post[i].volume = 100 + i;
+			if (!threads[i].start(postVolumes, &post[i]))
+				postVolumes(&post[i]);
+		}
+
+		int16 out[2 * 64];
+		for (int i = 0; i < 200; ++i)
+			mixer.mixCallback((byte *)out, sizeof(out));
+
+		for (int i = 0; i < 2; ++i)
+			threads[i].join();
+
+		// Both threads end with their own volume, one of them is last
+		const byte volume = mixer.getChannelVolume(handle);
+		TS_ASSERT(volume == 100 || volume == 101);
+#endif
+	}
+};
@@ -0,0 +1,129 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/decoders/raw.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+
+#include "common/memstream.h"
+#include "../null_osystem.h"
+
+#include <math.h>
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+	public:
+	static Audio::AudioStream *createStream(int rate, bool stereo, const int16 *data, int samples) {
+		int16 *copy = (int16 *)malloc(samples * sizeof(int16));
+		memcpy(copy, data, samples * sizeof(int16));
+		Common::SeekableReadStream *s = new Common::MemoryReadStream((const byte *)copy, samples * sizeof(int16), DisposeAfterUse::YES);
+		return Audio::makeRawStream(s, rate, Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0)
+#ifdef SCUMM_LITTLE_ENDIAN
+		                            | Audio::FLAG_LITTLE_ENDIAN
+#endif
+		                            , DisposeAfterUse::YES);
+	}
+
+	void test_polyphase_dc() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// The polyphase filter has unity gain at DC, so a constant input
+		// must come out unchanged once the filter window is filled
+		Common::install_null_g_system();
+
+		const Audio::ResamplerQuality qualities[] = { Audio::kResamplerPolyphase, Audio::kResamplerPolyphaseBest };
+		const int rates[][2] = { { 11025, 48000 }, { 22050, 44100 }, { 22254, 44100 }, { 48000, 22050 } };
+
+		for (int q = 0; q < ARRAYSIZE(qualities); ++q) {
+			for (int r = 0; r < ARRAYSIZE(rates); ++r) {
+				const int inSamples = 4000;
+				int16 in[2 * inSamples];
+				for (int i = 0; i < inSamples; ++i) {
+					in[2 * i] = 1000;
+					in[2 * i + 1] = -20000;
+				}
+
+				Audio::AudioStream *stream = createStream(rates[r][0], true, in, 2 * inSamples);
+				Audio::RateConverter *conv = Audio::makeRateConverter(rates[r][0], rates[r][1], true, false, qualities[q]);
+
+				const int outSamples = 1000;
+				int16 out[2 * outSamples];
+				memset(out, 0, sizeof(out));
+				TS_ASSERT_EQUALS(conv->flow(*stream, out, outSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outSamples);
+
+				for (int i = 200; i < outSamples; ++i) {
+					TS_ASSERT_EQUALS(out[2 * i], 1000);
+					TS_ASSERT_EQUALS(out[2 * i + 1], -20000);
+				}
+
+				delete conv;
+				delete stream;
+			}
+		}
+#endif
+	}
+
+	void test_polyphase_sine() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// A 1 kHz tone must keep its amplitude when upsampled
+		Common::install_null_g_system();
+
+		const int inRate = 11025, outRate = 48000;
+		const int inSamples = inRate / 2;
+		int16 in[inSamples];
+		for (int i = 0; i < inSamples; ++i)
+			in[i] = (int16)(sin(2 * M_PI * 1000 * i / inRate) * 16000);
+
+		Audio::AudioStream *stream = createStream(inRate, false, in, inSamples);
+		Audio::RateConverter *conv = Audio::makeRateConverter(inRate, outRate, false, false, Audio::kResamplerPolyphase);
+
+		const int outSamples = 2000;
+		int16 out[2 * outSamples];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(conv->flow(*stream, out, outSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), outSamples);
+
+		int peak = 0;
+		for (int i = 100; i < outSamples; ++i) {
+			TS_ASSERT_EQUALS(out[2 * i], out[2 * i + 1]);
+			peak = MAX<int>(peak, ABS<int>(out[2 * i]));
+		}
+		TS_ASSERT_LESS_THAN(15800, peak);
+		TS_ASSERT_LESS_THAN(peak, 16200);
+
+		delete conv;
+		delete stream;
+#endif
+	}
+
+	void test_polyphase_tail() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// Every input sample comes out, including the ones which only fill
+		// the filter window once the stream has ended
+		Common::install_null_g_system();
+
+		const Audio::ResamplerQuality qualities[] = { Audio::kResamplerPolyphase, Audio::kResamplerPolyphaseBest };
+
+		for (int q = 0; q < ARRAYSIZE(qualities); ++q) {
+			const int inSamples = 1000;
+			int16 in[inSamples];
+			for (int i = 0; i < inSamples; ++i)
+				in[i] = 1000;
+
+			Audio::AudioStream *stream = createStream(11025, false, in, inSamples);
+			Audio::RateConverter *conv = Audio::makeRateConverter(11025, 44100, false, false, qualities[q]);
+
+			const int outSamples = 8 * inSamples;
+			int16 out[2 * outSamples];
+			memset(out, 0, sizeof(out));
+			TS_ASSERT_EQUALS(conv->flow(*stream, out, outSamples, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), 4 * inSamples);
+			TS_ASSERT(!conv->hasTail());
+
+			// The filter only reaches past the end in the last few samples
+			for (int i = 200; i < 4 * inSamples - 200; ++i)
+				TS_ASSERT_EQUALS(out[2 * i], 1000);
+			TS_ASSERT_DIFFERS(out[2 * (4 * inSamples - 1)], 0);
+
+			delete conv;
+			delete stream;
+		}
+#endif
+	}
+};
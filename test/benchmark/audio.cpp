@@ -0,0 +1,257 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/system.h"
+#include "common/thread.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "audio/rate.h"
+#include "audio/decoders/raw.h"
+
+#include "test/benchmark/benchmark.h"
+
+namespace {
+
+/** Create a looping stream of a tone to mix or resample */
+Audio::AudioStream *makeBenchmarkTone(int rate, bool stereo, int pitch) {
+	const int count = (stereo ? 2 : 1) * (rate / 4);
+	int16 *samples = (int16 *)malloc(count * sizeof(int16));
+	for (int i = 0; i < count; ++i)
+		samples[i] = (int16)(((i * pitch) & 0x3FFF) - 0x2000);
+
+	byte flags = Audio::FLAG_16BITS | (stereo ? Audio::FLAG_STEREO : 0);
+#ifdef SCUMM_LITTLE_ENDIAN
+	flags |= Audio::FLAG_LITTLE_ENDIAN;
+#endif
+	return Audio::makeLoopingAudioStream(Audio::makeRawStream((byte *)samples, count * sizeof(int16), rate, flags), 0);
+}
+
+/** Mixer callback state for benchmarkMixer() */
+struct BenchmarkMixerThread {
+	Audio::MixerImpl *mixer;
+	volatile int32 quit;
+	int32 callbacks;
+};
+
+void benchmarkMixerProc(void *data) {
+	BenchmarkMixerThread *thread = (BenchmarkMixerThread *)data;
+	int16 buffer[2 * 1024];
+	while (!Common::atomicLoad(&thread->quit)) {
+		thread->mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		thread->callbacks++;
+	}
+}
+
+} // End of anonymous namespace
+
+/**
+ * Time mixing channels directly into the output, as before the mix bus,
+ * and through the mix bus, then time volume changes while the mixer runs
+ */
+void benchmarkMixer() {
+	static const uint kOutputRate = 44100;
+	static const uint kBufferSize = 1024;
+	static const int kIterations = 200;
+	static const int kVolumeChanges = 100000;
+	static const int channelCounts[] = { 8, 32, 128 };
+	static const struct {
+		int rate;
+		bool stereo;
+	} sources[] = {
+		{ 22050, false },
+		{ 44100, true },
+		{ 11025, false },
+		{ 44100, false }
+	};
+
+	Audio::st_sample_t *out[2];
+	out[0] = new Audio::st_sample_t[2 * kBufferSize];
+	out[1] = new Audio::st_sample_t[2 * kBufferSize];
+	Audio::st_sample_t *scratch = new Audio::st_sample_t[2 * kBufferSize];
+	int32 *bus = new int32[2 * kBufferSize];
+
+	// Mixing directly clamps after every channel, so once the sum clips
+	// the output depends on the order of the channels. Count the samples
+	// of the last buffer which differ from the bus, which clamps once.
+	printf("Channels   Direct ms  Bus ms     Differing\n");
+	printf("---------- ---------- ---------- ----------\n");
+
+	for (uint c = 0; c < ARRAYSIZE(channelCounts); ++c) {
+		const int count = channelCounts[c];
+		uint32 elapsed[2];
+
+		for (int useBus = 0; useBus < 2; ++useBus) {
+			Common::Array<Audio::AudioStream *> streams;
+			Common::Array<Audio::RateConverter *> converters;
+			for (int i = 0; i < count; ++i) {
+				const int s = i % ARRAYSIZE(sources);
+				streams.push_back(makeBenchmarkTone(sources[s].rate, sources[s].stereo, 3 + i));
+				converters.push_back(Audio::makeRateConverter(sources[s].rate, kOutputRate, sources[s].stereo));
+			}
+
+			const uint32 start = g_system->getMillis(true);
+			for (int n = 0; n < kIterations; ++n) {
+				if (!useBus) {
+					// Every channel scales and clamps into the output
+					memset(out[0], 0, 2 * kBufferSize * sizeof(Audio::st_sample_t));
+					for (int i = 0; i < count; ++i)
+						converters[i]->flow(*streams[i], out[0], kBufferSize, (i * 37) & 0xFF, 255 - ((i * 37) & 0xFF));
+				} else {
+					memset(bus, 0, 2 * kBufferSize * sizeof(int32));
+					for (int i = 0; i < count; ++i) {
+						memset(scratch, 0, 2 * kBufferSize * sizeof(Audio::st_sample_t));
+						const int res = converters[i]->flow(*streams[i], scratch, kBufferSize, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+						Audio::mixToBus(bus, scratch, res, (i * 37) & 0xFF, 255 - ((i * 37) & 0xFF));
+					}
+					Audio::clampBusToOutput(out[1], bus, kBufferSize);
+				}
+			}
+			elapsed[useBus] = g_system->getMillis(true) - start;
+
+			for (int i = 0; i < count; ++i) {
+				delete converters[i];
+				delete streams[i];
+			}
+		}
+
+		uint differing = 0;
+		for (uint i = 0; i < 2 * kBufferSize; ++i) {
+			if (out[0][i] != out[1][i])
+				differing++;
+		}
+
+		printf("%10d %10.3f %10.3f %10u\n", count, (double)elapsed[0] / kIterations, (double)elapsed[1] / kIterations, differing);
+	}
+
+	delete[] out[0];
+	delete[] out[1];
+	delete[] scratch;
+	delete[] bus;
+
+	// Change the volume of sounds while another thread keeps mixing them,
+	// through the command queue and by taking the mixer mutex. Without
+	// threads, mix in between the changes instead, which times the cost of
+	// either path but not the waiting for the audio thread.
+	printf("\nVolume changes Changes    Total ms   Mixes\n");
+	printf("-------------- ---------- ---------- ----------\n");
+
+	for (int queued = 1; queued >= 0; --queued) {
+		Audio::MixerImpl mixer(kOutputRate);
+		mixer.setReady(true);
+		mixer.enableCommandQueue(queued != 0);
+
+		Common::Array<Audio::SoundHandle> handles;
+		for (int i = 0; i < 16; ++i) {
+			const int s = i % ARRAYSIZE(sources);
+			Audio::SoundHandle handle;
+			mixer.playStream(Audio::Mixer::kPlainSoundType, &handle, makeBenchmarkTone(sources[s].rate, sources[s].stereo, 3 + i),
+			                 -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::YES, false, false);
+			handles.push_back(handle);
+		}
+
+		BenchmarkMixerThread state;
+		state.mixer = &mixer;
+		state.quit = 0;
+		state.callbacks = 0;
+		Common::Thread thread;
+		const bool threaded = thread.start(benchmarkMixerProc, &state);
+		int16 buffer[2 * kBufferSize];
+
+		const uint32 start = g_system->getMillis(true);
+		for (int n = 0; n < kVolumeChanges; ++n) {
+			mixer.setChannelVolume(handles[n % handles.size()], n & 0xFF);
+			if (!threaded && (n % 64) == 63) {
+				mixer.mixCallback((byte *)buffer, sizeof(buffer));
+				state.callbacks++;
+			}
+		}
+		const uint32 elapsed = g_system->getMillis(true) - start;
+
+		if (threaded) {
+			Common::atomicStore(&state.quit, 1);
+			thread.join();
+		}
+
+		printf("%-14s %10d %10u %10d%s\n", queued ? "queued" : "locked", kVolumeChanges, elapsed, state.callbacks,
+		       threaded ? "" : " (inline)");
+	}
+}
+
+/** Time every resampler quality at common rate pairs, in ns per output sample */
+void benchmarkResampler() {
+	static const int kOutputSamples = 1 << 21;
+	static const uint kBufferSize = 1024;
+	static const struct {
+		uint inRate;
+		uint outRate;
+	} ratePairs[] = {
+		{ 11025, 44100 },
+		{ 11025, 48000 },
+		{ 22050, 44100 },
+		{ 22050, 48000 },
+		{ 44100, 48000 },
+		{ 48000, 44100 },
+		{ 44100, 22050 }
+	};
+	static const Audio::ResamplerQuality qualities[] = {
+		Audio::kResamplerLinear,
+		Audio::kResamplerPolyphase,
+		Audio::kResamplerPolyphaseBest
+	};
+
+	Audio::st_sample_t *out = new Audio::st_sample_t[2 * kBufferSize];
+
+	printf("Rates         Channels Linear ns  Poly ns    Best ns\n");
+	printf("------------- -------- ---------- ---------- ----------\n");
+
+	for (uint r = 0; r < ARRAYSIZE(ratePairs); ++r) {
+		for (int stereo = 0; stereo < 2; ++stereo) {
+			double ns[ARRAYSIZE(qualities)];
+
+			for (uint q = 0; q < ARRAYSIZE(qualities); ++q) {
+				Audio::AudioStream *stream = makeBenchmarkTone(ratePairs[r].inRate, stereo != 0, 7);
+				Audio::RateConverter *converter = Audio::makeRateConverter(ratePairs[r].inRate, ratePairs[r].outRate, stereo != 0, false, qualities[q]);
+
+				const uint32 start = g_system->getMillis(true);
+				for (int n = 0; n < kOutputSamples; n += kBufferSize) {
+					memset(out, 0, 2 * kBufferSize * sizeof(Audio::st_sample_t));
+					converter->flow(*stream, out, kBufferSize, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+				}
+				ns[q] = (g_system->getMillis(true) - start) * 1000000.0 / kOutputSamples;
+
+				delete converter;
+				delete stream;
+			}
+
+			printf("%5u > %5u %8s %10.2f %10.2f %10.2f\n", ratePairs[r].inRate, ratePairs[r].outRate, stereo ? "stereo" : "mono",
+			       ns[0], ns[1], ns[2]);
+		}
+	}
+
+	delete[] out;
+}
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "common/scummsys.h"
+#include "common/archive.h"
+#include "common/hash-str.h"
+#include "common/memstream.h"
+#include "common/system.h"
+
+#include "test/benchmark/benchmark.h"
+
+namespace {
+
+/** An archive of one byte members held in memory, for benchmarkSearchSet() */
+class BenchmarkArchive : public Common::Archive {
+public:
+	void addMember(const Common::String &name, byte value) { _members[name] = value; }
+
+	bool hasFile(const Common::Path &path) const override {
+		return _members.contains(path.rawString());
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		for (MemberMap::const_iterator i = _members.begin(); i != _members.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(i->_key, this)));
+		return _members.size();
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return Common::ArchiveMemberPtr();
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(path.rawString(), this));
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		MemberMap::const_iterator i = _members.find(path.rawString());
+		if (i == _members.end())
+			return nullptr;
+		return new Common::MemoryReadStream(&i->_value, 1);
+	}
+
+private:
+	typedef Common::HashMap<Common::String, byte, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> MemberMap;
+	MemberMap _members;
+};
+
+} // End of anonymous namespace
+
+/** Time opening every member of a set of archives, with and without the search index */
+void benchmarkSearchSet() {
+	static const int kArchives = 20;
+	static const int kMembersPerArchive = 500;
+	static const int kIterations = 10;
+
+	BenchmarkArchive archives[kArchives];
+	Common::Array<Common::String> names;
+	for (int a = 0; a < kArchives; ++a) {
+		for (int m = 0; m < kMembersPerArchive; ++m) {
+			Common::String name = Common::String::format("cast%02d/member%04d.bin", a, m);
+			archives[a].addMember(name, (byte)m);
+			// Engines do not always use the case of the archive
+			if (m & 1)
+				name.toUppercase();
+			names.push_back(name);
+		}
+	}
+
+	Common::SearchSet linear, indexed;
+	for (int a = 0; a < kArchives; ++a) {
+		const Common::String name = Common::String::format("archive%02d", a);
+		linear.add(name, &archives[a], 0, false);
+		indexed.add(name, &archives[a], 0, false);
+	}
+	indexed.enableIndex(true);
+
+	printf("Search set    Lookups    Total ms   Hits       Misses\n");
+	printf("------------- ---------- ---------- ---------- ----------\n");
+
+	uint32 checksums[2];
+	for (int i = 0; i < 2; ++i) {
+		const Common::SearchSet &set = i ? indexed : linear;
+		checksums[i] = 0;
+
+		const uint32 start = g_system->getMillis(true);
+		for (int n = 0; n < kIterations; ++n) {
+			for (uint m = 0; m < names.size(); ++m) {
+				Common::SeekableReadStream *stream = set.createReadStreamForMember(names[m]);
+				if (stream) {
+					checksums[i] = checksums[i] * 31 + stream->readByte();
+					delete stream;
+				}
+			}
+		}
+		const uint32 elapsed = g_system->getMillis(true) - start;
+
+		// The index must not change which members are found.
+		const bool match = (i == 0 || checksums[1] == checksums[0]);
+
+		printf("%-13s %10u %10u %10u %10u%s\n", i ? "indexed" : "linear", names.size() * kIterations, elapsed,
+		       i ? indexed.getIndexHits() : 0, i ? indexed.getIndexMisses() : 0, match ? "" : " MISMATCH");
+	}
+}
@@ -0,0 +1,512 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "common/scummsys.h"
+#include "common/array.h"
+#include "common/cpudetect.h"
+#include "common/jobsystem.h"
+#include "common/system.h"
+
+#include "graphics/transparent_surface.h"
+#include "graphics/scaler/normal.h"
+#ifdef USE_SCALERS
+#ifdef USE_HQ_SCALERS
+#include "graphics/scaler/hq.h"
+#endif
+#ifdef USE_EDGE_SCALERS
+#include "graphics/scaler/edge.h"
+#endif
+#include "graphics/scaler/dotmatrix.h"
+#include "graphics/scaler/pm.h"
+#include "graphics/scaler/sai.h"
+#include "graphics/scaler/scalebit.h"
+#include "graphics/scaler/tv.h"
+#endif
+#ifdef USE_TINYGL
+#include "graphics/tinygl/zgl.h"
+#endif
+
+#include "test/benchmark/benchmark.h"
+
+/** Time every scaler and factor on reference frames, serially and in bands */
+void benchmarkScalers() {
+	static const int kIterations = 10;
+	static const struct {
+		int width, height;
+	} frameSizes[] = {
+		{ 320, 200 },
+		{ 640, 480 }
+	};
+
+	// The SDL surface graphics manager always scales 16bpp surfaces.
+	const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+	Common::Array<ScalerPluginObject *> scalers;
+	scalers.push_back(new NormalPlugin());
+#ifdef USE_SCALERS
+#ifdef USE_HQ_SCALERS
+	scalers.push_back(new HQPlugin());
+#endif
+#ifdef USE_EDGE_SCALERS
+	scalers.push_back(new EdgePlugin());
+#endif
+	scalers.push_back(new AdvMamePlugin());
+	scalers.push_back(new SAIPlugin());
+	scalers.push_back(new SuperSAIPlugin());
+	scalers.push_back(new SuperEaglePlugin());
+	scalers.push_back(new PMPlugin());
+	scalers.push_back(new DotMatrixPlugin());
+	scalers.push_back(new TVPlugin());
+#endif
+
+	int extraPixels = 0;
+	for (uint i = 0; i < scalers.size(); ++i)
+		extraPixels = MAX<int>(extraPixels, scalers[i]->extraPixels());
+
+	printf("Scaler          Factor Frame     Serial ms  Banded ms\n");
+	printf("--------------- ------ --------- ---------- ----------\n");
+
+	for (uint i = 0; i < ARRAYSIZE(frameSizes); ++i) {
+		const int width = frameSizes[i].width;
+		const int height = frameSizes[i].height;
+
+		// Fill the frame, including the border scalers may read, with a mix
+		// of flat areas and edges.
+		Graphics::Surface src;
+		src.create(width + extraPixels * 2, height + extraPixels * 2, format);
+		for (int y = 0; y < src.h; ++y) {
+			uint16 *dst = (uint16 *)src.getBasePtr(0, y);
+			for (int x = 0; x < src.w; ++x) {
+				const uint8 shade = ((x >> 3) * 37 + (y >> 3) * 91 + ((x * y) >> 6)) & 0xFF;
+				*dst++ = format.RGBToColor(shade, 255 - shade, (shade & 0x80) ? 255 : 0);
+			}
+		}
+		const uint8 *srcPtr = (const uint8 *)src.getBasePtr(extraPixels, extraPixels);
+
+		for (uint p = 0; p < scalers.size(); ++p) {
+			ScalerPluginObject &scaler = *scalers[p];
+			scaler.initialize(format);
+			const uint oldFactor = scaler.getFactor();
+
+			const Common::Array<uint> &factors = scaler.getFactors();
+			for (Common::Array<uint>::const_iterator f = factors.begin(); f != factors.end(); ++f) {
+				scaler.setFactor(*f);
+
+				Graphics::Surface dst, bandedDst;
+				dst.create(width * *f, height * *f, format);
+				bandedDst.create(width * *f, height * *f, format);
+
+				uint32 start = g_system->getMillis(true);
+				for (int n = 0; n < kIterations; ++n) {
+					scaler.scale(srcPtr, src.pitch, (uint8 *)dst.getPixels(), dst.pitch, width, height, 0, 0);
+				}
+				const uint32 serial = g_system->getMillis(true) - start;
+
+				start = g_system->getMillis(true);
+				for (int n = 0; n < kIterations; ++n) {
+					scaler.scaleBanded(srcPtr, src.pitch, (uint8 *)bandedDst.getPixels(), bandedDst.pitch, width, height, 0, 0);
+				}
+				const uint32 banded = g_system->getMillis(true) - start;
+
+				// Banding must not change the result.
+				const bool match = !memcmp(dst.getPixels(), bandedDst.getPixels(), dst.h * dst.pitch);
+
+				printf("%-15s %5ux %4dx%-4d %10.2f %10.2f%s\n", scaler.getName(), *f, width, height,
+				       (double)serial / kIterations, (double)banded / kIterations, match ? "" : " MISMATCH");
+
+				dst.free();
+				bandedDst.free();
+			}
+
+			scaler.setFactor(oldFactor);
+			scaler.deinitialize();
+		}
+
+		src.free();
+	}
+
+	for (uint i = 0; i < scalers.size(); ++i)
+		delete scalers[i];
+}
+/** Time alpha blits of a sprite in every blend mode, with and without SIMD */
+void benchmarkBlit() {
+	static const int kIterations = 200;
+	static const char *const blendNames[] = { "normal", "additive", "subtractive", "multiply" };
+	static const struct {
+		const char *name;
+		uint32 color;
+	} tints[] = {
+		{ "none", TS_ARGB(255, 255, 255, 255) },
+		{ "color", TS_ARGB(255, 255, 128, 64) },
+		{ "alpha", TS_ARGB(200, 255, 128, 64) }
+	};
+
+	// A sprite with fully transparent, fully opaque and translucent areas,
+	// like the ones engines draw over their backgrounds.
+	const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+	Graphics::TransparentSurface sprite;
+	sprite.create(256, 256, format);
+	for (int y = 0; y < sprite.h; ++y) {
+		uint32 *dst = (uint32 *)sprite.getBasePtr(0, y);
+		for (int x = 0; x < sprite.w; ++x) {
+			const int distance = ABS(x - 128) + ABS(y - 128);
+			const uint8 alpha = distance < 96 ? 255 : (distance < 160 ? (uint8)((160 - distance) * 4) : 0);
+			*dst++ = format.ARGBToColor(alpha, x, y, (x * y) >> 8);
+		}
+	}
+
+	Graphics::Surface background;
+	background.create(640, 480, format);
+	for (int y = 0; y < background.h; ++y) {
+		uint32 *dst = (uint32 *)background.getBasePtr(0, y);
+		for (int x = 0; x < background.w; ++x)
+			*dst++ = format.ARGBToColor(255, (x >> 2) & 0xFF, (y >> 1) & 0xFF, ((x + y) >> 3) & 0xFF);
+	}
+
+	// The AVX2 column is only filled on CPUs which have it
+	const bool hasAVX2 = Common::hasCpuFeature(Common::kCpuFeatureAVX2);
+	printf("Blend mode  Tint   Scalar ms  SIMD ms    AVX2 ms\n");
+	printf("----------- ------ ---------- ---------- ----------\n");
+
+	for (int blend = Graphics::BLEND_NORMAL; blend < Graphics::NUM_BLEND_MODES; ++blend) {
+		for (uint t = 0; t < ARRAYSIZE(tints); ++t) {
+			Graphics::Surface dst[3];
+			uint32 elapsed[3];
+			bool match = true;
+
+			for (int simd = 0; simd < (hasAVX2 ? 3 : 2); ++simd) {
+				dst[simd].copyFrom(background);
+				Graphics::TransparentSurface::enableSimd(simd != 0);
+				Common::enableCpuFeature(Common::kCpuFeatureAVX2, simd == 2);
+
+				const uint32 start = g_system->getMillis(true);
+				for (int n = 0; n < kIterations; ++n) {
+					sprite.blit(dst[simd], (n * 37) % 384, (n * 23) % 224, n & Graphics::FLIP_HV, nullptr,
+					            tints[t].color, -1, -1, (Graphics::TSpriteBlendMode)blend);
+				}
+				elapsed[simd] = g_system->getMillis(true) - start;
+
+				// SIMD must not change the result.
+				if (simd != 0)
+					match = match && !memcmp(dst[0].getPixels(), dst[simd].getPixels(), dst[0].h * dst[0].pitch);
+			}
+
+			printf("%-11s %-6s %10.3f %10.3f", blendNames[blend], tints[t].name,
+			       (double)elapsed[0] / kIterations, (double)elapsed[1] / kIterations);
+			if (hasAVX2)
+				printf(" %10.3f", (double)elapsed[2] / kIterations);
+			else
+				printf(" %10s", "-");
+			printf("%s\n", match ? "" : " MISMATCH");
+
+			for (int simd = 0; simd < (hasAVX2 ? 3 : 2); ++simd)
+				dst[simd].free();
+		}
+	}
+
+	Common::enableCpuFeature(Common::kCpuFeatureAVX2, true);
+	Graphics::TransparentSurface::enableSimd(true);
+	background.free();
+	sprite.free();
+}
+
+#ifdef USE_TINYGL
+/** A lit, textured sphere, standing in for the models of an actor */
+static void drawBenchmarkModel(float x, float y, float z, float angle) {
+	static const int kSlices = 32;
+	static const int kStacks = 24;
+
+	tglPushMatrix();
+	tglTranslatef(x, y, z);
+	tglRotatef(angle, 0.0f, 1.0f, 0.0f);
+	tglScalef(0.7f, 1.4f, 0.7f);
+
+	tglBegin(TGL_QUADS);
+	for (int i = 0; i < kStacks; ++i) {
+		for (int j = 0; j < kSlices; ++j) {
+			static const int corners[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+			for (int c = 0; c < 4; ++c) {
+				const float theta = (float)M_PI * (i + corners[c][1]) / kStacks;
+				const float phi = 2.0f * (float)M_PI * (j + corners[c][0]) / kSlices;
+				const float nx = sinf(theta) * cosf(phi), ny = cosf(theta), nz = sinf(theta) * sinf(phi);
+				tglNormal3f(nx, ny, nz);
+				tglTexCoord2f(2.0f * (j + corners[c][0]) / kSlices, (float)(i + corners[c][1]) / kStacks);
+				tglVertex3f(nx, ny, nz);
+			}
+		}
+	}
+	tglEnd();
+
+	tglPopMatrix();
+}
+
+namespace {
+
+/** The images and the texture of the scene of benchmarkTinyGL() */
+struct BenchmarkTinyGLScene {
+	static const int kWidth = 640;
+	static const int kHeight = 480;
+	static const int kTextureSize = 256;
+
+	Graphics::PixelFormat format;
+	Graphics::Surface background;
+	Graphics::Surface depth;
+	Graphics::Surface glyph;
+	byte *texture;
+};
+
+} // End of anonymous namespace
+
+/**
+ * Render @p frames frames of the scene into @p frame and return the time it
+ * took in milliseconds. The frames are drawn the way GfxTinyGL draws them.
+ */
+static uint32 renderBenchmarkTinyGLScene(const BenchmarkTinyGLScene &scene, int frames, bool dirtyRects, bool tiled, bool simd, byte *frame) {
+	TinyGL::FrameBuffer fb(scene.kWidth, scene.kHeight, scene.format);
+	fb.enableSimdSpans(simd);
+	TinyGL::glInit(&fb, scene.kTextureSize);
+	tglEnableDirtyRects(dirtyRects);
+	tglEnableTiledRendering(tiled);
+
+	Graphics::BlitImage *backgroundImage = Graphics::tglGenBlitImage();
+	Graphics::tglUploadBlitImage(backgroundImage, scene.background, 0, false);
+	Graphics::BlitImage *depthImage = Graphics::tglGenBlitImage();
+	Graphics::tglUploadBlitImage(depthImage, scene.depth, 0, false);
+	Graphics::BlitImage *glyphImage = Graphics::tglGenBlitImage();
+	Graphics::tglUploadBlitImage(glyphImage, scene.glyph, 0, false);
+
+	unsigned int textureId;
+	tglGenTextures(1, &textureId);
+	tglBindTexture(TGL_TEXTURE_2D, textureId);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_S, TGL_REPEAT);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_WRAP_T, TGL_REPEAT);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_LINEAR);
+	tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_LINEAR);
+	tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, scene.kTextureSize, scene.kTextureSize, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, scene.texture);
+
+	tglViewport(0, 0, scene.kWidth, scene.kHeight);
+	tglMatrixMode(TGL_PROJECTION);
+	tglLoadIdentity();
+	const float right = 0.1f * tanf(35.0f * (float)M_PI / 180.0f);
+	tglFrustum(-right, right, -right * 0.75f, right * 0.75f, 0.1f, 100.0f);
+	tglMatrixMode(TGL_MODELVIEW);
+
+	const float ambient[] = { 0.3f, 0.3f, 0.3f, 1.0f };
+	const float diffuse[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	const float position[] = { 2.0f, 3.0f, 1.0f, 0.0f };
+	tglLightModelfv(TGL_LIGHT_MODEL_AMBIENT, ambient);
+	tglMaterialfv(TGL_FRONT, TGL_DIFFUSE, diffuse);
+
+	const uint32 start = g_system->getMillis(true);
+	for (int n = 0; n < frames; ++n) {
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglDisable(TGL_DEPTH_TEST);
+		tglDisable(TGL_BLEND);
+		Graphics::tglBlitFast(backgroundImage, 0, 0);
+		Graphics::tglBlitZBuffer(depthImage, 0, 0);
+
+		tglLoadIdentity();
+		tglLightfv(TGL_LIGHT0, TGL_POSITION, position);
+		tglLightfv(TGL_LIGHT0, TGL_DIFFUSE, diffuse);
+		tglEnable(TGL_LIGHTING);
+		tglEnable(TGL_LIGHT0);
+		tglEnable(TGL_DEPTH_TEST);
+		tglEnable(TGL_TEXTURE_2D);
+		tglBindTexture(TGL_TEXTURE_2D, textureId);
+
+		// Actors walking across the set. Like Grim, their transparent
+		// texels are dropped by the alpha test.
+		tglAlphaFunc(TGL_GREATER, 0.5f);
+		tglEnable(TGL_ALPHA_TEST);
+		for (int actor = 0; actor < 3; ++actor) {
+			const float x = -2.5f + actor * 2.5f + 0.5f * sinf((n + actor * 30) * 0.05f);
+			drawBenchmarkModel(x, -0.5f, -4.5f - actor, n * 3.0f + actor * 40.0f);
+		}
+		tglDisable(TGL_ALPHA_TEST);
+
+		tglDisable(TGL_TEXTURE_2D);
+		tglDisable(TGL_LIGHTING);
+		tglDisable(TGL_DEPTH_TEST);
+
+		// A line of dialogue
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		for (int c = 0; c < 40; ++c)
+			Graphics::tglBlit(glyphImage, 120 + c * 10, 420);
+
+		TinyGL::tglPresentBuffer();
+	}
+	const uint32 elapsed = g_system->getMillis(true) - start;
+
+	memcpy(frame, fb.getPixelBuffer(), scene.kWidth * scene.kHeight * 4);
+
+	tglDeleteTextures(1, &textureId);
+	Graphics::tglDeleteBlitImage(glyphImage);
+	Graphics::tglDeleteBlitImage(depthImage);
+	Graphics::tglDeleteBlitImage(backgroundImage);
+	TinyGL::glClose();
+
+	return elapsed;
+}
+
+/**
+ * Time TinyGL on a scene built like a Grim frame: a background and its
+ * depth image, lit and textured actors with the depth test, and blended
+ * text on top.
+ */
+void benchmarkTinyGL() {
+	static const int kFrames = 100;
+	const int w = BenchmarkTinyGLScene::kWidth;
+	const int h = BenchmarkTinyGLScene::kHeight;
+	const int textureSize = BenchmarkTinyGLScene::kTextureSize;
+
+	BenchmarkTinyGLScene scene;
+	scene.format = Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24);
+	const Graphics::PixelFormat &format = scene.format;
+
+	scene.background.create(w, h, format);
+	for (int y = 0; y < h; ++y) {
+		uint32 *dst = (uint32 *)scene.background.getBasePtr(0, y);
+		for (int x = 0; x < w; ++x)
+			*dst++ = format.ARGBToColor(255, (x >> 2) & 0xFF, (y >> 1) & 0xFF, ((x ^ y) >> 2) & 0xFF);
+	}
+
+	// The depth image of the set. TinyGL stores larger values for closer
+	// points. The back wall is at the far plane, the floor comes closer
+	// towards the bottom and hides the feet of the actors further back.
+	scene.depth.create(w, h, format);
+	for (int y = 0; y < h; ++y) {
+		uint32 *dst = (uint32 *)scene.depth.getBasePtr(0, y);
+		const uint32 z = y < h / 3 ? 0 : 14000000 + (y - h / 3) * 31000;
+		for (int x = 0; x < w; ++x)
+			*dst++ = z;
+	}
+
+	scene.glyph.create(10, 16, format);
+	for (int y = 0; y < scene.glyph.h; ++y) {
+		uint32 *dst = (uint32 *)scene.glyph.getBasePtr(0, y);
+		for (int x = 0; x < scene.glyph.w; ++x)
+			*dst++ = ((x + y) % 3) ? format.ARGBToColor(255, 255, 255, 255) : format.ARGBToColor(0, 0, 0, 0);
+	}
+
+	scene.texture = new byte[textureSize * textureSize * 4];
+	for (int y = 0; y < textureSize; ++y) {
+		for (int x = 0; x < textureSize; ++x) {
+			byte *texel = scene.texture + (y * textureSize + x) * 4;
+			texel[0] = ((x >> 4) ^ (y >> 4)) & 1 ? 220 : 90;
+			texel[1] = x;
+			texel[2] = y;
+			texel[3] = (y & 63) < 4 ? 0 : 255;
+		}
+	}
+
+	printf("Job system workers: %u\n", Common::JobSystem::instance().getWorkerCount());
+	printf("Dirty rects Tiled  Scalar ms  SIMD ms    SIMD FPS\n");
+	printf("----------- ------ ---------- ---------- ----------\n");
+
+	byte *reference = new byte[w * h * 4];
+	byte *frame = new byte[w * h * 4];
+
+	for (int mode = 0; mode < 4; ++mode) {
+		const bool dirtyRects = (mode & 2) != 0;
+		const bool tiled = (mode & 1) != 0;
+
+		// Each mode has to render exactly the same frame
+		uint32 elapsed[2];
+		bool match = true;
+		for (int simd = 0; simd < 2; ++simd) {
+			elapsed[simd] = renderBenchmarkTinyGLScene(scene, kFrames, dirtyRects, tiled, simd != 0, frame);
+			if (mode == 0 && simd == 0)
+				memcpy(reference, frame, w * h * 4);
+			else if (memcmp(reference, frame, w * h * 4))
+				match = false;
+		}
+
+		printf("%-11s %-6s %10.3f %10.3f %10.1f%s\n", dirtyRects ? "yes" : "no", tiled ? "yes" : "no",
+		       (double)elapsed[0] / kFrames, (double)elapsed[1] / kFrames,
+		       elapsed[1] ? kFrames * 1000.0 / elapsed[1] : 0.0, match ? "" : " MISMATCH");
+	}
+
+	// The spans alone, on triangles covering the whole screen
+	printf("\nTextured spans      Scalar ns  SIMD ns\n");
+	printf("------------------- ---------- ----------\n");
+
+	static const int kSpanFrames = 20;
+	Graphics::PixelBuffer texels(Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), scene.texture);
+	Graphics::NearestTexelBuffer nearest(texels, textureSize, textureSize, textureSize);
+	Graphics::BilinearTexelBuffer bilinear(texels, textureSize, textureSize, textureSize);
+
+	for (int filter = 0; filter < 2; ++filter) {
+		for (int alphaTest = 0; alphaTest < 2; ++alphaTest) {
+			uint32 elapsed[2];
+			bool match = true;
+
+			for (int simd = 0; simd < 2; ++simd) {
+				TinyGL::FrameBuffer fb(w, h, format);
+				fb.enableSimdSpans(simd != 0);
+				fb.enableDepthTest(true);
+				fb.setDepthFunc(TGL_LESS);
+				fb.enableAlphaTest(alphaTest != 0);
+				fb.setAlphaTestFunc(TGL_GREATER, 128);
+				fb.setTexture(filter ? (const Graphics::TexelBuffer *)&bilinear : &nearest, TGL_REPEAT, TGL_REPEAT);
+				fb.selectSpanFunctions();
+
+				const uint32 start = g_system->getMillis(true);
+				for (int n = 0; n < kSpanFrames; ++n) {
+					memset(fb.getZBuffer(), 0, w * h * sizeof(unsigned int));
+					TinyGL::ZBufferPoint p[4];
+					for (int i = 0; i < 4; ++i) {
+						p[i].x = (i & 1) ? w - 1 : 0;
+						p[i].y = (i & 2) ? h - 1 : 0;
+						p[i].z = 0x100000 + i * 0x10000;
+						p[i].s = ((i & 1) ? 3 * textureSize : 0) << ZB_POINT_ST_FRAC_BITS;
+						p[i].t = ((i & 2) ? 2 * textureSize : 0) << ZB_POINT_ST_FRAC_BITS;
+						p[i].r = p[i].g = p[i].b = p[i].a = (0x8000 + i * 0x2000);
+					}
+					TinyGL::ZBufferPoint q[4] = { p[0], p[1], p[2], p[3] };
+					fb.fillTriangleTextureMappingPerspectiveSmooth(&q[0], &q[1], &q[2]);
+					fb.fillTriangleTextureMappingPerspectiveSmooth(&q[1], &q[3], &q[2]);
+				}
+				elapsed[simd] = g_system->getMillis(true) - start;
+
+				if (simd == 0)
+					memcpy(reference, fb.getPixelBuffer(), w * h * 4);
+				else
+					match = !memcmp(reference, fb.getPixelBuffer(), w * h * 4);
+			}
+
+			printf("%-8s %-10s %10.2f %10.2f%s\n", filter ? "linear" : "nearest", alphaTest ? "alpha test" : "",
+			       elapsed[0] * 1000000.0 / ((double)kSpanFrames * w * h), elapsed[1] * 1000000.0 / ((double)kSpanFrames * w * h),
+			       match ? "" : " MISMATCH");
+		}
+	}
+
+	delete[] frame;
+	delete[] reference;
+	delete[] scene.texture;
+	scene.glyph.free();
+	scene.depth.free();
+	scene.background.free();
+}
+#endif
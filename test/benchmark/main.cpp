@@ -0,0 +1,88 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_EXCEPTION_printf
+
+#include "common/scummsys.h"
+#include "common/jobsystem.h"
+#include "common/system.h"
+
+#include "test/benchmark/benchmark.h"
+#include "test/null_osystem.h"
+
+static const struct {
+	const char *name;
+	const char *description;
+	void (*run)();
+} benchmarks[] = {
+	{ "mixer", "Time mixing channels and changing their volume", benchmarkMixer },
+	{ "resampler", "Time the sample rate converters of each quality", benchmarkResampler },
+	{ "searchset", "Time member lookups with and without the search index", benchmarkSearchSet },
+	{ "scalers", "Time all graphics scalers on reference frames", benchmarkScalers },
+	{ "blit", "Time alpha blits in all blend modes with and without SIMD", benchmarkBlit },
+#ifdef USE_TINYGL
+	{ "tinygl", "Time TinyGL on a Grim-like scene in each rendering mode", benchmarkTinyGL },
+#endif
+};
+
+static void usage(const char *appName) {
+	printf("Usage: %s [BENCHMARK...]\n\n", appName);
+	printf("Runs the given benchmarks, or all of them:\n");
+	for (uint i = 0; i < ARRAYSIZE(benchmarks); ++i)
+		printf("  %-14s %s\n", benchmarks[i].name, benchmarks[i].description);
+}
+
+int main(int argc, char *argv[]) {
+#if !NULL_OSYSTEM_IS_AVAILABLE
+	printf("The benchmarks need the null backend of the tests\n");
+	return 1;
+#else
+	for (int a = 1; a < argc; ++a) {
+		uint i = 0;
+		while (i < ARRAYSIZE(benchmarks) && strcmp(argv[a], benchmarks[i].name))
+			++i;
+		if (i == ARRAYSIZE(benchmarks)) {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	Common::install_null_g_system();
+	Common::JobSystem::instance();
+
+	bool first = true;
+	for (uint i = 0; i < ARRAYSIZE(benchmarks); ++i) {
+		bool selected = (argc == 1);
+		for (int a = 1; a < argc && !selected; ++a)
+			selected = !strcmp(argv[a], benchmarks[i].name);
+		if (!selected)
+			continue;
+
+		printf("%s%s\n\n", first ? "" : "\n", benchmarks[i].description);
+		benchmarks[i].run();
+		first = false;
+	}
+
+	Common::JobSystem::destroy();
+	return 0;
+#endif
+}
@@ -0,0 +1,160 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/jobsystem.h"
+#include "common/thread.h"
+#include "../null_osystem.h"
+
+class StoreJob : public Common::Job {
+public:
+	int *_slot;
+	int _value;
+
+	StoreJob(int *slot, int value) : _slot(slot), _value(value) {}
+
+	void run() override { *_slot = _value; }
+};
+
+/** Counts itself, and submits children to the same group when it runs */
+class CountJob : public Common::Job {
+public:
+	Common::JobSystem *_system;
+	Common::JobGroup *_group;
+	volatile int32 *_counter;
+	int _children;
+
+	CountJob(Common::JobSystem *system, Common::JobGroup *group, volatile int32 *counter, int children) :
+		_system(system), _group(group), _counter(counter), _children(children) {}
+
+	void run() override {
+		for (int i = 0; i < _children; ++i)
+			_system->submit(new CountJob(_system, _group, _counter, 0), _group, DisposeAfterUse::YES);
+		Common::atomicAdd(_counter, 1);
+	}
+};
+
+/** Blocks its worker until enough other jobs are done, or gives up */
+class BlockJob : public Common::Job {
+public:
+	volatile int32 *_counter;
+	int32 _target;
+	bool _timedOut;
+
+	BlockJob(volatile int32 *counter, int32 target) : _counter(counter), _target(target), _timedOut(false) {}
+
+	void run() override {
+		const uint32 start = g_system->getMillis();
+		while (Common::atomicLoad(_counter) < _target) {
+			if (g_system->getMillis() - start > 5000) {
+				_timedOut = true;
+				return;
+			}
+			g_system->delayMillis(1);
+		}
+	}
+};
+
+struct SubmitThreadData {
+	Common::JobSystem *system;
+	Common::JobGroup *group;
+	volatile int32 *counter;
+};
+
+static void submitJobs(void *data) {
+	SubmitThreadData *submit = (SubmitThreadData *)data;
+	for (int i = 0; i < 100; ++i)
+		submit->system->submit(new CountJob(submit->system, submit->group, submit->counter, i % 3), submit->group, DisposeAfterUse::YES);
+}
+
+class SquareFunc {
+public:
+	int _value;
+	explicit SquareFunc(int value) : _value(value) {}
+	int square() { return _value * _value; }
+};
+
+class JobSystemTestSuite : public CxxTest::TestSuite
+{
+	public:
+	void test_groups() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		int slots[100];
+		Common::JobGroup group;
+		StoreJob *jobs[100];
+		for (int i = 0; i < 100; ++i) {
+			slots[i] = -1;
+			jobs[i] = new StoreJob(&slots[i], i);
+			JobSys.submit(jobs[i], &group);
+		}
+		group.wait();
+		for (int i = 0; i < 100; ++i) {
+			TS_ASSERT_EQUALS(slots[i], i);
+			delete jobs[i];
+		}
+
+		// Jobs can be deleted by the job system
+		for (int i = 0; i < 10; ++i)
+			JobSys.submit(new StoreJob(&slots[i], 1000 + i), &group, DisposeAfterUse::YES);
+		group.wait();
+		for (int i = 0; i < 10; ++i)
+			TS_ASSERT_EQUALS(slots[i], 1000 + i);
+
+		// Waiting for an empty group returns right away
+		Common::JobGroup empty;
+		empty.wait();
+#endif
+	}
+
+	void test_futures() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		SquareFunc a(7), b(-3);
+		Common::Future<int> fa(new Common::Functor0Mem<int, SquareFunc>(&a, &SquareFunc::square));
+		Common::Future<int> fb(new Common::Functor0Mem<int, SquareFunc>(&b, &SquareFunc::square));
+		JobSys.submit(&fa);
+		JobSys.submit(&fb);
+		TS_ASSERT_EQUALS(fb.get(), 9);
+		TS_ASSERT_EQUALS(fa.get(), 49);
+		TS_ASSERT_EQUALS(fa.get(), 49);
+#endif
+	}
+
+	void test_workers() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Common::JobSystem jobs(3);
+		if (jobs.getWorkerCount() == 0)
+			return;
+
+		// Several threads submit at once, and the jobs submit more jobs
+		volatile int32 counter = 0;
+		Common::JobGroup group;
+		SubmitThreadData data = { &jobs, &group, &counter };
+		Common::Thread threads[2];
+		for (int i = 0; i < 2; ++i)
+			TS_ASSERT(threads[i].start(submitJobs, &data));
+		submitJobs(&data);
+		for (int i = 0; i < 2; ++i)
+			threads[i].join();
+		jobs.wait(group);
+
+		// 100 jobs with 0, 1 or 2 children each, from three threads
+		TS_ASSERT_EQUALS(Common::atomicLoad(&counter), 3 * (100 + 99));
+
+		// The jobs queued behind the blocking one can only run when other
+		// workers or the waiting thread steal them.
+		counter = 0;
+		BlockJob block(&counter, 50);
+		jobs.submit(&block, &group);
+		for (int i = 0; i < 50; ++i)
+			jobs.submit(new CountJob(&jobs, &group, &counter, 0), &group, DisposeAfterUse::YES);
+		jobs.wait(group);
+		TS_ASSERT(!block._timedOut);
+		TS_ASSERT_EQUALS(Common::atomicLoad(&counter), 50);
+#endif
+	}
+};
@@ -0,0 +1,242 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "../null_osystem.h"
+
+class CountingArchive : public Common::Archive {
+public:
+	typedef Common::HashMap<Common::String, byte, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileMap;
+	FileMap _files;
+	mutable int _lookups;
+
+	CountingArchive() : _lookups(0) {}
+
+	void addFile(const Common::String &name, byte value) { _files[name] = value; }
+
+	bool hasFile(const Common::Path &path) const override {
+		_lookups++;
+		return _files.contains(path.rawString());
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		for (FileMap::const_iterator i = _files.begin(); i != _files.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(i->_key, this)));
+		return _files.size();
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return Common::ArchiveMemberPtr();
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(path.rawString(), this));
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		_lookups++;
+		FileMap::const_iterator i = _files.find(path.rawString());
+		if (i == _files.end())
+			return nullptr;
+		return new Common::MemoryReadStream(&i->_value, 1);
+	}
+};
+
+/** An archive whose member names are case sensitive */
+class CaseSensitiveArchive : public Common::Archive {
+public:
+	typedef Common::HashMap<Common::String, byte> FileMap;
+	FileMap _files;
+
+	void addFile(const Common::String &name, byte value) { _files[name] = value; }
+
+	bool hasFile(const Common::Path &path) const override {
+		return _files.contains(path.rawString());
+	}
+
+	int listMembers(Common::ArchiveMemberList &list) const override {
+		for (FileMap::const_iterator i = _files.begin(); i != _files.end(); ++i)
+			list.push_back(Common::ArchiveMemberPtr(new Common::GenericArchiveMember(i->_key, this)));
+		return _files.size();
+	}
+
+	const Common::ArchiveMemberPtr getMember(const Common::Path &path) const override {
+		if (!hasFile(path))
+			return Common::ArchiveMemberPtr();
+		return Common::ArchiveMemberPtr(new Common::GenericArchiveMember(path.rawString(), this));
+	}
+
+	Common::SeekableReadStream *createReadStreamForMember(const Common::Path &path) const override {
+		FileMap::const_iterator i = _files.find(path.rawString());
+		if (i == _files.end())
+			return nullptr;
+		return new Common::MemoryReadStream(&i->_value, 1);
+	}
+};
+
+class SearchSetTestSuite : public CxxTest::TestSuite
+{
+	public:
+	static byte readMember(const Common::SearchSet &set, const char *name) {
+		Common::SeekableReadStream *stream = set.createReadStreamForMember(name);
+		if (!stream)
+			return 0;
+		byte value = stream->readByte();
+		delete stream;
+		return value;
+	}
+
+	void test_index_lookup() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// The index uses a mutex
+		Common::install_null_g_system();
+
+		Common::SearchSet set;
+		CountingArchive *low = new CountingArchive();
+		CountingArchive *high = new CountingArchive();
+		low->addFile("a.dat", 1);
+		low->addFile("b.dat", 2);
+		high->addFile("b.dat", 3);
+		set.add("low", low, 0);
+		set.add("high", high, 10);
+		set.enableIndex(true);
+
+		// The first lookup searches the archives, later ones use the index
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 1);
+		TS_ASSERT_EQUALS(set.getIndexMisses(), 1u);
+		TS_ASSERT_EQUALS(set.getIndexHits(), 0u);
+
+		int lookups = low->_lookups + high->_lookups;
+		const int highLookups = high->_lookups;
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 1);
+		TS_ASSERT(set.hasFile("a.dat"));
+		TS_ASSERT_EQUALS(set.getIndexHits(), 2u);
+		// Only the archive with the file is asked, to confirm it still has
+		// the file and to open it
+		TS_ASSERT_EQUALS(high->_lookups, highLookups);
+		TS_ASSERT_EQUALS(high->_lookups + low->_lookups, lookups + 3);
+
+		// Other cases of the path use the same entry
+		TS_ASSERT_EQUALS(readMember(set, "A.DAT"), 1);
+		TS_ASSERT(set.hasFile("a.DAT"));
+		TS_ASSERT_EQUALS(set.getIndexMisses(), 1u);
+		TS_ASSERT_EQUALS(set.getIndexHits(), 4u);
+
+		// Priorities are respected
+		TS_ASSERT_EQUALS(readMember(set, "b.dat"), 3);
+		TS_ASSERT_EQUALS(readMember(set, "b.dat"), 3);
+
+		// Missing files are remembered as well
+		TS_ASSERT(!set.hasFile("c.dat"));
+		lookups = low->_lookups + high->_lookups;
+		TS_ASSERT(!set.hasFile("c.dat"));
+		TS_ASSERT_EQUALS(readMember(set, "c.dat"), 0);
+		TS_ASSERT_EQUALS(high->_lookups + low->_lookups, lookups);
+
+		set.resetIndexStats();
+		TS_ASSERT_EQUALS(set.getIndexHits(), 0u);
+		TS_ASSERT_EQUALS(set.getIndexMisses(), 0u);
+#endif
+	}
+
+	void test_index_matches_linear() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		// A case sensitive archive in front of a case insensitive one, which
+		// do not have the same files in different cases
+		CaseSensitiveArchive sensitive;
+		sensitive.addFile("Data.bin", 1);
+		sensitive.addFile("DATA.BIN", 2);
+		sensitive.addFile("Both.bin", 5);
+		CountingArchive insensitive;
+		insensitive.addFile("both.bin", 3);
+		insensitive.addFile("other.bin", 4);
+
+		Common::SearchSet linear, indexed;
+		linear.add("sensitive", &sensitive, 10, false);
+		linear.add("insensitive", &insensitive, 0, false);
+		indexed.add("sensitive", &sensitive, 10, false);
+		indexed.add("insensitive", &insensitive, 0, false);
+		indexed.enableIndex(true);
+
+		// Every order of case variants, twice to go through the index
+		static const char *const names[] = {
+			"Data.bin", "DATA.BIN", "data.bin", "dAtA.bIn", "Other.bin", "missing.bin",
+			"data.bin", "DATA.BIN", "Data.bin", "OTHER.BIN", "MISSING.BIN", "Both.bin"
+		};
+		for (int pass = 0; pass < 2; ++pass) {
+			for (int i = 0; i < ARRAYSIZE(names); ++i) {
+				TS_ASSERT_EQUALS(readMember(indexed, names[i]), readMember(linear, names[i]));
+				TS_ASSERT_EQUALS(indexed.hasFile(names[i]), linear.hasFile(names[i]));
+				TS_ASSERT_EQUALS(indexed.getMember(names[i]).get() != nullptr, linear.getMember(names[i]).get() != nullptr);
+			}
+		}
+		TS_ASSERT(indexed.getIndexHits() > 0);
+#endif
+	}
+
+	void test_index_invalidation() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Common::SearchSet set;
+		CountingArchive *low = new CountingArchive();
+		low->addFile("a.dat", 1);
+		set.add("low", low, 0);
+		set.enableIndex(true);
+
+		TS_ASSERT(!set.hasFile("b.dat"));
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 1);
+
+		// Adding an archive drops the index
+		CountingArchive *high = new CountingArchive();
+		high->addFile("a.dat", 2);
+		high->addFile("b.dat", 3);
+		set.add("high", high, 10);
+		TS_ASSERT(set.hasFile("b.dat"));
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 2);
+
+		// So do priority changes and removals
+		set.setPriority("low", 20);
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 1);
+		set.remove("low");
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 2);
+
+		// Changes to nested sets are noticed too
+		Common::SearchSet *nested = new Common::SearchSet();
+		set.add("nested", nested, 30);
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 2);
+		CountingArchive *inner = new CountingArchive();
+		inner->addFile("a.dat", 4);
+		nested->add("inner", inner);
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 4);
+
+		// Changes to unrelated sets keep the index
+		Common::SearchSet other;
+		other.add("other", new CountingArchive());
+		set.resetIndexStats();
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 4);
+		TS_ASSERT_EQUALS(set.getIndexHits(), 1u);
+		TS_ASSERT_EQUALS(set.getIndexMisses(), 0u);
+
+		// Archives changing by themselves need the index to be reset
+		TS_ASSERT(!set.hasFile("d.dat"));
+		inner->addFile("d.dat", 5);
+		TS_ASSERT(!set.hasFile("d.dat"));
+		set.enableIndex(true);
+		TS_ASSERT_EQUALS(readMember(set, "d.dat"), 5);
+
+		// So does removing an archive from a nested set
+		nested->remove("inner");
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 2);
+		TS_ASSERT(!set.hasFile("d.dat"));
+		inner = new CountingArchive();
+		inner->addFile("a.dat", 4);
+		nested->add("inner", inner);
+
+		// Stale entries fall back to searching all archives
+		inner->_files.erase("a.dat");
+		TS_ASSERT_EQUALS(readMember(set, "a.dat"), 2);
+		TS_ASSERT(set.hasFile("a.dat"));
+#endif
+	}
+};
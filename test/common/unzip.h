@@ -0,0 +1,227 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/memstream.h"
+#include "common/scummsys.h"
+#include "common/unzip.h"
+
+/**
+ * A zip file with three members:
+ * - "stored.txt": stored, containing "Hello, stored zip member!"
+ * - "small.bin": deflated, 1000 bytes with byte i being (i * 7) & 0xFF
+ * - "big.bin": deflated, 600000 zero bytes, except for every 4096th byte,
+ *   which holds the index of its 4 KB block
+ */
+static const byte zipData[] = {
+	0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xe9, 0xe4,
+	0x6e, 0xb8, 0x19, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x73, 0x74,
+	0x6f, 0x72, 0x65, 0x64, 0x2e, 0x74, 0x78, 0x74, 0x48, 0x65, 0x6c, 0x6c, 0x6f, 0x2c, 0x20, 0x73,
+	0x74, 0x6f, 0x72, 0x65, 0x64, 0x20, 0x7a, 0x69, 0x70, 0x20, 0x6d, 0x65, 0x6d, 0x62, 0x65, 0x72,
+	0x21, 0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0xff,
+	0xd5, 0x4a, 0x11, 0x18, 0x01, 0x00, 0x00, 0xe8, 0x03, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x73,
+	0x6d, 0x61, 0x6c, 0x6c, 0x2e, 0x62, 0x69, 0x6e, 0x63, 0x60, 0xe7, 0x13, 0x95, 0x51, 0xd6, 0x32,
+	0xb4, 0xb0, 0x77, 0xf3, 0x0d, 0x89, 0x4e, 0xca, 0x2c, 0x28, 0xaf, 0x6b, 0xed, 0x99, 0x3c, 0x6b,
+	0xe1, 0x8a, 0xf5, 0xdb, 0xf6, 0x1e, 0x39, 0x7d, 0xe9, 0xe6, 0x83, 0xe7, 0xef, 0xbe, 0xfe, 0x61,
+	0xe6, 0x12, 0x94, 0x90, 0x57, 0xd3, 0x35, 0xb1, 0x76, 0xf2, 0x0c, 0x08, 0x8f, 0x4b, 0xcd, 0x29,
+	0xae, 0x6a, 0xec, 0xe8, 0x9f, 0x36, 0x77, 0xc9, 0xea, 0x4d, 0x3b, 0x0f, 0x1c, 0x3f, 0x77, 0xf5,
+	0xce, 0xe3, 0x57, 0x1f, 0x7f, 0xfc, 0x67, 0xe3, 0x15, 0x91, 0x56, 0xd2, 0x34, 0x30, 0xb7, 0x73,
+	0xf5, 0x09, 0x8e, 0x4a, 0xcc, 0xc8, 0x2f, 0xab, 0x6d, 0xe9, 0x9e, 0x34, 0x73, 0xc1, 0xf2, 0x75,
+	0x5b, 0xf7, 0x1c, 0x3e, 0x75, 0xf1, 0xc6, 0xfd, 0x67, 0x6f, 0xbf, 0xfc, 0x66, 0xe2, 0x14, 0x10,
+	0x97, 0x53, 0xd5, 0x31, 0xb6, 0x72, 0xf4, 0xf0, 0x0f, 0x8b, 0x4d, 0xc9, 0x2e, 0xaa, 0x6c, 0x68,
+	0xef, 0x9b, 0x3a, 0x67, 0xf1, 0xaa, 0x8d, 0x3b, 0xf6, 0x1f, 0x3b, 0x7b, 0xe5, 0xf6, 0xa3, 0x97,
+	0x1f, 0xbe, 0xff, 0x63, 0xe5, 0x11, 0x96, 0x52, 0xd4, 0xd0, 0x37, 0xb3, 0x75, 0xf1, 0x0e, 0x8a,
+	0x4c, 0x48, 0xcf, 0x2b, 0xad, 0x69, 0xee, 0x9a, 0x38, 0x63, 0xfe, 0xb2, 0xb5, 0x5b, 0x76, 0x1f,
+	0x3a, 0x79, 0xe1, 0xfa, 0xbd, 0xa7, 0x6f, 0x3e, 0xff, 0x62, 0xe4, 0xe0, 0x17, 0x93, 0x55, 0xd1,
+	0x36, 0xb2, 0x74, 0x70, 0xf7, 0x0b, 0x8d, 0x49, 0xce, 0x2a, 0xac, 0xa8, 0x6f, 0xeb, 0x9d, 0x32,
+	0x7b, 0xd1, 0xca, 0x0d, 0xdb, 0xf7, 0x1d, 0x3d, 0x73, 0xf9, 0xd6, 0xc3, 0x17, 0xef, 0xbf, 0xfd,
+	0x65, 0xe1, 0x16, 0x92, 0x54, 0x50, 0xd7, 0x33, 0xb5, 0x71, 0xf6, 0x0a, 0x8c, 0x88, 0x4f, 0xcb,
+	0x2d, 0xa9, 0x6e, 0xea, 0x9c, 0x30, 0x7d, 0xde, 0xd2, 0x35, 0x9b, 0x77, 0x1d, 0x3c, 0x71, 0xfe,
+	0xda, 0xdd, 0x27, 0xaf, 0x3f, 0xfd, 0x64, 0x18, 0xf5, 0xff, 0xa8, 0xff, 0x47, 0x80, 0xff, 0x01,
+	0x50, 0x4b, 0x03, 0x04, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0x33, 0x46,
+	0x67, 0x93, 0x95, 0x04, 0x00, 0x00, 0xc0, 0x27, 0x09, 0x00, 0x07, 0x00, 0x00, 0x00, 0x62, 0x69,
+	0x67, 0x2e, 0x62, 0x69, 0x6e, 0xed, 0xce, 0xe7, 0x16, 0x08, 0x04, 0x00, 0x06, 0x50, 0x51, 0x46,
+	0x21, 0x19, 0xd9, 0x24, 0x23, 0xab, 0xec, 0xac, 0x6c, 0x2a, 0x52, 0x84, 0xa2, 0x28, 0xb3, 0xd2,
+	0x50, 0x22, 0x2b, 0x23, 0x23, 0x7b, 0x14, 0x4f, 0xec, 0x19, 0xfc, 0xf8, 0xce, 0x77, 0x8e, 0x73,
+	0xef, 0x13, 0xdc, 0x01, 0x03, 0x00, 0x00, 0x00, 0x80, 0x97, 0xdd, 0x2b, 0xed, 0x00, 0x00, 0x00,
+	0x00, 0x10, 0x37, 0xb0, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0x06, 0xb5, 0x03, 0x00, 0x00, 0x00,
+	0x40, 0xdc, 0xab, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xf7, 0x5a, 0x3b, 0x00, 0x00, 0x00, 0x00,
+	0xc4, 0x0d, 0x6e, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x21, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10,
+	0x37, 0xb4, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0x86, 0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc,
+	0xeb, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xf7, 0x46, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x0d,
+	0x6f, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x11, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0x37, 0xb2,
+	0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xde, 0x6c, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x51, 0xed,
+	0x00, 0x00, 0x00, 0x00, 0x10, 0xf7, 0x56, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x8d, 0x6e, 0x07,
+	0x00, 0x00, 0x00, 0x80, 0xb8, 0x31, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0x37, 0xb6, 0x1d, 0x00,
+	0x00, 0x00, 0x00, 0xe2, 0xc6, 0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xdb, 0xed, 0x00, 0x00,
+	0x00, 0x00, 0x10, 0x37, 0xbe, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0x26, 0xb4, 0x03, 0x00, 0x00,
+	0x00, 0x40, 0xdc, 0xc4, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0x9b, 0xd4, 0x0e, 0x00, 0x00, 0x00,
+	0x00, 0x71, 0x93, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20, 0x6e, 0x4a, 0x3b, 0x00, 0x00, 0x00, 0x00,
+	0xc4, 0x4d, 0x6d, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x69, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10,
+	0x37, 0xbd, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xde, 0x69, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8,
+	0x19, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xf7, 0x6e, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0xcd,
+	0x6c, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x59, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0x37, 0xbb,
+	0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xe6, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0x7b, 0xed,
+	0x00, 0x00, 0x00, 0x00, 0x10, 0x37, 0xb7, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xe6, 0xb5, 0x03,
+	0x00, 0x00, 0x00, 0x40, 0xdc, 0xfc, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0x5b, 0xd0, 0x0e, 0x00,
+	0x00, 0x00, 0x00, 0x71, 0x0b, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20, 0xee, 0xfd, 0x76, 0x00, 0x00,
+	0x00, 0x00, 0x88, 0xfb, 0xa0, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0x16, 0xb5, 0x03, 0x00, 0x00,
+	0x00, 0x40, 0xdc, 0xe2, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0x5b, 0xd2, 0x0e, 0x00, 0x00, 0x00,
+	0x00, 0x71, 0x4b, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20, 0x6e, 0x59, 0x3b, 0x00, 0x00, 0x00, 0x00,
+	0xc4, 0x2d, 0x6f, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x15, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10,
+	0xf7, 0x61, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0xad, 0x6c, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8,
+	0x55, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xb7, 0xba, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xd6,
+	0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xda, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0xfb, 0xa8,
+	0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xd6, 0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xfa, 0x76,
+	0x00, 0x00, 0x00, 0x00, 0x88, 0xdb, 0xd0, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0x1b, 0xdb, 0x01,
+	0x00, 0x00, 0x00, 0x20, 0x6e, 0x53, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x6d, 0x6e, 0x07, 0x00,
+	0x00, 0x00, 0x80, 0xb8, 0x2d, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xb7, 0xb5, 0x1d, 0x00, 0x00,
+	0x00, 0x00, 0xe2, 0xb6, 0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xc7, 0xed, 0x00, 0x00, 0x00,
+	0x00, 0x10, 0xf7, 0x49, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x7d, 0xda, 0x0e, 0x00, 0x00, 0x00,
+	0x00, 0x71, 0xdb, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20, 0x6e, 0x47, 0x3b, 0x00, 0x00, 0x00, 0x00,
+	0xc4, 0x7d, 0xd6, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0x3b, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20,
+	0xee, 0xf3, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0xfb, 0xa2, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2,
+	0x76, 0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xee, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0xfb,
+	0xb2, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xf6, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xde,
+	0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0xdb, 0xd7, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0x5f, 0xb5,
+	0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xd7, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xb7, 0xbf, 0x1d,
+	0x00, 0x00, 0x00, 0x00, 0xe2, 0x0e, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0x37, 0xed, 0x00,
+	0x00, 0x00, 0x00, 0x10, 0xf7, 0x6d, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x1d, 0x6c, 0x07, 0x00,
+	0x00, 0x00, 0x80, 0xb8, 0x43, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xf7, 0x5d, 0x3b, 0x00, 0x00,
+	0x00, 0x00, 0xc4, 0x7d, 0xdf, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0x87, 0xdb, 0x01, 0x00, 0x00,
+	0x00, 0x20, 0xee, 0x48, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x1d, 0x6d, 0x07, 0x00, 0x00, 0x00,
+	0x80, 0xb8, 0x63, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0x77, 0xbc, 0x1d, 0x00, 0x00, 0x00, 0x00,
+	0xe2, 0x4e, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0x0f, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10,
+	0xf7, 0x63, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0xfd, 0xd4, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71,
+	0x27, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20, 0xee, 0xe7, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0xfb,
+	0xa5, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0x7e, 0x6d, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0xdf,
+	0xda, 0x01, 0x00, 0x00, 0x00, 0x20, 0xee, 0x54, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0xfd, 0xde,
+	0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0x7f, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xe9, 0x76,
+	0x00, 0x00, 0x00, 0x00, 0x88, 0xfb, 0xb3, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xce, 0xb4, 0x03,
+	0x00, 0x00, 0x00, 0x40, 0xdc, 0xd9, 0x76, 0x00, 0x00, 0x00, 0x00, 0x88, 0xfb, 0xab, 0x1d, 0x00,
+	0x00, 0x00, 0x00, 0xe2, 0xce, 0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xf9, 0x76, 0x00, 0x00,
+	0x00, 0x00, 0x88, 0xbb, 0xd0, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0x17, 0xdb, 0x01, 0x00, 0x00,
+	0x00, 0x20, 0xee, 0x52, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0xfd, 0xdd, 0x0e, 0x00, 0x00, 0x00,
+	0x00, 0x71, 0x97, 0xdb, 0x01, 0x00, 0x00, 0x00, 0x20, 0xee, 0x4a, 0x3b, 0x00, 0x00, 0x00, 0x00,
+	0xc4, 0x5d, 0x6d, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8, 0x6b, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10,
+	0xf7, 0x4f, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x5d, 0x6f, 0x07, 0x00, 0x00, 0x00, 0x80, 0xb8,
+	0x1b, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0x77, 0xb3, 0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0x6e,
+	0xb5, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xbf, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0x77, 0xbb,
+	0x1d, 0x00, 0x00, 0x00, 0x00, 0xe2, 0xee, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0xdd, 0x76,
+	0x00, 0x00, 0x00, 0x00, 0x88, 0xbb, 0xd7, 0x0e, 0x00, 0x00, 0x00, 0x00, 0x71, 0xf7, 0xdb, 0x01,
+	0x00, 0x00, 0x00, 0x20, 0xee, 0x41, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x3d, 0x6c, 0x07, 0x00,
+	0x00, 0x00, 0x80, 0xb8, 0x47, 0xed, 0x00, 0x00, 0x00, 0x00, 0x10, 0xf7, 0xb8, 0x1d, 0x00, 0x00,
+	0x00, 0x00, 0xe2, 0x9e, 0xb4, 0x03, 0x00, 0x00, 0x00, 0x40, 0xdc, 0x7f, 0xed, 0x00, 0x00, 0x00,
+	0x00, 0x10, 0xf7, 0x7f, 0x3b, 0x00, 0x00, 0x00, 0x00, 0xc4, 0x3d, 0x6d, 0x07, 0x00, 0x00, 0x00,
+	0x80, 0xb8, 0x67, 0xed, 0x00, 0x00, 0xf0, 0xc2, 0x9e, 0x03, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03,
+	0x14, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x21, 0x00, 0xe9, 0xe4, 0x6e, 0xb8, 0x19, 0x00,
+	0x00, 0x00, 0x19, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x00, 0x00, 0x73, 0x74, 0x6f, 0x72, 0x65, 0x64, 0x2e, 0x74,
+	0x78, 0x74, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00,
+	0x21, 0x00, 0xff, 0xd5, 0x4a, 0x11, 0x18, 0x01, 0x00, 0x00, 0xe8, 0x03, 0x00, 0x00, 0x09, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x01, 0x41, 0x00, 0x00, 0x00,
+	0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x2e, 0x62, 0x69, 0x6e, 0x50, 0x4b, 0x01, 0x02, 0x14, 0x03, 0x14,
+	0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x21, 0x00, 0x33, 0x46, 0x67, 0x93, 0x95, 0x04, 0x00,
+	0x00, 0xc0, 0x27, 0x09, 0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x80, 0x01, 0x80, 0x01, 0x00, 0x00, 0x62, 0x69, 0x67, 0x2e, 0x62, 0x69, 0x6e, 0x50, 0x4b,
+	0x05, 0x06, 0x00, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00, 0xa4, 0x00, 0x00, 0x00, 0x3a, 0x06,
+	0x00, 0x00, 0x00, 0x00
+};
+
+class UnzipTestSuite : public CxxTest::TestSuite {
+public:
+	static Common::Archive *openArchive() {
+		return Common::makeZipArchive(new Common::MemoryReadStream(zipData, sizeof(zipData)));
+	}
+
+	void test_stored_member() {
+		Common::Archive *archive = openArchive();
+		TS_ASSERT(archive);
+
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("stored.txt");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 25);
+
+		char buf[26];
+		TS_ASSERT_EQUALS(stream->read(buf, 25), 25u);
+		buf[25] = 0;
+		TS_ASSERT_EQUALS(Common::String(buf), "Hello, stored zip member!");
+
+		TS_ASSERT(stream->seek(7));
+		TS_ASSERT_EQUALS(stream->readByte(), 's');
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_member_outlives_archive() {
+		Common::Archive *archive = openArchive();
+		Common::SeekableReadStream *stored = archive->createReadStreamForMember("stored.txt");
+		delete archive;
+
+		TS_ASSERT(stored);
+		TS_ASSERT_EQUALS(stored->readByte(), 'H');
+		delete stored;
+	}
+
+#ifdef USE_ZLIB
+	void test_small_deflated_member() {
+		Common::Archive *archive = openArchive();
+		Common::SeekableReadStream *stream = archive->createReadStreamForMember("small.bin");
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), 1000);
+
+		for (int i = 0; i < 1000; ++i)
+			TS_ASSERT_EQUALS(stream->readByte(), (byte)(i * 7));
+		TS_ASSERT(!stream->err());
+
+		delete stream;
+		delete archive;
+	}
+
+	void test_big_deflated_member() {
+		Common::Archive *archive = openArchive();
+		Common::SeekableReadStream *big = archive->createReadStreamForMember("big.bin");
+		Common::SeekableReadStream *small = archive->createReadStreamForMember("small.bin");
+		TS_ASSERT(big);
+		TS_ASSERT(small);
+		TS_ASSERT_EQUALS(big->size(), 600000);
+
+		// Read the whole member, interleaved with reads from another member
+		uint32 sum = 0;
+		byte buf[4096];
+		for (int block = 0; !big->eos(); ++block) {
+			const uint32 len = big->read(buf, sizeof(buf));
+			for (uint32 i = 0; i < len; ++i)
+				sum += buf[i];
+			if (len)
+				TS_ASSERT_EQUALS(buf[0], (byte)block);
+			small->seek(block % 1000);
+			TS_ASSERT_EQUALS(small->readByte(), (byte)((block % 1000) * 7));
+		}
+		TS_ASSERT(!big->err());
+		TS_ASSERT_EQUALS(big->pos(), 600000);
+
+		uint32 expected = 0;
+		for (int i = 0; i < 600000; i += 4096)
+			expected += (i >> 12) & 0xFF;
+		TS_ASSERT_EQUALS(sum, expected);
+
+		// Seek backward and forward
+		TS_ASSERT(big->seek(4096 * 100));
+		TS_ASSERT_EQUALS(big->readByte(), 100);
+		TS_ASSERT(big->seek(4096 * 3));
+		TS_ASSERT_EQUALS(big->readByte(), 3);
+		TS_ASSERT(big->seek(-(600000 - 4096 * 146), SEEK_END));
+		TS_ASSERT_EQUALS(big->readByte(), 146);
+		TS_ASSERT_EQUALS(big->readByte(), 0);
+
+		delete small;
+		delete archive;
+
+		// Still usable after the archive is gone
+		TS_ASSERT(big->seek(4096 * 5));
+		TS_ASSERT_EQUALS(big->readByte(), 5);
+		delete big;
+	}
+#endif
+};
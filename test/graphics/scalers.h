@@ -0,0 +1,206 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/file.h"
+#include "common/random.h"
+#include "graphics/surface.h"
+#include "image/png.h"
+
+#include "../null_osystem.h"
+
+#ifdef USE_HQ_SCALERS
+#include "graphics/scaler/hq.h"
+#endif
+#ifdef USE_EDGE_SCALERS
+#include "graphics/scaler/edge.h"
+#endif
+
+class ScalerTestSuite : public CxxTest::TestSuite
+{
+	public:
+	// Wider than the chunks the HQ patterns are computed in
+	static const int kWidth = 300;
+	static const int kHeight = 40;
+	// The size of the real game frames
+	static const int kFrameWidth = 320;
+	static const int kFrameHeight = 200;
+
+	static Graphics::PixelFormat getFormat(int index) {
+		switch (index) {
+		case 0:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		case 1:
+			return Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+		case 2:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		default:
+			return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		}
+	}
+
+	static void setPixel(Graphics::Surface &s, int x, int y, uint32 color) {
+		if (s.format.bytesPerPixel == 2)
+			*(uint16 *)s.getBasePtr(x, y) = color;
+		else
+			*(uint32 *)s.getBasePtr(x, y) = color;
+	}
+
+	/**
+	 * Fill the frame, including the border the scalers read, with colors
+	 * from a small palette and slight variations of them, so that both
+	 * equal and barely different neighbours are common.
+	 */
+	static void fillRandom(Graphics::Surface &s, uint32 seed) {
+		Common::RandomSource rnd("scalers");
+		rnd.setSeed(seed);
+
+		byte palette[8][3];
+		for (int i = 0; i < 8; ++i)
+			for (int c = 0; c < 3; ++c)
+				palette[i][c] = rnd.getRandomNumber(255);
+
+		for (int y = 0; y < s.h; ++y) {
+			for (int x = 0; x < s.w; ++x) {
+				const byte *color = palette[rnd.getRandomNumber(7)];
+				int r = color[0], g = color[1], b = color[2];
+				if (rnd.getRandomBit()) {
+					r = CLIP<int>(r + rnd.getRandomNumberRngSigned(-12, 12), 0, 255);
+					g = CLIP<int>(g + rnd.getRandomNumberRngSigned(-12, 12), 0, 255);
+					b = CLIP<int>(b + rnd.getRandomNumberRngSigned(-12, 12), 0, 255);
+				}
+				setPixel(s, x, y, s.format.RGBToColor(r, g, b));
+			}
+		}
+	}
+
+	/**
+	 * Load a 640x400 screenshot of a 320x200 game and convert it to the
+	 * frame, including the border the scalers read.
+	 */
+	static bool loadFrame(Graphics::Surface &s, const char *name) {
+#if defined(USE_PNG) && NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Common::File file;
+		if (!file.open(Common::Path("render_mode").join(name)))
+			return false;
+
+		Image::PNGDecoder decoder;
+		if (!decoder.loadStream(file))
+			return false;
+
+		const Graphics::Surface *image = decoder.getSurface();
+		for (int y = 0; y < s.h; ++y) {
+			for (int x = 0; x < s.w; ++x) {
+				const int imageX = CLIP<int>(x - 1, 0, image->w / 2 - 1) * 2;
+				const int imageY = CLIP<int>(y - 1, 0, image->h / 2 - 1) * 2;
+				byte r, g, b;
+				image->format.colorToRGB(image->getPixel(imageX, imageY), r, g, b);
+				setPixel(s, x, y, s.format.RGBToColor(r, g, b));
+			}
+		}
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	/**
+	 * Scale the frame with every factor of the scaler, with the scalar code
+	 * and then with the SIMD code on each instruction set the CPU supports,
+	 * and compare the results.
+	 */
+	static void compareFactors(ScalerPluginObject &scaler, void (*enableSimd)(ScalerPluginObject &, bool), const Graphics::Surface &src) {
+		const Common::CpuFeature features[] = { Common::kCpuFeatureAVX2, Common::kCpuFeatureSSE41 };
+		const int width = src.w - 2, height = src.h - 2;
+
+		const Common::Array<uint> &factors = scaler.getFactors();
+		for (uint i = 0; i < factors.size(); ++i) {
+			scaler.setFactor(factors[i]);
+
+			Graphics::Surface expected, dst;
+			expected.create(width * factors[i], height * factors[i], src.format);
+			dst.create(width * factors[i], height * factors[i], src.format);
+
+			enableSimd(scaler, false);
+			scaler.scale((const uint8 *)src.getBasePtr(1, 1), src.pitch,
+			             (uint8 *)expected.getPixels(), expected.pitch, width, height, 0, 0);
+
+			// Disable the newest instruction set after each run
+			enableSimd(scaler, true);
+			for (int disabled = 0; disabled <= ARRAYSIZE(features); ++disabled) {
+				memset(dst.getPixels(), 0, dst.h * dst.pitch);
+				scaler.scale((const uint8 *)src.getBasePtr(1, 1), src.pitch,
+				             (uint8 *)dst.getPixels(), dst.pitch, width, height, 0, 0);
+				TS_ASSERT_EQUALS(memcmp(expected.getPixels(), dst.getPixels(), dst.h * dst.pitch), 0);
+
+				if (disabled < ARRAYSIZE(features))
+					Common::enableCpuFeature(features[disabled], false);
+			}
+			for (int j = 0; j < ARRAYSIZE(features); ++j)
+				Common::enableCpuFeature(features[j], true);
+
+			expected.free();
+			dst.free();
+		}
+	}
+
+	static void compareScaler(ScalerPluginObject &scaler, void (*enableSimd)(ScalerPluginObject &, bool)) {
+		const char *const frames[] = { "default.png", "ega.png", "cga.png", "amiga.png" };
+
+		for (int f = 0; f < 4; ++f) {
+			const Graphics::PixelFormat format = getFormat(f);
+			scaler.initialize(format);
+
+			Graphics::Surface src;
+			src.create(kWidth + 2, kHeight + 2, format);
+			for (uint32 seed = 1; seed <= 3; ++seed) {
+				fillRandom(src, seed);
+				compareFactors(scaler, enableSimd, src);
+			}
+			src.free();
+
+			src.create(kFrameWidth + 2, kFrameHeight + 2, format);
+			for (int i = 0; i < ARRAYSIZE(frames); ++i) {
+				const bool loaded = loadFrame(src, frames[i]);
+#if defined(USE_PNG) && NULL_OSYSTEM_IS_AVAILABLE
+				TS_ASSERT(loaded);
+#endif
+				if (loaded)
+					compareFactors(scaler, enableSimd, src);
+			}
+			src.free();
+
+			scaler.deinitialize();
+		}
+	}
+
+#ifdef USE_HQ_SCALERS
+	static void enableHQSimd(ScalerPluginObject &scaler, bool enable) {
+		static_cast<HQPlugin &>(scaler).enableSimd(enable);
+	}
+#endif
+
+#ifdef USE_EDGE_SCALERS
+	static void enableEdgeSimd(ScalerPluginObject &scaler, bool enable) {
+		static_cast<EdgePlugin &>(scaler).enableSimd(enable);
+	}
+#endif
+
+	void test_hq_simd() {
+#ifdef USE_HQ_SCALERS
+		// The difference patterns computed a row at a time have to give
+		// exactly the same pixels as the per pixel code
+		HQPlugin scaler;
+		compareScaler(scaler, enableHQSimd);
+#endif
+	}
+
+	void test_edge_simd() {
+#ifdef USE_EDGE_SCALERS
+		EdgePlugin *scaler = new EdgePlugin();
+		compareScaler(*scaler, enableEdgeSimd);
+		delete scaler;
+#endif
+	}
+};
@@ -0,0 +1,268 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/random.h"
+
+#ifdef USE_TINYGL
+#include "graphics/tinygl/gl.h"
+#include "graphics/tinygl/texelbuffer.h"
+#include "graphics/tinygl/zblit.h"
+#include "graphics/tinygl/zbuffer.h"
+#include "graphics/tinygl/zgl.h"
+#endif
+
+class TinyGLTestSuite : public CxxTest::TestSuite
+{
+	public:
+#ifdef USE_TINYGL
+	static void randomPoint(Common::RandomSource &rnd, TinyGL::ZBufferPoint &p, int w, int h) {
+		p.x = rnd.getRandomNumber(w - 1);
+		p.y = rnd.getRandomNumber(h - 1);
+		p.z = rnd.getRandomNumber(0xFFFFFF);
+		p.s = p.t = 0;
+		p.r = rnd.getRandomNumber(ZB_POINT_RED_MAX);
+		p.g = rnd.getRandomNumber(ZB_POINT_GREEN_MAX);
+		p.b = rnd.getRandomNumber(ZB_POINT_BLUE_MAX);
+		p.a = rnd.getRandomNumber(ZB_POINT_ALPHA_MAX);
+	}
+
+	static void fillBuffer(TinyGL::FrameBuffer &fb, uint32 seed) {
+		Common::RandomSource rnd("tinygl");
+		rnd.setSeed(seed);
+		byte *pixels = fb.getPixelBuffer();
+		unsigned int *zbuf = fb.getZBuffer();
+		for (int i = 0; i < fb.xsize * fb.ysize; ++i) {
+			for (int j = 0; j < fb.pixelbytes; ++j)
+				pixels[i * fb.pixelbytes + j] = rnd.getRandomNumber(255);
+			zbuf[i] = rnd.getRandomNumber(0xFFFFFF);
+		}
+	}
+
+	static float randomCoord(Common::RandomSource &rnd) {
+		return rnd.getRandomNumber(2400) / 1000.0f - 1.2f;
+	}
+
+	static void renderScene(TinyGL::FrameBuffer &fb, bool tiled, uint32 seed) {
+		static const int primitives[] = {
+			TGL_TRIANGLES, TGL_TRIANGLE_STRIP, TGL_TRIANGLE_FAN, TGL_QUADS, TGL_QUAD_STRIP, TGL_POLYGON, TGL_LINES, TGL_LINE_LOOP
+		};
+
+		Common::RandomSource rnd("tinygl");
+		rnd.setSeed(seed);
+
+		TinyGL::glInit(&fb, 256);
+		tglEnableDirtyRects(false);
+		tglEnableTiledRendering(tiled);
+
+		Graphics::Surface sprite;
+		sprite.create(40, 30, Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+		for (int i = 0; i < sprite.w * sprite.h * 4; ++i)
+			((byte *)sprite.getPixels())[i] = rnd.getRandomNumber(255);
+		Graphics::BlitImage *image = Graphics::tglGenBlitImage();
+		Graphics::tglUploadBlitImage(image, sprite, 0, false);
+
+		tglViewport(0, 0, fb.xsize, fb.ysize);
+		tglClearColor(0.2f, 0.3f, 0.4f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglEnable(TGL_DEPTH_TEST);
+
+		for (int i = 0; i < 60; ++i) {
+			if (rnd.getRandomBit())
+				tglEnable(TGL_BLEND);
+			else
+				tglDisable(TGL_BLEND);
+			tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+			tglShadeModel(rnd.getRandomBit() ? TGL_SMOOTH : TGL_FLAT);
+
+			if (i % 10 == 9) {
+				Graphics::BlitTransform transform((int)rnd.getRandomNumber(fb.xsize) - 20, (int)rnd.getRandomNumber(fb.ysize) - 15);
+				transform.tint(rnd.getRandomNumber(255) / 255.0f);
+				Graphics::tglBlit(image, transform);
+				continue;
+			}
+
+			// The vertex count has to suit all primitives, the fans draw every other triangle
+			const int primitive = primitives[rnd.getRandomNumber(ARRAYSIZE(primitives) - 1)];
+			const int vertices = primitive == TGL_TRIANGLE_FAN ? 13 : 12;
+			tglBegin(primitive);
+			for (int v = 0; v < vertices; ++v) {
+				tglColor4f(rnd.getRandomNumber(255) / 255.0f, rnd.getRandomNumber(255) / 255.0f,
+				           rnd.getRandomNumber(255) / 255.0f, rnd.getRandomNumber(255) / 255.0f);
+				tglVertex3f(randomCoord(rnd), randomCoord(rnd), randomCoord(rnd));
+			}
+			tglEnd();
+		}
+
+		TinyGL::tglPresentBuffer();
+		Graphics::tglDeleteBlitImage(image);
+		TinyGL::glClose();
+		sprite.free();
+	}
+#endif
+
+	void test_simd_spans() {
+#ifdef USE_TINYGL
+		// The vectorized spans have to produce exactly the same pixels as
+		// the generic ones, for every state they are used with
+		const int w = 67, h = 45;
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 5, 6, 5, 0, 11, 5, 0, 0)
+		};
+		const int depthFuncs[] = {
+			TGL_NEVER, TGL_LESS, TGL_EQUAL, TGL_LEQUAL, TGL_GREATER, TGL_NOTEQUAL, TGL_GEQUAL, TGL_ALWAYS
+		};
+
+		Common::RandomSource rnd("tinygl");
+		rnd.setSeed(1);
+
+		for (int f = 0; f < ARRAYSIZE(formats); ++f) {
+			TinyGL::FrameBuffer scalar(w, h, formats[f]);
+			TinyGL::FrameBuffer simd(w, h, formats[f]);
+			scalar.enableSimdSpans(false);
+			simd.enableSimdSpans(true);
+
+			for (int state = 0; state < 2 * 2 * 2 * ARRAYSIZE(depthFuncs); ++state) {
+				const bool depthTest = state & 1;
+				const bool depthWrite = state & 2;
+				const bool scissor = state & 4;
+				const int depthFunc = depthFuncs[state >> 3];
+
+				TinyGL::FrameBuffer *buffers[] = { &scalar, &simd };
+				for (int i = 0; i < 2; ++i) {
+					fillBuffer(*buffers[i], state);
+					buffers[i]->enableDepthTest(depthTest);
+					buffers[i]->enableDepthWrite(depthWrite);
+					buffers[i]->setDepthFunc(depthFunc);
+					buffers[i]->selectSpanFunctions();
+					if (scissor)
+						buffers[i]->setScissorRectangle(Common::Rect(5, 3, 50, 40));
+					else
+						buffers[i]->resetScissorRectangle();
+				}
+
+				for (int t = 0; t < 40; ++t) {
+					TinyGL::ZBufferPoint p[3];
+					for (int i = 0; i < 3; ++i)
+						randomPoint(rnd, p[i], w, h);
+
+					for (int i = 0; i < 2; ++i) {
+						TinyGL::ZBufferPoint q[3] = { p[0], p[1], p[2] };
+						if (t & 1)
+							buffers[i]->fillTriangleSmooth(&q[0], &q[1], &q[2]);
+						else
+							buffers[i]->fillTriangleFlat(&q[0], &q[1], &q[2]);
+					}
+				}
+
+				TS_ASSERT_EQUALS(memcmp(scalar.getPixelBuffer(), simd.getPixelBuffer(), w * h * 4), 0);
+				TS_ASSERT_EQUALS(memcmp(scalar.getZBuffer(), simd.getZBuffer(), w * h * sizeof(unsigned int)), 0);
+			}
+		}
+#endif
+	}
+
+	void test_simd_texture_spans() {
+#ifdef USE_TINYGL
+		// The same for lit, textured triangles, with both texture filters,
+		// every wrap mode and the alpha test
+		const int w = 67, h = 45;
+		const int textureSize = 64;
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 5, 6, 5, 0, 11, 5, 0, 0)
+		};
+		const int wrapModes[] = { TGL_REPEAT, TGL_CLAMP_TO_EDGE, TGL_MIRRORED_REPEAT };
+		const int alphaFuncs[] = {
+			TGL_NEVER, TGL_LESS, TGL_EQUAL, TGL_LEQUAL, TGL_GREATER, TGL_NOTEQUAL, TGL_GEQUAL, TGL_ALWAYS
+		};
+
+		Common::RandomSource rnd("tinygl");
+		rnd.setSeed(2);
+
+		// A texture smaller than the texture size, which is scaled up like
+		// the ones of the games
+		const int texWidth = 40, texHeight = 24;
+		byte *texels = new byte[texWidth * texHeight * 4];
+		for (int i = 0; i < texWidth * texHeight * 4; ++i)
+			texels[i] = rnd.getRandomNumber(255);
+		Graphics::PixelBuffer src(Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24), texels);
+		Graphics::NearestTexelBuffer nearest(src, texWidth, texHeight, textureSize);
+		Graphics::BilinearTexelBuffer bilinear(src, texWidth, texHeight, textureSize);
+		const Graphics::TexelBuffer *textures[] = { &nearest, &bilinear };
+
+		for (int f = 0; f < ARRAYSIZE(formats); ++f) {
+			TinyGL::FrameBuffer scalar(w, h, formats[f]);
+			TinyGL::FrameBuffer simd(w, h, formats[f]);
+			scalar.enableSimdSpans(false);
+			simd.enableSimdSpans(true);
+
+			for (int state = 0; state < 2 * 2 * 2 * ARRAYSIZE(wrapModes) * ARRAYSIZE(alphaFuncs); ++state) {
+				const bool depthWrite = state & 1;
+				const bool scissor = state & 2;
+				const Graphics::TexelBuffer *texture = textures[(state >> 2) & 1];
+				const int wrap = wrapModes[(state >> 3) % ARRAYSIZE(wrapModes)];
+				const int alphaFunc = alphaFuncs[(state >> 3) / ARRAYSIZE(wrapModes)];
+
+				TinyGL::FrameBuffer *buffers[] = { &scalar, &simd };
+				for (int i = 0; i < 2; ++i) {
+					fillBuffer(*buffers[i], state);
+					buffers[i]->enableDepthTest(true);
+					buffers[i]->enableDepthWrite(depthWrite);
+					buffers[i]->setDepthFunc(TGL_LESS);
+					buffers[i]->enableAlphaTest(alphaFunc != TGL_ALWAYS);
+					buffers[i]->setAlphaTestFunc(alphaFunc, 128);
+					buffers[i]->setTexture(texture, wrap, wrap);
+					buffers[i]->selectSpanFunctions();
+					if (scissor)
+						buffers[i]->setScissorRectangle(Common::Rect(5, 3, 50, 40));
+					else
+						buffers[i]->resetScissorRectangle();
+				}
+
+				for (int t = 0; t < 20; ++t) {
+					TinyGL::ZBufferPoint p[3];
+					for (int i = 0; i < 3; ++i) {
+						randomPoint(rnd, p[i], w, h);
+						// Coordinates outside the texture, to wrap around
+						p[i].s = rnd.getRandomNumber((3 * textureSize) << ZB_POINT_ST_FRAC_BITS) - (textureSize << ZB_POINT_ST_FRAC_BITS);
+						p[i].t = rnd.getRandomNumber((3 * textureSize) << ZB_POINT_ST_FRAC_BITS) - (textureSize << ZB_POINT_ST_FRAC_BITS);
+					}
+
+					for (int i = 0; i < 2; ++i) {
+						TinyGL::ZBufferPoint q[3] = { p[0], p[1], p[2] };
+						if (t & 1)
+							buffers[i]->fillTriangleTextureMappingPerspectiveSmooth(&q[0], &q[1], &q[2]);
+						else
+							buffers[i]->fillTriangleTextureMappingPerspectiveFlat(&q[0], &q[1], &q[2]);
+					}
+				}
+
+				TS_ASSERT_EQUALS(memcmp(scalar.getPixelBuffer(), simd.getPixelBuffer(), w * h * 4), 0);
+				TS_ASSERT_EQUALS(memcmp(scalar.getZBuffer(), simd.getZBuffer(), w * h * sizeof(unsigned int)), 0);
+			}
+		}
+
+		delete[] texels;
+#endif
+	}
+
+	void test_tiled_rendering() {
+#ifdef USE_TINYGL
+		// Rendering the frame in bands, possibly on several threads, has to
+		// give exactly the same pixels as rendering it in one go
+		const int w = 160, h = 120;
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+
+		for (uint32 seed = 1; seed <= 8; ++seed) {
+			TinyGL::FrameBuffer whole(w, h, format);
+			TinyGL::FrameBuffer tiled(w, h, format);
+			renderScene(whole, false, seed);
+			renderScene(tiled, true, seed);
+
+			TS_ASSERT_EQUALS(memcmp(whole.getPixelBuffer(), tiled.getPixelBuffer(), w * h * 4), 0);
+			TS_ASSERT_EQUALS(memcmp(whole.getZBuffer(), tiled.getZBuffer(), w * h * sizeof(unsigned int)), 0);
+		}
+#endif
+	}
+};
@@ -0,0 +1,76 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/random.h"
+#include "graphics/transparent_surface.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+	public:
+	// Not a multiple of the vector widths, to cover the shorter vectors and
+	// the scalar tails
+	static const int kWidth = 37;
+	static const int kHeight = 13;
+	static const int kTargetWidth = 64;
+	static const int kTargetHeight = 32;
+
+	static void fillRandom(Graphics::Surface &surf, Common::RandomSource &rnd) {
+		byte *pixels = (byte *)surf.getPixels();
+		for (int i = 0; i < surf.h * surf.pitch; i++) {
+			pixels[i] = rnd.getRandomNumber(255);
+		}
+	}
+
+	void test_simd_matches_scalar() {
+		Common::RandomSource rnd("transparent_surface");
+		rnd.setSeed(1);
+
+		Graphics::TransparentSurface src;
+		src.create(kWidth, kHeight, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fillRandom(src, rnd);
+		// Make sure fully transparent and fully opaque pixels show up often
+		for (int y = 0; y < kHeight; y++) {
+			for (int x = 0; x < kWidth; x += 3) {
+				*((byte *)src.getBasePtr(x, y) + (y & 1)) = (y & 2) ? 0 : 255;
+			}
+		}
+
+		Graphics::Surface background;
+		background.create(kTargetWidth, kTargetHeight, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fillRandom(background, rnd);
+
+		const uint32 colors[] = {
+			TS_ARGB(255, 255, 255, 255),
+			TS_ARGB(255, 255, 128, 0),
+			TS_ARGB(128, 255, 255, 255),
+			TS_ARGB(200, 17, 255, 96),
+			TS_ARGB(0, 255, 255, 255),
+			TS_ARGB(rnd.getRandomNumber(255), rnd.getRandomNumber(255), rnd.getRandomNumber(255), rnd.getRandomNumber(255))
+		};
+
+		for (int blend = Graphics::BLEND_NORMAL; blend < Graphics::NUM_BLEND_MODES; blend++) {
+			for (uint c = 0; c < ARRAYSIZE(colors); c++) {
+				for (int flipping = Graphics::FLIP_NONE; flipping <= Graphics::FLIP_HV; flipping++) {
+					// Scalar, SIMD without AVX2 and SIMD with AVX2 if the CPU has it
+					Graphics::Surface dst[3];
+					for (int simd = 0; simd < 3; simd++) {
+						dst[simd].copyFrom(background);
+						Graphics::TransparentSurface::enableSimd(simd != 0);
+						Common::enableCpuFeature(Common::kCpuFeatureAVX2, simd == 2);
+						src.blit(dst[simd], 5, 3, flipping, nullptr, colors[c], -1, -1, (Graphics::TSpriteBlendMode)blend);
+					}
+
+					TS_ASSERT_EQUALS(memcmp(dst[0].getPixels(), dst[1].getPixels(), kTargetHeight * dst[0].pitch), 0);
+					TS_ASSERT_EQUALS(memcmp(dst[0].getPixels(), dst[2].getPixels(), kTargetHeight * dst[0].pitch), 0);
+
+					for (int simd = 0; simd < 3; simd++)
+						dst[simd].free();
+				}
+			}
+		}
+
+		Graphics::TransparentSurface::enableSimd(true);
+		background.free();
+		src.free();
+	}
+};
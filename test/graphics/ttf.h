@@ -0,0 +1,229 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/array.h"
+#include "common/file.h"
+#include "common/memstream.h"
+#include "common/ustr.h"
+#include "graphics/font.h"
+#include "graphics/fonts/ttf.h"
+#include "graphics/surface.h"
+
+#include "../null_osystem.h"
+
+// The font is read from the test data, which is only available with the null
+// OSystem
+#if defined(USE_FREETYPE2) && NULL_OSYSTEM_IS_AVAILABLE
+#define TEST_TTF 1
+#else
+#define TEST_TTF 0
+#endif
+
+#if TEST_TTF
+/**
+ * Forwards everything to a font except for the string layouts, so that
+ * strings are measured and drawn character by character.
+ */
+class UncachedFont : public Graphics::Font {
+public:
+	UncachedFont(const Graphics::Font &font) : _font(font) {}
+
+	int getFontHeight() const override { return _font.getFontHeight(); }
+	int getFontAscent() const override { return _font.getFontAscent(); }
+	int getMaxCharWidth() const override { return _font.getMaxCharWidth(); }
+	int getCharWidth(uint32 chr) const override { return _font.getCharWidth(chr); }
+	int getKerningOffset(uint32 left, uint32 right) const override { return _font.getKerningOffset(left, right); }
+	Common::Rect getBoundingBox(uint32 chr) const override { return _font.getBoundingBox(chr); }
+	void drawChar(Graphics::Surface *dst, uint32 chr, int x, int y, uint32 color) const override { _font.drawChar(dst, chr, x, y, color); }
+
+private:
+	const Graphics::Font &_font;
+};
+#endif
+
+class TTFTestSuite : public CxxTest::TestSuite
+{
+public:
+#if TEST_TTF
+	static bool loadFontFile(Common::Array<byte> &data) {
+		Common::install_null_g_system();
+
+		Common::File file;
+		if (!file.open(Common::Path("fonts/LiberationSans-Regular.ttf")))
+			return false;
+
+		data.resize(file.size());
+		return file.read(data.data(), data.size()) == data.size();
+	}
+
+	static Graphics::Font *loadFont(const Common::Array<byte> &data, int size) {
+		Common::MemoryReadStream stream(data.data(), data.size());
+		return Graphics::loadTTFFont(stream, size);
+	}
+
+	static bool compareSurfaces(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; ++y) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+#endif
+
+	void test_atlas_reuse() {
+#if TEST_TTF
+		Common::Array<byte> data;
+		TS_ASSERT(loadFontFile(data));
+		if (data.empty())
+			return;
+
+		const uint atlases = Graphics::getTTFCacheStats().atlases;
+
+		// The same face at the same size shares the glyphs
+		Graphics::Font *font = loadFont(data, 14);
+		Graphics::Font *sameFont = loadFont(data, 14);
+		TS_ASSERT(font && sameFont);
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlases, atlases + 1);
+
+		Graphics::Surface surface;
+		surface.create(200, 40, Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24));
+		font->drawString(&surface, "Sphinx of black quartz", 0, 0, surface.w, 0xffffffff);
+		const uint glyphs = Graphics::getTTFCacheStats().atlasGlyphs;
+		sameFont->drawString(&surface, "Sphinx of black quartz", 0, 20, surface.w, 0xffffffff);
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlasGlyphs, glyphs);
+		surface.free();
+
+		// Another size renders different glyphs
+		Graphics::Font *largerFont = loadFont(data, 20);
+		TS_ASSERT(largerFont);
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlases, atlases + 2);
+
+		// So does a different file with the same header, here with a changed
+		// byte near its end
+		Common::Array<byte> changedData(data);
+		changedData[changedData.size() - 16] ^= 0x5a;
+		Graphics::Font *changedFont = loadFont(changedData, 14);
+		TS_ASSERT(changedFont);
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlases, atlases + 3);
+
+		// The atlas is released with the last font using it
+		delete changedFont;
+		delete largerFont;
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlases, atlases + 1);
+		delete font;
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlases, atlases + 1);
+		delete sameFont;
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().atlases, atlases);
+#endif
+	}
+
+	void test_run_eviction() {
+#if TEST_TTF
+		Common::Array<byte> data;
+		TS_ASSERT(loadFontFile(data));
+		if (data.empty())
+			return;
+
+		Graphics::Font *font = loadFont(data, 14);
+		TS_ASSERT(font);
+		if (!font)
+			return;
+
+		const uint runs = Graphics::getTTFCacheStats().runs;
+		const int count = 1000;
+		for (int i = 0; i < count; ++i)
+			TS_ASSERT(font->getTextRun(Common::String::format("String %d", i)));
+
+		// The cache is limited, so the oldest strings are gone while the most
+		// recent ones are still there
+		Graphics::TTFCacheStats stats = Graphics::getTTFCacheStats();
+		TS_ASSERT_LESS_THAN(stats.runs, runs + count);
+		TS_ASSERT_LESS_THAN(0u, stats.runs);
+
+		font->getTextRun(Common::String::format("String %d", count - 1));
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().runHits, stats.runHits + 1);
+		font->getTextRun("String 0");
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().runMisses, stats.runMisses + 1);
+
+		// The runs of a font are dropped with it
+		delete font;
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats().runs, runs);
+#endif
+	}
+
+	void test_run_matches_uncached() {
+#if TEST_TTF
+		Common::Array<byte> data;
+		TS_ASSERT(loadFontFile(data));
+		if (data.empty())
+			return;
+
+		Graphics::Font *font = loadFont(data, 14);
+		TS_ASSERT(font);
+		if (!font)
+			return;
+
+		const UncachedFont uncachedFont(*font);
+		const Graphics::Font &uncached = uncachedFont;
+		TS_ASSERT(!uncached.getTextRun("AV"));
+
+		// Kerned pairs, glyphs reaching left of their origin and wide strings
+		const char *const strings[] = {
+			"Hello, World!", "AVAWAYATo Ty Wa", "jumps fjord", "iiiiiiiiiiiiiiiiiiiiiiiiiiiiiiiiiii",
+			"WWWWWWWWWWWWWWWWWWWWWWWWWWWWWW", "", "_j_"
+		};
+		const Graphics::TextAlign aligns[] = {
+			Graphics::kTextAlignLeft, Graphics::kTextAlignCenter, Graphics::kTextAlignRight
+		};
+		// Clipped, fitting and with room to spare
+		const int widths[] = { 40, 120, 300 };
+
+		Graphics::Surface cachedSurface, uncachedSurface;
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		cachedSurface.create(320, 30, format);
+		uncachedSurface.create(320, 30, format);
+
+		for (int i = 0; i < ARRAYSIZE(strings); ++i) {
+			const Common::String str(strings[i]);
+			const Common::U32String u32str(str);
+
+			// Once to fill the cache and once from it
+			for (int pass = 0; pass < 2; ++pass) {
+				const uint hits = Graphics::getTTFCacheStats().runHits;
+				TS_ASSERT_EQUALS(font->getStringWidth(str), uncached.getStringWidth(str));
+				TS_ASSERT_EQUALS(font->getStringWidth(u32str), uncached.getStringWidth(u32str));
+				if (pass == 1 && !str.empty())
+					TS_ASSERT_LESS_THAN(hits, Graphics::getTTFCacheStats().runHits);
+			}
+
+			for (int a = 0; a < ARRAYSIZE(aligns); ++a) {
+				for (int w = 0; w < ARRAYSIZE(widths); ++w) {
+					TS_ASSERT_EQUALS(font->getBoundingBox(str, 5, 3, widths[w], aligns[a]),
+						uncached.getBoundingBox(str, 5, 3, widths[w], aligns[a]));
+					TS_ASSERT_EQUALS(font->getBoundingBox(u32str, 5, 3, widths[w], aligns[a], 7),
+						uncached.getBoundingBox(u32str, 5, 3, widths[w], aligns[a], 7));
+
+					for (int ellipsis = 0; ellipsis < 2; ++ellipsis) {
+						cachedSurface.fillRect(Common::Rect(cachedSurface.w, cachedSurface.h), 0);
+						uncachedSurface.fillRect(Common::Rect(uncachedSurface.w, uncachedSurface.h), 0);
+						font->drawString(&cachedSurface, str, 5, 3, widths[w], 0xffffffff, aligns[a], 0, ellipsis);
+						uncached.drawString(&uncachedSurface, str, 5, 3, widths[w], 0xffffffff, aligns[a], 0, ellipsis);
+						TS_ASSERT(compareSurfaces(cachedSurface, uncachedSurface));
+
+						font->drawString(&cachedSurface, u32str, 5, 15, widths[w], 0xff00ff00, aligns[a], 7, ellipsis);
+						uncached.drawString(&uncachedSurface, u32str, 5, 15, widths[w], 0xff00ff00, aligns[a], 7, ellipsis);
+						TS_ASSERT(compareSurfaces(cachedSurface, uncachedSurface));
+					}
+				}
+			}
+		}
+
+		cachedSurface.free();
+		uncachedSurface.free();
+		delete font;
+#endif
+	}
+};
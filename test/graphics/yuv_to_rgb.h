@@ -0,0 +1,95 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/random.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+	public:
+	// Not a multiple of the vector width, to cover the scalar tails
+	static const int kWidth = 300;
+	static const int kHeight = 24;
+
+	enum Subsampling {
+		k444,
+		k420,
+		k420Alpha,
+		k410
+	};
+
+	struct Planes {
+		byte y[kWidth * kHeight];
+		byte a[kWidth * kHeight];
+		// 410 reads one extra chroma row and column
+		byte u[(kWidth + 1) * (kHeight + 1)];
+		byte v[(kWidth + 1) * (kHeight + 1)];
+	};
+
+	static Graphics::PixelFormat getFormat(int index) {
+		switch (index) {
+		case 0:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		case 1:
+			return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		case 2:
+			return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0);
+		default:
+			return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		}
+	}
+
+	static void convert(Graphics::Surface &dst, Subsampling subsampling, Graphics::YUVToRGBManager::LuminanceScale scale, const Planes &planes) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(&dst, scale, planes.y, planes.u, planes.v, kWidth, kHeight, kWidth, kWidth + 1);
+			break;
+		case k420:
+			YUVToRGBMan.convert420(&dst, scale, planes.y, planes.u, planes.v, kWidth, kHeight, kWidth, kWidth + 1);
+			break;
+		case k420Alpha:
+			YUVToRGBMan.convert420Alpha(&dst, scale, planes.y, planes.u, planes.v, planes.a, kWidth, kHeight, kWidth, kWidth + 1);
+			break;
+		case k410:
+			YUVToRGBMan.convert410(&dst, scale, planes.y, planes.u, planes.v, kWidth, kHeight, kWidth, kWidth + 1);
+			break;
+		}
+	}
+
+	void test_simd_matches_lookup() {
+		Common::RandomSource rnd("yuv_to_rgb");
+		rnd.setSeed(1);
+
+		// Full range planes make sure the clipping at both ends is covered
+		Planes *planes = new Planes();
+		for (int i = 0; i < kWidth * kHeight; i++) {
+			planes->y[i] = rnd.getRandomNumber(255);
+			planes->a[i] = rnd.getRandomNumber(255);
+		}
+		for (int i = 0; i < (kWidth + 1) * (kHeight + 1); i++) {
+			planes->u[i] = rnd.getRandomNumber(255);
+			planes->v[i] = rnd.getRandomNumber(255);
+		}
+
+		for (int f = 0; f < 4; f++) {
+			for (int s = k444; s <= k410; s++) {
+				for (int scale = 0; scale < 2; scale++) {
+					Graphics::Surface dst[2];
+					for (int simd = 0; simd < 2; simd++) {
+						dst[simd].create(kWidth, kHeight, getFormat(f));
+						YUVToRGBMan.enableSimd(simd != 0);
+						convert(dst[simd], (Subsampling)s, scale ? Graphics::YUVToRGBManager::kScaleITU : Graphics::YUVToRGBManager::kScaleFull, *planes);
+					}
+
+					TS_ASSERT_EQUALS(memcmp(dst[0].getPixels(), dst[1].getPixels(), kHeight * dst[0].pitch), 0);
+
+					dst[0].free();
+					dst[1].free();
+				}
+			}
+		}
+
+		YUVToRGBMan.enableSimd(true);
+		delete planes;
+	}
+};
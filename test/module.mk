@@ -5,7 +5,7 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/video/*.h
 TEST_LIBS    :=
 
 ifdef POSIX
@@ -15,7 +15,9 @@ TEST_LIBS += test/null_osystem.o \
 	backends/fs/posix/posix-iostream.o \
 	backends/fs/abstract-fs.o \
 	backends/fs/stdiostream.o \
-	backends/modular-backend.o
+	backends/modular-backend.o \
+	backends/mutex/pthread/pthread-mutex.o \
+	backends/threads/pthread/pthread-threads.o
 endif
 
 ifdef WIN32
@@ -28,7 +30,7 @@ TEST_LIBS += test/null_osystem.o \
 	backends/platform/sdl/win32/win32_wrapper.o
 endif
 
-TEST_LIBS +=	audio/libaudio.a math/libmath.a common/libcommon.a image/libimage.a graphics/libgraphics.a
+TEST_LIBS +=	video/libvideo.a audio/libaudio.a math/libmath.a image/libimage.a graphics/libgraphics.a common/libcommon.a
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -46,6 +48,10 @@ TEST_CFLAGS  := $(CFLAGS) -I$(srcdir)/test/cxxtest
 TEST_LDFLAGS := $(LDFLAGS) $(LIBS)
 TEST_CXXFLAGS := $(filter-out -Wglobal-constructors,$(CXXFLAGS))
 
+ifdef POSIX
+TEST_LDFLAGS += -lpthread
+endif
+
 ifdef WIN32
 TEST_LDFLAGS := $(filter-out -mwindows,$(TEST_LDFLAGS))
 endif
@@ -73,15 +79,44 @@ test/runner.cpp: $(TESTS) $(srcdir)/test/module.mk
 	@mkdir -p test
 	$(srcdir)/test/cxxtest/cxxtestgen.py $(TEST_FLAGS) -o $@ $+
 
+# Benchmarks of the optimized code paths. They are not part of the tests,
+# since their timings depend on the machine. Use the 'benchmark' target to
+# run all of them, or pass names to test/benchmark/benchmark.
+BENCHMARK_OBJS := \
+	test/benchmark/main.o \
+	test/benchmark/audio.o \
+	test/benchmark/common.o \
+	test/benchmark/graphics.o
+
+benchmark: test/benchmark/benchmark
+	./test/benchmark/benchmark
+test/benchmark/benchmark: $(BENCHMARK_OBJS) $(TEST_LIBS)
+	+$(QUIET_LINK)$(LD) $(TEST_CXXFLAGS) $(CPPFLAGS) -o $@ $(BENCHMARK_OBJS) $(TEST_LIBS) $(TEST_LDFLAGS)
+
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner test/engine-data/encoding.dat
+	-$(RM) test/runner.cpp test/runner test/engine-data/encoding.dat $(RENDER_MODE_FRAMES:%=test/engine-data/render_mode/%.png) $(TEST_FONTS:%=test/engine-data/fonts/%.ttf)
+	-$(RM) test/benchmark/benchmark $(BENCHMARK_OBJS)
+	-rmdir test/engine-data/render_mode
+	-rmdir test/engine-data/fonts
 	-rmdir test/engine-data
 
 test/engine-data/encoding.dat: $(srcdir)/dists/engine-data/encoding.dat
 	$(MKDIR) test/engine-data
 	$(CP) $(srcdir)/dists/engine-data/encoding.dat test/engine-data/encoding.dat
 
-copy-dat: test/engine-data/encoding.dat
+RENDER_MODE_FRAMES := default ega cga amiga
+
+test/engine-data/render_mode/%.png: $(srcdir)/doc/docportal/images/graphics/render_mode/%.png
+	$(MKDIR) test/engine-data/render_mode
+	$(CP) $< $@
+
+TEST_FONTS := LiberationSans-Regular
+
+test/engine-data/fonts/%.ttf: $(srcdir)/gui/themes/fonts/%.ttf
+	$(MKDIR) test/engine-data/fonts
+	$(CP) $< $@
+
+copy-dat: test/engine-data/encoding.dat $(RENDER_MODE_FRAMES:%=test/engine-data/render_mode/%.png) $(TEST_FONTS:%=test/engine-data/fonts/%.ttf)
 
-.PHONY: test clean-test copy-dat
+.PHONY: test benchmark clean-test copy-dat
@@ -0,0 +1,221 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/memstream.h"
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+#include "../null_osystem.h"
+
+/**
+ * Plays a generated stream of 8bpp frames, some of them preceded by a new
+ * palette.
+ */
+class GeneratedVideoDecoder : public Video::VideoDecoder {
+public:
+	static const int kWidth = 16;
+	static const int kHeight = 8;
+	static const int kFrameCount = 40;
+
+	static Common::SeekableReadStream *generateStream() {
+		Common::MemoryWriteStreamDynamic out(DisposeAfterUse::NO);
+
+		for (int frame = 0; frame < kFrameCount; frame++) {
+			const bool newPalette = (frame % 13) == 0;
+			out.writeByte(newPalette);
+			if (newPalette) {
+				for (int i = 0; i < 256 * 3; i++)
+					out.writeByte((i * 7 + frame) & 0xFF);
+			}
+
+			for (int i = 0; i < kWidth * kHeight; i++)
+				out.writeByte((i * 3 + frame * 5) & 0xFF);
+		}
+
+		return new Common::MemoryReadStream(out.getData(), out.size(), DisposeAfterUse::YES);
+	}
+
+	~GeneratedVideoDecoder() {
+		close();
+	}
+
+	bool loadStream(Common::SeekableReadStream *stream) override {
+		close();
+		addTrack(new GeneratedVideoTrack(stream));
+		return true;
+	}
+
+private:
+	class GeneratedVideoTrack : public FixedRateVideoTrack {
+	public:
+		GeneratedVideoTrack(Common::SeekableReadStream *stream) : _stream(stream), _curFrame(-1), _dirtyPalette(false) {
+			memset(_palette, 0, sizeof(_palette));
+			_surface.create(kWidth, kHeight, Graphics::PixelFormat::createFormatCLUT8());
+
+			for (int frame = 0; frame < kFrameCount; frame++) {
+				_offsets.push_back(_stream->pos());
+				_stream->skip((_stream->readByte() ? 256 * 3 : 0) + kWidth * kHeight);
+			}
+		}
+
+		~GeneratedVideoTrack() {
+			_surface.free();
+			delete _stream;
+		}
+
+		uint16 getWidth() const override { return kWidth; }
+		uint16 getHeight() const override { return kHeight; }
+		Graphics::PixelFormat getPixelFormat() const override { return _surface.format; }
+		int getCurFrame() const override { return _curFrame; }
+		int getFrameCount() const override { return kFrameCount; }
+		bool isSeekable() const override { return true; }
+
+		bool seek(const Audio::Timestamp &time) override {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		const Graphics::Surface *decodeNextFrame() override {
+			_curFrame++;
+			_stream->seek(_offsets[_curFrame]);
+
+			if (_stream->readByte()) {
+				_stream->read(_palette, sizeof(_palette));
+				_dirtyPalette = true;
+			}
+
+			_stream->read(_surface.getPixels(), kWidth * kHeight);
+			return &_surface;
+		}
+
+		const byte *getPalette() const override {
+			_dirtyPalette = false;
+			return _palette;
+		}
+
+		bool hasDirtyPalette() const override { return _dirtyPalette; }
+
+	protected:
+		Common::Rational getFrameRate() const override { return 30; }
+
+	private:
+		Common::SeekableReadStream *_stream;
+		Common::Array<int32> _offsets;
+		Graphics::Surface _surface;
+		int _curFrame;
+		byte _palette[256 * 3];
+		mutable bool _dirtyPalette;
+	};
+};
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite
+{
+	public:
+	/** Decode frames and log everything the caller gets to see of them */
+	static void decodeFrames(GeneratedVideoDecoder &decoder, int count, Common::Array<int> &log) {
+		for (int i = 0; i < count; i++) {
+			const Graphics::Surface *surface = decoder.decodeNextFrame();
+
+			log.push_back(decoder.getCurFrame());
+			log.push_back(decoder.endOfVideo());
+			log.push_back(surface != nullptr);
+			if (surface) {
+				const byte *pixels = (const byte *)surface->getPixels();
+				for (int p = 0; p < surface->w * surface->h; p++)
+					log.push_back(pixels[p]);
+			}
+
+			log.push_back(decoder.hasDirtyPalette());
+			if (decoder.hasDirtyPalette()) {
+				const byte *palette = decoder.getPalette();
+				for (int p = 0; p < 256 * 3; p++)
+					log.push_back(palette[p]);
+			}
+		}
+	}
+
+	static void play(GeneratedVideoDecoder &decoder, Common::Array<int> &log) {
+		decoder.start();
+		decodeFrames(decoder, 10, log);
+
+		TS_ASSERT(decoder.seekToFrame(20));
+		decodeFrames(decoder, 4, log);
+
+		TS_ASSERT(decoder.rewind());
+		decodeFrames(decoder, 6, log);
+
+		decoder.pauseVideo(true);
+		decodeFrames(decoder, 2, log);
+		decoder.pauseVideo(false);
+
+		decoder.stop();
+		decoder.start();
+		decodeFrames(decoder, 3, log);
+
+		// Past the end of the video too
+		TS_ASSERT(decoder.seekToFrame(35));
+		decodeFrames(decoder, 6, log);
+	}
+
+	void test_decode_ahead() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		for (uint maxFrames = 1; maxFrames <= 4; maxFrames += 3) {
+			GeneratedVideoDecoder onDemand;
+			TS_ASSERT(onDemand.loadStream(GeneratedVideoDecoder::generateStream()));
+			TS_ASSERT(!onDemand.isDecodingAhead());
+
+			GeneratedVideoDecoder ahead;
+			TS_ASSERT(ahead.loadStream(GeneratedVideoDecoder::generateStream()));
+			ahead.setDecodeAhead(true, maxFrames);
+#ifdef POSIX
+			// The test backend has threads there
+			TS_ASSERT(ahead.isDecodingAhead());
+#endif
+
+			Common::Array<int> expected, actual;
+			play(onDemand, expected);
+			play(ahead, actual);
+
+			TS_ASSERT_EQUALS(expected.size(), actual.size());
+			TS_ASSERT(expected == actual);
+
+			if (ahead.isDecodingAhead())
+				TS_ASSERT(ahead.getDecodeAheadStats().decodedFrames > 0);
+
+			ahead.close();
+			TS_ASSERT(!ahead.isDecodingAhead());
+		}
+#endif
+	}
+
+	void test_turn_off_decode_ahead() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		GeneratedVideoDecoder decoder;
+		TS_ASSERT(decoder.loadStream(GeneratedVideoDecoder::generateStream()));
+		decoder.setDecodeAhead(true, 4);
+		decoder.start();
+
+		const Graphics::Surface *surface = decoder.decodeNextFrame();
+		TS_ASSERT(surface != nullptr);
+		TS_ASSERT(decoder.hasDirtyPalette());
+
+		// The frame and palette returned before stay valid
+		decoder.setDecodeAhead(false);
+		TS_ASSERT(!decoder.isDecodingAhead());
+
+		const byte *pixels = (const byte *)surface->getPixels();
+		for (int p = 0; p < GeneratedVideoDecoder::kWidth * GeneratedVideoDecoder::kHeight; p++)
+			TS_ASSERT_EQUALS(pixels[p], (p * 3) & 0xFF);
+
+		const byte *palette = decoder.getPalette();
+		for (int p = 0; p < 256 * 3; p++)
+			TS_ASSERT_EQUALS(palette[p], (p * 7) & 0xFF);
+
+		TS_ASSERT(decoder.decodeNextFrame() != nullptr);
+		TS_ASSERT(decoder.getPalette() != nullptr);
+#endif
+	}
+};
@@ -27,6 +27,7 @@
 #include "audio/audiostream.h"
 #include "audio/decoders/raw.h"
 
+#include "common/debug.h"
 #include "common/util.h"
 #include "common/textconsole.h"
 #include "common/math.h"
@@ -495,6 +496,7 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 	// Convert the YUV data we have to our format
 	// The width used here is the surface-width, and not the video-width
 	// to allow for odd-sized videos.
+	const uint32 convertStart = g_system->getMillis(true);
 	if (_hasAlpha) {
 		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
 		YUVToRGBMan.convert420Alpha(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
@@ -504,6 +506,7 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		YUVToRGBMan.convert420(&_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
 				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
 	}
+	debug(9, "Bink: Converted %dx%d frame to RGB in %d ms", _surfaceWidth, _surfaceHeight, g_system->getMillis(true) - convertStart);
 
 	// And swap the planes with the reference planes
 	for (int i = 0; i < 4; i++)
@@ -26,6 +26,7 @@
 #include "audio/audiostream.h"
 #include "audio/decoders/adpcm.h"
 #include "common/bitstream.h"
+#include "common/debug.h"
 #include "common/huffman.h"
 #include "common/stream.h"
 #include "common/system.h"
@@ -404,7 +405,9 @@ void PSXStreamDecoder::PSXVideoTrack::decodeFrame(Common::BitStreamMemoryStream
 			decodeMacroBlock(&bits, mbX, mbY, scale, version);
 
 	// Output data onto the frame
+	const uint32 convertStart = g_system->getMillis(true);
 	YUVToRGBMan.convert420(_surface, Graphics::YUVToRGBManager::kScaleFull, _yBuffer, _cbBuffer, _crBuffer, _surface->w, _surface->h, _macroBlocksW * 16, _macroBlocksW * 8);
+	debug(9, "PSX: Converted %dx%d frame to RGB in %d ms", _surface->w, _surface->h, g_system->getMillis(true) - convertStart);
 
 	_curFrame++;
 
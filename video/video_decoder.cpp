@@ -27,12 +27,296 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/list.h"
+#include "common/mutex.h"
+#include "common/rect.h"
 #include "common/system.h"
+#include "common/thread.h"
 
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Video {
 
+/**
+ * Decodes the frames of a video track in a worker thread and queues them up
+ * until decodeNextFrame() asks for them.
+ *
+ * The worker thread holds the decoder's track mutex while it decodes a
+ * frame. Apart from the queue, everything else belongs to the thread
+ * calling decodeNextFrame().
+ */
+class VideoDecoder::DecodeAhead {
+public:
+	struct Frame {
+		Frame() : hasSurface(false), dirtyPalette(false) {}
+
+		Graphics::Surface surface;
+		bool hasSurface;
+		bool dirtyPalette;
+		byte palette[256 * 3];
+		VideoTrackStatus status;
+	};
+
+	DecodeAhead(VideoDecoder *decoder, VideoTrack *track, uint maxFrames);
+	~DecodeAhead();
+
+	/**
+	 * Start the worker thread, decoding from the track's current position.
+	 */
+	bool start();
+
+	/**
+	 * Stop the worker thread, keeping the frames it decoded. start()
+	 * carries on after them.
+	 */
+	void suspend();
+
+	/**
+	 * Stop the worker thread and drop the frames it decoded. The frame
+	 * last returned by nextFrame() stays valid.
+	 */
+	void stop();
+
+	/**
+	 * Returns if the track is ahead of the frames returned, so that the
+	 * shown status has to be used instead of the track's own.
+	 */
+	bool isActive() const;
+
+	/**
+	 * Get the next decoded frame, waiting for the worker thread if there
+	 * is none yet.
+	 *
+	 * @return the frame, or 0 at the end of the track
+	 */
+	const Frame *nextFrame();
+
+	const VideoTrack *getTrack() const { return _track; }
+	const VideoTrackStatus &getShownStatus() const { return _shownStatus; }
+	const byte *getShownPalette() const { return _shownPalette; }
+	DecodeAheadStats getStats() const;
+
+private:
+	static void threadProc(void *data);
+	void run();
+	bool decodeFrame(Frame *frame);
+
+	VideoDecoder *_decoder;
+	VideoTrack *_track;
+	uint _maxFrames;
+
+	Common::Thread _thread;
+	bool _running;
+
+	// Guarded by _mutex
+	Common::Mutex _mutex;
+	Common::ConditionVariable _cond;
+	Common::List<Frame *> _queue;
+	Common::Array<Frame *> _freeFrames;
+	bool _quit;
+	bool _finished;
+	uint _decodedFrames;
+
+	Frame *_shownFrame;
+	VideoTrackStatus _shownStatus;
+	byte _shownPalette[256 * 3];
+	uint _underruns;
+	uint _droppedFrames;
+};
+
+VideoDecoder::DecodeAhead::DecodeAhead(VideoDecoder *decoder, VideoTrack *track, uint maxFrames) :
+		_decoder(decoder), _track(track), _maxFrames(maxFrames), _running(false), _quit(false),
+		_finished(false), _decodedFrames(0), _shownFrame(0), _underruns(0), _droppedFrames(0) {
+	memset(_shownPalette, 0, sizeof(_shownPalette));
+}
+
+VideoDecoder::DecodeAhead::~DecodeAhead() {
+	stop();
+
+	for (uint i = 0; i < _freeFrames.size(); i++) {
+		_freeFrames[i]->surface.free();
+		delete _freeFrames[i];
+	}
+
+	if (_shownFrame) {
+		_shownFrame->surface.free();
+		delete _shownFrame;
+	}
+}
+
+bool VideoDecoder::DecodeAhead::start() {
+	if (_running)
+		return true;
+
+	_quit = false;
+	_finished = false;
+
+	// Frames kept by suspend() are still to be shown
+	if (_queue.empty())
+		_shownStatus = VideoTrackStatus(_track);
+
+	_running = _thread.start(threadProc, this);
+	return _running;
+}
+
+void VideoDecoder::DecodeAhead::suspend() {
+	if (!_running)
+		return;
+
+	{
+		Common::StackLock lock(_mutex);
+		_quit = true;
+		_cond.broadcast();
+	}
+
+	_thread.join();
+	_running = false;
+}
+
+void VideoDecoder::DecodeAhead::stop() {
+	suspend();
+
+	while (!_queue.empty()) {
+		_freeFrames.push_back(_queue.front());
+		_queue.pop_front();
+	}
+}
+
+bool VideoDecoder::DecodeAhead::isActive() const {
+	if (_running)
+		return true;
+
+	Common::StackLock lock(_mutex);
+	return !_queue.empty();
+}
+
+const VideoDecoder::DecodeAhead::Frame *VideoDecoder::DecodeAhead::nextFrame() {
+	Common::StackLock lock(_mutex);
+
+	// The frame returned before is not used anymore
+	if (_shownFrame) {
+		_freeFrames.push_back(_shownFrame);
+		_shownFrame = 0;
+	}
+
+	if (_queue.empty() && !_finished) {
+		_underruns++;
+
+		while (_queue.empty() && !_finished)
+			_cond.wait(_mutex);
+	}
+
+	if (_queue.empty())
+		return 0;
+
+	_shownFrame = _queue.front();
+	_queue.pop_front();
+	_cond.broadcast();
+
+	_shownStatus = _shownFrame->status;
+	if (_shownFrame->dirtyPalette)
+		memcpy(_shownPalette, _shownFrame->palette, sizeof(_shownPalette));
+
+	// Count the frame as dropped if the one after it is due already
+	if (_decoder->isPlaying() && !_decoder->isPaused() && !_shownStatus.endOfTrack &&
+			_shownStatus.nextFrameStartTime <= _decoder->getTime())
+		_droppedFrames++;
+
+	return _shownFrame;
+}
+
+VideoDecoder::DecodeAheadStats VideoDecoder::DecodeAhead::getStats() const {
+	Common::StackLock lock(_mutex);
+
+	DecodeAheadStats stats;
+	stats.queuedFrames = _queue.size();
+	stats.maxFrames = _maxFrames;
+	stats.decodedFrames = _decodedFrames;
+	stats.underruns = _underruns;
+	stats.droppedFrames = _droppedFrames;
+	return stats;
+}
+
+void VideoDecoder::DecodeAhead::threadProc(void *data) {
+	((DecodeAhead *)data)->run();
+}
+
+void VideoDecoder::DecodeAhead::run() {
+	for (;;) {
+		Frame *frame;
+
+		{
+			Common::StackLock lock(_mutex);
+
+			while (!_quit && _queue.size() >= _maxFrames)
+				_cond.wait(_mutex);
+
+			if (_quit)
+				return;
+
+			if (_freeFrames.empty()) {
+				frame = new Frame();
+			} else {
+				frame = _freeFrames.back();
+				_freeFrames.pop_back();
+			}
+		}
+
+		bool decoded = decodeFrame(frame);
+
+		Common::StackLock lock(_mutex);
+
+		if (decoded) {
+			_queue.push_back(frame);
+			_decodedFrames++;
+		} else {
+			_freeFrames.push_back(frame);
+			_finished = true;
+		}
+
+		_cond.broadcast();
+
+		if (!decoded)
+			return;
+	}
+}
+
+bool VideoDecoder::DecodeAhead::decodeFrame(Frame *frame) {
+	Common::StackLock lock(_decoder->_trackMutex);
+
+	// Same as decodeNextFrame(), keeping the results in the frame
+	_decoder->readNextPacket();
+
+	if (!_decoder->_nextVideoTrack)
+		return false;
+
+	const Graphics::Surface *surface = _track->decodeNextFrame();
+
+	frame->hasSurface = surface != 0;
+	if (surface) {
+		// Reuse the surface of an earlier frame if possible
+		if (frame->surface.w == surface->w && frame->surface.h == surface->h && frame->surface.format == surface->format)
+			frame->surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+		else
+			frame->surface.copyFrom(*surface);
+	}
+
+	frame->dirtyPalette = _track->hasDirtyPalette();
+	if (frame->dirtyPalette)
+		memcpy(frame->palette, _track->getPalette(), sizeof(frame->palette));
+
+	_decoder->findNextVideoTrack();
+	frame->status = VideoTrackStatus(_track);
+	return true;
+}
+
+VideoDecoder::VideoTrackStatus::VideoTrackStatus(const VideoTrack *track) :
+		curFrame(track->getCurFrame()),
+		nextFrameStartTime(track->getNextFrameStartTime()),
+		endOfTrack(track->endOfTrack()) {
+}
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -49,6 +333,8 @@ VideoDecoder::VideoDecoder() {
 	_nextVideoTrack = 0;
 	_mainAudioTrack = 0;
 	_canSetDither = true;
+	_decodeAhead = 0;
+	_oldDecodeAhead = 0;
 
 	// Find the best format for output
 	_defaultHighColorFormat = g_system->getScreenFormat();
@@ -57,7 +343,17 @@ VideoDecoder::VideoDecoder() {
 		_defaultHighColorFormat = Graphics::PixelFormat(4, 8, 8, 8, 8, 8, 16, 24, 0);
 }
 
+VideoDecoder::~VideoDecoder() {
+	delete _decodeAhead;
+	delete _oldDecodeAhead;
+}
+
 void VideoDecoder::close() {
+	delete _decodeAhead;
+	_decodeAhead = 0;
+	delete _oldDecodeAhead;
+	_oldDecodeAhead = 0;
+
 	if (isPlaying())
 		stop();
 
@@ -110,6 +406,8 @@ void VideoDecoder::pauseVideo(bool pause) {
 		return;
 	}
 
+	Common::StackLock lock(_trackMutex);
+
 	if (_pauseLevel == 1 && pause) {
 		_pauseStartTime = g_system->getMillis(); // Store the starting time from pausing to keep it for later
 
@@ -131,6 +429,8 @@ void VideoDecoder::resetPauseStartTime() {
 void VideoDecoder::setVolume(byte volume) {
 	_audioVolume = volume;
 
+	Common::StackLock lock(_trackMutex);
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
 			((AudioTrack *)*it)->setVolume(_audioVolume);
@@ -139,6 +439,8 @@ void VideoDecoder::setVolume(byte volume) {
 void VideoDecoder::setBalance(int8 balance) {
 	_audioBalance = balance;
 
+	Common::StackLock lock(_trackMutex);
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
 			((AudioTrack *)*it)->setBalance(_audioBalance);
@@ -151,6 +453,8 @@ Audio::Mixer::SoundType VideoDecoder::getSoundType() const {
 void VideoDecoder::setSoundType(Audio::Mixer::SoundType soundType) {
 	_soundType = soundType;
 
+	Common::StackLock lock(_trackMutex);
+
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
 			((AudioTrack *)*it)->setSoundType(_soundType);
@@ -188,6 +492,32 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_needsUpdate = false;
 	_canSetDither = false;
 
+	// The frame kept by setDecodeAhead() is not used anymore. Its palette
+	// may still be the current one, the track has the same or a newer one.
+	if (_oldDecodeAhead) {
+		if (_palette == _oldDecodeAhead->getShownPalette()) {
+			_palette = _oldDecodeAhead->getTrack()->getPalette();
+			_dirtyPalette = true;
+		}
+
+		delete _oldDecodeAhead;
+		_oldDecodeAhead = 0;
+	}
+
+	if (_decodeAhead && _decodeAhead->start()) {
+		const DecodeAhead::Frame *frame = _decodeAhead->nextFrame();
+
+		if (!frame)
+			return 0;
+
+		if (frame->dirtyPalette) {
+			_palette = _decodeAhead->getShownPalette();
+			_dirtyPalette = true;
+		}
+
+		return frame->hasSurface ? &frame->surface : 0;
+	}
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -213,6 +543,10 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	// Frames are only decoded ahead when playing forward
+	if (_decodeAhead)
+		return !reverse;
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)*it)->isReversed() != reverse) {
@@ -237,7 +571,7 @@ int VideoDecoder::getCurFrame() const {
 
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo)
-			frame += ((VideoTrack *)*it)->getCurFrame() + 1;
+			frame += getTrackStatus((const VideoTrack *)*it).curFrame + 1;
 
 	return frame;
 }
@@ -274,13 +608,21 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate)
+		return 0;
+
+	// While decoding ahead, _nextVideoTrack belongs to the worker thread
+	const VideoTrack *nextVideoTrack = _nextVideoTrack;
+	if (_decodeAhead && _decodeAhead->isActive())
+		nextVideoTrack = _decodeAhead->getShownStatus().endOfTrack ? 0 : _decodeAhead->getTrack();
+
+	if (!nextVideoTrack)
 		return 0;
 
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+	uint32 nextFrameStartTime = getTrackStatus(nextVideoTrack).nextFrameStartTime;
 
-	if (_nextVideoTrack->isReversed()) {
+	if (nextVideoTrack->isReversed()) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -296,11 +638,21 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	// Audio tracks are fed by readNextPacket() in the decode ahead worker
+	Common::StackLock lock(_trackMutex);
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++) {
 		const Track *track = *it;
 
-		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool endReached;
+		if (track->getTrackType() == Track::kTrackTypeVideo) {
+			VideoTrackStatus status = getTrackStatus((const VideoTrack *)track);
+			bool videoEndTimeReached = _endTimeSet && status.nextFrameStartTime >= (uint)_endTime.msecs();
+			endReached = status.endOfTrack || (isPlaying() && videoEndTimeReached);
+		} else {
+			endReached = track->endOfTrack();
+		}
+
 		if (!endReached)
 			return false;
 	}
@@ -323,6 +675,10 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	// The frames decoded ahead are from before the rewind
+	if (_decodeAhead)
+		_decodeAhead->stop();
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -357,6 +713,10 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	// The frames decoded ahead are from before the seek
+	if (_decodeAhead)
+		_decodeAhead->stop();
+
 	// Stop all tracks so they can be seeked
 	if (isPlaying())
 		stopAudio();
@@ -423,6 +783,11 @@ void VideoDecoder::stop() {
 	if (!isPlaying())
 		return;
 
+	// Keep the frames decoded ahead for when playback starts again, but do
+	// not decode any more until then
+	if (_decodeAhead)
+		_decodeAhead->suspend();
+
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
@@ -481,6 +846,7 @@ void VideoDecoder::setRate(const Common::Rational &rate) {
 	if (_lastTimeChange != 0)
 		_startTime -= (_lastTimeChange.msecs() / _playbackRate).toInt();
 
+	Common::StackLock lock(_trackMutex);
 	startAudio();
 }
 
@@ -764,10 +1130,13 @@ bool VideoDecoder::addStreamFileTrack(const Common::String &baseName) {
 
 	bool result = track->loadFromFile(baseName);
 
-	if (result)
+	if (result) {
+		// The worker thread goes through the tracks after each frame
+		Common::StackLock lock(_trackMutex);
 		addTrack(track, true);
-	else
+	} else {
 		delete track;
+	}
 
 	return result;
 }
@@ -784,6 +1153,7 @@ bool VideoDecoder::setAudioTrack(int index) {
 	if (_mainAudioTrack == audioTrack)
 		return true;
 
+	Common::StackLock lock(_trackMutex);
 	_mainAudioTrack->setMute(true);
 	audioTrack->setMute(false);
 	_mainAudioTrack = audioTrack;
@@ -801,6 +1171,7 @@ uint VideoDecoder::getAudioTrackCount() const {
 }
 
 void VideoDecoder::setEndTime(const Audio::Timestamp &endTime) {
+	Common::StackLock lock(_trackMutex);
 	Audio::Timestamp startTime = 0;
 
 	if (isPlaying()) {
@@ -863,6 +1234,10 @@ const VideoDecoder::Track *VideoDecoder::getTrack(uint track) const {
 }
 
 bool VideoDecoder::endOfVideoTracks() const {
+	// This is the state of the tracks themselves, for readNextPacket()
+	// implementations, which may be running in the decode ahead worker
+	Common::StackLock lock(_trackMutex);
+
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeVideo && !(*it)->endOfTrack())
 			return false;
@@ -922,10 +1297,10 @@ bool VideoDecoder::hasFramesLeft() const {
 		if ((*it)->getTrackType() != Track::kTrackTypeVideo)
 			continue;
 
-		const VideoTrack *track = (const VideoTrack *)*it;
+		VideoTrackStatus status = getTrackStatus((const VideoTrack *)*it);
 
-		bool videoEndTimeReached = _endTimeSet && track->getNextFrameStartTime() >= (uint)_endTime.msecs();
-		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
+		bool videoEndTimeReached = _endTimeSet && status.nextFrameStartTime >= (uint)_endTime.msecs();
+		bool endReached = status.endOfTrack || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
 			return true;
 	}
@@ -933,6 +1308,64 @@ bool VideoDecoder::hasFramesLeft() const {
 	return false;
 }
 
+bool VideoDecoder::setDecodeAhead(bool enable, uint maxFrames) {
+	if (_decodeAhead) {
+		// The caller may still draw the frame and palette returned last,
+		// which belong to the worker, so keep it until the next frame
+		_decodeAhead->stop();
+		delete _oldDecodeAhead;
+		_oldDecodeAhead = _decodeAhead;
+		_decodeAhead = 0;
+	}
+
+	if (!enable || maxFrames == 0)
+		return false;
+
+	VideoTrack *track = 0;
+
+	for (TrackList::iterator it = _tracks.begin(); it != _tracks.end(); it++) {
+		if ((*it)->getTrackType() == Track::kTrackTypeVideo) {
+			// Only one video track may be decoded ahead
+			if (track)
+				return false;
+
+			track = (VideoTrack *)*it;
+		}
+	}
+
+	if (!track || track->isReversed())
+		return false;
+
+	_decodeAhead = new DecodeAhead(this, track, maxFrames);
+
+	if (!_decodeAhead->start()) {
+		delete _decodeAhead;
+		_decodeAhead = 0;
+		return false;
+	}
+
+	// The worker thread starts decoding right away
+	_canSetDither = false;
+	return true;
+}
+
+VideoDecoder::DecodeAheadStats VideoDecoder::getDecodeAheadStats() const {
+	if (_decodeAhead)
+		return _decodeAhead->getStats();
+
+	DecodeAheadStats stats;
+	memset(&stats, 0, sizeof(stats));
+	return stats;
+}
+
+VideoDecoder::VideoTrackStatus VideoDecoder::getTrackStatus(const VideoTrack *track) const {
+	// The track itself is already some frames further
+	if (_decodeAhead && _decodeAhead->isActive() && track == _decodeAhead->getTrack())
+		return _decodeAhead->getShownStatus();
+
+	return VideoTrackStatus(track);
+}
+
 bool VideoDecoder::hasAudio() const {
 	for (TrackList::const_iterator it = _tracks.begin(); it != _tracks.end(); it++)
 		if ((*it)->getTrackType() == Track::kTrackTypeAudio)
@@ -26,6 +26,7 @@
 #include "audio/mixer.h"
 #include "audio/timestamp.h"	// TODO: Move this to common/ ?
 #include "common/array.h"
+#include "common/mutex.h"
 #include "common/path.h"
 #include "common/rational.h"
 #include "common/str.h"
@@ -53,7 +54,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -397,6 +398,58 @@ public:
 	 */
 	bool setDitheringPalette(const byte *palette);
 
+	/////////////////////////////////////////
+	// Decoding Ahead
+	/////////////////////////////////////////
+
+	/**
+	 * Statistics about the frames decoded ahead.
+	 */
+	struct DecodeAheadStats {
+		uint queuedFrames;  ///< Frames decoded and waiting to be returned
+		uint maxFrames;     ///< The most frames decoded ahead at a time
+		uint decodedFrames; ///< Frames decoded by the worker thread
+		uint underruns;     ///< Times decodeNextFrame() had to wait for a frame
+		uint droppedFrames; ///< Frames returned when the next one was already due
+	};
+
+	/**
+	 * Decode frames ahead of time in a worker thread.
+	 *
+	 * decodeNextFrame() then returns frames from a queue of decoded frames,
+	 * so that a frame that is slow to decode does not hold up the engine.
+	 * The playback status, like getCurFrame() or getTimeToNextFrame(),
+	 * still describes the frames decodeNextFrame() returned. Seeking or
+	 * rewinding drops the queued frames, stopping only pauses the worker
+	 * thread until the next decodeNextFrame().
+	 *
+	 * This should be called after loadStream(), and only works for videos
+	 * with a single video track playing forward, on backends with threads.
+	 * readNextPacket() and the track's decodeNextFrame() are called from the
+	 * worker thread then, so a subclass may not use its video track from
+	 * other functions while decoding ahead. close() stops decoding ahead.
+	 *
+	 * Changing it during playback keeps the frame decodeNextFrame() returned
+	 * last valid, but skips the frames which were decoded ahead and not
+	 * returned yet.
+	 *
+	 * @param enable    true to decode ahead, false to decode on demand
+	 * @param maxFrames the number of frames to decode ahead at most
+	 * @return true if frames are decoded ahead now, false otherwise
+	 */
+	bool setDecodeAhead(bool enable, uint maxFrames = 4);
+
+	/**
+	 * Returns if frames are decoded ahead.
+	 */
+	bool isDecodingAhead() const { return _decodeAhead != 0; }
+
+	/**
+	 * Get statistics about the frames decoded ahead since setDecodeAhead()
+	 * was called. Everything is zero when not decoding ahead.
+	 */
+	DecodeAheadStats getDecodeAheadStats() const;
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -960,6 +1013,34 @@ private:
 	// Default PixelFormat settings
 	Graphics::PixelFormat _defaultHighColorFormat;
 
+	// The status of a video track, kept for frames decoded ahead
+	struct VideoTrackStatus {
+		VideoTrackStatus() : curFrame(-1), nextFrameStartTime(0), endOfTrack(false) {}
+		explicit VideoTrackStatus(const VideoTrack *track);
+
+		int curFrame;
+		uint32 nextFrameStartTime;
+		bool endOfTrack;
+	};
+
+	// Decoding frames ahead in a worker thread
+	class DecodeAhead;
+	DecodeAhead *_decodeAhead;
+
+	// Stopped, but still holding the frame and palette decodeNextFrame()
+	// returned last, when decoding ahead was turned off after it
+	DecodeAhead *_oldDecodeAhead;
+
+	// Held by the worker thread while it decodes, and by everything else
+	// that uses the tracks while it may be running
+	Common::Mutex _trackMutex;
+
+	/**
+	 * Get the status of a video track as of the last frame decodeNextFrame()
+	 * returned, which differs from the track's own when decoding ahead.
+	 */
+	VideoTrackStatus getTrackStatus(const VideoTrack *track) const;
+
 protected:
 	// Internal helper functions
 	void stopAudio();